@@ -2,11 +2,16 @@ part of '../record.dart';
 
 /// Methods for stream recording.
 mixin _StreamMixin {
-  StreamController<Uint8List>? _recordStreamCtrl;
+  StreamController<Object>? _recordStreamCtrl;
   StreamSubscription? _recordStreamSubscription;
 
-  Future<Stream<Uint8List>> _startRecordStream(Stream<Uint8List> stream) async {
-    _recordStreamCtrl ??= StreamController.broadcast();
+  /// [T] is either [Uint8List] or [EncodedPacket].
+  Future<Stream<T>> _startRecordStream<T extends Object>(
+    Stream<T> stream,
+  ) async {
+    // Synchronous, chunks are acknowledged to the platform once listeners
+    // handled them.
+    _recordStreamCtrl ??= StreamController.broadcast(sync: true);
 
     _recordStreamSubscription = stream.listen(
       (data) {
@@ -16,7 +21,7 @@ mixin _StreamMixin {
       },
     );
 
-    return _recordStreamCtrl!.stream;
+    return _recordStreamCtrl!.stream.cast<T>();
   }
 
   /// Stops and closes the record stream.
@@ -30,6 +30,18 @@ class AudioRecorder with _AmplitudeMixin, _StateMixin, _StreamMixin {
     _platform.create(_recorderId).whenComplete(() => _semaphore.release());
   }
 
+  /// Opens the capture of [config] ahead of [start] or [startStream], so they
+  /// only keep audio from their call instead of opening the device.
+  ///
+  /// Start with the same device, sample rate, channels, sample format and
+  /// latency to use it. The device is in use until started, stopped or
+  /// disposed.
+  ///
+  /// Does nothing on unsupported platforms.
+  Future<void> prepare(RecordConfig config) {
+    return _safeCall(() => _platform.prepare(_recorderId, config));
+  }
+
   /// Starts new recording session.
   ///
   /// [path]: The output path file. Required on all IO platforms.
@@ -62,6 +74,28 @@ class AudioRecorder with _AmplitudeMixin, _StateMixin, _StreamMixin {
     return _startRecordStream(stream);
   }
 
+  /// Starts stream recording and returns the stream of packets with their
+  /// timing.
+  ///
+  /// With compressed encoders, each packet is an encoder output without
+  /// container. Decoder setup data, when required, is the first packet
+  /// (see [EncodedPacket.isConfig]).
+  ///
+  /// When stopping the record, you must rely on stream close event to get
+  /// full recorded data.
+  Future<Stream<EncodedPacket>> startPacketStream(RecordConfig config) async {
+    final stream = await _safeCall(
+      () async {
+        await _stopRecordStream();
+        _initStateStream();
+
+        return _platform.startPacketStream(_recorderId, config);
+      },
+    );
+
+    return _startRecordStream(stream);
+  }
+
   /// Stops recording session and release internal recorder resource.
   ///
   /// Returns the output path if any.
@@ -111,6 +145,29 @@ class AudioRecorder with _AmplitudeMixin, _StateMixin, _StreamMixin {
     return _onAmplitudeChanged(interval, isRecording, getAmplitude);
   }
 
+  /// Listen to waveform envelope buckets computed natively.
+  ///
+  /// [RecordConfig.envelopeInterval] must be set when starting the recording.
+  Stream<EnvelopeBucket> onEnvelope() => _platform.onEnvelope(_recorderId);
+
+  /// Listen to spectrum frames computed natively.
+  ///
+  /// Each frame holds band magnitudes in dBFS, from low to high frequencies.
+  /// [RecordConfig.spectrum] must be set when starting the recording.
+  Stream<Float32List> onSpectrum() => _platform.onSpectrum(_recorderId);
+
+  /// Listen to voice activity changes, `true` when voice starts.
+  ///
+  /// [RecordConfig.vad] must be set when starting the recording.
+  Stream<bool> onVoiceActivity() => _platform.onVoiceActivity(_recorderId);
+
+  /// Listen to input devices being added or removed and to default input
+  /// device changes.
+  ///
+  /// [listInputDevices] returns the list the changes apply to.
+  Stream<InputDeviceChange> onInputDevicesChanged() =>
+      _platform.onInputDevicesChanged(_recorderId);
+
   /// Checks if there's valid recording session.
   /// So if session is paused, this method will still return [true].
   Future<bool> isRecording() {
@@ -146,6 +203,37 @@ class AudioRecorder with _AmplitudeMixin, _StateMixin, _StreamMixin {
     return _safeCall(() => _platform.getAmplitude(_recorderId));
   }
 
+  /// Gets current loudness measurements (ITU-R BS.1770 / EBU R128).
+  ///
+  /// Values of the last recording remain available after [stop]
+  /// until a new recording is started.
+  ///
+  /// Returns [null] on unsupported platforms.
+  Future<Loudness?> getLoudness() {
+    return _safeCall(() => _platform.getLoudness(_recorderId));
+  }
+
+  /// Gets stream delivery counters of the current or last stream.
+  ///
+  /// Returns [null] on unsupported platforms.
+  Future<StreamStats?> getStreamStats() {
+    return _safeCall(() => _platform.getStreamStats(_recorderId));
+  }
+
+  /// Gets the time spent paused by the current or last recording.
+  ///
+  /// Returns [null] on unsupported platforms.
+  Future<Duration?> getPausedDuration() {
+    return _safeCall(() => _platform.getPausedDuration(_recorderId));
+  }
+
+  /// Gets the capture latency and period measured by the current recording.
+  ///
+  /// See [RecordConfig.latency] to request a lower latency.
+  Future<CaptureLatency?> getLatency() {
+    return _safeCall(() => _platform.getLatency(_recorderId));
+  }
+
   /// Checks if the given encoder is supported on the current platform.
   Future<bool> isEncoderSupported(AudioEncoder encoder) {
     return _safeCall(() => _platform.isEncoderSupported(_recorderId, encoder));
@@ -1,44 +1,85 @@
-import 'dart:async';
-import 'dart:convert';
-import 'dart:io';
-import 'dart:math';
 import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
 
 import 'package:record_platform_interface/record_platform_interface.dart';
 
-const _parecordBin = 'parecord';
-const _ffmpegBin = 'ffmpeg';
-
 class RecordLinux extends RecordPlatform {
   static void registerWith() {
     RecordPlatform.instance = RecordLinux();
   }
 
-  RecordState _state = RecordState.stop;
-  String? _path;
-  StreamController<RecordState>? _stateStreamCtrl;
-  Process? _parecordProcess;
-  Process? _ffmpegProcess;
-  StreamController<List<int>>? _inputPcmController;
-  double _currentAmplitude = -160.0;
-  double _maxAmplitude = -160.0;
+  // Capture and encoding run in the native plugin, keyed by recorder id.
+  final _methodChannel = const MethodChannel('com.llfbandit.record/messages');
+
+  // Device changes are global to the plugin, the channel is shared.
+  Stream<InputDeviceChange>? _inputDevicesChanges;
 
   @override
-  Future<void> create(String recorderId) async {}
+  Future<void> create(String recorderId) {
+    return _methodChannel.invokeMethod<void>(
+      'create',
+      {'recorderId': recorderId},
+    );
+  }
 
   @override
   Future<void> dispose(String recorderId) async {
-    await _stateStreamCtrl?.close();
-    _stateStreamCtrl = null;
-
     await stop(recorderId);
+
+    await _methodChannel.invokeMethod<void>(
+      'dispose',
+      {'recorderId': recorderId},
+    );
+  }
+
+  @override
+  Future<Amplitude> getAmplitude(String recorderId) async {
+    final result = await _methodChannel.invokeMethod(
+      'getAmplitude',
+      {'recorderId': recorderId},
+    );
+
+    return Amplitude.fromMap(result ?? const {});
+  }
+
+  @override
+  Future<Loudness?> getLoudness(String recorderId) async {
+    final result = await _methodChannel.invokeMethod(
+      'getLoudness',
+      {'recorderId': recorderId},
+    );
+
+    return result != null ? Loudness.fromMap(result) : null;
+  }
+
+  @override
+  Future<StreamStats?> getStreamStats(String recorderId) async {
+    final result = await _methodChannel.invokeMethod(
+      'getStreamStats',
+      {'recorderId': recorderId},
+    );
+
+    return result != null ? StreamStats.fromMap(result) : null;
   }
 
   @override
-  Future<Amplitude> getAmplitude(String recorderId) {
-    return Future.value(
-      Amplitude(current: _currentAmplitude, max: _maxAmplitude),
+  Future<Duration?> getPausedDuration(String recorderId) async {
+    final result = await _methodChannel.invokeMethod<int>(
+      'getPausedDuration',
+      {'recorderId': recorderId},
     );
+
+    return result != null ? Duration(microseconds: result) : null;
+  }
+
+  @override
+  Future<CaptureLatency?> getLatency(String recorderId) async {
+    final result = await _methodChannel.invokeMethod(
+      'getLatency',
+      {'recorderId': recorderId},
+    );
+
+    return result != null ? CaptureLatency.fromMap(result) : null;
   }
 
   @override
@@ -51,66 +92,76 @@ class RecordLinux extends RecordPlatform {
     String recorderId,
     AudioEncoder encoder,
   ) async {
-    switch (encoder) {
-      case AudioEncoder.aacLc:
-      case AudioEncoder.flac:
-      case AudioEncoder.opus:
-      case AudioEncoder.wav:
-        return true;
-      default:
-        return false;
-    }
+    // Compressed encoders depend on libraries found at build time.
+    final result = await _methodChannel.invokeMethod<bool>(
+      'isEncoderSupported',
+      {'recorderId': recorderId, 'encoder': encoder.name},
+    );
+
+    return result ?? false;
   }
 
   @override
-  Future<bool> isPaused(String recorderId) {
-    return Future.value(_state == RecordState.pause);
+  Future<bool> isPaused(String recorderId) async {
+    final result = await _methodChannel.invokeMethod<bool>(
+      'isPaused',
+      {'recorderId': recorderId},
+    );
+
+    return result ?? false;
   }
 
   @override
-  Future<bool> isRecording(String recorderId) {
-    return Future.value(_state == RecordState.record);
+  Future<bool> isRecording(String recorderId) async {
+    final result = await _methodChannel.invokeMethod<bool>(
+      'isRecording',
+      {'recorderId': recorderId},
+    );
+
+    return result ?? false;
   }
 
   @override
-  Future<void> pause(String recorderId) async {
-    if (_state == RecordState.record) {
-      _parecordProcess?.kill(ProcessSignal.sigstop);
-      _updateState(RecordState.pause);
-    }
+  Future<void> pause(String recorderId) {
+    return _methodChannel.invokeMethod<void>(
+      'pause',
+      {'recorderId': recorderId},
+    );
   }
 
   @override
-  Future<void> resume(String recorderId) async {
-    if (_state == RecordState.pause) {
-      _parecordProcess?.kill(ProcessSignal.sigcont);
-      _updateState(RecordState.record);
-    }
+  Future<void> resume(String recorderId) {
+    return _methodChannel.invokeMethod<void>(
+      'resume',
+      {'recorderId': recorderId},
+    );
   }
 
+  @override
+  Future<void> prepare(String recorderId, RecordConfig config) {
+    return _methodChannel.invokeMethod<void>('prepare', {
+      'recorderId': recorderId,
+      ...config.toMap(),
+      'numChannels': _getNumChannels(config),
+    });
+  }
+
+  // Native start stops the previous recording itself, keeping the capture
+  // opened by prepare.
   @override
   Future<void> start(
     String recorderId,
     RecordConfig config, {
     required String path,
   }) async {
-    await stop(recorderId);
-
     await _supportedOrThrow(recorderId, config);
 
-    _deleteFile(path);
-
-    // Step 1: Use parecord to capture raw PCM audio from the microphone
-    // We always capture raw PCM (not encoded) so we can calculate amplitude
-    final args = _getParecordArgs(config, path: null, canEncode: false);
-    _parecordProcess = await Process.start(_parecordBin, args);
-
-    // Step 2: Pipe the raw PCM through amplitude monitoring to ffmpeg for encoding
-    // parecord (capture) -> amplitude calculation -> ffmpeg (encode to file)
-    _startFfmpegWithAmplitudeMonitoring(config, _parecordProcess!, path);
-
-    _path = path;
-    _updateState(RecordState.record);
+    await _methodChannel.invokeMethod<void>('start', {
+      'recorderId': recorderId,
+      'path': path,
+      ...config.toMap(),
+      'numChannels': _getNumChannels(config),
+    });
   }
 
   @override
@@ -118,319 +169,176 @@ class RecordLinux extends RecordPlatform {
     String recorderId,
     RecordConfig config,
   ) async {
-    await stop(recorderId);
-
-    final args = _getParecordArgs(config);
-    _parecordProcess = await Process.start(_parecordBin, args);
+    final (_, events) = await _startNativeStream(recorderId, config);
 
-    _updateState(RecordState.record);
-
-    return _parecordProcess!.stdout.map((list) {
-      final data = (list is Uint8List) ? list : Uint8List.fromList(list);
-      // Calculate amplitude from PCM data
-      _calculateAmplitude(data);
-      return data;
-    });
+    // Encoded packets are sent with their timing.
+    return events.map<Uint8List>(
+      (event) => event is Uint8List ? event : (event as List).first,
+    );
   }
 
   @override
-  Future<String?> stop(String recorderId) async {
-    final path = _path;
-
-    // Close amplitude stream controller
-    await _inputPcmController?.close();
-    _inputPcmController = null;
-
-    // Kill parecord first
-    _parecordProcess?.kill();
-    _parecordProcess = null;
-
-    // Close ffmpeg stdin and wait for it to finish
-    if (_ffmpegProcess case final process?) {
-      // Wait for ffmpeg to finish writing
-      await process.exitCode;
-      _ffmpegProcess = null;
+  Future<Stream<EncodedPacket>> startPacketStream(
+    String recorderId,
+    RecordConfig config,
+  ) async {
+    final (codecConfig, events) = await _startNativeStream(recorderId, config);
+
+    if (config.encoder == AudioEncoder.pcm16bits) {
+      return EncodedPacket.fromPcmStream(
+        events.cast<Uint8List>(),
+        sampleRate: config.sampleRate,
+        numChannels: _getNumChannels(config),
+        sampleFormat: config.sampleFormat,
+      );
     }
 
-    _path = null;
-
-    // Reset amplitude values
-    _currentAmplitude = -160.0;
-    _maxAmplitude = -160.0;
+    final packets = events.map<EncodedPacket>(
+      (event) => EncodedPacket.fromList(event as List),
+    );
 
-    _updateState(RecordState.stop);
+    if (codecConfig == null) return packets;
 
-    return path;
+    return Stream.multi((controller) {
+      controller.add(EncodedPacket(
+        data: codecConfig,
+        timestamp: Duration.zero,
+        duration: Duration.zero,
+        isConfig: true,
+      ));
+      controller.addStream(packets).whenComplete(controller.close);
+    });
   }
 
   @override
-  Future<void> cancel(String recorderId) async {
-    final path = await stop(recorderId);
+  Future<String?> stop(String recorderId) {
+    return _methodChannel.invokeMethod<String>(
+      'stop',
+      {'recorderId': recorderId},
+    );
+  }
 
-    _deleteFile(path);
+  @override
+  Future<void> cancel(String recorderId) {
+    return _methodChannel.invokeMethod<void>(
+      'cancel',
+      {'recorderId': recorderId},
+    );
   }
 
   @override
   Future<List<InputDevice>> listInputDevices(String recorderId) async {
-    final outStreamCtrl = StreamController<List<int>>();
-
-    final out = <String>[];
-    outStreamCtrl.stream
-        .transform(utf8.decoder)
-        .transform(const LineSplitter())
-        .listen((chunk) {
-      out.add(chunk);
-    });
-
-    try {
-      await _callPactl(
-        ['list', 'sources'],
-        recorderId: recorderId,
-        outStreamCtrl: outStreamCtrl,
-      );
+    final devices = await _methodChannel.invokeMethod<List<dynamic>>(
+      'listInputDevices',
+      {'recorderId': recorderId},
+    );
 
-      return _parseInputDevices(out);
-    } finally {
-      outStreamCtrl.close();
-    }
+    return devices
+            ?.map((d) => InputDevice.fromMap(d as Map))
+            .toList(growable: false) ??
+        [];
   }
 
   @override
   Stream<RecordState> onStateChanged(String recorderId) {
-    _stateStreamCtrl ??= StreamController.broadcast();
-    return _stateStreamCtrl!.stream;
-  }
-
-  void _deleteFile(String? path) {
-    if (path == null) return;
+    final eventChannel = EventChannel(
+      'com.llfbandit.record/events/$recorderId',
+    );
 
-    final file = File(path);
-    if (file.existsSync()) {
-      file.deleteSync();
-    }
+    return eventChannel.receiveBroadcastStream().map<RecordState>(
+          (state) => RecordState.values.firstWhere((e) => e.index == state),
+        );
   }
 
-  Future<void> _supportedOrThrow(String recorderId, RecordConfig config) async {
-    final supported = await isEncoderSupported(recorderId, config.encoder);
-    if (!supported) {
-      throw Exception('${config.encoder} is not supported.');
-    }
-  }
+  @override
+  Stream<EnvelopeBucket> onEnvelope(String recorderId) {
+    final eventChannel = EventChannel(
+      'com.llfbandit.record/eventsEnvelope/$recorderId',
+    );
 
-  List<String> _getParecordArgs(
-    RecordConfig config, {
-    String? path,
-    bool canEncode = false,
-  }) {
-    final numChannels = _getNumChannels(config);
-
-    final args = [
-      '--raw',
-      '--format=s16le',
-      '--rate=${config.sampleRate}',
-      '--channels=$numChannels',
-      '--latency-msec=100',
-      if (config.device != null) '--device=${config.device!.id}',
-      if (config.autoGain) '--property=auto_gain_control=1',
-      if (config.echoCancel) '--property=echo_cancellation=1',
-      if (config.noiseSuppress) '--property=noise_suppression=1',
-      if (canEncode) ...[
-        '--file-format=${config.encoder.name}',
-        if (path case final path?) path,
-      ],
-    ];
-
-    return args;
+    return eventChannel
+        .receiveBroadcastStream()
+        .expand<EnvelopeBucket>((data) => EnvelopeBucket.fromFloat32List(data));
   }
 
-  int _getNumChannels(RecordConfig config) {
-    return config.numChannels.clamp(1, 2);
-  }
+  @override
+  Stream<Float32List> onSpectrum(String recorderId) {
+    final eventChannel = EventChannel(
+      'com.llfbandit.record/eventsSpectrum/$recorderId',
+    );
 
-  List<String> _getFfmpegEncoderSettings(
-      AudioEncoder encoder, String path, int bitRate) {
-    switch (encoder) {
-      case AudioEncoder.aacLc:
-        return ['-c:a', 'aac', '-b:a', '${bitRate / 1000}k', path];
-      case AudioEncoder.wav:
-        return ['-c:a', 'pcm_s16le', '-f', 'wav', path];
-      case AudioEncoder.flac:
-        return ['-c:a', 'flac', path];
-      case AudioEncoder.opus:
-        return ['-c:a', 'libopus', '-b:a', '${bitRate / 1000}k', path];
-      case AudioEncoder.pcm16bits:
-        return ['-c:a', 'copy', '-f', 's16le', path];
-      default:
-        return [];
-    }
+    return eventChannel.receiveBroadcastStream().cast<Float32List>();
   }
 
-  Future<void> _callPactl(
-    List<String> arguments, {
-    required String recorderId,
-    StreamController<List<int>>? outStreamCtrl,
-    VoidCallback? onStarted,
-    bool consumeOutput = true,
-  }) async {
-    // Force LC_ALL=C for pactl output to ensure consistent parsing
-    final process = await Process.start('pactl', arguments, environment: {"LC_ALL": "C"});
-
-    if (onStarted != null) {
-      onStarted();
-    }
-
-    // Listen to both stdout & stderr to not leak system resources.
-    if (consumeOutput) {
-      final out = outStreamCtrl ?? StreamController<List<int>>();
-      if (outStreamCtrl == null) out.stream.listen((event) {});
-      final err = StreamController<List<int>>();
-      err.stream.listen((event) {});
-
-      await Future.wait([
-        out.addStream(process.stdout),
-        err.addStream(process.stderr),
-      ]);
+  @override
+  Stream<bool> onVoiceActivity(String recorderId) {
+    final eventChannel = EventChannel(
+      'com.llfbandit.record/eventsVad/$recorderId',
+    );
 
-      if (outStreamCtrl == null) out.close();
-      err.close();
-    }
+    return eventChannel.receiveBroadcastStream().cast<bool>();
   }
 
-  // Output can be retrieved with `pactl list sources`
-  // --- Example ---
-  // Source #2325
-  // State: SUSPENDED
-  // Name: alsa_output.usb-Generic_Blue_Microphones_LT_2201070607069D01069D_111000-00.analog-stereo.monitor
-  // Description: Monitor of Blue Microphones Analog Stereo
-  // Driver: PipeWire
-  // Sample Specification: s16le 2ch 48000Hz
-  // Channel Map: front-left,front-right
-  // Owner Module: 4294967295
-  // Mute: no
-  // Volume: front-left: 65536 / 100% / 0.00 dB,   front-right: 65536 / 100% / 0.00 dB
-  //         balance 0.00
-  // Base Volume: 65536 / 100% / 0.00 dB
-  // Monitor of Sink: alsa_output.usb-Generic_Blue_Microphones_LT_2201070607069D01069D_111000-00.analog-stereo
-  // Latency: 0 usec, configured 0 usec
-  // Flags: HARDWARE DECIBEL_VOLUME LATENCY
-  // Properties:
-  // 	alsa.card = "2"
-  // 	alsa.card_name = "Blue Microphones"
-  // 	alsa.class = "generic"
-  // 	alsa.components = "USB046d:0ab7"
-  //  node.name = "alsa_input.usb-Generic_Blue_Microphones_LT_2201070607069D01069D_111000-00.analog-stereo"
-  List<InputDevice> _parseInputDevices(List<String> output) {
-    final devices = <InputDevice>[];
-    String? currentDeviceId;
-    String? currentDeviceName;
-
-    for (final line in output) {
-      if (line.startsWith('Source #')) {
-        if (currentDeviceId != null && currentDeviceName != null) {
-          if (!currentDeviceName.startsWith('Monitor of')) {
-            devices.add(
-                InputDevice(id: currentDeviceId, label: currentDeviceName));
-          }
-        }
-      } else if (line.trim().startsWith('node.name')) {
-        currentDeviceId = line.split('=')[1].trim();
-      } else if (line.trim().startsWith('Name:')) {
-        currentDeviceName = line.split(':')[1].trim();
-      } else if (line.trim().startsWith('Description:')) {
-        currentDeviceName = line.split(':')[1].trim();
-      }
-    }
-
-    if (currentDeviceId != null && currentDeviceName != null) {
-      if (!currentDeviceName.startsWith('Monitor of')) {
-        devices.add(InputDevice(id: currentDeviceId, label: currentDeviceName));
-      }
-    }
-
-    return devices;
+  @override
+  Stream<InputDeviceChange> onInputDevicesChanged(String recorderId) {
+    return _inputDevicesChanges ??=
+        const EventChannel('com.llfbandit.record/eventsDevices')
+            .receiveBroadcastStream()
+            .map<InputDeviceChange>(
+              (change) => InputDeviceChange.fromMap(change),
+            );
   }
 
-  void _updateState(RecordState state) {
-    if (_state == state) return;
+  /// Starts the native stream.
+  ///
+  /// Returns codec setup data if any, and events, either PCM chunks or
+  /// `[data, timestamp, duration]` packets.
+  Future<(Uint8List?, Stream<dynamic>)> _startNativeStream(
+    String recorderId,
+    RecordConfig config,
+  ) async {
+    final eventRecordChannel = EventChannel(
+      'com.llfbandit.record/eventsRecord/$recorderId',
+    );
 
-    _state = state;
+    final result = await _methodChannel.invokeMethod<Map>('startStream', {
+      'recorderId': recorderId,
+      ...config.toMap(),
+      'numChannels': _getNumChannels(config),
+    });
 
-    if (_stateStreamCtrl case final controller? when controller.hasListener) {
-      controller.add(state);
+    Stream<dynamic> events = eventRecordChannel.receiveBroadcastStream();
+
+    // Native side only sends credit chunks ahead of acknowledgements.
+    final credit = result?['credit'];
+    if (credit is int) {
+      events = acknowledgeEvents(events, credit, (count) {
+        _methodChannel.invokeMethod<void>('ackStream', {
+          'recorderId': recorderId,
+          'count': count,
+        }).catchError((_) {
+          // Recorder is gone, e.g. disposed while its last chunks were
+          // handled.
+        });
+      });
     }
-  }
 
-  void _calculateAmplitude(Uint8List data) {
-    if (data.isEmpty) return;
-
-    // Convert bytes to 16-bit signed integers (little-endian)
-    double maxSample = 0;
-    for (int i = 0; i < data.length - 1; i += 2) {
-      // Combine two bytes into a 16-bit signed integer (little-endian)
-      int sample = data[i] | (data[i + 1] << 8);
-      // Convert unsigned to signed
-      if (sample > 32767) sample -= 65536;
-
-      double absSample = sample.abs().toDouble();
-      if (absSample > maxSample) {
-        maxSample = absSample;
-      }
+    // Zero copy stream, events are chunk locations in the shared ring.
+    if (result != null && result.containsKey('ring')) {
+      return (null, readSharedPcmChunks(result, events));
     }
 
-    // Calculate dBFS
-    if (maxSample > 0) {
-      _currentAmplitude = 20 * (log(maxSample / 32767.0) / ln10);
-    } else {
-      _currentAmplitude = -160.0;
-    }
+    return (result?['codecConfig'] as Uint8List?, events);
+  }
 
-    // Update max amplitude
-    if (_currentAmplitude > _maxAmplitude) {
-      _maxAmplitude = _currentAmplitude;
+  Future<void> _supportedOrThrow(String recorderId, RecordConfig config) async {
+    final supported = await isEncoderSupported(recorderId, config.encoder);
+    if (!supported) {
+      throw Exception('${config.encoder} is not supported.');
     }
   }
 
-  /// Sets up ffmpeg to encode audio while monitoring amplitude.
-  ///
-  /// Audio flow: parecord (capture) -> amplitude calculation -> ffmpeg (encode)
-  /// - parecord: Captures raw PCM audio from the microphone
-  /// - amplitude calculation: Analyzes PCM samples for VU meter (doesn't modify audio)
-  /// - ffmpeg: Encodes the PCM data to the desired format (AAC, WAV, FLAC, etc.)
-  Future<void> _startFfmpegWithAmplitudeMonitoring(
-    RecordConfig config,
-    Process parecordProc,
-    String path,
-  ) async {
-    final ffmpegArgs = [
-      '-f',
-      's16le',
-      '-ar',
-      config.sampleRate.toString(),
-      '-ac',
-      '${_getNumChannels(config)}',
-      '-i',
-      '-',
-      ..._getFfmpegEncoderSettings(config.encoder, path, config.bitRate)
-    ];
-
-    _ffmpegProcess = await Process.start(_ffmpegBin, ffmpegArgs);
-
-    // Create a passthrough stream controller to intercept audio data
-    _inputPcmController = StreamController<List<int>>();
-
-    // Listen to raw PCM data from parecord:
-    // 1. Calculate amplitude for VU meter
-    // 2. Forward the unchanged PCM data to our stream controller
-    parecordProc.stdout.listen((data) {
-      _calculateAmplitude(Uint8List.fromList(data));
-
-      if (_inputPcmController case final ctrl? when !ctrl.isClosed) {
-        ctrl.add(data);
-      }
-    }, onDone: () => _inputPcmController?.close());
-
-    // Pipe the PCM data from our controller to ffmpeg for encoding
-    // This uses pipe() for proper backpressure handling
-    _inputPcmController!.stream.pipe(_ffmpegProcess!.stdin);
+  int _getNumChannels(RecordConfig config) {
+    return config.numChannels.clamp(1, 2);
   }
 }
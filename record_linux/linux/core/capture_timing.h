@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	// Capture delays measured while recording, in microseconds.
+	struct CaptureLatency
+	{
+		// Age of the first frame of a buffer when it is delivered: device
+		// period and buffering. 0 when the platform can't tell.
+		int64_t latencyUs = 0;
+		// Mean duration of the delivered buffers.
+		int64_t periodUs = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  CaptureTiming
+	//  Description: Measures latency and period from the delivered capture
+	//               buffers. Latency is smoothed over about 8 buffers to
+	//               hide scheduling jitter. A single thread adds buffers,
+	//               values are read from any thread.
+	//////////////////////////////////////////////////////////////////////////
+	class CaptureTiming
+	{
+	public:
+		// Must not be called while buffers are added.
+		void Reset()
+		{
+			m_totalUs = 0;
+			m_count = 0;
+			m_smoothedUs = -1;
+			m_latencyUs.store(0, std::memory_order_relaxed);
+			m_periodUs.store(0, std::memory_order_relaxed);
+		}
+
+		// latencyUs is negative when unknown.
+		void AddBuffer(int64_t durationUs, int64_t latencyUs)
+		{
+			if (durationUs <= 0) return;
+
+			m_totalUs += durationUs;
+			m_count++;
+			m_periodUs.store(m_totalUs / m_count, std::memory_order_relaxed);
+
+			if (latencyUs < 0) return;
+
+			m_smoothedUs = m_smoothedUs < 0
+				? latencyUs
+				: m_smoothedUs + (latencyUs - m_smoothedUs) / 8;
+			m_latencyUs.store(m_smoothedUs, std::memory_order_relaxed);
+		}
+
+		CaptureLatency Get() const
+		{
+			CaptureLatency latency;
+			latency.latencyUs = m_latencyUs.load(std::memory_order_relaxed);
+			latency.periodUs = m_periodUs.load(std::memory_order_relaxed);
+			return latency;
+		}
+
+	private:
+		// Capture thread state.
+		int64_t m_totalUs = 0;
+		int64_t m_count = 0;
+		int64_t m_smoothedUs = -1;
+
+		std::atomic<int64_t> m_latencyUs{ 0 };
+		std::atomic<int64_t> m_periodUs{ 0 };
+	};
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	// Shortest allowed bucket duration.
+	constexpr int kMinEnvelopeIntervalMs = 5;
+
+	//////////////////////////////////////////////////////////////////////////
+	//  EnvelopeBucket
+	//  Description: Waveform envelope of a time slice, all channels mixed.
+	//               Values are normalized in [-1, 1].
+	//////////////////////////////////////////////////////////////////////////
+	struct EnvelopeBucket
+	{
+		float min = 0.0f;
+		float max = 0.0f;
+		float rms = 0.0f;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  EnvelopeGenerator
+	//  Description: Decimates interleaved signed 16 bits PCM into one
+	//               min/max/RMS bucket per interval. Buckets may span
+	//               several processed blocks.
+	//////////////////////////////////////////////////////////////////////////
+	class EnvelopeGenerator
+	{
+	public:
+		// Resets the generator. A zero or negative interval disables it.
+		void Configure(int sampleRate, int numChannels, int intervalMs);
+		// Drops the pending bucket.
+		void Reset();
+
+		bool IsEnabled() const { return m_bucketFrames != 0; }
+
+		// Processes interleaved frames and calls onBucket(const EnvelopeBucket&)
+		// for each completed bucket.
+		template <typename OnBucket>
+		void Process(const int16_t* samples, size_t frameCount, OnBucket&& onBucket)
+		{
+			if (!IsEnabled()) return;
+
+			const size_t sampleCount = frameCount * m_frameStride;
+			const size_t bucketSamples = m_bucketFrames * m_frameStride;
+
+			for (size_t i = 0; i < sampleCount; i++)
+			{
+				const int32_t sample = samples[i];
+
+				m_min = std::min(m_min, sample);
+				m_max = std::max(m_max, sample);
+				m_sumSquares += static_cast<uint64_t>(sample * sample);
+
+				if (++m_sampleCount == bucketSamples)
+				{
+					onBucket(TakeBucket());
+				}
+			}
+		}
+
+	private:
+		EnvelopeBucket TakeBucket();
+
+		size_t m_frameStride = 1;
+		size_t m_bucketFrames = 0;
+
+		int32_t m_min = INT16_MAX;
+		int32_t m_max = INT16_MIN;
+		uint64_t m_sumSquares = 0;
+		size_t m_sampleCount = 0;
+	};
+};
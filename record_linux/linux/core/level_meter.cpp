@@ -0,0 +1,126 @@
+#include "level_meter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace record_core
+{
+	// ITU-R BS.1770-4 annex 2, 48 taps interpolation filter split in 4 phases.
+	static constexpr float kTruePeakCoefs[4][12] = {
+		{ 0.0017089843750f, 0.0109863281250f, -0.0196533203125f, 0.0332031250000f, -0.0594482421875f, 0.1373291015625f,
+		  0.9721679687500f, -0.1022949218750f, 0.0476074218750f, -0.0266113281250f, 0.0148925781250f, -0.0083007812500f },
+		{ -0.0291748046875f, 0.0292968750000f, -0.0517578125000f, 0.0891113281250f, -0.1665039062500f, 0.4650878906250f,
+		  0.7797851562500f, -0.2003173828125f, 0.1015625000000f, -0.0582275390625f, 0.0330810546875f, -0.0189208984375f },
+		{ -0.0189208984375f, 0.0330810546875f, -0.0582275390625f, 0.1015625000000f, -0.2003173828125f, 0.7797851562500f,
+		  0.4650878906250f, -0.1665039062500f, 0.0891113281250f, -0.0517578125000f, 0.0292968750000f, -0.0291748046875f },
+		{ -0.0083007812500f, 0.0148925781250f, -0.0266113281250f, 0.0476074218750f, -0.1022949218750f, 0.9721679687500f,
+		  0.1373291015625f, -0.0594482421875f, 0.0332031250000f, -0.0196533203125f, 0.0109863281250f, 0.0017089843750f },
+	};
+
+	static double ToDbfs(double linear)
+	{
+		if (linear <= 0.0)
+		{
+			return kMinDbfs;
+		}
+
+		return std::max(kMinDbfs, 20 * std::log10(linear));
+	}
+
+	void LevelMeter::Configure(int sampleRate, int numChannels)
+	{
+		m_sampleRate = std::max(1, sampleRate);
+		m_frameStride = std::max(1, numChannels);
+		m_numChannels = std::min(m_frameStride, kMaxMeterChannels);
+
+		Reset();
+	}
+
+	void LevelMeter::Reset()
+	{
+		m_levels.Reset();
+		m_channels.fill(ChannelState());
+	}
+
+	void LevelMeter::Process(const int16_t* samples, size_t frameCount)
+	{
+		if (frameCount == 0)
+		{
+			return;
+		}
+
+		m_levels.Reset();
+		MeasurePcm16(samples, frameCount * m_frameStride, m_levels);
+
+		const double blockMs = frameCount * 1000.0 / m_sampleRate;
+
+		for (int ch = 0; ch < m_numChannels; ch++)
+		{
+			auto& state = m_channels[ch];
+			PcmLevels channelLevels;
+			float truePeak = 0.0f;
+
+			for (size_t frame = 0; frame < frameCount; frame++)
+			{
+				const int32_t sample = samples[frame * m_frameStride + ch];
+				const int32_t absSample = sample < 0 ? -sample : sample;
+
+				if (absSample > channelLevels.peak)
+				{
+					channelLevels.peak = absSample;
+				}
+				channelLevels.sumSquares += static_cast<uint64_t>(sample * sample);
+
+				truePeak = std::max(truePeak, TruePeak(state, sample / 32768.0f));
+			}
+			channelLevels.sampleCount = frameCount;
+
+			state.levels.peak = channelLevels.PeakDbfs();
+			state.levels.rms = channelLevels.RmsDbfs();
+			state.levels.truePeak = ToDbfs(truePeak);
+			UpdateHold(state, state.levels.peak, blockMs);
+		}
+	}
+
+	float LevelMeter::TruePeak(ChannelState& state, float sample)
+	{
+		// Newest sample first so taps are applied as a convolution.
+		state.historyPos = (state.historyPos + kTruePeakTaps - 1) % kTruePeakTaps;
+		state.history[state.historyPos] = sample;
+		state.history[state.historyPos + kTruePeakTaps] = sample;
+
+		const float* taps = &state.history[state.historyPos];
+		float peak = std::fabs(sample);
+
+		for (const auto& coefs : kTruePeakCoefs)
+		{
+			float value = 0.0f;
+			for (int i = 0; i < kTruePeakTaps; i++)
+			{
+				value += coefs[i] * taps[i];
+			}
+			peak = std::max(peak, std::fabs(value));
+		}
+
+		return peak;
+	}
+
+	void LevelMeter::UpdateHold(ChannelState& state, double blockPeak, double blockMs)
+	{
+		auto& hold = state.levels.peakHold;
+
+		if (blockPeak >= hold)
+		{
+			hold = blockPeak;
+			state.holdRemainingMs = holdTimeMs;
+		}
+		else if (state.holdRemainingMs > 0.0)
+		{
+			state.holdRemainingMs -= blockMs;
+		}
+		else
+		{
+			hold = std::max(blockPeak, hold - decayDbPerSecond * blockMs / 1000.0);
+		}
+	}
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pcm_meter.h"
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	// Highest number of channels handled by meters.
+	constexpr int kMaxMeterChannels = 8;
+
+	//////////////////////////////////////////////////////////////////////////
+	//  ChannelLevels
+	//  Description: Levels of a single channel for the last processed block.
+	//               All values are in dBFS.
+	//////////////////////////////////////////////////////////////////////////
+	struct ChannelLevels
+	{
+		// Highest absolute sample value.
+		double peak = kMinDbfs;
+		// Root mean square value.
+		double rms = kMinDbfs;
+		// Inter-sample peak estimated with 4x oversampling (ITU-R BS.1770 annex 2).
+		double truePeak = kMinDbfs;
+		// Sample peak held for holdTimeMs and then decaying at decayDbPerSecond.
+		double peakHold = kMinDbfs;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  LevelMeter
+	//  Description: Per channel meter of interleaved signed 16 bits PCM.
+	//               Process is meant to be called once per captured block
+	//               and doesn't allocate.
+	//////////////////////////////////////////////////////////////////////////
+	class LevelMeter
+	{
+	public:
+		// Peak hold duration before decay.
+		double holdTimeMs = 1500.0;
+		// Peak hold decay once hold time is elapsed.
+		double decayDbPerSecond = 20.0;
+
+		// Resets the meter for the given format.
+		// Channels above kMaxMeterChannels are ignored.
+		void Configure(int sampleRate, int numChannels);
+		// Resets levels and filters states.
+		void Reset();
+		// Processes interleaved frames.
+		void Process(const int16_t* samples, size_t frameCount);
+
+		int NumChannels() const { return m_numChannels; }
+		const ChannelLevels& Channel(int channel) const { return m_channels[channel].levels; }
+		// Levels of the last block over all channels.
+		const PcmLevels& Levels() const { return m_levels; }
+
+	private:
+		// Number of taps of each polyphase filter of the true peak oversampler.
+		static constexpr int kTruePeakTaps = 12;
+
+		struct ChannelState
+		{
+			// History is written twice to read taps contiguously.
+			std::array<float, kTruePeakTaps * 2> history{};
+			int historyPos = 0;
+			double holdRemainingMs = 0.0;
+			ChannelLevels levels;
+		};
+
+		float TruePeak(ChannelState& state, float sample);
+		void UpdateHold(ChannelState& state, double blockPeak, double blockMs);
+
+		int m_sampleRate = 44100;
+		int m_numChannels = 1;
+		int m_frameStride = 1;
+		PcmLevels m_levels;
+		std::array<ChannelState, kMaxMeterChannels> m_channels{};
+	};
+};
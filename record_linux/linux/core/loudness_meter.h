@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "level_meter.h"
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	// Lowest reported loudness in LUFS.
+	constexpr double kMinLufs = -160.0;
+
+	//////////////////////////////////////////////////////////////////////////
+	//  LoudnessLevels
+	//  Description: Loudness values as defined by ITU-R BS.1770-4 and
+	//               EBU Tech 3341/3342.
+	//////////////////////////////////////////////////////////////////////////
+	struct LoudnessLevels
+	{
+		// Loudness of the last 400ms in LUFS.
+		double momentary = kMinLufs;
+		// Loudness of the last 3s in LUFS.
+		double shortTerm = kMinLufs;
+		// Gated loudness since Reset in LUFS.
+		double integrated = kMinLufs;
+		// Loudness range (LRA) since Reset in LU.
+		double range = 0.0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  LoudnessMeter
+	//  Description: Incremental loudness meter of interleaved signed 16 bits
+	//               PCM. Audio is K-weighted and measured by 100ms steps.
+	//               Gating is done with fixed 0.1 LU histograms so memory
+	//               does not grow with the recording length and nothing is
+	//               allocated after construction.
+	//////////////////////////////////////////////////////////////////////////
+	class LoudnessMeter
+	{
+	public:
+		// Resets the meter for the given format.
+		// Channels above kMaxMeterChannels are ignored.
+		void Configure(int sampleRate, int numChannels);
+		// Resets all measurements and filters states.
+		void Reset();
+		// Processes interleaved frames.
+		void Process(const int16_t* samples, size_t frameCount);
+
+		// Computes current values. Cost doesn't depend on the recording length.
+		LoudnessLevels GetLevels() const;
+
+	private:
+		// Histograms cover [-70, +10[ LUFS by 0.1 LU.
+		static constexpr int kHistogramBins = 800;
+		// Short-term window in 100ms steps.
+		static constexpr int kShortTermSteps = 30;
+		// Momentary window in 100ms steps.
+		static constexpr int kMomentarySteps = 4;
+
+		struct Biquad
+		{
+			double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+		};
+
+		struct ChannelState
+		{
+			// Direct form II transposed states of each K-weighting stage.
+			double shelf1 = 0.0, shelf2 = 0.0;
+			double highPass1 = 0.0, highPass2 = 0.0;
+			double weight = 1.0;
+			double sumSquares = 0.0;
+		};
+
+		struct Histogram
+		{
+			std::array<uint32_t, kHistogramBins> counts{};
+			std::array<double, kHistogramBins> energies{};
+			uint64_t count = 0;
+			double energy = 0.0;
+
+			void Add(double blockEnergy);
+			void Clear();
+		};
+
+		void EndStep();
+		double WindowEnergy(int steps) const;
+
+		int m_numChannels = 1;
+		int m_frameStride = 1;
+		size_t m_stepFrames = 4410;
+		size_t m_stepPosition = 0;
+
+		Biquad m_shelf;
+		Biquad m_highPass;
+		std::array<ChannelState, kMaxMeterChannels> m_channels{};
+
+		// Energies of the last 100ms steps, newest at (m_stepCount - 1) % kShortTermSteps.
+		std::array<double, kShortTermSteps> m_stepEnergies{};
+		uint64_t m_stepCount = 0;
+
+		Histogram m_blocks;
+		Histogram m_shortTermBlocks;
+	};
+};
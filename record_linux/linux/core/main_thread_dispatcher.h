@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	//////////////////////////////////////////////////////////////////////////
+	//  MainThreadTask
+	//  Description: Move only callable with inline storage. Callables up to
+	//               kInlineSize bytes (e.g. a few pointers and a vector) are
+	//               stored in place, bigger ones are allocated.
+	//////////////////////////////////////////////////////////////////////////
+	class MainThreadTask
+	{
+	public:
+		static constexpr size_t kInlineSize = 48;
+
+		MainThreadTask() = default;
+
+		template <typename F, typename Callable = typename std::decay<F>::type,
+			typename = typename std::enable_if<!std::is_same<Callable, MainThreadTask>::value>::type>
+		MainThreadTask(F&& callable)
+		{
+			Init<Callable>(std::forward<F>(callable), std::integral_constant<bool, FitsInline<Callable>()>());
+		}
+
+		MainThreadTask(MainThreadTask&& other) noexcept
+		{
+			MoveFrom(other);
+		}
+
+		MainThreadTask& operator=(MainThreadTask&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Reset();
+				MoveFrom(other);
+			}
+			return *this;
+		}
+
+		MainThreadTask(const MainThreadTask&) = delete;
+		MainThreadTask& operator=(const MainThreadTask&) = delete;
+
+		~MainThreadTask()
+		{
+			Reset();
+		}
+
+		explicit operator bool() const { return m_ops != nullptr; }
+
+		void operator()()
+		{
+			m_ops->invoke(m_storage.bytes);
+		}
+
+		void Reset()
+		{
+			if (m_ops)
+			{
+				m_ops->destroy(m_storage.bytes);
+				m_ops = nullptr;
+			}
+		}
+
+	private:
+		struct Ops
+		{
+			void (*invoke)(void* storage);
+			// Move constructs into dst and destroys src.
+			void (*relocate)(void* dst, void* src);
+			void (*destroy)(void* storage);
+		};
+
+		// Natural alignment of pointers and doubles, without alignas padding.
+		union Storage
+		{
+			void* pointer;
+			double number;
+			long long integer;
+			unsigned char bytes[kInlineSize];
+		};
+
+		template <typename Callable>
+		static constexpr bool FitsInline()
+		{
+			return sizeof(Callable) <= kInlineSize
+				&& alignof(Callable) <= alignof(Storage)
+				&& std::is_nothrow_move_constructible<Callable>::value;
+		}
+
+		template <typename Callable, typename F>
+		void Init(F&& callable, std::true_type)
+		{
+			static const Ops ops = {
+				[](void* storage) { (*static_cast<Callable*>(storage))(); },
+				[](void* dst, void* src) {
+					new (dst) Callable(std::move(*static_cast<Callable*>(src)));
+					static_cast<Callable*>(src)->~Callable();
+				},
+				[](void* storage) { static_cast<Callable*>(storage)->~Callable(); },
+			};
+
+			new (m_storage.bytes) Callable(std::forward<F>(callable));
+			m_ops = &ops;
+		}
+
+		template <typename Callable, typename F>
+		void Init(F&& callable, std::false_type)
+		{
+			static const Ops ops = {
+				[](void* storage) { (**static_cast<Callable**>(storage))(); },
+				[](void* dst, void* src) { *static_cast<Callable**>(dst) = *static_cast<Callable**>(src); },
+				[](void* storage) { delete *static_cast<Callable**>(storage); },
+			};
+
+			*reinterpret_cast<Callable**>(m_storage.bytes) = new Callable(std::forward<F>(callable));
+			m_ops = &ops;
+		}
+
+		void MoveFrom(MainThreadTask& other)
+		{
+			if (other.m_ops)
+			{
+				other.m_ops->relocate(m_storage.bytes, other.m_storage.bytes);
+				m_ops = other.m_ops;
+				other.m_ops = nullptr;
+			}
+		}
+
+		Storage m_storage;
+		const Ops* m_ops = nullptr;
+	};
+
+	struct DispatcherStats
+	{
+		// Tasks waiting to run.
+		size_t queueDepth = 0;
+		// Highest queue depth seen.
+		size_t maxQueueDepth = 0;
+		uint64_t tasksRun = 0;
+		uint64_t wakeups = 0;
+		// Time between Post and run, in microseconds.
+		double meanLatencyUs = 0.0;
+		double maxLatencyUs = 0.0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  MainThreadDispatcher
+	//  Description: Runs tasks posted from any thread on the thread calling
+	//               Drain (e.g. the platform UI thread).
+	//               The platform adapter is woken up only when the queue
+	//               becomes non empty, and each Drain runs all queued tasks.
+	//               Task slots are kept between drains so posting doesn't
+	//               allocate once warmed up.
+	//////////////////////////////////////////////////////////////////////////
+	class MainThreadDispatcher
+	{
+	public:
+		// Called from posting thread to schedule a Drain on the main thread.
+		using WakeupFunction = void (*)(void* context);
+
+		MainThreadDispatcher();
+
+		MainThreadDispatcher(const MainThreadDispatcher&) = delete;
+		MainThreadDispatcher& operator=(const MainThreadDispatcher&) = delete;
+
+		// Sets the platform adapter. Must be called before posting.
+		void SetWakeup(WakeupFunction wakeup, void* context);
+
+		// Any thread.
+		template <typename F>
+		void Post(F&& callable)
+		{
+			Enqueue(MainThreadTask(std::forward<F>(callable)));
+		}
+
+		// Main thread. Runs all queued tasks, including tasks posted by them
+		// if any. Returns the number of run tasks.
+		size_t Drain();
+
+		DispatcherStats Stats() const;
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct Slot
+		{
+			MainThreadTask task;
+			Clock::time_point posted;
+		};
+
+		void Enqueue(MainThreadTask&& task);
+
+		WakeupFunction m_wakeup = nullptr;
+		void* m_wakeupContext = nullptr;
+
+		std::mutex m_mutex;
+		// Filled by producers under m_mutex.
+		std::vector<Slot> m_pending;
+		bool m_wakeupPending = false;
+		// Swapped with m_pending and run by Drain.
+		std::vector<Slot> m_running;
+
+		std::atomic<size_t> m_queueDepth{ 0 };
+		std::atomic<size_t> m_maxQueueDepth{ 0 };
+		std::atomic<uint64_t> m_tasksRun{ 0 };
+		std::atomic<uint64_t> m_wakeups{ 0 };
+		std::atomic<uint64_t> m_totalLatencyUs{ 0 };
+		std::atomic<uint64_t> m_maxLatencyUs{ 0 };
+	};
+};
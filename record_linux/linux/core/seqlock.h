@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	//////////////////////////////////////////////////////////////////////////
+	//  SeqLock
+	//  Description: Holds a copy of a trivially copyable value which can be
+	//               published by a writer and read from any thread without
+	//               locking. Readers never block the writer and retry
+	//               until they get a consistent (non torn) copy.
+	//
+	//  Note: Writers must be serialized by the caller.
+	//        Value is stored in atomic words so concurrent accesses are
+	//        well defined (and quiet under ThreadSanitizer).
+	//////////////////////////////////////////////////////////////////////////
+	template <typename T>
+	class SeqLock
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "SeqLock value must be trivially copyable");
+
+	public:
+		SeqLock()
+		{
+			Store(T());
+		}
+
+		explicit SeqLock(const T& value)
+		{
+			Store(value);
+		}
+
+		SeqLock(const SeqLock&) = delete;
+		SeqLock& operator=(const SeqLock&) = delete;
+
+		void Store(const T& value)
+		{
+			uint64_t words[kWords] = {};
+			std::memcpy(words, &value, sizeof(T));
+
+			const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+
+			// Odd sequence tells readers a write is in progress.
+			// Release stores of words keep them after this one, so a reader
+			// seeing any new word also sees the odd sequence.
+			m_sequence.store(sequence + 1, std::memory_order_relaxed);
+
+			for (size_t i = 0; i < kWords; i++)
+			{
+				m_words[i].store(words[i], std::memory_order_release);
+			}
+
+			m_sequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		T Load() const
+		{
+			uint64_t words[kWords];
+			uint32_t before, after;
+
+			do
+			{
+				before = m_sequence.load(std::memory_order_acquire);
+
+				for (size_t i = 0; i < kWords; i++)
+				{
+					words[i] = m_words[i].load(std::memory_order_acquire);
+				}
+
+				after = m_sequence.load(std::memory_order_relaxed);
+			} while ((before & 1) != 0 || before != after);
+
+			T value;
+			std::memcpy(&value, words, sizeof(T));
+			return value;
+		}
+
+	private:
+		static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+		std::atomic<uint32_t> m_sequence{ 0 };
+		std::array<std::atomic<uint64_t>, kWords> m_words{};
+	};
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	// Producer and consumer indices are kept on separate cache lines.
+	constexpr size_t kCacheLineSize = 64;
+
+	//////////////////////////////////////////////////////////////////////////
+	//  SpscRing
+	//  Description: Bounded lock-free single producer / single consumer ring
+	//               of preallocated slots. Slots are filled and consumed in
+	//               place, so slot resources (e.g. vector capacity) are
+	//               reused instead of being allocated for each item.
+	//
+	//  Note: One thread at a time may produce and one thread at a time may
+	//        consume. Producer changes must be serialized by the caller
+	//        (e.g. a lock held while producing).
+	//////////////////////////////////////////////////////////////////////////
+	template <typename T>
+	class SpscRing
+	{
+	public:
+		// Capacity is rounded up to a power of 2.
+		explicit SpscRing(size_t capacity)
+		{
+			m_capacity = 2;
+			while (m_capacity < capacity) m_capacity <<= 1;
+			m_mask = m_capacity - 1;
+			m_slots.reset(new T[m_capacity]);
+		}
+
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+
+		size_t Capacity() const { return m_capacity; }
+
+		// Approximate item count, exact when called from producer or consumer
+		// while the other side is idle.
+		size_t Size() const
+		{
+			return m_producer.tail.load(std::memory_order_acquire) - m_consumer.head.load(std::memory_order_acquire);
+		}
+
+		// Producer side.
+		// Calls fill(T& slot) on the next free slot and publishes it.
+		// Returns false without calling fill when the ring is full.
+		template <typename Fill>
+		bool TryPush(Fill&& fill)
+		{
+			const size_t tail = m_producer.tail.load(std::memory_order_relaxed);
+
+			if (tail - m_producer.cachedHead == m_capacity)
+			{
+				m_producer.cachedHead = m_consumer.head.load(std::memory_order_acquire);
+				if (tail - m_producer.cachedHead == m_capacity)
+				{
+					return false;
+				}
+			}
+
+			fill(m_slots[tail & m_mask]);
+			m_producer.tail.store(tail + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		// Consumer side.
+		// Calls consume(T& slot) for every published item, including items
+		// published while draining. Returns the number of consumed items.
+		template <typename Consume>
+		size_t Drain(Consume&& consume)
+		{
+			return Drain(consume, std::numeric_limits<size_t>::max());
+		}
+
+		// Same as above, consuming maxCount items at most.
+		template <typename Consume>
+		size_t Drain(Consume&& consume, size_t maxCount)
+		{
+			size_t head = m_consumer.head.load(std::memory_order_relaxed);
+			size_t count = 0;
+
+			while (count < maxCount)
+			{
+				const size_t tail = m_producer.tail.load(std::memory_order_acquire);
+				if (head == tail)
+				{
+					break;
+				}
+
+				const size_t end = head + std::min(tail - head, maxCount - count);
+				for (; head != end; head++, count++)
+				{
+					consume(m_slots[head & m_mask]);
+				}
+
+				// Release slots by batch.
+				m_consumer.head.store(head, std::memory_order_release);
+			}
+
+			return count;
+		}
+
+	private:
+		// Explicit padding rather than alignas, which would make owners over-aligned.
+		struct ConsumerState
+		{
+			std::atomic<size_t> head{ 0 };
+			char padding[kCacheLineSize - sizeof(std::atomic<size_t>)];
+		};
+
+		struct ProducerState
+		{
+			std::atomic<size_t> tail{ 0 };
+			// Last known head, refreshed only when the ring looks full.
+			size_t cachedHead = 0;
+			char padding[kCacheLineSize - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+		};
+
+		ConsumerState m_consumer;
+		ProducerState m_producer;
+
+		size_t m_capacity = 0;
+		size_t m_mask = 0;
+		std::unique_ptr<T[]> m_slots;
+	};
+};
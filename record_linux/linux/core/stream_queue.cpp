@@ -0,0 +1,169 @@
+#include "stream_queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace record_core
+{
+	void StreamQueue::Configure(StreamOverflowPolicy policy, size_t maxSpillBytes, size_t frameBytes)
+	{
+		m_policy = policy;
+		m_blocking.store(policy == StreamOverflowPolicy::block, std::memory_order_release);
+		m_frameBytes = std::max<size_t>(1, frameBytes);
+		m_maxSpillBytes = maxSpillBytes / m_frameBytes * m_frameBytes;
+		m_spill.clear();
+		m_aborted.store(false, std::memory_order_release);
+
+		m_droppedBytes.store(0, std::memory_order_relaxed);
+		m_droppedChunks.store(0, std::memory_order_relaxed);
+	}
+
+	bool StreamQueue::Push(const uint8_t* data, size_t size)
+	{
+		if (size == 0)
+		{
+			return false;
+		}
+
+		// Keep order, spilled data goes first.
+		if (!m_spill.empty() && !FlushSpill())
+		{
+			return Overflow(data, size);
+		}
+
+		return TryPush(data, size) || Overflow(data, size);
+	}
+
+	bool StreamQueue::PushShared(const PcmRingChunk& chunk)
+	{
+		const bool pushed = m_ring.TryPush([&chunk](StreamQueueItem& item) {
+			item.bytes.clear();
+			item.shared = chunk;
+			item.isPacket = false;
+		});
+
+		if (!pushed)
+		{
+			AddDropped(static_cast<size_t>(chunk.length));
+		}
+
+		return pushed;
+	}
+
+	bool StreamQueue::PushPacket(const uint8_t* data, size_t size, const StreamPacketInfo& info)
+	{
+		if (size == 0)
+		{
+			return false;
+		}
+
+		auto fill = [data, size, &info](StreamQueueItem& item) {
+			item.bytes.assign(data, data + size);
+			item.isPacket = true;
+			item.packet = info;
+		};
+
+		if (m_ring.TryPush(fill))
+		{
+			return true;
+		}
+
+		AddDropped(size);
+		return false;
+	}
+
+	bool StreamQueue::FlushSpill()
+	{
+		if (m_spill.empty())
+		{
+			return true;
+		}
+
+		// Swap buffers so both keep their capacity.
+		return m_ring.TryPush([this](StreamQueueItem& item) {
+			item.bytes.clear();
+			item.bytes.swap(m_spill);
+			item.isPacket = false;
+		});
+	}
+
+	void StreamQueue::AddDropped(size_t size)
+	{
+		m_droppedBytes.fetch_add(size, std::memory_order_relaxed);
+		m_droppedChunks.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void StreamQueue::WaitForSpace()
+	{
+		if (!m_blocking.load(std::memory_order_acquire))
+		{
+			return;
+		}
+
+		// Polled, the consumer side doesn't signal. Waiting for half of the slots
+		// leaves room for the chunks of a whole capture buffer.
+		while (m_ring.Size() > m_ring.Capacity() / 2 && !IsAborted())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	void StreamQueue::Acknowledge(size_t count)
+	{
+		if (m_credit != kUnlimitedCredit)
+		{
+			m_credit = std::min(m_credit + count, kUnlimitedCredit - 1);
+		}
+	}
+
+	StreamQueueStats StreamQueue::Stats() const
+	{
+		StreamQueueStats stats;
+		stats.droppedBytes = m_droppedBytes.load(std::memory_order_relaxed);
+		stats.droppedChunks = m_droppedChunks.load(std::memory_order_relaxed);
+		stats.queuedChunks = m_ring.Size();
+
+		return stats;
+	}
+
+	bool StreamQueue::TryPush(const uint8_t* data, size_t size)
+	{
+		return m_ring.TryPush([data, size](StreamQueueItem& item) {
+			item.bytes.assign(data, data + size);
+			item.isPacket = false;
+		});
+	}
+
+	bool StreamQueue::Overflow(const uint8_t* data, size_t size)
+	{
+		switch (m_policy)
+		{
+		case StreamOverflowPolicy::dropOldest:
+			m_spill.insert(m_spill.end(), data, data + size);
+
+			if (m_spill.size() > m_maxSpillBytes)
+			{
+				const size_t excess = m_spill.size() - m_maxSpillBytes;
+				m_spill.erase(m_spill.begin(), m_spill.begin() + excess);
+				AddDropped(excess);
+			}
+			return false;
+
+		case StreamOverflowPolicy::block:
+		case StreamOverflowPolicy::coalesce:
+			if (m_spill.size() + size <= m_maxSpillBytes)
+			{
+				m_spill.insert(m_spill.end(), data, data + size);
+				return false;
+			}
+			break;
+
+		case StreamOverflowPolicy::dropNewest:
+			break;
+		}
+
+		AddDropped(size);
+		return false;
+	}
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pcm_ring.h"
+#include "spsc_ring.h"
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	// Behaviour when the consumer doesn't keep up and the queue is full.
+	enum class StreamOverflowPolicy
+	{
+		// Producer waits for free space before producing (see StreamQueue::WaitForSpace),
+		// overflowing data is gathered in the bounded spill buffer like coalesce.
+		block,
+		// Overflowing data is gathered in a bounded spill buffer, its oldest bytes are dropped.
+		dropOldest,
+		// Overflowing data is dropped.
+		dropNewest,
+		// Overflowing data is gathered in a bounded spill buffer sent as one chunk,
+		// new data is dropped when it is full.
+		coalesce,
+	};
+
+	// Timing of an encoded packet, in microseconds from the start of the recording.
+	struct StreamPacketInfo
+	{
+		int64_t timestampUs = 0;
+		int64_t durationUs = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  StreamQueueItem
+	//  Description: Queued stream data, either copied bytes or the location
+	//               of a chunk in a shared PcmRing (when bytes is empty).
+	//               Encoded packets are copied bytes with their timing.
+	//////////////////////////////////////////////////////////////////////////
+	struct StreamQueueItem
+	{
+		std::vector<uint8_t> bytes;
+		PcmRingChunk shared;
+		bool isPacket = false;
+		StreamPacketInfo packet;
+	};
+
+	// Chunks sent ahead of consumer acknowledgements (see StreamQueue::SetCredit).
+	constexpr size_t kStreamCredit = 64;
+
+	struct StreamQueueStats
+	{
+		uint64_t droppedBytes = 0;
+		uint64_t droppedChunks = 0;
+		size_t queuedChunks = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  StreamQueue
+	//  Description: Bounded queue of stream data between a capture thread
+	//               and a consumer thread, with an overflow policy.
+	//               Memory is bounded by the ring slots and the spill buffer
+	//               whatever the consumer does. Drains are bounded by the
+	//               credit the consumer gave, so a stalled consumer only
+	//               receives that much and the queue overflows instead.
+	//
+	//  Note: Producer calls must be serialized by the caller and only one
+	//        thread at a time may drain (see SpscRing).
+	//////////////////////////////////////////////////////////////////////////
+	class StreamQueue
+	{
+	public:
+		explicit StreamQueue(size_t capacity) : m_ring(capacity) {}
+
+		// Producer side.
+		// Drops spilled data and resets stats.
+		// Spill size is rounded down to whole frames.
+		void Configure(StreamOverflowPolicy policy, size_t maxSpillBytes, size_t frameBytes);
+
+		// Returns true when data was queued.
+		bool Push(const uint8_t* data, size_t size);
+		// Shared chunks are never spilled, they are dropped on overflow.
+		bool PushShared(const PcmRingChunk& chunk);
+		// Packets are never spilled nor merged so their boundaries are kept.
+		// They are dropped on overflow.
+		bool PushPacket(const uint8_t* data, size_t size, const StreamPacketInfo& info);
+		// Queues spilled data if possible. Returns true when data was queued.
+		bool FlushSpill();
+		// Counts data dropped by the caller.
+		void AddDropped(size_t size);
+		// With the block policy, waits until half of the slots are free or the
+		// queue is aborted. Pushes never wait, so this must be called before
+		// taking locks the consumer or other callers need.
+		void WaitForSpace();
+
+		// Any thread.
+		// Stops waiting producers and lifts the credit so the end of the stream
+		// is drained, until next Configure.
+		void Abort() { m_aborted.store(true, std::memory_order_release); }
+		StreamQueueStats Stats() const;
+
+		// Consumer side.
+		// Limits drains to credit items until more are acknowledged.
+		// Drains are unlimited until called.
+		void SetCredit(size_t credit) { m_credit = credit; }
+		void Acknowledge(size_t count);
+		// False when drains wait for acknowledgements.
+		bool HasCredit() const { return m_credit > 0 || IsAborted(); }
+
+		// Calls consume(StreamQueueItem&) for queued items, within the credit.
+		// Consumers may keep item resources (e.g. bytes capacity) for reuse.
+		template <typename Consume>
+		size_t Drain(Consume&& consume)
+		{
+			if (IsAborted() || m_credit == kUnlimitedCredit)
+			{
+				return m_ring.Drain(consume);
+			}
+
+			const size_t count = m_ring.Drain(consume, m_credit);
+			m_credit -= count;
+			return count;
+		}
+
+	private:
+		static constexpr size_t kUnlimitedCredit = static_cast<size_t>(-1);
+
+		bool IsAborted() const { return m_aborted.load(std::memory_order_acquire); }
+		bool TryPush(const uint8_t* data, size_t size);
+		bool Overflow(const uint8_t* data, size_t size);
+
+		SpscRing<StreamQueueItem> m_ring;
+		StreamOverflowPolicy m_policy = StreamOverflowPolicy::dropNewest;
+		size_t m_maxSpillBytes = 0;
+		size_t m_frameBytes = 1;
+		std::vector<uint8_t> m_spill;
+		std::atomic<bool> m_aborted{ false };
+		// Policy is block, read by WaitForSpace without the producer lock.
+		std::atomic<bool> m_blocking{ false };
+		// Consumer side only.
+		size_t m_credit = kUnlimitedCredit;
+
+		std::atomic<uint64_t> m_droppedBytes{ 0 };
+		std::atomic<uint64_t> m_droppedChunks{ 0 };
+	};
+};
@@ -0,0 +1,137 @@
+#include "voice_activity_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace record_core
+{
+	// Analysis frame duration.
+	static constexpr int kFrameMs = 10;
+	// Lowest tracked noise floor, avoids digital silence pinning it.
+	static constexpr double kMinNoiseFloorDb = -90.0;
+	// Noise floor rise speed when no voice is detected.
+	static constexpr double kNoiseRiseDbPerSecond = 1.0;
+	// Above this zero crossing rate (per sample) the frame is noise like.
+	static constexpr double kMaxVoicedZcr = 0.35;
+	// Under this normalized lag-1 correlation the spectrum is considered flat.
+	static constexpr double kMinVoicedCorrelation = 0.3;
+	// Frames this far above the threshold are voiced whatever their spectrum
+	// (e.g. fricatives).
+	static constexpr double kLoudFrameMarginDb = 10.0;
+
+	void VoiceActivityDetector::Configure(int sampleRate, int numChannels, const VadConfig& config)
+	{
+		m_mode = config.mode;
+		m_thresholdDb = config.thresholdDb;
+		m_minEnergyDb = config.minEnergyDb;
+		m_frameStride = std::max(1, numChannels);
+		m_analysisFrames = std::max(1, sampleRate * kFrameMs / 1000);
+		m_hangoverFrames = std::max(0, config.hangoverMs) / kFrameMs;
+		m_noiseRiseDb = kNoiseRiseDbPerSecond * kFrameMs / 1000.0;
+
+		Reset();
+	}
+
+	void VoiceActivityDetector::Reset()
+	{
+		m_framePosition = 0;
+		m_energy = 0.0;
+		m_correlation = 0.0;
+		m_zeroCrossings = 0;
+		m_previous = 0.0f;
+
+		m_hasNoiseFloor = false;
+		m_noiseFloorDb = kMinNoiseFloorDb;
+		m_hangoverRemaining = 0;
+		m_active = false;
+	}
+
+	bool VoiceActivityDetector::Process(const int16_t* samples, size_t frameCount)
+	{
+		if (!IsEnabled()) return true;
+
+		m_blockActive = m_active;
+
+		const float scale = 1.0f / (32768.0f * m_frameStride);
+
+		for (size_t frame = 0; frame < frameCount; frame++)
+		{
+			int32_t mix = 0;
+			for (int ch = 0; ch < m_frameStride; ch++)
+			{
+				mix += samples[frame * m_frameStride + ch];
+			}
+
+			const float sample = mix * scale;
+
+			m_energy += sample * sample;
+			m_correlation += sample * m_previous;
+			if ((sample < 0.0f) != (m_previous < 0.0f))
+			{
+				m_zeroCrossings++;
+			}
+			m_previous = sample;
+
+			if (++m_framePosition == m_analysisFrames)
+			{
+				EndFrame();
+			}
+		}
+
+		return m_blockActive;
+	}
+
+	void VoiceActivityDetector::EndFrame()
+	{
+		const double meanEnergy = m_energy / m_analysisFrames;
+		const double energyDb = meanEnergy > 0.0 ? 10.0 * std::log10(meanEnergy) : kMinNoiseFloorDb;
+		const double zcr = static_cast<double>(m_zeroCrossings) / m_analysisFrames;
+		const double correlation = m_energy > 0.0 ? m_correlation / m_energy : 0.0;
+
+		m_framePosition = 0;
+		m_energy = 0.0;
+		m_correlation = 0.0;
+		m_zeroCrossings = 0;
+
+		if (!m_hasNoiseFloor)
+		{
+			m_noiseFloorDb = std::max(kMinNoiseFloorDb, energyDb);
+			m_hasNoiseFloor = true;
+		}
+
+		const double aboveFloorDb = energyDb - m_noiseFloorDb;
+		const bool structured = zcr < kMaxVoicedZcr && correlation > kMinVoicedCorrelation;
+		const bool voiced = energyDb > m_minEnergyDb
+			&& aboveFloorDb > m_thresholdDb
+			&& (structured || aboveFloorDb > m_thresholdDb + kLoudFrameMarginDb);
+
+		if (voiced)
+		{
+			m_hangoverRemaining = m_hangoverFrames;
+			m_active = true;
+		}
+		else
+		{
+			// Floor follows drops immediately and rises slowly while not voiced.
+			if (energyDb < m_noiseFloorDb)
+			{
+				m_noiseFloorDb = std::max(kMinNoiseFloorDb, energyDb);
+			}
+			else
+			{
+				m_noiseFloorDb += std::min(aboveFloorDb, m_noiseRiseDb);
+			}
+
+			if (m_hangoverRemaining > 0)
+			{
+				m_hangoverRemaining--;
+			}
+			else
+			{
+				m_active = false;
+			}
+		}
+
+		m_blockActive = m_blockActive || m_active;
+	}
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	enum class VadMode
+	{
+		// No detection.
+		disabled,
+		// Voice activity is detected and reported, audio is kept.
+		flag,
+		// Silent blocks are dropped before encoding or streaming.
+		skip,
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  VadConfig
+	//  Description: Voice activity detector settings.
+	//////////////////////////////////////////////////////////////////////////
+	struct VadConfig
+	{
+		VadMode mode = VadMode::disabled;
+		// Energy above the estimated noise floor for a frame to be voiced, in dB.
+		double thresholdDb = 12.0;
+		// Frames under this energy are never voiced, in dBFS.
+		double minEnergyDb = -55.0;
+		// Activity duration kept after the last voiced frame.
+		int hangoverMs = 300;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  VoiceActivityDetector
+	//  Description: Frame based (10ms) voice activity detection of
+	//               interleaved signed 16 bits PCM, channels mixed.
+	//               A frame is voiced when its energy rises enough above an
+	//               adaptive noise floor and its spectrum is not flat
+	//               (zero crossing rate and lag-1 correlation).
+	//               Activity is held for the hangover duration.
+	//////////////////////////////////////////////////////////////////////////
+	class VoiceActivityDetector
+	{
+	public:
+		void Configure(int sampleRate, int numChannels, const VadConfig& config);
+		// Resets noise floor estimation and activity.
+		void Reset();
+
+		bool IsEnabled() const { return m_mode != VadMode::disabled; }
+		VadMode Mode() const { return m_mode; }
+		// Activity after the last processed frame.
+		bool IsActive() const { return m_active; }
+		double NoiseFloorDb() const { return m_noiseFloorDb; }
+
+		// Processes interleaved frames.
+		// Returns true if any analysis frame ending in this block was active
+		// or if activity was ongoing when the block started.
+		bool Process(const int16_t* samples, size_t frameCount);
+
+	private:
+		void EndFrame();
+
+		VadMode m_mode = VadMode::disabled;
+		double m_thresholdDb = 12.0;
+		double m_minEnergyDb = -55.0;
+		int m_frameStride = 1;
+		size_t m_analysisFrames = 441;
+		size_t m_hangoverFrames = 30;
+		// Noise floor rise per analysis frame in dB.
+		double m_noiseRiseDb = 0.01;
+
+		// Current analysis frame accumulators, samples normalized in [-1, 1].
+		size_t m_framePosition = 0;
+		double m_energy = 0.0;
+		double m_correlation = 0.0;
+		size_t m_zeroCrossings = 0;
+		float m_previous = 0.0f;
+
+		bool m_hasNoiseFloor = false;
+		double m_noiseFloorDb = -90.0;
+		size_t m_hangoverRemaining = 0;
+		bool m_active = false;
+		bool m_blockActive = false;
+	};
+};
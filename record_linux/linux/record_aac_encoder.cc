@@ -0,0 +1,191 @@
+#include "record_aac_encoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace record_linux {
+
+AacEncoder::~AacEncoder() {
+  if (encoder_ != nullptr) {
+    aacEncClose(&encoder_);
+  }
+}
+
+bool AacEncoder::Open(const std::string& path,
+                      const EncoderConfig& config,
+                      std::string* error) {
+  return Init(config, error) && writer_.Open(path, error);
+}
+
+bool AacEncoder::OpenStream(const EncoderConfig& config,
+                            EncodedPacketCallback on_packet,
+                            std::string* error) {
+  if (!Init(config, error)) {
+    return false;
+  }
+
+  on_packet_ = std::move(on_packet);
+  return true;
+}
+
+bool AacEncoder::Init(const EncoderConfig& config, std::string* error) {
+  config_ = config;
+
+  if (aacEncOpen(&encoder_, 0, config.num_channels) != AACENC_OK) {
+    *error = "Failed to create AAC encoder.";
+    return false;
+  }
+
+  // Raw access units, framing is given by the MPEG-4 file or the stream.
+  const bool configured =
+      aacEncoder_SetParam(encoder_, AACENC_AOT, AOT_AAC_LC) == AACENC_OK &&
+      aacEncoder_SetParam(encoder_, AACENC_SAMPLERATE, config.sample_rate) ==
+          AACENC_OK &&
+      aacEncoder_SetParam(encoder_, AACENC_CHANNELMODE,
+                          config.num_channels == 1 ? MODE_1 : MODE_2) ==
+          AACENC_OK &&
+      aacEncoder_SetParam(encoder_, AACENC_BITRATE, config.bit_rate) ==
+          AACENC_OK &&
+      aacEncoder_SetParam(encoder_, AACENC_TRANSMUX, TT_MP4_RAW) ==
+          AACENC_OK &&
+      aacEncoder_SetParam(encoder_, AACENC_AFTERBURNER, 1) == AACENC_OK &&
+      aacEncEncode(encoder_, nullptr, nullptr, nullptr, nullptr) == AACENC_OK;
+
+  AACENC_InfoStruct info = {};
+  if (!configured || aacEncInfo(encoder_, &info) != AACENC_OK) {
+    *error = "Unsupported AAC sample rate, channel count or bit rate.";
+    return false;
+  }
+
+  frame_length_ = static_cast<int>(info.frameLength);
+  audio_specific_config_.assign(info.confBuf, info.confBuf + info.confSize);
+  output_.resize(std::max<size_t>(info.maxOutBufBytes,
+                                  768 * config.num_channels));
+  pending_.clear();
+  pending_.reserve(frame_length_ * config.num_channels);
+  packet_count_ = 0;
+
+  return true;
+}
+
+bool AacEncoder::Write(const uint8_t* data, size_t size) {
+  const size_t frame_samples = frame_length_ * config_.num_channels;
+  size_t count = size / sizeof(int16_t);
+
+  // Encoder is fed by whole frames.
+  while (count > 0) {
+    const size_t offset = pending_.size();
+    const size_t taken = std::min(count, frame_samples - offset);
+
+    pending_.resize(offset + taken);
+    memcpy(pending_.data() + offset, data, taken * sizeof(int16_t));
+    data += taken * sizeof(int16_t);
+    count -= taken;
+
+    if (pending_.size() == frame_samples) {
+      if (Encode(pending_.data(), static_cast<int>(frame_samples)) !=
+          AACENC_OK) {
+        return false;
+      }
+      pending_.clear();
+    }
+  }
+
+  return true;
+}
+
+bool AacEncoder::Finish() {
+  bool encoded = pending_.empty() ||
+                 Encode(pending_.data(), static_cast<int>(pending_.size())) ==
+                     AACENC_OK;
+  pending_.clear();
+
+  // Encoder delay is flushed with the last access units.
+  AACENC_ERROR result = AACENC_OK;
+  while (encoded && result == AACENC_OK) {
+    result = Encode(nullptr, -1);
+  }
+  encoded = encoded && result == AACENC_ENCODE_EOF;
+
+  aacEncClose(&encoder_);
+  encoder_ = nullptr;
+
+  if (on_packet_) {
+    return encoded;
+  }
+
+  return writer_.Finish(audio_specific_config_, config_.sample_rate,
+                        config_.num_channels, config_.bit_rate,
+                        frame_length_) &&
+         encoded;
+}
+
+AACENC_ERROR AacEncoder::Encode(const int16_t* samples, int count) {
+  int consumed = 0;
+
+  do {
+    void* input = const_cast<int16_t*>(samples + consumed);
+    INT input_id = IN_AUDIO_DATA;
+    INT input_size =
+        count > 0 ? static_cast<INT>((count - consumed) * sizeof(int16_t)) : 0;
+    INT input_element_size = sizeof(int16_t);
+
+    void* output = output_.data();
+    INT output_id = OUT_BITSTREAM_DATA;
+    INT output_size = static_cast<INT>(output_.size());
+    INT output_element_size = 1;
+
+    AACENC_BufDesc input_desc = {};
+    input_desc.numBufs = count > 0 ? 1 : 0;
+    input_desc.bufs = &input;
+    input_desc.bufferIdentifiers = &input_id;
+    input_desc.bufSizes = &input_size;
+    input_desc.bufElSizes = &input_element_size;
+
+    AACENC_BufDesc output_desc = {};
+    output_desc.numBufs = 1;
+    output_desc.bufs = &output;
+    output_desc.bufferIdentifiers = &output_id;
+    output_desc.bufSizes = &output_size;
+    output_desc.bufElSizes = &output_element_size;
+
+    AACENC_InArgs in_args = {};
+    in_args.numInSamples = count > 0 ? count - consumed : -1;
+    AACENC_OutArgs out_args = {};
+
+    const AACENC_ERROR result =
+        aacEncEncode(encoder_, &input_desc, &output_desc, &in_args, &out_args);
+    if (result != AACENC_OK) {
+      return result;
+    }
+
+    // Each output is a single access unit.
+    if (out_args.numOutBytes > 0) {
+      if (on_packet_) {
+        record_core::StreamPacketInfo info;
+        info.timestampUs =
+            packet_count_ * frame_length_ * 1000000 / config_.sample_rate;
+        info.durationUs =
+            static_cast<int64_t>(frame_length_) * 1000000 / config_.sample_rate;
+        packet_count_++;
+        on_packet_(output_.data(), out_args.numOutBytes, info);
+      } else if (!writer_.WriteSample(output_.data(), out_args.numOutBytes)) {
+        return AACENC_ENCODE_ERROR;
+      }
+    }
+
+    if (count <= 0) {
+      break;
+    }
+    if (out_args.numInSamples <= 0 && out_args.numOutBytes <= 0) {
+      return AACENC_ENCODE_ERROR;
+    }
+
+    consumed += out_args.numInSamples;
+  } while (consumed < count);
+
+  return AACENC_OK;
+}
+
+}  // namespace record_linux
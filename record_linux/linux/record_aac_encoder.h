@@ -0,0 +1,54 @@
+#ifndef FLUTTER_PLUGIN_RECORD_AAC_ENCODER_H_
+#define FLUTTER_PLUGIN_RECORD_AAC_ENCODER_H_
+
+#include <aacenc_lib.h>
+
+#include <vector>
+
+#include "record_encoder.h"
+#include "record_mp4_writer.h"
+
+namespace record_linux {
+
+// AAC LC with fdk-aac, in an MPEG-4 file. Streamed packets are raw access
+// units, the codec config is the AudioSpecificConfig.
+class AacEncoder : public AudioEncoder {
+ public:
+  AacEncoder() = default;
+  ~AacEncoder() override;
+
+  bool Open(const std::string& path,
+            const EncoderConfig& config,
+            std::string* error) override;
+  bool OpenStream(const EncoderConfig& config,
+                  EncodedPacketCallback on_packet,
+                  std::string* error) override;
+  std::vector<uint8_t> CodecConfig() const override {
+    return audio_specific_config_;
+  }
+  bool Write(const uint8_t* data, size_t size) override;
+  bool Finish() override;
+
+ private:
+  bool Init(const EncoderConfig& config, std::string* error);
+  // Encodes count samples, or flushes the encoder when count is -1.
+  // Returns AACENC_ENCODE_EOF once flushed.
+  AACENC_ERROR Encode(const int16_t* samples, int count);
+
+  EncoderConfig config_;
+  HANDLE_AACENCODER encoder_ = nullptr;
+  Mp4Writer writer_;
+  std::vector<uint8_t> audio_specific_config_;
+  int frame_length_ = 1024;
+  // Set when streaming, access units are sent instead of written.
+  EncodedPacketCallback on_packet_;
+  int64_t packet_count_ = 0;
+
+  // Samples of an incomplete frame.
+  std::vector<int16_t> pending_;
+  std::vector<uint8_t> output_;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_AAC_ENCODER_H_
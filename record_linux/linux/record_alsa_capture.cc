@@ -0,0 +1,430 @@
+#include "record_alsa_capture.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace record_linux {
+
+namespace {
+
+snd_pcm_format_t ToAlsaFormat(record_core::SampleFormat format) {
+  switch (format) {
+    case record_core::SampleFormat::s24:
+      return SND_PCM_FORMAT_S24_3LE;
+    case record_core::SampleFormat::s32:
+      return SND_PCM_FORMAT_S32_LE;
+    case record_core::SampleFormat::f32:
+      return SND_PCM_FORMAT_FLOAT_LE;
+    case record_core::SampleFormat::s16:
+    default:
+      return SND_PCM_FORMAT_S16_LE;
+  }
+}
+
+bool SetError(std::string* error, const std::string& message, int code) {
+  *error = message + ": " + snd_strerror(code);
+  return false;
+}
+
+}  // namespace
+
+AlsaCapture::~AlsaCapture() {
+  Close();
+}
+
+bool AlsaCapture::Open(const CaptureConfig& config,
+                       CaptureDataCallback on_data,
+                       CaptureErrorCallback on_error,
+                       std::string* error) {
+  Close();
+
+  const std::string device =
+      config.device_id.empty() ? "default" : config.device_id;
+
+  // Non blocking, the capture thread waits on the device descriptors.
+  int result = snd_pcm_open(&pcm_, device.c_str(), SND_PCM_STREAM_CAPTURE,
+                            SND_PCM_NONBLOCK);
+  if (result < 0) {
+    pcm_ = nullptr;
+    return SetError(error, "Unable to open " + device, result);
+  }
+
+  if (!Configure(config, error)) {
+    Close();
+    return false;
+  }
+
+  wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (wakeup_fd_ < 0) {
+    *error = "Unable to create the capture wakeup.";
+    Close();
+    return false;
+  }
+
+  sample_rate_ = config.sample_rate;
+  read_frames_ = 0;
+  captured_frames_ = 0;
+  captured_time_ = std::chrono::steady_clock::now();
+  paused_frames_.Clear();
+  if (config.start_paused) {
+    paused_frames_.Pause(0);
+  }
+  timing_.Reset();
+  on_data_ = std::move(on_data);
+  on_error_ = std::move(on_error);
+
+  result = snd_pcm_start(pcm_);
+  if (result < 0) {
+    Close();
+    return SetError(error, "Unable to start " + device, result);
+  }
+
+  closing_ = false;
+  thread_ = std::thread(&AlsaCapture::CaptureLoop, this);
+  return true;
+}
+
+bool AlsaCapture::Configure(const CaptureConfig& config, std::string* error) {
+  snd_pcm_hw_params_t* hw_params;
+  snd_pcm_hw_params_alloca(&hw_params);
+
+  int result = snd_pcm_hw_params_any(pcm_, hw_params);
+  if (result < 0) {
+    return SetError(error, "Unable to get the device parameters", result);
+  }
+
+  mmap_ = snd_pcm_hw_params_set_access(pcm_, hw_params,
+                                       SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+  if (!mmap_) {
+    result = snd_pcm_hw_params_set_access(pcm_, hw_params,
+                                          SND_PCM_ACCESS_RW_INTERLEAVED);
+    if (result < 0) {
+      return SetError(error, "Interleaved access is not supported", result);
+    }
+  }
+
+  // Exact format, the encoder is set up from the requested one. Devices
+  // going through the plug plugin (e.g. "default", "plughw:") convert.
+  result = snd_pcm_hw_params_set_format(pcm_, hw_params,
+                                        ToAlsaFormat(config.sample_format));
+  if (result < 0) {
+    return SetError(error, "Sample format is not supported", result);
+  }
+
+  result = snd_pcm_hw_params_set_channels(
+      pcm_, hw_params, static_cast<unsigned int>(config.num_channels));
+  if (result < 0) {
+    return SetError(error, "Channel count is not supported", result);
+  }
+
+  result = snd_pcm_hw_params_set_rate(
+      pcm_, hw_params, static_cast<unsigned int>(config.sample_rate), 0);
+  if (result < 0) {
+    return SetError(error, "Sample rate is not supported", result);
+  }
+
+  unsigned int period_us = static_cast<unsigned int>(config.latency_ms) * 1000;
+  result = snd_pcm_hw_params_set_period_time_near(pcm_, hw_params, &period_us,
+                                                  nullptr);
+  if (result < 0) {
+    return SetError(error, "Unable to set the period", result);
+  }
+
+  unsigned int periods = static_cast<unsigned int>(config.buffer_periods);
+  result =
+      snd_pcm_hw_params_set_periods_near(pcm_, hw_params, &periods, nullptr);
+  if (result < 0) {
+    return SetError(error, "Unable to set the buffer size", result);
+  }
+
+  result = snd_pcm_hw_params(pcm_, hw_params);
+  if (result < 0) {
+    return SetError(error, "Unable to apply the device parameters", result);
+  }
+
+  snd_pcm_hw_params_get_period_size(hw_params, &period_frames_, nullptr);
+
+  // Woken up once per period.
+  snd_pcm_sw_params_t* sw_params;
+  snd_pcm_sw_params_alloca(&sw_params);
+  snd_pcm_sw_params_current(pcm_, sw_params);
+  snd_pcm_sw_params_set_avail_min(pcm_, sw_params, period_frames_);
+
+  result = snd_pcm_sw_params(pcm_, sw_params);
+  if (result < 0) {
+    return SetError(error, "Unable to apply the software parameters", result);
+  }
+
+  const int count = snd_pcm_poll_descriptors_count(pcm_);
+  if (count <= 0) {
+    return SetError(error, "Unable to poll the device",
+                    count < 0 ? count : -EINVAL);
+  }
+  // Wakeup first, then the device.
+  poll_fds_.resize(1 + static_cast<size_t>(count));
+
+  frame_size_ = static_cast<size_t>(snd_pcm_frames_to_bytes(pcm_, 1));
+  if (!mmap_) {
+    buffer_.resize(period_frames_ * frame_size_);
+  }
+
+  return true;
+}
+
+void AlsaCapture::Close() {
+  if (thread_.joinable()) {
+    closing_ = true;
+
+    const uint64_t count = 1;
+    ssize_t written;
+    do {
+      written = write(wakeup_fd_, &count, sizeof(count));
+    } while (written < 0 && errno == EINTR);
+
+    thread_.join();
+  }
+
+  if (pcm_ != nullptr) {
+    snd_pcm_drop(pcm_);
+    snd_pcm_close(pcm_);
+    pcm_ = nullptr;
+  }
+
+  if (wakeup_fd_ >= 0) {
+    close(wakeup_fd_);
+    wakeup_fd_ = -1;
+  }
+
+  buffer_.clear();
+  poll_fds_.clear();
+  on_data_ = nullptr;
+  on_error_ = nullptr;
+}
+
+bool AlsaCapture::SetPaused(bool paused) {
+  if (pcm_ == nullptr) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(pause_mutex_);
+
+  const int64_t position = CapturePosition();
+
+  if (paused) {
+    paused_frames_.Pause(position);
+  } else {
+    paused_frames_.Resume(position);
+  }
+
+  return true;
+}
+
+int64_t AlsaCapture::CapturePosition() const {
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - captured_time_);
+
+  return captured_frames_ + elapsed.count() * sample_rate_ / 1000000;
+}
+
+void AlsaCapture::CaptureLoop() {
+  // Shown by per thread tools (top -H, pidstat -t), 15 characters at most.
+  pthread_setname_np(pthread_self(), "record-alsa");
+  PromoteCaptureThread();
+
+  while (!closing_) {
+    int result = Wait();
+    if (result == 0) {
+      return;
+    }
+    if (result < 0) {
+      on_error_(std::string("Capture stopped: ") + std::strerror(-result));
+      return;
+    }
+
+    result = Read();
+    if (result < 0) {
+      result = Recover(result);
+    }
+
+    if (result < 0) {
+      on_error_(std::string("Capture stopped: ") + snd_strerror(result));
+      return;
+    }
+  }
+}
+
+int AlsaCapture::Wait() {
+  pollfd* device_fds = poll_fds_.data() + 1;
+  const auto device_count = static_cast<unsigned int>(poll_fds_.size() - 1);
+  poll_fds_[0] = {wakeup_fd_, POLLIN, 0};
+  snd_pcm_poll_descriptors(pcm_, device_fds, device_count);
+
+  while (poll(poll_fds_.data(), poll_fds_.size(), -1) < 0) {
+    if (errno != EINTR) {
+      return -errno;
+    }
+  }
+
+  if (poll_fds_[0].revents != 0) {
+    return 0;
+  }
+
+  // Errors (e.g. an overrun) are returned by the following read.
+  unsigned short revents;
+  snd_pcm_poll_descriptors_revents(pcm_, device_fds, device_count, &revents);
+  return 1;
+}
+
+int AlsaCapture::Read() {
+  // Captured frames not read yet, hardware included. Also updates the
+  // device position.
+  snd_pcm_sframes_t delay = 0;
+  const bool has_delay = snd_pcm_delay(pcm_, &delay) == 0 && delay >= 0;
+
+  const snd_pcm_sframes_t available = snd_pcm_avail_update(pcm_);
+  if (available < 0) {
+    return static_cast<int>(available);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(pause_mutex_);
+    captured_frames_ =
+        read_frames_ + std::max(has_delay ? delay : 0, available);
+    captured_time_ = std::chrono::steady_clock::now();
+  }
+
+  const int64_t start = read_frames_;
+  auto remaining = static_cast<snd_pcm_uframes_t>(available);
+
+  while (remaining > 0) {
+    snd_pcm_uframes_t frames = remaining;
+
+    if (mmap_) {
+      const snd_pcm_channel_area_t* areas;
+      snd_pcm_uframes_t offset;
+
+      int result = snd_pcm_mmap_begin(pcm_, &areas, &offset, &frames);
+      if (result < 0) {
+        return result;
+      }
+      if (frames == 0) {
+        break;
+      }
+
+      // Interleaved, the first area holds all channels.
+      const uint8_t* data = static_cast<const uint8_t*>(areas[0].addr) +
+                            (areas[0].first + offset * areas[0].step) / 8;
+      Deliver(data, frames);
+
+      const snd_pcm_sframes_t committed =
+          snd_pcm_mmap_commit(pcm_, offset, frames);
+      if (committed < 0) {
+        return static_cast<int>(committed);
+      }
+      if (static_cast<snd_pcm_uframes_t>(committed) != frames) {
+        return -EPIPE;
+      }
+    } else {
+      frames = std::min<snd_pcm_uframes_t>(frames, period_frames_);
+
+      const snd_pcm_sframes_t count =
+          snd_pcm_readi(pcm_, buffer_.data(), frames);
+      if (count == -EAGAIN || count == 0) {
+        break;
+      }
+      if (count < 0) {
+        return static_cast<int>(count);
+      }
+
+      frames = static_cast<snd_pcm_uframes_t>(count);
+      Deliver(buffer_.data(), frames);
+    }
+
+    remaining -= frames;
+  }
+
+  if (read_frames_ > start) {
+    timing_.AddBuffer((read_frames_ - start) * 1000000 / sample_rate_,
+                      has_delay ? delay * 1000000 / sample_rate_ : -1);
+  }
+
+  return 0;
+}
+
+int AlsaCapture::Recover(int error) {
+  // Overrun or suspend, other errors (e.g. unplugged device) are final.
+  int result = snd_pcm_recover(pcm_, error, 1);
+  if (result < 0) {
+    return result;
+  }
+
+  // Restarted after an overrun, resumed devices are already running.
+  if (snd_pcm_state(pcm_) == SND_PCM_STATE_PREPARED) {
+    result = snd_pcm_start(pcm_);
+  }
+
+  // Lost frames are not in read positions, capture goes on from here.
+  std::lock_guard<std::mutex> lock(pause_mutex_);
+  captured_frames_ = read_frames_;
+  captured_time_ = std::chrono::steady_clock::now();
+
+  return result;
+}
+
+void AlsaCapture::Deliver(const uint8_t* data, snd_pcm_uframes_t frames) {
+  std::lock_guard<std::mutex> lock(pause_mutex_);
+
+  paused_frames_.Deliver(read_frames_, data, frames * frame_size_,
+                         frame_size_, on_data_);
+  read_frames_ += static_cast<int64_t>(frames);
+}
+
+bool ListAlsaDevices(std::vector<InputDeviceInfo>* devices,
+                     std::string* error) {
+  void** hints;
+  const int result = snd_device_name_hint(-1, "pcm", &hints);
+  if (result < 0) {
+    return SetError(error, "Unable to list devices", result);
+  }
+
+  devices->clear();
+
+  for (void** hint = hints; *hint != nullptr; ++hint) {
+    char* name = snd_device_name_get_hint(*hint, "NAME");
+    char* description = snd_device_name_get_hint(*hint, "DESC");
+    // Absent for devices of both directions.
+    char* direction = snd_device_name_get_hint(*hint, "IOID");
+
+    if (name != nullptr &&
+        (direction == nullptr || strcmp(direction, "Input") == 0)) {
+      InputDeviceInfo device;
+      device.id = name;
+      device.label = description != nullptr ? description : name;
+      // Descriptions hold the card and the device on two lines.
+      std::replace(device.label.begin(), device.label.end(), '\n', ' ');
+      device.is_default = device.id == "default";
+
+      if (device.is_default) {
+        devices->insert(devices->begin(), std::move(device));
+      } else {
+        devices->push_back(std::move(device));
+      }
+    }
+
+    free(name);
+    free(description);
+    free(direction);
+  }
+
+  snd_device_name_free_hint(hints);
+  return true;
+}
+
+}  // namespace record_linux
@@ -0,0 +1,101 @@
+#ifndef FLUTTER_PLUGIN_RECORD_ALSA_CAPTURE_H_
+#define FLUTTER_PLUGIN_RECORD_ALSA_CAPTURE_H_
+
+#include <alsa/asoundlib.h>
+#include <poll.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "record_capture.h"
+#include "record_devices.h"
+
+namespace record_linux {
+
+// Capture from an ALSA PCM, for hosts without a sound server.
+//
+// The device is read through mmap when it allows it (hw, dsnoop and most
+// plugins), read otherwise, on a dedicated thread raised to real-time
+// priority when allowed. The period is CaptureConfig::latency_ms and the
+// buffer holds CaptureConfig::buffer_periods periods. Overruns are recovered by restarting the
+// device, frames lost meanwhile are not replaced.
+//
+// Pause keeps the device running and drops frames from the pause request
+// until resuming. Requests don't come from the capture thread, their frame
+// position is extrapolated from the last read.
+class AlsaCapture : public CaptureBackend {
+ public:
+  AlsaCapture() = default;
+  ~AlsaCapture() override;
+
+  AlsaCapture(const AlsaCapture&) = delete;
+  AlsaCapture& operator=(const AlsaCapture&) = delete;
+
+  bool Open(const CaptureConfig& config,
+            CaptureDataCallback on_data,
+            CaptureErrorCallback on_error,
+            std::string* error) override;
+  void Close() override;
+  bool SetPaused(bool paused) override;
+  record_core::CaptureLatency GetLatency() const override {
+    return timing_.Get();
+  }
+
+ private:
+  bool Configure(const CaptureConfig& config, std::string* error);
+
+  // Capture thread.
+  void CaptureLoop();
+  // Returns 1 when the device is ready, 0 when closing or a negative errno.
+  int Wait();
+  // Returns 0 or a negative error code.
+  int Read();
+  int Recover(int error);
+  void Deliver(const uint8_t* data, snd_pcm_uframes_t frames);
+
+  // Frame currently captured by the device, with pause_mutex_ locked.
+  int64_t CapturePosition() const;
+
+  snd_pcm_t* pcm_ = nullptr;
+  bool mmap_ = true;
+  size_t frame_size_ = 2;
+  int sample_rate_ = 0;
+  snd_pcm_uframes_t period_frames_ = 0;
+
+  std::thread thread_;
+  // Wakes the capture thread up to close.
+  int wakeup_fd_ = -1;
+  std::atomic<bool> closing_{false};
+
+  // Capture thread state.
+  std::vector<pollfd> poll_fds_;
+  // Read buffer without mmap.
+  std::vector<uint8_t> buffer_;
+  record_core::CaptureTiming timing_;
+
+  // Shared with pause requests.
+  std::mutex pause_mutex_;
+  // Read position since Open, overruns excluded.
+  int64_t read_frames_ = 0;
+  // Frames captured by the device at the last read.
+  int64_t captured_frames_ = 0;
+  std::chrono::steady_clock::time_point captured_time_;
+  PausedFrames paused_frames_;
+
+  CaptureDataCallback on_data_;
+  CaptureErrorCallback on_error_;
+};
+
+// Capture PCMs from the ALSA configuration and sound cards, with "default"
+// first.
+bool ListAlsaDevices(std::vector<InputDeviceInfo>* devices,
+                     std::string* error);
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_ALSA_CAPTURE_H_
@@ -0,0 +1,75 @@
+#include "record_capture.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace record_linux {
+
+namespace {
+
+constexpr int kCapturePriority = 10;
+
+}  // namespace
+
+void PausedFrames::Pause(int64_t position) {
+  ranges_.push_back({position, std::numeric_limits<int64_t>::max()});
+}
+
+void PausedFrames::Resume(int64_t position) {
+  if (!ranges_.empty()) {
+    auto& range = ranges_.back();
+    range.end = std::max(range.start, position);
+  }
+}
+
+void PausedFrames::Deliver(int64_t position,
+                           const uint8_t* data,
+                           size_t size,
+                           size_t frame_size,
+                           const CaptureDataCallback& on_data) {
+  const int64_t end = position + static_cast<int64_t>(size / frame_size);
+
+  while (position < end) {
+    while (!ranges_.empty() && ranges_.front().end <= position) {
+      ranges_.pop_front();
+    }
+
+    if (ranges_.empty() || ranges_.front().start >= end) {
+      on_data(data, static_cast<size_t>(end - position) * frame_size);
+      return;
+    }
+
+    const FrameRange& range = ranges_.front();
+
+    if (range.start > position) {
+      const auto count = static_cast<size_t>(range.start - position);
+      on_data(data, count * frame_size);
+      data += count * frame_size;
+      position = range.start;
+    }
+
+    // Skip frames captured while paused.
+    const int64_t skipped = std::min(end, range.end) - position;
+    data += static_cast<size_t>(skipped) * frame_size;
+    position += skipped;
+  }
+}
+
+void PromoteCaptureThread() {
+  static thread_local bool promoted = false;
+  if (promoted) {
+    return;
+  }
+  promoted = true;
+
+  sched_param param = {};
+  param.sched_priority =
+      std::min(kCapturePriority, sched_get_priority_max(SCHED_FIFO));
+  pthread_setschedparam(pthread_self(), SCHED_FIFO | SCHED_RESET_ON_FORK,
+                        &param);
+}
+
+}  // namespace record_linux
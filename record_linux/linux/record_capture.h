@@ -0,0 +1,115 @@
+#ifndef FLUTTER_PLUGIN_RECORD_CAPTURE_H_
+#define FLUTTER_PLUGIN_RECORD_CAPTURE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "core/capture_timing.h"
+#include "core/sample_format.h"
+
+namespace record_linux {
+
+// Bounds of CaptureConfig::latency_ms.
+constexpr int kMinLatencyMs = 5;
+constexpr int kMaxLatencyMs = 200;
+// Bounds of CaptureConfig::buffer_periods.
+constexpr int kMinBufferPeriods = 2;
+constexpr int kMaxBufferPeriods = 32;
+
+// Capture parameters requested by a recorder.
+struct CaptureConfig {
+  // Source (or ALSA PCM) name, empty for the default one.
+  std::string device_id;
+  // Name of the capture stream shown by the sound server.
+  std::string stream_name = "record";
+  int sample_rate = 44100;
+  int num_channels = 2;
+  record_core::SampleFormat sample_format = record_core::SampleFormat::s16;
+  // Requested capture period in milliseconds, see kMinLatencyMs and
+  // kMaxLatencyMs.
+  int latency_ms = 100;
+  // Device buffer size in periods, for backends reading a device directly
+  // (ALSA). More periods tolerate longer stalls before an overrun.
+  int buffer_periods = 4;
+  bool auto_gain = false;
+  bool echo_cancel = false;
+  bool noise_suppress = false;
+  // Frames are dropped from the start until SetPaused(false), the device
+  // runs meanwhile (see Recorder::Prepare).
+  bool start_paused = false;
+};
+
+// Receives interleaved whole frames in the configured format.
+// Called from the capture thread, must not block.
+using CaptureDataCallback =
+    std::function<void(const uint8_t* data, size_t size)>;
+
+// Called from the capture thread when capture stops unexpectedly
+// (e.g. server shutdown).
+using CaptureErrorCallback = std::function<void(const std::string& message)>;
+
+// Audio capture from a sound server or a device.
+// Methods are called from one thread at a time.
+class CaptureBackend {
+ public:
+  virtual ~CaptureBackend() = default;
+
+  // Opens the source and starts capturing. Callbacks are called until Close.
+  virtual bool Open(const CaptureConfig& config,
+                    CaptureDataCallback on_data,
+                    CaptureErrorCallback on_error,
+                    std::string* error) = 0;
+
+  // Stops capturing. Callbacks are not called anymore once it returns.
+  virtual void Close() = 0;
+
+  // Suspends or resumes capture. Data captured after pausing is not
+  // delivered, and resuming doesn't wait for the device.
+  virtual bool SetPaused(bool paused) = 0;
+
+  // Measured since Open, any thread.
+  virtual record_core::CaptureLatency GetLatency() const = 0;
+};
+
+// Frames to drop from a capture that keeps running while paused, from the
+// pause position to the resume position. Positions are frames since Open.
+class PausedFrames {
+ public:
+  void Clear() { ranges_.clear(); }
+  void Pause(int64_t position);
+  void Resume(int64_t position);
+
+  // Gives the frames of data, read at position, which are not paused.
+  void Deliver(int64_t position,
+               const uint8_t* data,
+               size_t size,
+               size_t frame_size,
+               const CaptureDataCallback& on_data);
+
+ private:
+  // Frames, from the pause position to the resume position (or open).
+  struct FrameRange {
+    int64_t start;
+    int64_t end;
+  };
+
+  std::deque<FrameRange> ranges_;
+};
+
+// Raises the calling thread to real-time priority once. Best effort, it
+// needs RLIMIT_RTPRIO or CAP_SYS_NICE, otherwise the thread is left as is.
+void PromoteCaptureThread();
+
+// Capture from native PipeWire streams or the sound server, or directly
+// from ALSA devices when no server is running. PipeWire and ALSA backends
+// are optional in builds. Defined in its own file so tests can link a fake
+// backend instead.
+std::unique_ptr<CaptureBackend> CreateCaptureBackend();
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_CAPTURE_H_
@@ -0,0 +1,45 @@
+#include "record_capture.h"
+
+#ifdef RECORD_HAVE_ALSA
+#include "record_alsa_capture.h"
+#endif
+#ifdef RECORD_HAVE_PIPEWIRE
+#include "record_pipewire_capture.h"
+#endif
+#ifdef RECORD_HAVE_PULSE
+#include "record_pulse_capture.h"
+#include "record_pulse_context.h"
+#endif
+
+namespace record_linux {
+
+std::unique_ptr<CaptureBackend> CreateCaptureBackend() {
+  std::string error;
+
+#ifdef RECORD_HAVE_PIPEWIRE
+  // Native streams skip the pulse layer of PipeWire hosts.
+  auto pipewire = PipeWireContext::Acquire(&error);
+  if (pipewire) {
+    return std::unique_ptr<CaptureBackend>(
+        new PipeWireCapture(std::move(pipewire)));
+  }
+#endif
+
+#ifdef RECORD_HAVE_PULSE
+  auto pulse = PulseContext::Acquire(&error);
+
+#ifdef RECORD_HAVE_ALSA
+  // Without libpulse or a running server (it's not spawned), devices are
+  // opened directly.
+  if (!pulse) {
+    return std::unique_ptr<CaptureBackend>(new AlsaCapture());
+  }
+#endif
+
+  return std::unique_ptr<CaptureBackend>(new PulseCapture(std::move(pulse)));
+#else
+  return std::unique_ptr<CaptureBackend>(new AlsaCapture());
+#endif
+}
+
+}  // namespace record_linux
@@ -0,0 +1,43 @@
+#include "record_devices.h"
+
+#include <algorithm>
+
+namespace record_linux {
+
+namespace {
+
+bool Contains(const std::vector<InputDeviceInfo>& devices,
+              const std::string& id) {
+  return std::any_of(
+      devices.begin(), devices.end(),
+      [&id](const InputDeviceInfo& device) { return device.id == id; });
+}
+
+std::string DefaultId(const std::vector<InputDeviceInfo>& devices) {
+  auto device = std::find_if(
+      devices.begin(), devices.end(),
+      [](const InputDeviceInfo& device) { return device.is_default; });
+  return device != devices.end() ? device->id : std::string();
+}
+
+}  // namespace
+
+InputDeviceChange DiffInputDevices(const std::vector<InputDeviceInfo>& before,
+                                   const std::vector<InputDeviceInfo>& after) {
+  InputDeviceChange change;
+  for (const auto& device : after) {
+    if (!Contains(before, device.id)) {
+      change.added.push_back(device);
+    }
+  }
+  for (const auto& device : before) {
+    if (!Contains(after, device.id)) {
+      change.removed.push_back(device);
+    }
+  }
+  change.default_id = DefaultId(after);
+  change.default_changed = change.default_id != DefaultId(before);
+  return change;
+}
+
+}  // namespace record_linux
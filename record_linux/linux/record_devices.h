@@ -0,0 +1,52 @@
+#ifndef FLUTTER_PLUGIN_RECORD_DEVICES_H_
+#define FLUTTER_PLUGIN_RECORD_DEVICES_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace record_linux {
+
+// Input device of the sound server or ALSA.
+struct InputDeviceInfo {
+  std::string id;
+  std::string label;
+  // Native sample spec.
+  int sample_rate = 0;
+  int num_channels = 0;
+  // SampleFormat value, -1 when the source format has none.
+  int sample_format = -1;
+  int64_t latency_us = 0;
+  // Monitor of a sink, captures what is played.
+  bool is_monitor = false;
+  bool is_default = false;
+};
+
+// Difference between two device lists, devices are compared by id.
+struct InputDeviceChange {
+  std::vector<InputDeviceInfo> added;
+  std::vector<InputDeviceInfo> removed;
+  bool default_changed = false;
+  // Empty when there is no default source.
+  std::string default_id;
+
+  bool empty() const {
+    return added.empty() && removed.empty() && !default_changed;
+  }
+};
+
+// Devices added to or removed from before, and default device change.
+InputDeviceChange DiffInputDevices(const std::vector<InputDeviceInfo>& before,
+                                   const std::vector<InputDeviceInfo>& after);
+
+// Receives device changes, on the main thread.
+class DeviceListener {
+ public:
+  virtual ~DeviceListener() = default;
+
+  virtual void OnDevicesChanged(const InputDeviceChange& change) = 0;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_DEVICES_H_
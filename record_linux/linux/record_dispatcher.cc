@@ -0,0 +1,27 @@
+#include "record_dispatcher.h"
+
+#include <glib.h>
+
+static gboolean record_dispatcher_drain(gpointer user_data) {
+  static_cast<record_core::MainThreadDispatcher*>(user_data)->Drain();
+  return G_SOURCE_REMOVE;
+}
+
+// GLib adapter. An idle source is always deferred (unlike
+// g_main_context_invoke from the main thread) so tasks never run within
+// Post.
+static void record_dispatcher_wakeup(void* context) {
+  g_idle_add_full(G_PRIORITY_DEFAULT, record_dispatcher_drain, context,
+                  nullptr);
+}
+
+record_core::MainThreadDispatcher& record_dispatcher() {
+  static record_core::MainThreadDispatcher* dispatcher = [] {
+    // Never destroyed, sources may still be pending at exit.
+    auto* instance = new record_core::MainThreadDispatcher();
+    instance->SetWakeup(record_dispatcher_wakeup, instance);
+    return instance;
+  }();
+
+  return *dispatcher;
+}
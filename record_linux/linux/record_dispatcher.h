@@ -0,0 +1,18 @@
+#ifndef FLUTTER_PLUGIN_RECORD_DISPATCHER_H_
+#define FLUTTER_PLUGIN_RECORD_DISPATCHER_H_
+
+#include <utility>
+
+#include "core/main_thread_dispatcher.h"
+
+// Dispatcher of the plugin, tasks posted from any thread run on the GLib
+// default main context (Flutter platform thread).
+record_core::MainThreadDispatcher& record_dispatcher();
+
+// Posts callable to run on the main context.
+template <typename F>
+void record_run_on_main_thread(F&& callable) {
+  record_dispatcher().Post(std::forward<F>(callable));
+}
+
+#endif  // FLUTTER_PLUGIN_RECORD_DISPATCHER_H_
@@ -0,0 +1,30 @@
+#include "record_encoder.h"
+
+#ifdef RECORD_HAVE_OPUS
+#include "record_opus_encoder.h"
+#endif
+
+namespace record_linux {
+
+bool AudioEncoder::OpenStream(const EncoderConfig&,
+                              EncodedPacketCallback,
+                              std::string* error) {
+  *error = "Encoder does not stream.";
+  return false;
+}
+
+bool IsEncoderSupported(const std::string& name) {
+  return CreateAudioEncoder(name) != nullptr;
+}
+
+int EncoderSampleRate(const std::string& name, int sample_rate) {
+  if (name == "opus") {
+#ifdef RECORD_HAVE_OPUS
+    return OggOpusEncoder::SupportedSampleRate(sample_rate);
+#endif
+  }
+
+  return sample_rate;
+}
+
+}  // namespace record_linux
@@ -0,0 +1,71 @@
+#ifndef FLUTTER_PLUGIN_RECORD_ENCODER_H_
+#define FLUTTER_PLUGIN_RECORD_ENCODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/sample_format.h"
+#include "core/stream_queue.h"
+
+namespace record_linux {
+
+struct EncoderConfig {
+  int sample_rate = 44100;
+  int num_channels = 2;
+  int bit_rate = 128000;
+  // Compressed encoders are always fed with 16 bits samples.
+  record_core::SampleFormat sample_format = record_core::SampleFormat::s16;
+};
+
+// Receives an encoded packet of a stream, timed from the stream start.
+using EncodedPacketCallback =
+    std::function<void(const uint8_t* data,
+                       size_t size,
+                       const record_core::StreamPacketInfo& info)>;
+
+// Encodes interleaved PCM frames to a file, or to packets of a stream.
+// Methods are called from one thread at a time (the recorder processing
+// thread).
+class AudioEncoder {
+ public:
+  virtual ~AudioEncoder() = default;
+
+  // Creates the file, replacing any existing one.
+  virtual bool Open(const std::string& path,
+                    const EncoderConfig& config,
+                    std::string* error) = 0;
+
+  // Sends packets without container to on_packet instead of writing a file.
+  // Returns false when the encoder only writes files.
+  virtual bool OpenStream(const EncoderConfig& config,
+                          EncodedPacketCallback on_packet,
+                          std::string* error);
+
+  // Setup data decoders need ahead of the packets of a stream, empty when
+  // there is none. Known once opened.
+  virtual std::vector<uint8_t> CodecConfig() const { return {}; }
+
+  // Data holds whole frames.
+  virtual bool Write(const uint8_t* data, size_t size) = 0;
+
+  // Encodes pending data, completes and closes the file.
+  virtual bool Finish() = 0;
+};
+
+// Returns nullptr when the encoder is unknown or not built in.
+// Encoder names are Dart AudioEncoder names.
+std::unique_ptr<AudioEncoder> CreateAudioEncoder(const std::string& name);
+
+// Tells if the encoder library was found at build time.
+bool IsEncoderSupported(const std::string& name);
+
+// Capture rate to use for the encoder, the closest rate it accepts.
+int EncoderSampleRate(const std::string& name, int sample_rate);
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_ENCODER_H_
@@ -0,0 +1,43 @@
+#include "record_encoder.h"
+
+#include "record_wav_encoder.h"
+
+#ifdef RECORD_HAVE_AAC
+#include "record_aac_encoder.h"
+#endif
+#ifdef RECORD_HAVE_FLAC
+#include "record_flac_encoder.h"
+#endif
+#ifdef RECORD_HAVE_OPUS
+#include "record_opus_encoder.h"
+#endif
+
+namespace record_linux {
+
+std::unique_ptr<AudioEncoder> CreateAudioEncoder(const std::string& name) {
+  if (name == "wav") {
+    return std::unique_ptr<AudioEncoder>(new WavEncoder(true));
+  }
+  if (name == "pcm16bits") {
+    return std::unique_ptr<AudioEncoder>(new WavEncoder(false));
+  }
+#ifdef RECORD_HAVE_AAC
+  if (name == "aacLc") {
+    return std::unique_ptr<AudioEncoder>(new AacEncoder());
+  }
+#endif
+#ifdef RECORD_HAVE_FLAC
+  if (name == "flac") {
+    return std::unique_ptr<AudioEncoder>(new FlacEncoder());
+  }
+#endif
+#ifdef RECORD_HAVE_OPUS
+  if (name == "opus") {
+    return std::unique_ptr<AudioEncoder>(new OggOpusEncoder());
+  }
+#endif
+
+  return nullptr;
+}
+
+}  // namespace record_linux
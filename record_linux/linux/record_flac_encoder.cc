@@ -0,0 +1,133 @@
+#include "record_flac_encoder.h"
+
+#include <cstring>
+#include <utility>
+
+namespace record_linux {
+
+namespace {
+
+constexpr unsigned kBitsPerSample = 16;
+// Default level of the flac tool.
+constexpr unsigned kCompressionLevel = 5;
+
+}  // namespace
+
+FlacEncoder::~FlacEncoder() {
+  if (encoder_ != nullptr) {
+    FLAC__stream_encoder_delete(encoder_);
+  }
+}
+
+bool FlacEncoder::Open(const std::string& path,
+                       const EncoderConfig& config,
+                       std::string* error) {
+  if (!Create(config, error)) {
+    return false;
+  }
+
+  const FLAC__StreamEncoderInitStatus status = FLAC__stream_encoder_init_file(
+      encoder_, path.c_str(), nullptr, nullptr);
+  if (status != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+    *error = std::string("Failed to create FLAC encoder: ") +
+             FLAC__StreamEncoderInitStatusString[status];
+    return false;
+  }
+
+  return true;
+}
+
+bool FlacEncoder::OpenStream(const EncoderConfig& config,
+                             EncodedPacketCallback on_packet,
+                             std::string* error) {
+  if (!Create(config, error)) {
+    return false;
+  }
+
+  on_packet_ = std::move(on_packet);
+  metadata_.clear();
+  streamed_frames_ = 0;
+
+  // Without seek callback, stream info is not rewritten on finish.
+  const FLAC__StreamEncoderInitStatus status = FLAC__stream_encoder_init_stream(
+      encoder_, &FlacEncoder::OnWrite, nullptr, nullptr, nullptr, this);
+  if (status != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+    *error = std::string("Failed to create FLAC encoder: ") +
+             FLAC__StreamEncoderInitStatusString[status];
+    return false;
+  }
+
+  return true;
+}
+
+bool FlacEncoder::Create(const EncoderConfig& config, std::string* error) {
+  config_ = config;
+
+  encoder_ = FLAC__stream_encoder_new();
+  if (encoder_ == nullptr) {
+    *error = "Failed to create FLAC encoder.";
+    return false;
+  }
+
+  FLAC__stream_encoder_set_channels(encoder_, config.num_channels);
+  FLAC__stream_encoder_set_bits_per_sample(encoder_, kBitsPerSample);
+  FLAC__stream_encoder_set_sample_rate(encoder_, config.sample_rate);
+  FLAC__stream_encoder_set_compression_level(encoder_, kCompressionLevel);
+
+  return true;
+}
+
+// static
+FLAC__StreamEncoderWriteStatus FlacEncoder::OnWrite(
+    const FLAC__StreamEncoder*,
+    const FLAC__byte buffer[],
+    size_t bytes,
+    uint32_t samples,
+    uint32_t,
+    void* client_data) {
+  auto* self = static_cast<FlacEncoder*>(client_data);
+
+  // Metadata is written by init, before any frame.
+  if (samples == 0) {
+    self->metadata_.insert(self->metadata_.end(), buffer, buffer + bytes);
+    return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+  }
+
+  // Each write is a whole frame of samples per channel.
+  record_core::StreamPacketInfo info;
+  info.timestampUs =
+      self->streamed_frames_ * 1000000 / self->config_.sample_rate;
+  info.durationUs =
+      static_cast<int64_t>(samples) * 1000000 / self->config_.sample_rate;
+  self->streamed_frames_ += samples;
+
+  self->on_packet_(buffer, bytes, info);
+  return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+}
+
+bool FlacEncoder::Write(const uint8_t* data, size_t size) {
+  const size_t count = size / sizeof(int16_t);
+
+  samples_.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    int16_t sample;
+    memcpy(&sample, data + i * sizeof(int16_t), sizeof(int16_t));
+    samples_[i] = sample;
+  }
+
+  return FLAC__stream_encoder_process_interleaved(
+             encoder_, samples_.data(),
+             static_cast<unsigned>(count / config_.num_channels)) != 0;
+}
+
+bool FlacEncoder::Finish() {
+  // Also completes the stream info with the MD5 signature and total samples.
+  const bool encoded = FLAC__stream_encoder_finish(encoder_) != 0;
+
+  FLAC__stream_encoder_delete(encoder_);
+  encoder_ = nullptr;
+
+  return encoded;
+}
+
+}  // namespace record_linux
@@ -0,0 +1,55 @@
+#ifndef FLUTTER_PLUGIN_RECORD_FLAC_ENCODER_H_
+#define FLUTTER_PLUGIN_RECORD_FLAC_ENCODER_H_
+
+#include <FLAC/stream_encoder.h>
+
+#include <vector>
+
+#include "record_encoder.h"
+
+namespace record_linux {
+
+// FLAC with libFLAC, 16 bits samples. Streamed packets are FLAC frames,
+// the codec config is the stream marker and metadata blocks.
+class FlacEncoder : public AudioEncoder {
+ public:
+  FlacEncoder() = default;
+  ~FlacEncoder() override;
+
+  bool Open(const std::string& path,
+            const EncoderConfig& config,
+            std::string* error) override;
+  bool OpenStream(const EncoderConfig& config,
+                  EncodedPacketCallback on_packet,
+                  std::string* error) override;
+  std::vector<uint8_t> CodecConfig() const override { return metadata_; }
+  bool Write(const uint8_t* data, size_t size) override;
+  bool Finish() override;
+
+ private:
+  // Creates and configures encoder_.
+  bool Create(const EncoderConfig& config, std::string* error);
+
+  static FLAC__StreamEncoderWriteStatus OnWrite(
+      const FLAC__StreamEncoder* encoder,
+      const FLAC__byte buffer[],
+      size_t bytes,
+      uint32_t samples,
+      uint32_t current_frame,
+      void* client_data);
+
+  EncoderConfig config_;
+  FLAC__StreamEncoder* encoder_ = nullptr;
+
+  // Stream state.
+  EncodedPacketCallback on_packet_;
+  std::vector<uint8_t> metadata_;
+  int64_t streamed_frames_ = 0;
+
+  // libFLAC takes 32 bits samples.
+  std::vector<FLAC__int32> samples_;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_FLAC_ENCODER_H_
@@ -3,17 +3,667 @@
 #include <flutter_linux/flutter_linux.h>
 #include <gtk/gtk.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "record_devices.h"
+#include "record_dispatcher.h"
+#include "record_recorder.h"
+
+#ifdef RECORD_HAVE_ALSA
+#include "record_alsa_capture.h"
+#endif
+#ifdef RECORD_HAVE_PULSE
+#include "record_pulse_devices.h"
+#endif
+
 #define RECORD_LINUX_PLUGIN(obj) \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), record_linux_plugin_get_type(), \
                               RecordLinuxPlugin))
 
+namespace {
+
+constexpr char kMethodChannel[] = "com.llfbandit.record/messages";
+constexpr char kStateEventChannel[] = "com.llfbandit.record/events/";
+constexpr char kRecordEventChannel[] = "com.llfbandit.record/eventsRecord/";
+constexpr char kEnvelopeEventChannel[] =
+    "com.llfbandit.record/eventsEnvelope/";
+constexpr char kSpectrumEventChannel[] =
+    "com.llfbandit.record/eventsSpectrum/";
+constexpr char kVadEventChannel[] = "com.llfbandit.record/eventsVad/";
+constexpr char kDevicesEventChannel[] = "com.llfbandit.record/eventsDevices";
+constexpr char kErrorCode[] = "Record";
+
+// Event channel sending only while Dart listens.
+class EventSink {
+ public:
+  // on_listen is called when Dart starts listening, on_cancel when it
+  // stops.
+  EventSink(FlBinaryMessenger* messenger,
+            const std::string& name,
+            std::function<void()> on_listen = nullptr,
+            std::function<void()> on_cancel = nullptr)
+      : on_listen_(std::move(on_listen)), on_cancel_(std::move(on_cancel)) {
+    g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+    channel_ = fl_event_channel_new(messenger, name.c_str(),
+                                    FL_METHOD_CODEC(codec));
+    fl_event_channel_set_stream_handlers(channel_, OnListen, OnCancel, this,
+                                         nullptr);
+  }
+
+  ~EventSink() {
+    fl_event_channel_set_stream_handlers(channel_, nullptr, nullptr, nullptr,
+                                         nullptr);
+    g_object_unref(channel_);
+  }
+
+  EventSink(const EventSink&) = delete;
+  EventSink& operator=(const EventSink&) = delete;
+
+  void Send(FlValue* event) {
+    if (listening_) {
+      fl_event_channel_send(channel_, event, nullptr, nullptr);
+    }
+  }
+
+  void SendError(const std::string& message) {
+    if (listening_) {
+      fl_event_channel_send_error(channel_, kErrorCode, message.c_str(),
+                                  nullptr, nullptr, nullptr);
+    }
+  }
+
+  void SendEndOfStream() {
+    if (listening_) {
+      fl_event_channel_send_end_of_stream(channel_, nullptr, nullptr);
+      listening_ = false;
+    }
+  }
+
+ private:
+  static FlMethodErrorResponse* OnListen(FlEventChannel* /* channel */,
+                                         FlValue* /* args */,
+                                         gpointer user_data) {
+    auto* self = static_cast<EventSink*>(user_data);
+    self->listening_ = true;
+    if (self->on_listen_) {
+      self->on_listen_();
+    }
+    return nullptr;
+  }
+
+  static FlMethodErrorResponse* OnCancel(FlEventChannel* /* channel */,
+                                         FlValue* /* args */,
+                                         gpointer user_data) {
+    auto* self = static_cast<EventSink*>(user_data);
+    self->listening_ = false;
+    if (self->on_cancel_) {
+      self->on_cancel_();
+    }
+    return nullptr;
+  }
+
+  FlEventChannel* channel_;
+  std::function<void()> on_listen_;
+  std::function<void()> on_cancel_;
+  bool listening_ = false;
+};
+
+// Sends recorder events to Dart.
+class RecorderEvents : public record_linux::RecorderListener {
+ public:
+  RecorderEvents(FlBinaryMessenger* messenger, const std::string& recorder_id)
+      : state_(messenger, kStateEventChannel + recorder_id),
+        record_(
+            messenger,
+            kRecordEventChannel + recorder_id,
+            [this]() { SetStreamListening(true); },
+            [this]() { SetStreamListening(false); }),
+        envelope_(messenger, kEnvelopeEventChannel + recorder_id),
+        spectrum_(messenger, kSpectrumEventChannel + recorder_id),
+        vad_(messenger, kVadEventChannel + recorder_id) {}
+
+  // Stream data is held by the recorder until Dart listens.
+  void SetRecorder(std::weak_ptr<record_linux::Recorder> recorder) {
+    recorder_ = std::move(recorder);
+  }
+
+  void OnStateChanged(record_linux::RecordState state) override {
+    g_autoptr(FlValue) event = fl_value_new_int(static_cast<int64_t>(state));
+    state_.Send(event);
+  }
+
+  void OnStreamData(const std::vector<uint8_t>& data) override {
+    g_autoptr(FlValue) event =
+        fl_value_new_uint8_list(data.data(), data.size());
+    record_.Send(event);
+  }
+
+  void OnSharedStreamData(const record_core::PcmRingChunk& chunk) override {
+    const int64_t location[] = {static_cast<int64_t>(chunk.position),
+                                static_cast<int64_t>(chunk.length),
+                                static_cast<int64_t>(chunk.sequence)};
+    g_autoptr(FlValue) event = fl_value_new_int64_list(location, 3);
+    record_.Send(event);
+  }
+
+  // Encoded packet with its timing in microseconds.
+  void OnStreamPacket(const std::vector<uint8_t>& data,
+                      const record_core::StreamPacketInfo& info) override {
+    g_autoptr(FlValue) event = fl_value_new_list();
+    fl_value_append_take(event,
+                         fl_value_new_uint8_list(data.data(), data.size()));
+    fl_value_append_take(event, fl_value_new_int(info.timestampUs));
+    fl_value_append_take(event, fl_value_new_int(info.durationUs));
+    record_.Send(event);
+  }
+
+  void OnStreamEnd() override { record_.SendEndOfStream(); }
+
+  void OnEnvelope(const std::vector<float>& buckets) override {
+    g_autoptr(FlValue) event =
+        fl_value_new_float32_list(buckets.data(), buckets.size());
+    envelope_.Send(event);
+  }
+
+  void OnSpectrum(const std::vector<float>& bands) override {
+    g_autoptr(FlValue) event =
+        fl_value_new_float32_list(bands.data(), bands.size());
+    spectrum_.Send(event);
+  }
+
+  void OnVoiceActivity(bool active) override {
+    g_autoptr(FlValue) event = fl_value_new_bool(active);
+    vad_.Send(event);
+  }
+
+  void OnError(const std::string& message) override {
+    state_.SendError(message);
+    record_.SendError(message);
+  }
+
+ private:
+  void SetStreamListening(bool listening) {
+    if (auto recorder = recorder_.lock()) {
+      recorder->SetStreamListening(listening);
+    }
+  }
+
+  std::weak_ptr<record_linux::Recorder> recorder_;
+  EventSink state_;
+  EventSink record_;
+  EventSink envelope_;
+  EventSink spectrum_;
+  EventSink vad_;
+};
+
+// Lists input devices and sends their changes to Dart.
+class DeviceEvents : public record_linux::DeviceListener {
+ public:
+  explicit DeviceEvents(FlBinaryMessenger* messenger)
+      :
+#ifdef RECORD_HAVE_PULSE
+        devices_(record_linux::PulseDevices::Create(this)),
+#endif
+        changes_(messenger, kDevicesEventChannel, [this]() {
+#ifdef RECORD_HAVE_PULSE
+          // Changes are reported from the list known when listening.
+          std::string error;
+          devices_->Update(&error);
+#endif
+        }) {}
+
+  bool List(std::vector<record_linux::InputDeviceInfo>* devices,
+            std::string* error) {
+#ifdef RECORD_HAVE_PULSE
+    if (devices_->List(devices, error)) {
+      return true;
+    }
+#endif
+#ifdef RECORD_HAVE_ALSA
+    // Without a sound server, capture is done from ALSA devices.
+    return record_linux::ListAlsaDevices(devices, error);
+#else
+    return false;
+#endif
+  }
+
+  void OnDevicesChanged(const record_linux::InputDeviceChange& change) override;
+
+ private:
+#ifdef RECORD_HAVE_PULSE
+  std::shared_ptr<record_linux::PulseDevices> devices_;
+#endif
+  EventSink changes_;
+};
+
+using RecorderMap =
+    std::map<std::string, std::shared_ptr<record_linux::Recorder>>;
+
+}  // namespace
+
 struct _RecordLinuxPlugin {
   GObject parent_instance;
+
+  // Owned by the engine, which outlives plugins.
+  FlBinaryMessenger* messenger;
+  RecorderMap* recorders;
+  DeviceEvents* devices;
 };
 
 G_DEFINE_TYPE(RecordLinuxPlugin, record_linux_plugin, g_object_get_type())
 
+static std::string record_lookup_string(FlValue* map, const char* key) {
+  FlValue* value = fl_value_lookup_string(map, key);
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+    return fl_value_get_string(value);
+  }
+  return std::string();
+}
+
+static int64_t record_lookup_int(FlValue* map,
+                                 const char* key,
+                                 int64_t fallback) {
+  FlValue* value = fl_value_lookup_string(map, key);
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    return fl_value_get_int(value);
+  }
+  return fallback;
+}
+
+static double record_lookup_double(FlValue* map,
+                                   const char* key,
+                                   double fallback) {
+  FlValue* value = fl_value_lookup_string(map, key);
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    return fl_value_get_float(value);
+  }
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    return static_cast<double>(fl_value_get_int(value));
+  }
+  return fallback;
+}
+
+static bool record_lookup_bool(FlValue* map, const char* key) {
+  FlValue* value = fl_value_lookup_string(map, key);
+  return value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL &&
+         fl_value_get_bool(value);
+}
+
+static record_linux::RecordConfig record_config_from_args(FlValue* args) {
+  record_linux::RecordConfig config;
+
+  config.encoder = record_lookup_string(args, "encoder");
+  config.bit_rate = record_lookup_int(args, "bitRate", config.bit_rate);
+  config.sample_rate =
+      record_lookup_int(args, "sampleRate", config.sample_rate);
+  config.num_channels = std::max<int64_t>(
+      1, record_lookup_int(args, "numChannels", config.num_channels));
+  config.latency_ms = record_lookup_int(args, "latency", config.latency_ms);
+  config.buffer_periods =
+      record_lookup_int(args, "bufferPeriods", config.buffer_periods);
+  config.auto_gain = record_lookup_bool(args, "autoGain");
+  config.echo_cancel = record_lookup_bool(args, "echoCancel");
+  config.noise_suppress = record_lookup_bool(args, "noiseSuppress");
+  config.stream_buffer_size = record_lookup_int(args, "streamBufferSize", 0);
+  config.stream_max_delay_ms = record_lookup_int(args, "streamMaxDelay", 0);
+  config.zero_copy_stream = record_lookup_bool(args, "zeroCopyStream");
+  config.envelope_interval_ms = record_lookup_int(args, "envelopeInterval", 0);
+
+  FlValue* device = fl_value_lookup_string(args, "device");
+  if (device != nullptr && fl_value_get_type(device) == FL_VALUE_TYPE_MAP) {
+    config.device_id = record_lookup_string(device, "id");
+  }
+
+  FlValue* spectrum = fl_value_lookup_string(args, "spectrum");
+  if (spectrum != nullptr &&
+      fl_value_get_type(spectrum) == FL_VALUE_TYPE_MAP) {
+    auto& analyzer = config.spectrum;
+    analyzer.fftSize = record_lookup_int(spectrum, "fftSize", 0);
+    analyzer.hopSize = record_lookup_int(spectrum, "hopSize", 0);
+    analyzer.numBands =
+        record_lookup_int(spectrum, "numBands", analyzer.numBands);
+    analyzer.minFrequency =
+        record_lookup_double(spectrum, "minFrequency", analyzer.minFrequency);
+    analyzer.maxFrameRate =
+        record_lookup_double(spectrum, "maxFrameRate", analyzer.maxFrameRate);
+  }
+
+  FlValue* vad = fl_value_lookup_string(args, "vad");
+  if (vad != nullptr && fl_value_get_type(vad) == FL_VALUE_TYPE_MAP) {
+    auto& detector = config.vad;
+    const int64_t mode = record_lookup_int(vad, "mode", 0);
+    if (mode >= 0 &&
+        mode <= static_cast<int64_t>(record_core::VadMode::skip)) {
+      detector.mode = static_cast<record_core::VadMode>(mode);
+    }
+    detector.thresholdDb =
+        record_lookup_double(vad, "threshold", detector.thresholdDb);
+    detector.minEnergyDb =
+        record_lookup_double(vad, "minEnergy", detector.minEnergyDb);
+    detector.hangoverMs =
+        record_lookup_int(vad, "hangover", detector.hangoverMs);
+  }
+
+  const int64_t policy = record_lookup_int(
+      args, "streamOverflowPolicy",
+      static_cast<int64_t>(config.stream_overflow_policy));
+  if (policy >= 0 &&
+      policy <= static_cast<int64_t>(
+                    record_core::StreamOverflowPolicy::coalesce)) {
+    config.stream_overflow_policy =
+        static_cast<record_core::StreamOverflowPolicy>(policy);
+  }
+
+  // Compressed encoders are fed with 16 bits samples.
+  const int64_t format = record_lookup_int(args, "sampleFormat", 0);
+  if ((config.encoder == "pcm16bits" || config.encoder == "wav") &&
+      format >= 0 &&
+      format <= static_cast<int64_t>(record_core::SampleFormat::f32)) {
+    config.sample_format = static_cast<record_core::SampleFormat>(format);
+  }
+
+  return config;
+}
+
+static FlValue* record_amplitude_to_value(
+    const record_core::MeterSnapshot& meters) {
+  FlValue* channels = fl_value_new_list();
+  for (int ch = 0; ch < meters.numChannels; ch++) {
+    const auto& levels = meters.channels[ch];
+
+    FlValue* channel = fl_value_new_map();
+    fl_value_set_string_take(channel, "peak", fl_value_new_float(levels.peak));
+    fl_value_set_string_take(channel, "rms", fl_value_new_float(levels.rms));
+    fl_value_set_string_take(channel, "truePeak",
+                             fl_value_new_float(levels.truePeak));
+    fl_value_set_string_take(channel, "peakHold",
+                             fl_value_new_float(levels.peakHold));
+    fl_value_append_take(channels, channel);
+  }
+
+  FlValue* amplitude = fl_value_new_map();
+  fl_value_set_string_take(amplitude, "current",
+                           fl_value_new_float(meters.current));
+  fl_value_set_string_take(amplitude, "max", fl_value_new_float(meters.max));
+  fl_value_set_string_take(amplitude, "rms", fl_value_new_float(meters.rms));
+  fl_value_set_string_take(
+      amplitude, "clipCount",
+      fl_value_new_int(static_cast<int64_t>(meters.clipCount)));
+  fl_value_set_string_take(amplitude, "channels", channels);
+
+  return amplitude;
+}
+
+static FlValue* record_loudness_to_value(
+    const record_core::LoudnessLevels& loudness) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "momentary",
+                           fl_value_new_float(loudness.momentary));
+  fl_value_set_string_take(value, "shortTerm",
+                           fl_value_new_float(loudness.shortTerm));
+  fl_value_set_string_take(value, "integrated",
+                           fl_value_new_float(loudness.integrated));
+  fl_value_set_string_take(value, "range", fl_value_new_float(loudness.range));
+  return value;
+}
+
+static FlValue* record_stream_stats_to_value(
+    const record_core::StreamQueueStats& stats) {
+  const record_core::DispatcherStats dispatcher = record_dispatcher().Stats();
+
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(
+      value, "droppedBytes",
+      fl_value_new_int(static_cast<int64_t>(stats.droppedBytes)));
+  fl_value_set_string_take(
+      value, "droppedChunks",
+      fl_value_new_int(static_cast<int64_t>(stats.droppedChunks)));
+  fl_value_set_string_take(
+      value, "queuedChunks",
+      fl_value_new_int(static_cast<int64_t>(stats.queuedChunks)));
+  fl_value_set_string_take(
+      value, "dispatchQueueDepth",
+      fl_value_new_int(static_cast<int64_t>(dispatcher.queueDepth)));
+  fl_value_set_string_take(value, "dispatchLatency",
+                           fl_value_new_float(dispatcher.meanLatencyUs));
+  fl_value_set_string_take(value, "maxDispatchLatency",
+                           fl_value_new_float(dispatcher.maxLatencyUs));
+  return value;
+}
+
+static FlValue* record_latency_to_value(
+    const record_core::CaptureLatency& latency) {
+  FlValue* value = fl_value_new_map();
+  if (latency.latencyUs > 0) {
+    fl_value_set_string_take(value, "latency",
+                             fl_value_new_int(latency.latencyUs));
+  }
+  fl_value_set_string_take(value, "period", fl_value_new_int(latency.periodUs));
+  return value;
+}
+
+static FlValue* record_devices_to_value(
+    const std::vector<record_linux::InputDeviceInfo>& devices) {
+  FlValue* value = fl_value_new_list();
+  for (const auto& device : devices) {
+    FlValue* map = fl_value_new_map();
+    fl_value_set_string_take(map, "id", fl_value_new_string(device.id.c_str()));
+    fl_value_set_string_take(map, "label",
+                             fl_value_new_string(device.label.c_str()));
+    fl_value_set_string_take(map, "sampleRate",
+                             fl_value_new_int(device.sample_rate));
+    fl_value_set_string_take(map, "numChannels",
+                             fl_value_new_int(device.num_channels));
+    if (device.sample_format >= 0) {
+      fl_value_set_string_take(map, "sampleFormat",
+                               fl_value_new_int(device.sample_format));
+    }
+    fl_value_set_string_take(map, "latency",
+                             fl_value_new_int(device.latency_us));
+    fl_value_set_string_take(map, "isMonitor",
+                             fl_value_new_bool(device.is_monitor));
+    fl_value_set_string_take(map, "isDefault",
+                             fl_value_new_bool(device.is_default));
+    fl_value_append_take(value, map);
+  }
+  return value;
+}
+
+static FlValue* record_device_change_to_value(
+    const record_linux::InputDeviceChange& change) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "added",
+                           record_devices_to_value(change.added));
+  fl_value_set_string_take(value, "removed",
+                           record_devices_to_value(change.removed));
+  fl_value_set_string_take(value, "defaultChanged",
+                           fl_value_new_bool(change.default_changed));
+  if (!change.default_id.empty()) {
+    fl_value_set_string_take(value, "defaultDeviceId",
+                             fl_value_new_string(change.default_id.c_str()));
+  }
+  return value;
+}
+
+void DeviceEvents::OnDevicesChanged(
+    const record_linux::InputDeviceChange& change) {
+  g_autoptr(FlValue) event = record_device_change_to_value(change);
+  changes_.Send(event);
+}
+
+static FlMethodResponse* record_error_response(const char* message) {
+  return FL_METHOD_RESPONSE(
+      fl_method_error_response_new(kErrorCode, message, nullptr));
+}
+
+static FlMethodResponse* record_linux_plugin_handle(RecordLinuxPlugin* self,
+                                                    FlMethodCall* method_call) {
+  const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return record_error_response("Call missing parameters");
+  }
+
+  const std::string recorder_id = record_lookup_string(args, "recorderId");
+  if (recorder_id.empty()) {
+    return record_error_response(
+        "Call missing mandatory parameter recorderId");
+  }
+
+  auto& recorders = *self->recorders;
+
+  if (strcmp(method, "create") == 0) {
+    // Channels of a previous instance are released before registering new
+    // ones with the same names.
+    recorders.erase(recorder_id);
+    auto events =
+        std::make_shared<RecorderEvents>(self->messenger, recorder_id);
+    auto recorder = record_linux::Recorder::Create(recorder_id, events);
+    events->SetRecorder(recorder);
+    recorders[recorder_id] = std::move(recorder);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+
+  if (strcmp(method, "listInputDevices") == 0) {
+    std::vector<record_linux::InputDeviceInfo> devices;
+    std::string error;
+    if (!self->devices->List(&devices, &error)) {
+      return record_error_response(error.c_str());
+    }
+
+    g_autoptr(FlValue) result = record_devices_to_value(devices);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+
+  auto it = recorders.find(recorder_id);
+  if (it == recorders.end()) {
+    return record_error_response(
+        "Recorder has not yet been created or has already been disposed.");
+  }
+  const auto& recorder = it->second;
+
+  g_autoptr(FlValue) result = nullptr;
+
+  if (strcmp(method, "hasPermission") == 0) {
+    result = fl_value_new_bool(TRUE);
+  } else if (strcmp(method, "isPaused") == 0) {
+    result = fl_value_new_bool(recorder->IsPaused());
+  } else if (strcmp(method, "isRecording") == 0) {
+    result = fl_value_new_bool(recorder->IsRecording());
+  } else if (strcmp(method, "pause") == 0) {
+    recorder->Pause();
+  } else if (strcmp(method, "resume") == 0) {
+    recorder->Resume();
+  } else if (strcmp(method, "isEncoderSupported") == 0) {
+    result = fl_value_new_bool(record_linux::IsEncoderSupported(
+        record_lookup_string(args, "encoder")));
+  } else if (strcmp(method, "prepare") == 0) {
+    std::string error;
+    if (!recorder->Prepare(record_config_from_args(args), &error)) {
+      return record_error_response(error.c_str());
+    }
+  } else if (strcmp(method, "start") == 0) {
+    std::string error;
+    if (!recorder->Start(record_config_from_args(args),
+                         record_lookup_string(args, "path"), &error)) {
+      return record_error_response(error.c_str());
+    }
+  } else if (strcmp(method, "startStream") == 0) {
+    std::string error;
+    if (!recorder->StartStream(record_config_from_args(args), &error)) {
+      return record_error_response(error.c_str());
+    }
+    // Chunks sent ahead of "ackStream" calls.
+    result = fl_value_new_map();
+    fl_value_set_string_take(
+        result, "credit",
+        fl_value_new_int(static_cast<int64_t>(record_core::kStreamCredit)));
+
+    // Shared ring, the reference is handed over to Dart.
+    if (record_core::PcmRing* ring = recorder->GetPcmRing()) {
+      fl_value_set_string_take(
+          result, "ring", fl_value_new_int(reinterpret_cast<int64_t>(ring)));
+      fl_value_set_string_take(
+          result, "data",
+          fl_value_new_int(reinterpret_cast<int64_t>(ring->Data())));
+      fl_value_set_string_take(
+          result, "cursor",
+          fl_value_new_int(reinterpret_cast<int64_t>(ring->ReservedCursor())));
+      fl_value_set_string_take(
+          result, "capacity",
+          fl_value_new_int(static_cast<int64_t>(ring->Capacity())));
+      fl_value_set_string_take(
+          result, "release",
+          fl_value_new_int(reinterpret_cast<int64_t>(
+              &record_core::PcmRing::ReleaseCallback)));
+    }
+
+    // Encoded stream, decoders may require setup data before packets.
+    const std::vector<uint8_t> codec_config = recorder->GetCodecConfig();
+    if (!codec_config.empty()) {
+      fl_value_set_string_take(
+          result, "codecConfig",
+          fl_value_new_uint8_list(codec_config.data(), codec_config.size()));
+    }
+  } else if (strcmp(method, "ackStream") == 0) {
+    recorder->AcknowledgeStream(static_cast<size_t>(
+        std::max<int64_t>(0, record_lookup_int(args, "count", 0))));
+  } else if (strcmp(method, "stop") == 0) {
+    const std::string path = recorder->Stop();
+    if (!path.empty()) {
+      result = fl_value_new_string(path.c_str());
+    }
+  } else if (strcmp(method, "cancel") == 0) {
+    const std::string path = recorder->Stop();
+    if (!path.empty()) {
+      remove(path.c_str());
+    }
+  } else if (strcmp(method, "dispose") == 0) {
+    recorders.erase(it);
+  } else if (strcmp(method, "getAmplitude") == 0) {
+    result = record_amplitude_to_value(recorder->GetMeters());
+  } else if (strcmp(method, "getLoudness") == 0) {
+    result = record_loudness_to_value(recorder->GetMeters().loudness);
+  } else if (strcmp(method, "getStreamStats") == 0) {
+    result = record_stream_stats_to_value(recorder->GetStreamStats());
+  } else if (strcmp(method, "getPausedDuration") == 0) {
+    result = fl_value_new_int(recorder->GetPausedDuration().count());
+  } else if (strcmp(method, "getLatency") == 0) {
+    record_core::CaptureLatency latency;
+    if (recorder->GetLatency(&latency)) {
+      result = record_latency_to_value(latency);
+    }
+  } else {
+    return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static void record_linux_plugin_method_call_cb(FlMethodChannel* /* channel */,
+                                               FlMethodCall* method_call,
+                                               gpointer user_data) {
+  g_autoptr(FlMethodResponse) response =
+      record_linux_plugin_handle(RECORD_LINUX_PLUGIN(user_data), method_call);
+  fl_method_call_respond(method_call, response, nullptr);
+}
+
 static void record_linux_plugin_dispose(GObject* object) {
+  RecordLinuxPlugin* self = RECORD_LINUX_PLUGIN(object);
+
+  delete self->recorders;
+  self->recorders = nullptr;
+  delete self->devices;
+  self->devices = nullptr;
+
   G_OBJECT_CLASS(record_linux_plugin_parent_class)->dispose(object);
 }
 
@@ -21,11 +671,23 @@ static void record_linux_plugin_class_init(RecordLinuxPluginClass* klass) {
   G_OBJECT_CLASS(klass)->dispose = record_linux_plugin_dispose;
 }
 
-static void record_linux_plugin_init(RecordLinuxPlugin* self) {}
+static void record_linux_plugin_init(RecordLinuxPlugin* self) {
+  self->recorders = new RecorderMap();
+}
 
 void record_linux_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
   RecordLinuxPlugin* plugin = RECORD_LINUX_PLUGIN(
       g_object_new(record_linux_plugin_get_type(), nullptr));
 
+  plugin->messenger = fl_plugin_registrar_get_messenger(registrar);
+  plugin->devices = new DeviceEvents(plugin->messenger);
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  g_autoptr(FlMethodChannel) channel = fl_method_channel_new(
+      plugin->messenger, kMethodChannel, FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(
+      channel, record_linux_plugin_method_call_cb, g_object_ref(plugin),
+      g_object_unref);
+
   g_object_unref(plugin);
 }
@@ -0,0 +1,328 @@
+#include "record_mp4_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace record_linux {
+
+namespace {
+
+// MPEG-4 audio object type and audio stream type, see ISO 14496-1.
+constexpr uint8_t kObjectTypeAudio = 0x40;
+constexpr uint8_t kStreamTypeAudio = 0x15;
+// Media data box follows the file type box, with a 64 bits size.
+constexpr long kMediaDataPosition = 32;
+constexpr size_t kMediaDataHeaderSize = 16;
+
+const uint32_t kUnityMatrix[9] = {0x00010000, 0, 0, 0, 0x00010000,
+                                  0,          0, 0, 0x40000000};
+
+// Big endian box serialization.
+class BoxWriter {
+ public:
+  void U8(uint8_t value) { data_.push_back(value); }
+
+  void U16(uint16_t value) {
+    U8(static_cast<uint8_t>(value >> 8));
+    U8(static_cast<uint8_t>(value));
+  }
+
+  void U24(uint32_t value) {
+    U8(static_cast<uint8_t>(value >> 16));
+    U16(static_cast<uint16_t>(value));
+  }
+
+  void U32(uint32_t value) {
+    U16(static_cast<uint16_t>(value >> 16));
+    U16(static_cast<uint16_t>(value));
+  }
+
+  void U64(uint64_t value) {
+    U32(static_cast<uint32_t>(value >> 32));
+    U32(static_cast<uint32_t>(value));
+  }
+
+  void Zeros(size_t count) { data_.insert(data_.end(), count, 0); }
+
+  void Bytes(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    data_.insert(data_.end(), bytes, bytes + size);
+  }
+
+  void Matrix() {
+    for (uint32_t value : kUnityMatrix) {
+      U32(value);
+    }
+  }
+
+  // Returns the box position, to give to End once its content is written.
+  size_t Begin(const char type[4]) {
+    const size_t position = data_.size();
+    U32(0);
+    Bytes(type, 4);
+    return position;
+  }
+
+  size_t BeginFull(const char type[4], uint8_t version, uint32_t flags) {
+    const size_t position = Begin(type);
+    U8(version);
+    U24(flags);
+    return position;
+  }
+
+  void End(size_t position) {
+    const auto size = static_cast<uint32_t>(data_.size() - position);
+    for (int i = 0; i < 4; i++) {
+      data_[position + i] = static_cast<uint8_t>(size >> (24 - 8 * i));
+    }
+  }
+
+  // Object descriptor with a fixed 4 bytes size field.
+  void Descriptor(uint8_t tag, const std::vector<uint8_t>& payload) {
+    U8(tag);
+    const auto size = static_cast<uint32_t>(payload.size());
+    U8(static_cast<uint8_t>(0x80 | ((size >> 21) & 0x7F)));
+    U8(static_cast<uint8_t>(0x80 | ((size >> 14) & 0x7F)));
+    U8(static_cast<uint8_t>(0x80 | ((size >> 7) & 0x7F)));
+    U8(static_cast<uint8_t>(size & 0x7F));
+    Bytes(payload.data(), payload.size());
+  }
+
+  const std::vector<uint8_t>& data() const { return data_; }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
+}  // namespace
+
+Mp4Writer::~Mp4Writer() {
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+}
+
+bool Mp4Writer::Open(const std::string& path, std::string* error) {
+  data_size_ = 0;
+  sample_sizes_.clear();
+
+  file_ = fopen(path.c_str(), "wb");
+  if (file_ == nullptr) {
+    *error = "Failed to create " + path + ": " + strerror(errno);
+    return false;
+  }
+
+  BoxWriter header;
+
+  const size_t file_type = header.Begin("ftyp");
+  header.Bytes("M4A ", 4);
+  header.U32(0x200);
+  header.Bytes("M4A isomiso2mp41", 16);
+  header.End(file_type);
+
+  // Media data size is completed by Finish.
+  header.U32(1);
+  header.Bytes("mdat", 4);
+  header.U64(0);
+
+  if (fwrite(header.data().data(), 1, header.data().size(), file_) !=
+      header.data().size()) {
+    *error = "Failed to write " + path;
+    return false;
+  }
+
+  return true;
+}
+
+bool Mp4Writer::WriteSample(const uint8_t* data, size_t size) {
+  if (fwrite(data, 1, size, file_) != size) {
+    return false;
+  }
+
+  data_size_ += size;
+  sample_sizes_.push_back(static_cast<uint32_t>(size));
+  return true;
+}
+
+bool Mp4Writer::Finish(const std::vector<uint8_t>& audio_specific_config,
+                       int sample_rate,
+                       int num_channels,
+                       int bit_rate,
+                       int frame_length) {
+  const auto movie = MovieBox(audio_specific_config, sample_rate,
+                              num_channels, bit_rate, frame_length);
+
+  bool written = fwrite(movie.data(), 1, movie.size(), file_) == movie.size();
+
+  BoxWriter size;
+  size.U64(kMediaDataHeaderSize + data_size_);
+
+  written = written && fseek(file_, kMediaDataPosition + 8, SEEK_SET) == 0 &&
+            fwrite(size.data().data(), 1, 8, file_) == 8;
+
+  written = fclose(file_) == 0 && written;
+  file_ = nullptr;
+
+  return written;
+}
+
+std::vector<uint8_t> Mp4Writer::MovieBox(
+    const std::vector<uint8_t>& audio_specific_config,
+    int sample_rate,
+    int num_channels,
+    int bit_rate,
+    int frame_length) const {
+  const auto sample_count = static_cast<uint32_t>(sample_sizes_.size());
+  const uint64_t duration = static_cast<uint64_t>(sample_count) * frame_length;
+  const auto movie_duration =
+      static_cast<uint32_t>(duration * 1000 / sample_rate);
+  const uint32_t max_sample_size =
+      sample_sizes_.empty()
+          ? 0
+          : *std::max_element(sample_sizes_.begin(), sample_sizes_.end());
+
+  BoxWriter box;
+
+  const size_t movie = box.Begin("moov");
+
+  const size_t movie_header = box.BeginFull("mvhd", 0, 0);
+  box.Zeros(8);  // creation and modification times
+  box.U32(1000);
+  box.U32(movie_duration);
+  box.U32(0x00010000);  // rate
+  box.U16(0x0100);      // volume
+  box.Zeros(10);
+  box.Matrix();
+  box.Zeros(24);
+  box.U32(2);  // next track id
+  box.End(movie_header);
+
+  const size_t track = box.Begin("trak");
+
+  const size_t track_header = box.BeginFull("tkhd", 0, 0x3);
+  box.Zeros(8);  // creation and modification times
+  box.U32(1);    // track id
+  box.Zeros(4);
+  box.U32(movie_duration);
+  box.Zeros(12);
+  box.U16(0x0100);  // volume
+  box.Zeros(2);
+  box.Matrix();
+  box.Zeros(8);  // width and height
+  box.End(track_header);
+
+  const size_t media = box.Begin("mdia");
+
+  const size_t media_header = box.BeginFull("mdhd", 0, 0);
+  box.Zeros(8);  // creation and modification times
+  box.U32(static_cast<uint32_t>(sample_rate));
+  box.U32(static_cast<uint32_t>(duration));
+  box.U16(0x55C4);  // "und" language
+  box.Zeros(2);
+  box.End(media_header);
+
+  const size_t handler = box.BeginFull("hdlr", 0, 0);
+  box.Zeros(4);
+  box.Bytes("soun", 4);
+  box.Zeros(12);
+  box.Bytes("SoundHandler", 13);
+  box.End(handler);
+
+  const size_t media_info = box.Begin("minf");
+
+  const size_t sound_header = box.BeginFull("smhd", 0, 0);
+  box.Zeros(4);
+  box.End(sound_header);
+
+  const size_t data_info = box.Begin("dinf");
+  const size_t data_ref = box.BeginFull("dref", 0, 0);
+  box.U32(1);
+  // Media data is in this file.
+  box.End(box.BeginFull("url ", 0, 1));
+  box.End(data_ref);
+  box.End(data_info);
+
+  const size_t sample_table = box.Begin("stbl");
+
+  const size_t sample_desc = box.BeginFull("stsd", 0, 0);
+  box.U32(1);
+  const size_t audio_entry = box.Begin("mp4a");
+  box.Zeros(6);
+  box.U16(1);  // data reference index
+  box.Zeros(8);
+  box.U16(static_cast<uint16_t>(num_channels));
+  box.U16(16);  // sample size
+  box.Zeros(4);
+  // 16.16 fixed point, rates above 65535 Hz are given by the config.
+  box.U32(sample_rate <= 0xFFFF ? static_cast<uint32_t>(sample_rate) << 16
+                                : 0);
+
+  BoxWriter decoder_config;
+  decoder_config.U8(kObjectTypeAudio);
+  decoder_config.U8(kStreamTypeAudio);
+  decoder_config.U24(max_sample_size);
+  decoder_config.U32(static_cast<uint32_t>(bit_rate));  // max bit rate
+  decoder_config.U32(static_cast<uint32_t>(bit_rate));  // average bit rate
+  decoder_config.Descriptor(0x05, audio_specific_config);
+
+  BoxWriter sync_config;
+  sync_config.U8(0x02);  // reserved for MP4 files
+
+  BoxWriter elementary_stream;
+  elementary_stream.U16(0);  // ES id
+  elementary_stream.U8(0);   // flags
+  elementary_stream.Descriptor(0x04, decoder_config.data());
+  elementary_stream.Descriptor(0x06, sync_config.data());
+
+  const size_t stream_desc = box.BeginFull("esds", 0, 0);
+  box.Descriptor(0x03, elementary_stream.data());
+  box.End(stream_desc);
+
+  box.End(audio_entry);
+  box.End(sample_desc);
+
+  // Every access unit has the same duration.
+  const size_t time_to_sample = box.BeginFull("stts", 0, 0);
+  box.U32(sample_count != 0 ? 1 : 0);
+  if (sample_count != 0) {
+    box.U32(sample_count);
+    box.U32(static_cast<uint32_t>(frame_length));
+  }
+  box.End(time_to_sample);
+
+  // A single chunk holds every sample.
+  const size_t sample_to_chunk = box.BeginFull("stsc", 0, 0);
+  box.U32(sample_count != 0 ? 1 : 0);
+  if (sample_count != 0) {
+    box.U32(1);
+    box.U32(sample_count);
+    box.U32(1);
+  }
+  box.End(sample_to_chunk);
+
+  const size_t sample_size = box.BeginFull("stsz", 0, 0);
+  box.U32(0);
+  box.U32(sample_count);
+  for (uint32_t size : sample_sizes_) {
+    box.U32(size);
+  }
+  box.End(sample_size);
+
+  const size_t chunk_offset = box.BeginFull("stco", 0, 0);
+  box.U32(sample_count != 0 ? 1 : 0);
+  if (sample_count != 0) {
+    box.U32(kMediaDataPosition + kMediaDataHeaderSize);
+  }
+  box.End(chunk_offset);
+
+  box.End(sample_table);
+  box.End(media_info);
+  box.End(media);
+  box.End(track);
+  box.End(movie);
+
+  return box.data();
+}
+
+}  // namespace record_linux
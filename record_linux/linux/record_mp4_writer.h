@@ -0,0 +1,53 @@
+#ifndef FLUTTER_PLUGIN_RECORD_MP4_WRITER_H_
+#define FLUTTER_PLUGIN_RECORD_MP4_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace record_linux {
+
+// Minimal MPEG-4 audio file (.m4a) writer of a single AAC track.
+//
+// Access units are appended to the media data as they come, the movie box
+// describing them is written by Finish. All samples are kept in a single
+// chunk, so only their sizes are kept in memory.
+class Mp4Writer {
+ public:
+  Mp4Writer() = default;
+  ~Mp4Writer();
+
+  Mp4Writer(const Mp4Writer&) = delete;
+  Mp4Writer& operator=(const Mp4Writer&) = delete;
+
+  bool Open(const std::string& path, std::string* error);
+
+  // Appends an access unit of frame_length samples per channel.
+  bool WriteSample(const uint8_t* data, size_t size);
+
+  // Writes the movie box and closes the file.
+  // audio_specific_config is the decoder setup data of the track.
+  bool Finish(const std::vector<uint8_t>& audio_specific_config,
+              int sample_rate,
+              int num_channels,
+              int bit_rate,
+              int frame_length);
+
+ private:
+  std::vector<uint8_t> MovieBox(
+      const std::vector<uint8_t>& audio_specific_config,
+      int sample_rate,
+      int num_channels,
+      int bit_rate,
+      int frame_length) const;
+
+  FILE* file_ = nullptr;
+  uint64_t data_size_ = 0;
+  std::vector<uint32_t> sample_sizes_;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_MP4_WRITER_H_
@@ -0,0 +1,270 @@
+#include "record_opus_encoder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <random>
+#include <utility>
+
+namespace record_linux {
+
+namespace {
+
+// Ogg Opus positions are always counted at 48 kHz.
+constexpr int kGranuleRate = 48000;
+constexpr int kFramesPerSecond = 50;
+// Recommended maximum packet size.
+constexpr size_t kMaxPacketSize = 4000;
+
+void PutU16(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(static_cast<uint8_t>(value));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void PutU32(std::vector<uint8_t>& out, uint32_t value) {
+  PutU16(out, static_cast<uint16_t>(value));
+  PutU16(out, static_cast<uint16_t>(value >> 16));
+}
+
+void PutString(std::vector<uint8_t>& out, const char* value) {
+  out.insert(out.end(), value, value + strlen(value));
+}
+
+}  // namespace
+
+OggOpusEncoder::~OggOpusEncoder() {
+  if (encoder_ != nullptr) {
+    opus_encoder_destroy(encoder_);
+  }
+  if (stream_initialized_) {
+    ogg_stream_clear(&stream_);
+  }
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+}
+
+int OggOpusEncoder::SupportedSampleRate(int sample_rate) {
+  for (int rate : {8000, 12000, 16000, 24000}) {
+    if (sample_rate <= rate) {
+      return rate;
+    }
+  }
+  return kGranuleRate;
+}
+
+bool OggOpusEncoder::Open(const std::string& path,
+                          const EncoderConfig& config,
+                          std::string* error) {
+  if (!Init(config, error)) {
+    return false;
+  }
+
+  file_ = fopen(path.c_str(), "wb");
+  if (file_ == nullptr) {
+    *error = "Failed to create " + path + ": " + strerror(errno);
+    return false;
+  }
+
+  std::random_device random;
+  ogg_stream_init(&stream_, static_cast<int>(random()));
+  stream_initialized_ = true;
+
+  if (!WriteHeaders()) {
+    *error = "Failed to write " + path;
+    return false;
+  }
+
+  return true;
+}
+
+bool OggOpusEncoder::OpenStream(const EncoderConfig& config,
+                                EncodedPacketCallback on_packet,
+                                std::string* error) {
+  if (!Init(config, error)) {
+    return false;
+  }
+
+  on_packet_ = std::move(on_packet);
+  return true;
+}
+
+bool OggOpusEncoder::Init(const EncoderConfig& config, std::string* error) {
+  config_ = config;
+
+  int result;
+  encoder_ = opus_encoder_create(config.sample_rate, config.num_channels,
+                                 OPUS_APPLICATION_AUDIO, &result);
+  if (result != OPUS_OK) {
+    encoder_ = nullptr;
+    *error = std::string("Failed to create Opus encoder: ") +
+             opus_strerror(result);
+    return false;
+  }
+
+  opus_encoder_ctl(encoder_, OPUS_SET_BITRATE(config.bit_rate));
+
+  opus_int32 lookahead = 0;
+  opus_encoder_ctl(encoder_, OPUS_GET_LOOKAHEAD(&lookahead));
+
+  frame_length_ = config.sample_rate / kFramesPerSecond;
+  granule_ratio_ = kGranuleRate / config.sample_rate;
+  pre_skip_ = lookahead * granule_ratio_;
+  input_samples_ = 0;
+  encoded_samples_ = 0;
+  packet_count_ = 0;
+  has_packet_ = false;
+  pending_.clear();
+  pending_.reserve(frame_length_ * config.num_channels);
+  packet_.resize(kMaxPacketSize);
+
+  head_.clear();
+  PutString(head_, "OpusHead");
+  head_.push_back(1);  // version
+  head_.push_back(static_cast<uint8_t>(config_.num_channels));
+  PutU16(head_, static_cast<uint16_t>(pre_skip_));
+  PutU32(head_, static_cast<uint32_t>(config_.sample_rate));
+  PutU16(head_, 0);    // output gain
+  head_.push_back(0);  // mono or stereo mapping
+
+  return true;
+}
+
+bool OggOpusEncoder::WriteHeaders() {
+  std::vector<uint8_t> tags;
+  PutString(tags, "OpusTags");
+  const char* vendor = opus_get_version_string();
+  PutU32(tags, static_cast<uint32_t>(strlen(vendor)));
+  PutString(tags, vendor);
+  PutU32(tags, 0);  // no user comment
+
+  // Each header is alone on its page.
+  for (auto* header : {&head_, &tags}) {
+    ogg_packet packet = {};
+    packet.packet = header->data();
+    packet.bytes = static_cast<long>(header->size());
+    packet.b_o_s = packet_count_ == 0 ? 1 : 0;
+    packet.packetno = packet_count_++;
+
+    if (ogg_stream_packetin(&stream_, &packet) != 0 || !WritePages(true)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool OggOpusEncoder::Write(const uint8_t* data, size_t size) {
+  const size_t frame_samples = frame_length_ * config_.num_channels;
+  size_t count = size / sizeof(int16_t);
+
+  input_samples_ += count / config_.num_channels;
+
+  while (count > 0) {
+    const size_t offset = pending_.size();
+    const size_t taken = std::min(count, frame_samples - offset);
+
+    pending_.resize(offset + taken);
+    memcpy(pending_.data() + offset, data, taken * sizeof(int16_t));
+    data += taken * sizeof(int16_t);
+    count -= taken;
+
+    if (pending_.size() == frame_samples) {
+      if (!EncodeFrame(pending_.data())) {
+        return false;
+      }
+      pending_.clear();
+    }
+  }
+
+  return true;
+}
+
+bool OggOpusEncoder::Finish() {
+  const size_t frame_samples = frame_length_ * config_.num_channels;
+  const int64_t end_position = pre_skip_ + input_samples_ * granule_ratio_;
+  bool encoded = true;
+
+  // Pads the last frame and flushes the encoder lookahead with silence.
+  while (encoded && encoded_samples_ < end_position) {
+    pending_.resize(frame_samples, 0);
+    encoded = EncodeFrame(pending_.data());
+    pending_.clear();
+  }
+
+  // Stream consumers trim the padding with the duration they recorded.
+  if (on_packet_) {
+    return encoded;
+  }
+
+  // End position trims padding on decoding.
+  encoded = encoded && has_packet_ && QueuePacket(true);
+
+  encoded = fclose(file_) == 0 && encoded;
+  file_ = nullptr;
+
+  return encoded;
+}
+
+bool OggOpusEncoder::EncodeFrame(const int16_t* samples) {
+  if (has_packet_ && !QueuePacket(false)) {
+    return false;
+  }
+
+  const opus_int32 size =
+      opus_encode(encoder_, samples, frame_length_, packet_.data(),
+                  static_cast<opus_int32>(packet_.size()));
+  if (size < 0) {
+    return false;
+  }
+
+  const int64_t frame_samples = frame_length_ * granule_ratio_;
+
+  if (on_packet_) {
+    // Times include the pre-skip, as Ogg positions do.
+    record_core::StreamPacketInfo info;
+    info.timestampUs = encoded_samples_ * 1000000 / kGranuleRate;
+    info.durationUs = frame_samples * 1000000 / kGranuleRate;
+    on_packet_(packet_.data(), static_cast<size_t>(size), info);
+  } else {
+    packet_size_ = static_cast<size_t>(size);
+    has_packet_ = true;
+  }
+  encoded_samples_ += frame_samples;
+
+  return true;
+}
+
+bool OggOpusEncoder::QueuePacket(bool end_of_stream) {
+  ogg_packet packet = {};
+  packet.packet = packet_.data();
+  packet.bytes = static_cast<long>(packet_size_);
+  packet.e_o_s = end_of_stream ? 1 : 0;
+  packet.granulepos = end_of_stream
+                          ? pre_skip_ + input_samples_ * granule_ratio_
+                          : encoded_samples_;
+  packet.packetno = packet_count_++;
+
+  has_packet_ = false;
+
+  return ogg_stream_packetin(&stream_, &packet) == 0 &&
+         WritePages(end_of_stream);
+}
+
+bool OggOpusEncoder::WritePages(bool flush) {
+  ogg_page page;
+
+  while (flush ? ogg_stream_flush(&stream_, &page)
+               : ogg_stream_pageout(&stream_, &page)) {
+    if (fwrite(page.header, 1, page.header_len, file_) !=
+            static_cast<size_t>(page.header_len) ||
+        fwrite(page.body, 1, page.body_len, file_) !=
+            static_cast<size_t>(page.body_len)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace record_linux
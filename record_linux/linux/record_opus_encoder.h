@@ -0,0 +1,68 @@
+#ifndef FLUTTER_PLUGIN_RECORD_OPUS_ENCODER_H_
+#define FLUTTER_PLUGIN_RECORD_OPUS_ENCODER_H_
+
+#include <ogg/ogg.h>
+#include <opus/opus.h>
+
+#include <cstdio>
+#include <vector>
+
+#include "record_encoder.h"
+
+namespace record_linux {
+
+// Opus with libopus, in an Ogg file (RFC 7845). Streamed packets are 20 ms
+// frames, the codec config is the OpusHead header.
+class OggOpusEncoder : public AudioEncoder {
+ public:
+  OggOpusEncoder() = default;
+  ~OggOpusEncoder() override;
+
+  bool Open(const std::string& path,
+            const EncoderConfig& config,
+            std::string* error) override;
+  bool OpenStream(const EncoderConfig& config,
+                  EncodedPacketCallback on_packet,
+                  std::string* error) override;
+  std::vector<uint8_t> CodecConfig() const override { return head_; }
+  bool Write(const uint8_t* data, size_t size) override;
+  bool Finish() override;
+
+  // Sample rates accepted by libopus.
+  static int SupportedSampleRate(int sample_rate);
+
+ private:
+  bool Init(const EncoderConfig& config, std::string* error);
+  bool WriteHeaders();
+  bool EncodeFrame(const int16_t* samples);
+  // Queues the previous packet, the last one is only known on Finish.
+  bool QueuePacket(bool end_of_stream);
+  bool WritePages(bool flush);
+
+  EncoderConfig config_;
+  OpusEncoder* encoder_ = nullptr;
+  FILE* file_ = nullptr;
+  // Set when streaming, packets are sent instead of written to the file.
+  EncodedPacketCallback on_packet_;
+  std::vector<uint8_t> head_;
+  ogg_stream_state stream_;
+  bool stream_initialized_ = false;
+
+  // Frame duration is 20 ms.
+  int frame_length_ = 960;
+  // Ogg positions are counted at 48 kHz.
+  int granule_ratio_ = 1;
+  int pre_skip_ = 0;
+  int64_t input_samples_ = 0;
+  int64_t encoded_samples_ = 0;
+  int64_t packet_count_ = 0;
+
+  std::vector<int16_t> pending_;
+  std::vector<uint8_t> packet_;
+  size_t packet_size_ = 0;
+  bool has_packet_ = false;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_OPUS_ENCODER_H_
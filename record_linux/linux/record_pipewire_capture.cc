@@ -0,0 +1,325 @@
+#include "record_pipewire_capture.h"
+
+#include <spa/param/audio/format-utils.h>
+
+#include <algorithm>
+
+namespace record_linux {
+
+namespace {
+
+// Stream creation is asynchronous, the session manager links it.
+constexpr int kConnectTimeoutSeconds = 5;
+
+spa_audio_format ToSpaFormat(record_core::SampleFormat format) {
+  switch (format) {
+    case record_core::SampleFormat::s24:
+      return SPA_AUDIO_FORMAT_S24_LE;
+    case record_core::SampleFormat::s32:
+      return SPA_AUDIO_FORMAT_S32_LE;
+    case record_core::SampleFormat::f32:
+      return SPA_AUDIO_FORMAT_F32_LE;
+    case record_core::SampleFormat::s16:
+    default:
+      return SPA_AUDIO_FORMAT_S16_LE;
+  }
+}
+
+bool EndsWith(const std::string& value, const std::string& suffix) {
+  return value.size() > suffix.size() &&
+         value.compare(value.size() - suffix.size(), suffix.size(), suffix) ==
+             0;
+}
+
+}  // namespace
+
+PipeWireTarget ToPipeWireTarget(const std::string& device_id) {
+  // Ids are the node names listed by the pulse layer, where sink monitors
+  // are sources of their own.
+  const std::string monitor_suffix = ".monitor";
+
+  PipeWireTarget target;
+  target.object = device_id;
+
+  if (EndsWith(target.object, monitor_suffix)) {
+    target.object.erase(target.object.size() - monitor_suffix.size());
+    target.capture_sink = true;
+  }
+
+  return target;
+}
+
+size_t ChunkFrameBytes(const spa_data& data,
+                       size_t frame_size,
+                       uint32_t* offset) {
+  *offset = std::min(data.chunk->offset, data.maxsize);
+  const size_t size = std::min(data.chunk->size, data.maxsize - *offset);
+  return size - size % frame_size;
+}
+
+PipeWireCapture::~PipeWireCapture() {
+  Close();
+}
+
+bool PipeWireCapture::Open(const CaptureConfig& config,
+                           CaptureDataCallback on_data,
+                           CaptureErrorCallback on_error,
+                           std::string* error) {
+  Close();
+
+  bool reachable = false;
+  if (context_) {
+    PipeWireLock lock(*context_);
+    reachable = context_->IsConnected();
+  }
+
+  if (!reachable) {
+    context_ = PipeWireContext::Acquire(error);
+    if (!context_) {
+      return false;
+    }
+  }
+
+  frame_size_ = record_core::BytesPerSample(config.sample_format) *
+                static_cast<size_t>(config.num_channels);
+  sample_rate_ = config.sample_rate;
+  // Requests left from a previous stream are dropped.
+  ApplyPauseRequests();
+  read_frames_ = 0;
+  read_position_.Store({0, std::chrono::steady_clock::now()});
+  paused_frames_.Clear();
+  if (config.start_paused) {
+    paused_frames_.Pause(0);
+  }
+  timing_.Reset();
+  on_data_ = std::move(on_data);
+  on_error_ = std::move(on_error);
+
+  bool connected;
+  {
+    PipeWireLock lock(*context_);
+    connected = Connect(config, error);
+  }
+
+  if (!connected) {
+    Close();
+  }
+
+  return connected;
+}
+
+bool PipeWireCapture::Connect(const CaptureConfig& config,
+                              std::string* error) {
+  if (config.sample_rate <= 0 || config.num_channels <= 0 ||
+      static_cast<uint32_t>(config.num_channels) > SPA_AUDIO_MAX_CHANNELS) {
+    *error = "Invalid sample rate or channel count.";
+    return false;
+  }
+
+  pw_properties* properties = pw_properties_new(
+      PW_KEY_MEDIA_TYPE, "Audio", PW_KEY_MEDIA_CATEGORY, "Capture",
+      PW_KEY_MEDIA_ROLE, "Production", nullptr);
+
+  // Quantum hint, the graph runs at the lowest one of its nodes.
+  pw_properties_setf(properties, PW_KEY_NODE_LATENCY, "%d/%d",
+                     config.latency_ms * config.sample_rate / 1000,
+                     config.sample_rate);
+
+  if (!config.device_id.empty()) {
+    const PipeWireTarget target = ToPipeWireTarget(config.device_id);
+
+    if (target.capture_sink) {
+      pw_properties_set(properties, PW_KEY_STREAM_CAPTURE_SINK, "true");
+    }
+
+    pw_properties_set(properties, PW_KEY_TARGET_OBJECT, target.object.c_str());
+  }
+
+  // Properties are owned by the stream, even on failure.
+  stream_ = pw_stream_new(context_->core(), config.stream_name.c_str(),
+                          properties);
+  if (stream_ == nullptr) {
+    *error = "Failed to create PipeWire stream.";
+    return false;
+  }
+
+  static const pw_stream_events events = []() {
+    pw_stream_events stream_events = {};
+    stream_events.version = PW_VERSION_STREAM_EVENTS;
+    stream_events.state_changed = OnStateChanged;
+    stream_events.process = OnProcess;
+    return stream_events;
+  }();
+  pw_stream_add_listener(stream_, &stream_listener_, &events, this);
+
+  spa_audio_info_raw info = {};
+  info.format = ToSpaFormat(config.sample_format);
+  info.rate = static_cast<uint32_t>(config.sample_rate);
+  info.channels = static_cast<uint32_t>(config.num_channels);
+  if (config.num_channels == 1) {
+    info.position[0] = SPA_AUDIO_CHANNEL_MONO;
+  } else if (config.num_channels == 2) {
+    info.position[0] = SPA_AUDIO_CHANNEL_FL;
+    info.position[1] = SPA_AUDIO_CHANNEL_FR;
+  } else {
+    info.flags = SPA_AUDIO_FLAG_UNPOSITIONED;
+  }
+
+  uint8_t buffer[1024];
+  spa_pod_builder builder;
+  spa_pod_builder_init(&builder, buffer, sizeof(buffer));
+  const spa_pod* params[] = {
+      spa_format_audio_raw_build(&builder, SPA_PARAM_EnumFormat, &info)};
+
+  // Processed on the data thread, from buffers mapped in our memory.
+  const auto flags = static_cast<pw_stream_flags>(
+      PW_STREAM_FLAG_AUTOCONNECT | PW_STREAM_FLAG_MAP_BUFFERS |
+      PW_STREAM_FLAG_RT_PROCESS);
+
+  if (pw_stream_connect(stream_, PW_DIRECTION_INPUT, PW_ID_ANY, flags, params,
+                        1) < 0) {
+    *error = "Failed to connect PipeWire stream.";
+    return false;
+  }
+
+  for (;;) {
+    const char* stream_error = nullptr;
+    const pw_stream_state state = pw_stream_get_state(stream_, &stream_error);
+
+    if (state == PW_STREAM_STATE_PAUSED ||
+        state == PW_STREAM_STATE_STREAMING) {
+      connected_ = true;
+      return true;
+    }
+    if (state == PW_STREAM_STATE_ERROR || !context_->IsConnected()) {
+      *error = stream_error != nullptr ? stream_error
+                                       : "PipeWire connection lost.";
+      return false;
+    }
+
+    if (pw_thread_loop_timed_wait(context_->loop(), kConnectTimeoutSeconds) !=
+        0) {
+      *error = "PipeWire stream connection timed out.";
+      return false;
+    }
+  }
+}
+
+void PipeWireCapture::Close() {
+  if (context_) {
+    PipeWireLock lock(*context_);
+
+    // Processing is stopped once destroyed.
+    if (stream_ != nullptr) {
+      spa_hook_remove(&stream_listener_);
+      pw_stream_destroy(stream_);
+      stream_ = nullptr;
+    }
+
+    connected_ = false;
+  }
+
+  on_data_ = nullptr;
+  on_error_ = nullptr;
+}
+
+bool PipeWireCapture::SetPaused(bool paused) {
+  if (stream_ == nullptr) {
+    return false;
+  }
+
+  const int64_t position = CapturePosition();
+
+  return pause_requests_.TryPush([&](PauseRequest& request) {
+    request.paused = paused;
+    request.position = position;
+  });
+}
+
+int64_t PipeWireCapture::CapturePosition() const {
+  const ReadPosition read = read_position_.Load();
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - read.time);
+
+  return read.frames + elapsed.count() * sample_rate_ / 1000000;
+}
+
+void PipeWireCapture::ApplyPauseRequests() {
+  pause_requests_.Drain([this](const PauseRequest& request) {
+    if (request.paused) {
+      paused_frames_.Pause(request.position);
+    } else {
+      paused_frames_.Resume(request.position);
+    }
+  });
+}
+
+void PipeWireCapture::Process() {
+  pw_buffer* buffer = pw_stream_dequeue_buffer(stream_);
+  if (buffer == nullptr) {
+    return;
+  }
+
+  const spa_buffer* frames = buffer->buffer;
+  size_t size = 0;
+
+  if (frames->n_datas > 0 && frames->datas[0].data != nullptr &&
+      frames->datas[0].chunk != nullptr) {
+    const spa_data& data = frames->datas[0];
+    uint32_t offset;
+    size = ChunkFrameBytes(data, frame_size_, &offset);
+
+    Deliver(static_cast<const uint8_t*>(data.data) + offset, size);
+  }
+
+  pw_stream_queue_buffer(stream_, buffer);
+
+  if (size == 0) {
+    return;
+  }
+
+  // Graph delay from the source, and frames waiting in the converter.
+  pw_time time;
+  int64_t latency_us = -1;
+  if (pw_stream_get_time_n(stream_, &time, sizeof(time)) == 0 &&
+      time.rate.denom > 0) {
+    latency_us = time.delay * 1000000 * time.rate.num / time.rate.denom +
+                 static_cast<int64_t>(time.buffered) * 1000000 / sample_rate_;
+  }
+
+  timing_.AddBuffer(
+      static_cast<int64_t>(size / frame_size_) * 1000000 / sample_rate_,
+      latency_us);
+}
+
+void PipeWireCapture::Deliver(const uint8_t* data, size_t size) {
+  ApplyPauseRequests();
+
+  paused_frames_.Deliver(read_frames_, data, size, frame_size_, on_data_);
+  read_frames_ += static_cast<int64_t>(size / frame_size_);
+  read_position_.Store({read_frames_, std::chrono::steady_clock::now()});
+}
+
+void PipeWireCapture::OnStateChanged(void* user_data,
+                                     pw_stream_state /* old_state */,
+                                     pw_stream_state state,
+                                     const char* error) {
+  auto* self = static_cast<PipeWireCapture*>(user_data);
+
+  if (self->connected_ && (state == PW_STREAM_STATE_ERROR ||
+                           state == PW_STREAM_STATE_UNCONNECTED)) {
+    self->connected_ = false;
+    if (self->on_error_) {
+      self->on_error_(error != nullptr ? error
+                                       : "PipeWire stream disconnected.");
+    }
+  }
+
+  self->context_->Signal();
+}
+
+void PipeWireCapture::OnProcess(void* user_data) {
+  static_cast<PipeWireCapture*>(user_data)->Process();
+}
+
+}  // namespace record_linux
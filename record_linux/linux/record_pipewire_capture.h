@@ -0,0 +1,125 @@
+#ifndef FLUTTER_PLUGIN_RECORD_PIPEWIRE_CAPTURE_H_
+#define FLUTTER_PLUGIN_RECORD_PIPEWIRE_CAPTURE_H_
+
+#include <pipewire/pipewire.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "core/seqlock.h"
+#include "core/spsc_ring.h"
+#include "record_capture.h"
+#include "record_pipewire_context.h"
+
+namespace record_linux {
+
+// Node targeted by a stream capturing a device id.
+struct PipeWireTarget {
+  // Node name, the device id of a sink monitor names its sink.
+  std::string object;
+  // Captures what the sink plays.
+  bool capture_sink = false;
+};
+
+PipeWireTarget ToPipeWireTarget(const std::string& device_id);
+
+// Bytes of whole frames in a mapped buffer chunk, from *offset, clamped to
+// the mapping.
+size_t ChunkFrameBytes(const spa_data& data,
+                       size_t frame_size,
+                       uint32_t* offset);
+
+// Capture through a native stream of the shared PipeWire connection, without
+// the pulse compatibility layer.
+//
+// The stream asks for the configured format, PipeWire only converts when the
+// source has another one. Buffers are mapped and given as is from the data
+// thread, the recorder copies them once into its ring. The quantum follows
+// CaptureConfig::latency_ms when the graph allows it.
+//
+// Pause keeps the stream running and drops frames from the pause request
+// until resuming. Requests don't come from the data thread, their frame
+// position is extrapolated from the last buffer. The real-time data thread
+// never waits on them: the read position is published through a seqlock and
+// requests are queued to the data thread.
+class PipeWireCapture : public CaptureBackend {
+ public:
+  // Context is the connection checked when choosing the backend, reused by
+  // Open while it's connected.
+  explicit PipeWireCapture(std::shared_ptr<PipeWireContext> context)
+      : context_(std::move(context)) {}
+  ~PipeWireCapture() override;
+
+  PipeWireCapture(const PipeWireCapture&) = delete;
+  PipeWireCapture& operator=(const PipeWireCapture&) = delete;
+
+  bool Open(const CaptureConfig& config,
+            CaptureDataCallback on_data,
+            CaptureErrorCallback on_error,
+            std::string* error) override;
+  void Close() override;
+  bool SetPaused(bool paused) override;
+  record_core::CaptureLatency GetLatency() const override {
+    return timing_.Get();
+  }
+
+ private:
+  // Called with the loop locked.
+  bool Connect(const CaptureConfig& config, std::string* error);
+
+  // Data thread.
+  void Process();
+  void Deliver(const uint8_t* data, size_t size);
+
+  // Frame currently captured, from the published read position.
+  int64_t CapturePosition() const;
+  // Data thread, or Open before connecting.
+  void ApplyPauseRequests();
+
+  static void OnStateChanged(void* user_data,
+                             pw_stream_state old_state,
+                             pw_stream_state state,
+                             const char* error);
+  static void OnProcess(void* user_data);
+
+  std::shared_ptr<PipeWireContext> context_;
+  pw_stream* stream_ = nullptr;
+  spa_hook stream_listener_ = {};
+  size_t frame_size_ = 2;
+  int sample_rate_ = 0;
+
+  // Loop state.
+  bool connected_ = false;
+
+  record_core::CaptureTiming timing_;
+
+  // Read position since Open, and when it was reached.
+  struct ReadPosition {
+    int64_t frames;
+    std::chrono::steady_clock::time_point time;
+  };
+
+  struct PauseRequest {
+    bool paused;
+    int64_t position;
+  };
+
+  // Written by the data thread, read by pause requests.
+  record_core::SeqLock<ReadPosition> read_position_;
+  // Produced by SetPaused, consumed by the data thread.
+  record_core::SpscRing<PauseRequest> pause_requests_{16};
+
+  // Data thread.
+  int64_t read_frames_ = 0;
+  PausedFrames paused_frames_;
+
+  CaptureDataCallback on_data_;
+  CaptureErrorCallback on_error_;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_PIPEWIRE_CAPTURE_H_
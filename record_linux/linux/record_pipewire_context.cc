@@ -0,0 +1,110 @@
+#include "record_pipewire_context.h"
+
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+namespace record_linux {
+
+std::shared_ptr<PipeWireContext> PipeWireContext::Acquire(
+    std::string* error) {
+  static std::once_flag init;
+  std::call_once(init, []() { pw_init(nullptr, nullptr); });
+
+  static std::mutex mutex;
+  // Not owned, the context is released with its last user.
+  static std::weak_ptr<PipeWireContext> shared;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (auto context = shared.lock()) {
+    PipeWireLock loop_lock(*context);
+    if (context->IsConnected()) {
+      return context;
+    }
+  }
+
+  std::shared_ptr<PipeWireContext> context(new PipeWireContext());
+  if (!context->Connect(error)) {
+    return nullptr;
+  }
+
+  shared = context;
+  return context;
+}
+
+PipeWireContext::~PipeWireContext() {
+  if (loop_ != nullptr) {
+    pw_thread_loop_stop(loop_);
+  }
+
+  // Loop thread is stopped, no lock needed.
+  if (core_ != nullptr) {
+    spa_hook_remove(&core_listener_);
+    pw_core_disconnect(core_);
+  }
+
+  if (context_ != nullptr) {
+    pw_context_destroy(context_);
+  }
+
+  if (loop_ != nullptr) {
+    pw_thread_loop_destroy(loop_);
+  }
+}
+
+bool PipeWireContext::Connect(std::string* error) {
+  // Shown by per thread tools, 15 characters at most.
+  loop_ = pw_thread_loop_new("record-pw", nullptr);
+  if (loop_ == nullptr) {
+    *error = "Failed to create PipeWire loop.";
+    return false;
+  }
+
+  context_ = pw_context_new(pw_thread_loop_get_loop(loop_), nullptr, 0);
+  if (context_ == nullptr) {
+    *error = "Failed to create PipeWire context.";
+    return false;
+  }
+
+  if (pw_thread_loop_start(loop_) < 0) {
+    *error = "Failed to start PipeWire loop.";
+    return false;
+  }
+
+  PipeWireLock lock(*this);
+
+  // Fails right away without daemon, other backends are used then.
+  core_ = pw_context_connect(context_, nullptr, 0);
+  if (core_ == nullptr) {
+    *error = std::string("PipeWire is not running: ") + strerror(errno);
+    return false;
+  }
+
+  static const pw_core_events events = []() {
+    pw_core_events core_events = {};
+    core_events.version = PW_VERSION_CORE_EVENTS;
+    core_events.error = OnError;
+    return core_events;
+  }();
+  pw_core_add_listener(core_, &core_listener_, &events, this);
+
+  return true;
+}
+
+void PipeWireContext::OnError(void* user_data,
+                              uint32_t id,
+                              int /* seq */,
+                              int result,
+                              const char* /* message */) {
+  auto* self = static_cast<PipeWireContext*>(user_data);
+
+  // Errors of other objects are reported to their own listeners.
+  if (id == PW_ID_CORE && result == -EPIPE) {
+    self->lost_ = true;
+  }
+
+  self->Signal();
+}
+
+}  // namespace record_linux
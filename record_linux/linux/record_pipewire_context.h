@@ -0,0 +1,75 @@
+#ifndef FLUTTER_PLUGIN_RECORD_PIPEWIRE_CONTEXT_H_
+#define FLUTTER_PLUGIN_RECORD_PIPEWIRE_CONTEXT_H_
+
+#include <pipewire/pipewire.h>
+
+#include <memory>
+#include <string>
+
+namespace record_linux {
+
+// Connection to the PipeWire daemon, shared by all recorders. Stream events
+// run on the thread of its thread loop, except processing which runs on
+// the real-time data thread of PipeWire.
+class PipeWireContext {
+ public:
+  // Returns the shared context, connecting when there is none or when the
+  // previous connection was lost. Returns nullptr with error set when no
+  // daemon is reachable.
+  static std::shared_ptr<PipeWireContext> Acquire(std::string* error);
+
+  ~PipeWireContext();
+
+  PipeWireContext(const PipeWireContext&) = delete;
+  PipeWireContext& operator=(const PipeWireContext&) = delete;
+
+  pw_thread_loop* loop() const { return loop_; }
+  pw_core* core() const { return core_; }
+
+  // With the loop locked.
+  bool IsConnected() const { return !lost_; }
+
+  // Wakes up threads waiting on the loop.
+  void Signal() { pw_thread_loop_signal(loop_, false); }
+
+ private:
+  PipeWireContext() = default;
+
+  bool Connect(std::string* error);
+
+  static void OnError(void* user_data,
+                      uint32_t id,
+                      int seq,
+                      int result,
+                      const char* message);
+
+  pw_thread_loop* loop_ = nullptr;
+  pw_context* context_ = nullptr;
+  pw_core* core_ = nullptr;
+  spa_hook core_listener_ = {};
+
+  // Loop state.
+  bool lost_ = false;
+};
+
+// Locks the thread loop of a context for the scope.
+// Must not be used from loop callbacks, they already hold the lock.
+class PipeWireLock {
+ public:
+  explicit PipeWireLock(const PipeWireContext& context)
+      : loop_(context.loop()) {
+    pw_thread_loop_lock(loop_);
+  }
+
+  ~PipeWireLock() { pw_thread_loop_unlock(loop_); }
+
+  PipeWireLock(const PipeWireLock&) = delete;
+  PipeWireLock& operator=(const PipeWireLock&) = delete;
+
+ private:
+  pw_thread_loop* loop_;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_PIPEWIRE_CONTEXT_H_
@@ -0,0 +1,276 @@
+#include "record_pulse_capture.h"
+
+#include <algorithm>
+
+namespace record_linux {
+
+namespace {
+
+pa_sample_format_t ToPulseFormat(record_core::SampleFormat format) {
+  switch (format) {
+    case record_core::SampleFormat::s24:
+      return PA_SAMPLE_S24LE;
+    case record_core::SampleFormat::s32:
+      return PA_SAMPLE_S32LE;
+    case record_core::SampleFormat::f32:
+      return PA_SAMPLE_FLOAT32LE;
+    case record_core::SampleFormat::s16:
+    default:
+      return PA_SAMPLE_S16LE;
+  }
+}
+
+}  // namespace
+
+PulseCapture::~PulseCapture() {
+  Close();
+}
+
+bool PulseCapture::Open(const CaptureConfig& config,
+                        CaptureDataCallback on_data,
+                        CaptureErrorCallback on_error,
+                        std::string* error) {
+  Close();
+
+  // Returns context_ while it's connected.
+  context_ = PulseContext::Acquire(error);
+  if (!context_) {
+    return false;
+  }
+
+  on_data_ = std::move(on_data);
+  on_error_ = std::move(on_error);
+
+  bool connected;
+  {
+    PulseLock lock(*context_);
+    connected = Connect(config, error);
+  }
+
+  if (!connected) {
+    Close();
+  }
+
+  return connected;
+}
+
+bool PulseCapture::Connect(const CaptureConfig& config, std::string* error) {
+  pa_sample_spec spec;
+  spec.format = ToPulseFormat(config.sample_format);
+  spec.rate = static_cast<uint32_t>(config.sample_rate);
+  spec.channels = static_cast<uint8_t>(config.num_channels);
+
+  if (!Pulse().pa_sample_spec_valid(&spec)) {
+    *error = "Invalid sample rate or channel count.";
+    return false;
+  }
+
+  frame_size_ = Pulse().pa_frame_size(&spec);
+  sample_rate_ = config.sample_rate;
+  read_frames_ = 0;
+  paused_frames_.Clear();
+  if (config.start_paused) {
+    paused_frames_.Pause(0);
+  }
+  timing_.Reset();
+
+  // Same properties as parecord used to set, the server or its filters may
+  // honor them.
+  pa_proplist* properties = Pulse().pa_proplist_new();
+  Pulse().pa_proplist_sets(properties, PA_PROP_MEDIA_ROLE, "production");
+  if (config.auto_gain) {
+    Pulse().pa_proplist_sets(properties, "auto_gain_control", "1");
+  }
+  if (config.echo_cancel) {
+    Pulse().pa_proplist_sets(properties, "echo_cancellation", "1");
+    Pulse().pa_proplist_sets(properties, PA_PROP_FILTER_WANT, "echo-cancel");
+  }
+  if (config.noise_suppress) {
+    Pulse().pa_proplist_sets(properties, "noise_suppression", "1");
+  }
+
+  stream_ = Pulse().pa_stream_new_with_proplist(
+      context_->context(), config.stream_name.c_str(), &spec, nullptr,
+      properties);
+  Pulse().pa_proplist_free(properties);
+
+  if (stream_ == nullptr) {
+    *error = context_->LastError();
+    return false;
+  }
+
+  Pulse().pa_stream_set_state_callback(stream_, OnStateChanged, this);
+  Pulse().pa_stream_set_read_callback(stream_, OnReadable, this);
+
+  // Server delivers a fragment per period, other values are server defaults.
+  // With ADJUST_LATENCY the source latency is lowered to match it.
+  pa_buffer_attr attributes;
+  attributes.maxlength = static_cast<uint32_t>(-1);
+  attributes.tlength = static_cast<uint32_t>(-1);
+  attributes.prebuf = static_cast<uint32_t>(-1);
+  attributes.minreq = static_cast<uint32_t>(-1);
+  attributes.fragsize = static_cast<uint32_t>(
+      Pulse().pa_usec_to_bytes(config.latency_ms * PA_USEC_PER_MSEC, &spec));
+
+  const auto flags = static_cast<pa_stream_flags_t>(
+      PA_STREAM_ADJUST_LATENCY | PA_STREAM_AUTO_TIMING_UPDATE |
+      PA_STREAM_INTERPOLATE_TIMING);
+  const char* device =
+      config.device_id.empty() ? nullptr : config.device_id.c_str();
+
+  if (Pulse().pa_stream_connect_record(stream_, device, &attributes,
+                                       flags) < 0) {
+    *error = context_->LastError();
+    return false;
+  }
+
+  for (;;) {
+    const pa_stream_state_t state = Pulse().pa_stream_get_state(stream_);
+
+    if (state == PA_STREAM_READY) {
+      connected_ = true;
+      return true;
+    }
+    if (!PA_STREAM_IS_GOOD(state)) {
+      *error = context_->LastError();
+      return false;
+    }
+
+    Pulse().pa_threaded_mainloop_wait(context_->mainloop());
+  }
+}
+
+void PulseCapture::Close() {
+  if (!context_) {
+    return;
+  }
+
+  {
+    PulseLock lock(*context_);
+
+    if (stream_ != nullptr) {
+      Pulse().pa_stream_set_state_callback(stream_, nullptr, nullptr);
+      Pulse().pa_stream_set_read_callback(stream_, nullptr, nullptr);
+      if (connected_) {
+        Pulse().pa_stream_disconnect(stream_);
+      }
+      Pulse().pa_stream_unref(stream_);
+      stream_ = nullptr;
+    }
+  }
+
+  connected_ = false;
+  on_data_ = nullptr;
+  on_error_ = nullptr;
+}
+
+bool PulseCapture::SetPaused(bool paused) {
+  if (!context_ || stream_ == nullptr) {
+    return false;
+  }
+
+  PulseLock lock(*context_);
+
+  const int64_t position = CapturePosition();
+
+  if (paused) {
+    paused_frames_.Pause(position);
+  } else {
+    // Corked stream doesn't advance, following frames are captured after
+    // resuming.
+    paused_frames_.Resume(position);
+  }
+
+  // Not waited, the stream keeps its read position and the server applies
+  // the request in order.
+  pa_operation* operation =
+      Pulse().pa_stream_cork(stream_, paused ? 1 : 0, nullptr, nullptr);
+  if (operation == nullptr) {
+    return false;
+  }
+
+  Pulse().pa_operation_unref(operation);
+  return true;
+}
+
+int64_t PulseCapture::CapturePosition() {
+  const pa_sample_spec* spec = Pulse().pa_stream_get_sample_spec(stream_);
+  pa_usec_t time;
+
+  // Interpolated from the last timing update. Before the first one, frames
+  // read so far are the best estimate.
+  if (Pulse().pa_stream_get_time(stream_, &time) < 0) {
+    return read_frames_;
+  }
+
+  return std::max(read_frames_,
+                  static_cast<int64_t>(Pulse().pa_usec_to_bytes(time, spec) /
+                                       frame_size_));
+}
+
+void PulseCapture::Read() {
+  const void* data;
+  size_t size;
+
+  // Source latency and data waiting in the record buffer, from the last
+  // timing update.
+  pa_usec_t latency;
+  int negative = 0;
+  const bool has_latency =
+      Pulse().pa_stream_get_latency(stream_, &latency, &negative) == 0 &&
+      !negative;
+  const int64_t start = read_frames_;
+
+  while (Pulse().pa_stream_readable_size(stream_) > 0) {
+    if (Pulse().pa_stream_peek(stream_, &data, &size) < 0 || size == 0) {
+      break;
+    }
+
+    if (data != nullptr) {
+      Deliver(static_cast<const uint8_t*>(data), size);
+    } else {
+      // Hole, samples were lost. Keep the timeline with silence.
+      if (silence_.size() < size) {
+        silence_.resize(size);
+      }
+      Deliver(silence_.data(), size);
+    }
+
+    Pulse().pa_stream_drop(stream_);
+  }
+
+  timing_.AddBuffer((read_frames_ - start) * 1000000 / sample_rate_,
+                    has_latency ? static_cast<int64_t>(latency) : -1);
+}
+
+void PulseCapture::Deliver(const uint8_t* data, size_t size) {
+  // Record buffer always holds whole frames.
+  const int64_t position = read_frames_;
+  read_frames_ += static_cast<int64_t>(size / frame_size_);
+
+  paused_frames_.Deliver(position, data, size, frame_size_, on_data_);
+}
+
+void PulseCapture::OnStateChanged(pa_stream* stream, void* user_data) {
+  auto* self = static_cast<PulseCapture*>(user_data);
+
+  if (self->connected_ &&
+      !PA_STREAM_IS_GOOD(Pulse().pa_stream_get_state(stream))) {
+    self->connected_ = false;
+    if (self->on_error_) {
+      self->on_error_(self->context_->LastError());
+    }
+  }
+
+  self->context_->Signal();
+}
+
+void PulseCapture::OnReadable(pa_stream* /* stream */,
+                              size_t /* length */,
+                              void* user_data) {
+  PromoteCaptureThread();
+
+  static_cast<PulseCapture*>(user_data)->Read();
+}
+
+}  // namespace record_linux
@@ -0,0 +1,76 @@
+#ifndef FLUTTER_PLUGIN_RECORD_PULSE_CAPTURE_H_
+#define FLUTTER_PLUGIN_RECORD_PULSE_CAPTURE_H_
+
+#include <pulse/pulseaudio.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "record_capture.h"
+#include "record_pulse_context.h"
+
+namespace record_linux {
+
+// Capture through a record stream of the shared sound server connection.
+// Data is delivered on the mainloop thread, raised to real-time priority
+// when allowed.
+//
+// Pause corks the stream. Corking only takes effect after a server round
+// trip, so frames captured from the pause request until the stream is
+// resumed are dropped from the read buffer, by stream position.
+class PulseCapture : public CaptureBackend {
+ public:
+  // Context is the connection checked when choosing the backend, kept so
+  // Open doesn't connect again. Open connects when it's null or lost.
+  explicit PulseCapture(std::shared_ptr<PulseContext> context)
+      : context_(std::move(context)) {}
+  ~PulseCapture() override;
+
+  PulseCapture(const PulseCapture&) = delete;
+  PulseCapture& operator=(const PulseCapture&) = delete;
+
+  bool Open(const CaptureConfig& config,
+            CaptureDataCallback on_data,
+            CaptureErrorCallback on_error,
+            std::string* error) override;
+  void Close() override;
+  bool SetPaused(bool paused) override;
+  record_core::CaptureLatency GetLatency() const override {
+    return timing_.Get();
+  }
+
+ private:
+  // Called with the mainloop locked.
+  bool Connect(const CaptureConfig& config, std::string* error);
+  void Read();
+  void Deliver(const uint8_t* data, size_t size);
+  // Frame currently captured by the device.
+  int64_t CapturePosition();
+
+  static void OnStateChanged(pa_stream* stream, void* user_data);
+  static void OnReadable(pa_stream* stream, size_t length, void* user_data);
+
+  std::shared_ptr<PulseContext> context_;
+  pa_stream* stream_ = nullptr;
+  bool connected_ = false;
+  size_t frame_size_ = 2;
+
+  // Mainloop state.
+  // Read position in the stream, holes included.
+  int64_t read_frames_ = 0;
+  PausedFrames paused_frames_;
+  record_core::CaptureTiming timing_;
+  int sample_rate_ = 0;
+
+  CaptureDataCallback on_data_;
+  CaptureErrorCallback on_error_;
+  // Given in place of holes in the record buffer.
+  std::vector<uint8_t> silence_;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_PULSE_CAPTURE_H_
@@ -0,0 +1,116 @@
+#include "record_pulse_context.h"
+
+#include <mutex>
+
+namespace record_linux {
+
+std::shared_ptr<PulseContext> PulseContext::Acquire(std::string* error) {
+  if (PulseLibrary::Load() == nullptr) {
+    *error = "PulseAudio client library is not installed.";
+    return nullptr;
+  }
+
+  static std::mutex mutex;
+  // Not owned, the context is released with its last user.
+  static std::weak_ptr<PulseContext> shared;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (auto context = shared.lock()) {
+    PulseLock mainloop_lock(*context);
+    if (PA_CONTEXT_IS_GOOD(Pulse().pa_context_get_state(context->context()))) {
+      return context;
+    }
+  }
+
+  std::shared_ptr<PulseContext> context(new PulseContext());
+  if (!context->Connect(error)) {
+    return nullptr;
+  }
+
+  shared = context;
+  return context;
+}
+
+PulseContext::~PulseContext() {
+  if (mainloop_ != nullptr) {
+    Pulse().pa_threaded_mainloop_stop(mainloop_);
+  }
+
+  // Mainloop thread is stopped, no lock needed.
+  if (context_ != nullptr) {
+    Pulse().pa_context_set_state_callback(context_, nullptr, nullptr);
+    Pulse().pa_context_disconnect(context_);
+    Pulse().pa_context_unref(context_);
+  }
+
+  if (mainloop_ != nullptr) {
+    Pulse().pa_threaded_mainloop_free(mainloop_);
+  }
+}
+
+bool PulseContext::Connect(std::string* error) {
+  mainloop_ = Pulse().pa_threaded_mainloop_new();
+  if (mainloop_ == nullptr) {
+    *error = "Failed to create sound server mainloop.";
+    return false;
+  }
+
+  context_ = Pulse().pa_context_new(
+      Pulse().pa_threaded_mainloop_get_api(mainloop_), "record");
+  if (context_ == nullptr) {
+    *error = "Failed to create sound server context.";
+    return false;
+  }
+
+  Pulse().pa_context_set_state_callback(context_, OnStateChanged, this);
+
+  PulseLock lock(*this);
+
+  // Don't spawn a daemon, hosts without sound server use another backend.
+  if (Pulse().pa_context_connect(context_, nullptr, PA_CONTEXT_NOAUTOSPAWN,
+                                 nullptr) < 0 ||
+      Pulse().pa_threaded_mainloop_start(mainloop_) < 0) {
+    *error = LastError();
+    return false;
+  }
+
+  for (;;) {
+    const pa_context_state_t state = Pulse().pa_context_get_state(context_);
+
+    if (state == PA_CONTEXT_READY) {
+      return true;
+    }
+    if (!PA_CONTEXT_IS_GOOD(state)) {
+      *error = LastError();
+      return false;
+    }
+
+    Pulse().pa_threaded_mainloop_wait(mainloop_);
+  }
+}
+
+std::string PulseContext::LastError() const {
+  return Pulse().pa_strerror(Pulse().pa_context_errno(context_));
+}
+
+void PulseContext::Wait(pa_operation* operation) {
+  if (operation == nullptr) {
+    return;
+  }
+
+  // Operations are cancelled when the connection is lost, and the state
+  // callback wakes us up.
+  while (Pulse().pa_operation_get_state(operation) == PA_OPERATION_RUNNING) {
+    Pulse().pa_threaded_mainloop_wait(mainloop_);
+  }
+
+  Pulse().pa_operation_unref(operation);
+}
+
+void PulseContext::OnStateChanged(pa_context* /* context */,
+                                  void* user_data) {
+  static_cast<PulseContext*>(user_data)->Signal();
+}
+
+}  // namespace record_linux
@@ -0,0 +1,72 @@
+#ifndef FLUTTER_PLUGIN_RECORD_PULSE_CONTEXT_H_
+#define FLUTTER_PLUGIN_RECORD_PULSE_CONTEXT_H_
+
+#include <pulse/pulseaudio.h>
+
+#include <memory>
+#include <string>
+
+#include "record_pulse_library.h"
+
+namespace record_linux {
+
+// Connection to the sound server (PulseAudio or PipeWire pulse), shared by
+// all recorders. Callbacks of its streams and operations run on the thread
+// of its threaded mainloop.
+class PulseContext {
+ public:
+  // Returns the shared context, connecting when there is none or when the
+  // previous connection was lost. Returns nullptr with error set when
+  // libpulse is missing or no server is reachable.
+  static std::shared_ptr<PulseContext> Acquire(std::string* error);
+
+  ~PulseContext();
+
+  PulseContext(const PulseContext&) = delete;
+  PulseContext& operator=(const PulseContext&) = delete;
+
+  pa_threaded_mainloop* mainloop() const { return mainloop_; }
+  pa_context* context() const { return context_; }
+
+  // Last error of the context.
+  std::string LastError() const;
+
+  // Waits until operation is done or cancelled and releases it.
+  // The mainloop must be locked and operation callbacks must call Signal.
+  void Wait(pa_operation* operation);
+
+  // Wakes up threads waiting on the mainloop.
+  void Signal() { Pulse().pa_threaded_mainloop_signal(mainloop_, 0); }
+
+ private:
+  PulseContext() = default;
+
+  bool Connect(std::string* error);
+
+  static void OnStateChanged(pa_context* context, void* user_data);
+
+  pa_threaded_mainloop* mainloop_ = nullptr;
+  pa_context* context_ = nullptr;
+};
+
+// Locks the mainloop of a context for the scope.
+// Must not be used from mainloop callbacks, they already hold the lock.
+class PulseLock {
+ public:
+  explicit PulseLock(const PulseContext& context)
+      : mainloop_(context.mainloop()) {
+    Pulse().pa_threaded_mainloop_lock(mainloop_);
+  }
+
+  ~PulseLock() { Pulse().pa_threaded_mainloop_unlock(mainloop_); }
+
+  PulseLock(const PulseLock&) = delete;
+  PulseLock& operator=(const PulseLock&) = delete;
+
+ private:
+  pa_threaded_mainloop* mainloop_;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_PULSE_CONTEXT_H_
@@ -0,0 +1,241 @@
+#include "record_pulse_devices.h"
+
+#include "core/sample_format.h"
+#include "record_dispatcher.h"
+
+namespace record_linux {
+
+namespace {
+
+int ToSampleFormat(pa_sample_format_t format) {
+  switch (format) {
+    case PA_SAMPLE_S16LE:
+      return static_cast<int>(record_core::SampleFormat::s16);
+    case PA_SAMPLE_S24LE:
+    case PA_SAMPLE_S24_32LE:
+      return static_cast<int>(record_core::SampleFormat::s24);
+    case PA_SAMPLE_S32LE:
+      return static_cast<int>(record_core::SampleFormat::s32);
+    case PA_SAMPLE_FLOAT32LE:
+      return static_cast<int>(record_core::SampleFormat::f32);
+    default:
+      return -1;
+  }
+}
+
+struct OperationResult {
+  PulseContext* context;
+  int success = 0;
+};
+
+void OnContextSuccess(pa_context* /* context */, int success, void* user_data) {
+  auto* result = static_cast<OperationResult*>(user_data);
+  result->success = success;
+  result->context->Signal();
+}
+
+struct SourceList {
+  PulseContext* context;
+  std::vector<InputDeviceInfo>* devices;
+  std::string default_id;
+  bool failed = false;
+};
+
+}  // namespace
+
+InputDeviceInfo ToInputDevice(const pa_source_info& info,
+                              const std::string& default_id) {
+  InputDeviceInfo device;
+  device.id = info.name;
+  device.label = info.description != nullptr ? info.description : info.name;
+  device.sample_rate = static_cast<int>(info.sample_spec.rate);
+  device.num_channels = info.sample_spec.channels;
+  device.sample_format = ToSampleFormat(info.sample_spec.format);
+  device.latency_us = static_cast<int64_t>(info.latency);
+  device.is_monitor = info.monitor_of_sink != PA_INVALID_INDEX;
+  device.is_default = device.id == default_id;
+  return device;
+}
+
+std::shared_ptr<PulseDevices> PulseDevices::Create(DeviceListener* listener) {
+  std::shared_ptr<PulseDevices> devices(new PulseDevices(listener));
+  devices->weak_this_ = devices;
+  return devices;
+}
+
+PulseDevices::~PulseDevices() {
+  if (context_) {
+    PulseLock lock(*context_);
+    Pulse().pa_context_set_subscribe_callback(context_->context(), nullptr,
+                                              nullptr);
+  }
+}
+
+bool PulseDevices::List(std::vector<InputDeviceInfo>* devices,
+                        std::string* error) {
+  if (!Update(error)) {
+    return false;
+  }
+
+  *devices = devices_;
+  return true;
+}
+
+bool PulseDevices::Update(std::string* error) {
+  if (!Connect(error)) {
+    return false;
+  }
+
+  if (!stale_.exchange(false)) {
+    return true;
+  }
+
+  std::vector<InputDeviceInfo> devices;
+  bool enumerated;
+  {
+    PulseLock lock(*context_);
+    enumerated = Enumerate(&devices, error);
+  }
+
+  if (!enumerated) {
+    stale_ = true;
+    return false;
+  }
+
+  const InputDeviceChange change = DiffInputDevices(devices_, devices);
+  const bool report = enumerated_ && !change.empty();
+
+  devices_ = std::move(devices);
+  enumerated_ = true;
+
+  if (report) {
+    listener_->OnDevicesChanged(change);
+  }
+
+  return true;
+}
+
+bool PulseDevices::Connect(std::string* error) {
+  if (context_) {
+    PulseLock lock(*context_);
+    if (PA_CONTEXT_IS_GOOD(Pulse().pa_context_get_state(context_->context()))) {
+      return true;
+    }
+    Pulse().pa_context_set_subscribe_callback(context_->context(), nullptr,
+                                              nullptr);
+  }
+
+  // Connection is new or was lost, changes may have been missed.
+  context_ = PulseContext::Acquire(error);
+  if (!context_) {
+    return false;
+  }
+
+  PulseLock lock(*context_);
+  if (!Subscribe(error)) {
+    context_.reset();
+    return false;
+  }
+
+  stale_ = true;
+  return true;
+}
+
+bool PulseDevices::Subscribe(std::string* error) {
+  Pulse().pa_context_set_subscribe_callback(context_->context(),
+                                            OnSubscription, this);
+
+  OperationResult result{context_.get()};
+  context_->Wait(Pulse().pa_context_subscribe(
+      context_->context(),
+      static_cast<pa_subscription_mask_t>(PA_SUBSCRIPTION_MASK_SOURCE |
+                                          PA_SUBSCRIPTION_MASK_SERVER),
+      OnContextSuccess, &result));
+
+  if (result.success == 0) {
+    Pulse().pa_context_set_subscribe_callback(context_->context(), nullptr,
+                                              nullptr);
+    *error = context_->LastError();
+    return false;
+  }
+
+  return true;
+}
+
+bool PulseDevices::Enumerate(std::vector<InputDeviceInfo>* devices,
+                             std::string* error) {
+  SourceList list{context_.get(), devices, {}};
+
+  pa_operation* server = Pulse().pa_context_get_server_info(
+      context_->context(), OnServerInfo, &list);
+  pa_operation* sources = Pulse().pa_context_get_source_info_list(
+      context_->context(), OnSourceInfo, &list);
+
+  // Replies come in request order.
+  context_->Wait(server);
+  context_->Wait(sources);
+
+  if (server == nullptr || sources == nullptr || list.failed) {
+    *error = context_->LastError();
+    return false;
+  }
+
+  return true;
+}
+
+void PulseDevices::OnSourceInfo(pa_context* /* context */,
+                                const pa_source_info* info,
+                                int eol,
+                                void* user_data) {
+  auto* list = static_cast<SourceList*>(user_data);
+
+  if (eol < 0) {
+    list->failed = true;
+  }
+  if (eol != 0) {
+    list->context->Signal();
+    return;
+  }
+
+  list->devices->push_back(ToInputDevice(*info, list->default_id));
+}
+
+void PulseDevices::OnServerInfo(pa_context* /* context */,
+                                const pa_server_info* info,
+                                void* user_data) {
+  auto* list = static_cast<SourceList*>(user_data);
+
+  if (info == nullptr) {
+    list->failed = true;
+  } else if (info->default_source_name != nullptr) {
+    list->default_id = info->default_source_name;
+  }
+
+  list->context->Signal();
+}
+
+void PulseDevices::OnSubscription(pa_context* /* context */,
+                                  pa_subscription_event_type_t /* type */,
+                                  uint32_t /* index */,
+                                  void* user_data) {
+  auto* self = static_cast<PulseDevices*>(user_data);
+
+  // Mask only gives source and server (default source) events.
+  self->stale_ = true;
+
+  // A single update is scheduled at a time, it sees every earlier event.
+  if (!self->update_pending_.exchange(true)) {
+    std::weak_ptr<PulseDevices> weak_devices = self->weak_this_;
+
+    record_run_on_main_thread([weak_devices]() {
+      if (auto devices = weak_devices.lock()) {
+        devices->update_pending_ = false;
+
+        std::string error;
+        devices->Update(&error);
+      }
+    });
+  }
+}
+
+}  // namespace record_linux
@@ -0,0 +1,79 @@
+#ifndef FLUTTER_PLUGIN_RECORD_PULSE_DEVICES_H_
+#define FLUTTER_PLUGIN_RECORD_PULSE_DEVICES_H_
+
+#include <pulse/pulseaudio.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "record_devices.h"
+#include "record_pulse_context.h"
+
+namespace record_linux {
+
+// Device of a source given by the introspection API, default_id is the
+// default source name.
+InputDeviceInfo ToInputDevice(const pa_source_info& info,
+                              const std::string& default_id);
+
+// Input devices from the sound server introspection API.
+//
+// The list is cached and enumerated again only after the server reported a
+// source or default source change, through a subscription on the shared
+// context. Reported changes are diffed against the cached list and given to
+// the listener.
+class PulseDevices {
+ public:
+  // Listener must outlive the returned instance.
+  static std::shared_ptr<PulseDevices> Create(DeviceListener* listener);
+
+  ~PulseDevices();
+
+  PulseDevices(const PulseDevices&) = delete;
+  PulseDevices& operator=(const PulseDevices&) = delete;
+
+  // Main thread.
+  bool List(std::vector<InputDeviceInfo>* devices, std::string* error);
+
+  // Main thread. Enumerates devices if needed, so later changes can be
+  // reported.
+  bool Update(std::string* error);
+
+ private:
+  explicit PulseDevices(DeviceListener* listener) : listener_(listener) {}
+
+  bool Connect(std::string* error);
+  // Called with the mainloop locked.
+  bool Subscribe(std::string* error);
+  bool Enumerate(std::vector<InputDeviceInfo>* devices, std::string* error);
+
+  static void OnSourceInfo(pa_context* context,
+                           const pa_source_info* info,
+                           int eol,
+                           void* user_data);
+  static void OnServerInfo(pa_context* context,
+                           const pa_server_info* info,
+                           void* user_data);
+  static void OnSubscription(pa_context* context,
+                             pa_subscription_event_type_t type,
+                             uint32_t index,
+                             void* user_data);
+
+  std::weak_ptr<PulseDevices> weak_this_;
+  DeviceListener* listener_;
+  std::shared_ptr<PulseContext> context_;
+  std::vector<InputDeviceInfo> devices_;
+  // Changes are only reported once a list is known.
+  bool enumerated_ = false;
+
+  // Set from the mainloop thread.
+  std::atomic<bool> stale_{true};
+  std::atomic<bool> update_pending_{false};
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_PULSE_DEVICES_H_
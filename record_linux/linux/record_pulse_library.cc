@@ -0,0 +1,36 @@
+#include "record_pulse_library.h"
+
+#include <dlfcn.h>
+
+namespace record_linux {
+
+namespace {
+
+const PulseLibrary* Open() {
+  // Never closed, contexts may live until the process exits.
+  void* handle = dlopen("libpulse.so.0", RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) {
+    return nullptr;
+  }
+
+  static PulseLibrary library;
+#define RECORD_PULSE_RESOLVE(name)                                   \
+  library.name =                                                     \
+      reinterpret_cast<decltype(library.name)>(dlsym(handle, #name)); \
+  if (library.name == nullptr) {                                     \
+    return nullptr;                                                  \
+  }
+  RECORD_PULSE_FUNCTIONS(RECORD_PULSE_RESOLVE)
+#undef RECORD_PULSE_RESOLVE
+
+  return &library;
+}
+
+}  // namespace
+
+const PulseLibrary* PulseLibrary::Load() {
+  static const PulseLibrary* library = Open();
+  return library;
+}
+
+}  // namespace record_linux
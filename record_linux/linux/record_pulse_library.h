@@ -0,0 +1,73 @@
+#ifndef FLUTTER_PLUGIN_RECORD_PULSE_LIBRARY_H_
+#define FLUTTER_PLUGIN_RECORD_PULSE_LIBRARY_H_
+
+#include <pulse/pulseaudio.h>
+
+namespace record_linux {
+
+#define RECORD_PULSE_FUNCTIONS(X)      \
+  X(pa_context_connect)                \
+  X(pa_context_disconnect)             \
+  X(pa_context_errno)                  \
+  X(pa_context_get_server_info)        \
+  X(pa_context_get_source_info_list)   \
+  X(pa_context_get_state)              \
+  X(pa_context_new)                    \
+  X(pa_context_set_state_callback)     \
+  X(pa_context_set_subscribe_callback) \
+  X(pa_context_subscribe)              \
+  X(pa_context_unref)                  \
+  X(pa_frame_size)                     \
+  X(pa_operation_get_state)            \
+  X(pa_operation_unref)                \
+  X(pa_proplist_free)                  \
+  X(pa_proplist_new)                   \
+  X(pa_proplist_sets)                  \
+  X(pa_sample_spec_valid)              \
+  X(pa_stream_connect_record)          \
+  X(pa_stream_cork)                    \
+  X(pa_stream_disconnect)              \
+  X(pa_stream_drop)                    \
+  X(pa_stream_get_latency)             \
+  X(pa_stream_get_sample_spec)         \
+  X(pa_stream_get_state)               \
+  X(pa_stream_get_time)                \
+  X(pa_stream_new_with_proplist)       \
+  X(pa_stream_peek)                    \
+  X(pa_stream_readable_size)           \
+  X(pa_stream_set_read_callback)       \
+  X(pa_stream_set_state_callback)      \
+  X(pa_stream_unref)                   \
+  X(pa_strerror)                       \
+  X(pa_threaded_mainloop_free)         \
+  X(pa_threaded_mainloop_get_api)      \
+  X(pa_threaded_mainloop_lock)         \
+  X(pa_threaded_mainloop_new)          \
+  X(pa_threaded_mainloop_signal)       \
+  X(pa_threaded_mainloop_start)        \
+  X(pa_threaded_mainloop_stop)         \
+  X(pa_threaded_mainloop_unlock)       \
+  X(pa_threaded_mainloop_wait)         \
+  X(pa_usec_to_bytes)
+
+// Functions of libpulse, which is opened at runtime so the plugin also
+// loads on hosts without it (they capture from ALSA).
+struct PulseLibrary {
+#define RECORD_PULSE_DECLARE(name) decltype(&::name) name = nullptr;
+  RECORD_PULSE_FUNCTIONS(RECORD_PULSE_DECLARE)
+#undef RECORD_PULSE_DECLARE
+
+  // Opens libpulse once, returns nullptr when it or one of its functions is
+  // missing.
+  static const PulseLibrary* Load();
+};
+
+// Loaded library, only valid once PulseLibrary::Load succeeded, which
+// PulseContext::Acquire checks.
+inline const PulseLibrary& Pulse() {
+  return *PulseLibrary::Load();
+}
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_PULSE_LIBRARY_H_
@@ -0,0 +1,665 @@
+#include "record_recorder.h"
+
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "record_dispatcher.h"
+
+namespace record_linux {
+
+namespace {
+
+// Whether a capture opened with a can be used for b.
+bool SameCapture(const CaptureConfig& a, const CaptureConfig& b) {
+  return a.device_id == b.device_id && a.sample_rate == b.sample_rate &&
+         a.num_channels == b.num_channels &&
+         a.sample_format == b.sample_format && a.latency_ms == b.latency_ms &&
+         a.buffer_periods == b.buffer_periods &&
+         a.auto_gain == b.auto_gain && a.echo_cancel == b.echo_cancel &&
+         a.noise_suppress == b.noise_suppress;
+}
+
+}  // namespace
+
+std::shared_ptr<Recorder> Recorder::Create(
+    const std::string& id,
+    std::shared_ptr<RecorderListener> listener) {
+  std::shared_ptr<Recorder> recorder(new Recorder(id, std::move(listener)));
+  recorder->weak_this_ = recorder;
+  return recorder;
+}
+
+Recorder::Recorder(const std::string& id,
+                   std::shared_ptr<RecorderListener> listener)
+    : id_(id), listener_(std::move(listener)) {}
+
+Recorder::~Recorder() {
+  Stop();
+}
+
+bool Recorder::Prepare(const RecordConfig& config, std::string* error) {
+  if (processing_thread_.joinable()) {
+    *error = "Recorder is already started.";
+    return false;
+  }
+
+  // Same rate as Start, so the capture is reused by file recordings too.
+  RecordConfig start_config = config;
+  start_config.sample_rate =
+      EncoderSampleRate(config.encoder, config.sample_rate);
+  const CaptureConfig capture_config = MakeCaptureConfig(start_config);
+
+  if (prepared_capture_ && SameCapture(prepared_config_, capture_config)) {
+    return true;
+  }
+
+  prepared_capture_.reset();
+
+  std::unique_ptr<CaptureBackend> capture = CreateCaptureBackend();
+  CaptureConfig paused_config = capture_config;
+  paused_config.start_paused = true;
+
+  if (!OpenCapture(capture.get(), paused_config, error)) {
+    return false;
+  }
+
+  prepared_capture_ = std::move(capture);
+  prepared_config_ = capture_config;
+  return true;
+}
+
+bool Recorder::Start(const RecordConfig& config,
+                     const std::string& path,
+                     std::string* error) {
+  return StartCapture(config, path, error);
+}
+
+bool Recorder::StartStream(const RecordConfig& config, std::string* error) {
+  // WAV header is only known once the file is complete.
+  if (config.encoder == "wav") {
+    *error = "Encoder " + config.encoder + " is not supported for streams.";
+    return false;
+  }
+
+  return StartCapture(config, std::string(), error);
+}
+
+bool Recorder::StartCapture(const RecordConfig& config,
+                            const std::string& path,
+                            std::string* error) {
+  // Kept from Prepare, used when it captures the same way.
+  std::unique_ptr<CaptureBackend> prepared = std::move(prepared_capture_);
+  Stop();
+
+  config_ = config;
+  path_ = path;
+  paused_duration_ = std::chrono::microseconds(0);
+  codec_config_.clear();
+
+  // PCM streams are sent as captured, other streams are encoded packets.
+  if (!path_.empty() || config_.encoder != "pcm16bits") {
+    encoder_ = CreateAudioEncoder(config_.encoder);
+    if (!encoder_) {
+      *error = "Encoder " + config_.encoder + " is not supported.";
+      return false;
+    }
+
+    // Sound server resamples to a rate accepted by the encoder.
+    config_.sample_rate =
+        EncoderSampleRate(config_.encoder, config_.sample_rate);
+
+    encoder_config_.sample_rate = config_.sample_rate;
+    encoder_config_.num_channels = config_.num_channels;
+    encoder_config_.bit_rate = config_.bit_rate;
+    encoder_config_.sample_format =
+        config_.encoder == "wav" || config_.encoder == "pcm16bits"
+            ? config_.sample_format
+            : record_core::SampleFormat::s16;
+
+    const bool opened =
+        path_.empty()
+            ? encoder_->OpenStream(
+                  encoder_config_,
+                  [this](const uint8_t* data, size_t size,
+                         const record_core::StreamPacketInfo& info) {
+                    PushStreamPacket(data, size, info);
+                  },
+                  error)
+            : encoder_->Open(path_, encoder_config_, error);
+    if (!opened) {
+      encoder_.reset();
+      return false;
+    }
+    codec_config_ = encoder_->CodecConfig();
+    encoded_ = true;
+  }
+
+  frame_bytes_ =
+      record_core::BytesPerSample(config_.sample_format) * config_.num_channels;
+
+  sample_converter_.Configure(config_.sample_format);
+  level_meter_.Configure(config_.sample_rate, config_.num_channels);
+  loudness_meter_.Configure(config_.sample_rate, config_.num_channels);
+  meters_ = record_core::MeterSnapshot();
+  meter_snapshot_.Store(meters_);
+  envelope_.Configure(config_.sample_rate, config_.num_channels,
+                      config_.envelope_interval_ms);
+  spectrum_.Configure(config_.sample_rate, config_.num_channels,
+                      config_.spectrum);
+  vad_.Configure(config_.sample_rate, config_.num_channels, config_.vad);
+  stream_coalescer_.Configure(
+      std::max(0, config_.stream_buffer_size), frame_bytes_,
+      std::chrono::milliseconds(std::max(0, config_.stream_max_delay_ms)));
+  // Spilled stream data is bounded to 1s of audio.
+  stream_queue_.Configure(config_.stream_overflow_policy,
+                          frame_bytes_ * config_.sample_rate, frame_bytes_);
+  stream_queue_.SetCredit(record_core::kStreamCredit);
+  stream_drain_pending_ = false;
+
+  // Packets keep their own bytes.
+  if (path_.empty() && !encoder_ && config_.zero_copy_stream) {
+    // At least 2s of audio and 16 chunks, so consumers have time to read
+    // chunks.
+    const size_t capacity = std::max(
+        frame_bytes_ * config_.sample_rate * 2,
+        static_cast<size_t>(std::max(0, config_.stream_buffer_size)) * 16);
+
+    pcm_ring_ = record_core::PcmRing::Create(capacity);
+    if (pcm_ring_ == nullptr) {
+      *error = "Failed to allocate the stream ring.";
+      encoder_.reset();
+      return false;
+    }
+  }
+
+  wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (wakeup_fd_ < 0) {
+    *error = "Failed to create capture wakeup.";
+    encoder_.reset();
+    if (pcm_ring_ != nullptr) {
+      pcm_ring_->Release();
+      pcm_ring_ = nullptr;
+    }
+    return false;
+  }
+
+  stopping_ = false;
+  processing_thread_ = std::thread(&Recorder::ProcessLoop, this);
+
+  const CaptureConfig capture_config = MakeCaptureConfig(config_);
+
+  if (prepared && SameCapture(prepared_config_, capture_config)) {
+    // Running since Prepare, frames are kept from now on.
+    capture_ = std::move(prepared);
+    if (!capture_->SetPaused(false)) {
+      *error = "Failed to start prepared capture.";
+      Stop();
+      return false;
+    }
+  } else {
+    prepared.reset();
+    capture_ = CreateCaptureBackend();
+
+    if (!OpenCapture(capture_.get(), capture_config, error)) {
+      Stop();
+      return false;
+    }
+  }
+
+  UpdateState(RecordState::kRecord);
+  return true;
+}
+
+CaptureConfig Recorder::MakeCaptureConfig(const RecordConfig& config) const {
+  CaptureConfig capture_config;
+  capture_config.device_id = config.device_id;
+  // Streams of simultaneous recorders can be told apart on the server.
+  capture_config.stream_name = "record " + id_;
+  capture_config.sample_rate = config.sample_rate;
+  capture_config.num_channels = config.num_channels;
+  capture_config.latency_ms =
+      std::min(std::max(config.latency_ms, kMinLatencyMs), kMaxLatencyMs);
+  capture_config.buffer_periods = std::min(
+      std::max(config.buffer_periods, kMinBufferPeriods), kMaxBufferPeriods);
+  capture_config.sample_format = config.sample_format;
+  capture_config.auto_gain = config.auto_gain;
+  capture_config.echo_cancel = config.echo_cancel;
+  capture_config.noise_suppress = config.noise_suppress;
+  return capture_config;
+}
+
+bool Recorder::OpenCapture(CaptureBackend* capture,
+                           const CaptureConfig& config,
+                           std::string* error) {
+  return capture->Open(
+      config,
+      [this](const uint8_t* data, size_t size) { OnCaptureData(data, size); },
+      [this](const std::string& message) { OnCaptureError(message); },
+      error);
+}
+
+std::string Recorder::Stop() {
+  prepared_capture_.reset();
+
+  if (capture_) {
+    capture_->Close();
+    capture_.reset();
+  }
+
+  if (!processing_thread_.joinable()) {
+    return std::string();
+  }
+
+  if (state_ == RecordState::kPause) {
+    paused_duration_ += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - pause_time_);
+  }
+
+  // Release a processing thread waiting for the stream consumer, the
+  // remaining data is then drained whatever the credit.
+  stream_queue_.Abort();
+
+  stopping_ = true;
+  WakeProcessing();
+  processing_thread_.join();
+
+  close(wakeup_fd_);
+  wakeup_fd_ = -1;
+
+  // File is completed by the processing thread.
+  encoder_.reset();
+  std::string path = encoded_ ? path_ : std::string();
+  path_.clear();
+
+  // Remaining data is sent before the end of the stream, nobody gets it
+  // when the listener never came.
+  if (stream_listening_) {
+    DrainStreamData();
+  } else {
+    DropStreamData();
+  }
+  listener_->OnStreamEnd();
+  stream_listening_ = false;
+
+  // Dart keeps its own reference while it views chunks.
+  if (pcm_ring_ != nullptr) {
+    pcm_ring_->Release();
+    pcm_ring_ = nullptr;
+  }
+
+  // Keep final loudness.
+  auto loudness = meters_.loudness;
+  meters_ = record_core::MeterSnapshot();
+  meters_.loudness = loudness;
+  meter_snapshot_.Store(meters_);
+
+  UpdateState(RecordState::kStop);
+
+  return path;
+}
+
+void Recorder::Pause() {
+  if (state_ == RecordState::kRecord && capture_->SetPaused(true)) {
+    pause_time_ = std::chrono::steady_clock::now();
+    UpdateState(RecordState::kPause);
+  }
+}
+
+void Recorder::Resume() {
+  if (state_ == RecordState::kPause && capture_->SetPaused(false)) {
+    paused_duration_ += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - pause_time_);
+    UpdateState(RecordState::kRecord);
+  }
+}
+
+std::chrono::microseconds Recorder::GetPausedDuration() const {
+  if (state_ == RecordState::kPause) {
+    return paused_duration_ +
+           std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - pause_time_);
+  }
+  return paused_duration_;
+}
+
+bool Recorder::GetLatency(record_core::CaptureLatency* latency) const {
+  if (!capture_) {
+    return false;
+  }
+
+  *latency = capture_->GetLatency();
+  return true;
+}
+
+void Recorder::UpdateState(RecordState state) {
+  if (state_ == state) {
+    return;
+  }
+
+  state_ = state;
+  listener_->OnStateChanged(state);
+}
+
+void Recorder::OnCaptureData(const uint8_t* data, size_t size) {
+  const bool pushed = capture_ring_.TryPush(
+      [data, size](CaptureChunk& chunk) { chunk.data.assign(data, data + size); });
+
+  if (!pushed) {
+    // Processing thread is late, don't make the capture thread wait.
+    stream_queue_.AddDropped(size);
+  }
+
+  WakeProcessing();
+}
+
+void Recorder::OnCaptureError(const std::string& message) {
+  std::weak_ptr<Recorder> weak_recorder = weak_this_;
+
+  record_run_on_main_thread([weak_recorder, message]() {
+    if (auto recorder = weak_recorder.lock()) {
+      recorder->listener_->OnError(message);
+      recorder->Stop();
+    }
+  });
+}
+
+void Recorder::WakeProcessing() {
+  const uint64_t count = 1;
+  ssize_t written;
+  do {
+    written = write(wakeup_fd_, &count, sizeof(count));
+  } while (written < 0 && errno == EINTR);
+}
+
+void Recorder::ProcessLoop() {
+  // Shown by per thread tools (top -H, pidstat -t), 15 characters at most.
+  pthread_setname_np(pthread_self(), "record-process");
+
+  for (;;) {
+    uint64_t count;
+    if (read(wakeup_fd_, &count, sizeof(count)) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      // Waiting again would fail the same way, the recorder is stopped.
+      OnCaptureError(std::string("Failed to wait for captured audio: ") +
+                     strerror(errno));
+      break;
+    }
+
+    // Read after the wakeup, so all data captured before Stop is processed.
+    const bool stopping = stopping_.load(std::memory_order_acquire);
+
+    capture_ring_.Drain([this](CaptureChunk& chunk) {
+      // Chunks wait here with the block policy, captured data then waits in
+      // capture_ring_.
+      stream_queue_.WaitForSpace();
+      Process(chunk.data.data(), chunk.data.size());
+    });
+
+    if (stopping) {
+      break;
+    }
+  }
+
+  if (encoder_) {
+    encoded_ = encoder_->Finish() && encoded_;
+  } else {
+    FlushStreamData();
+  }
+}
+
+void Recorder::Process(const uint8_t* data, size_t size) {
+  const size_t frame_count = size / frame_bytes_;
+  const int16_t* samples =
+      sample_converter_.ToS16(data, frame_count * config_.num_channels);
+
+  UpdateMeters(samples, frame_count);
+
+  if (!DetectVoice(samples, frame_count)) {
+    return;
+  }
+
+  if (encoder_) {
+    Encode(data, size, samples, frame_count);
+    return;
+  }
+
+  stream_coalescer_.Append(data, size, [this](const uint8_t* chunk,
+                                              size_t count) {
+    PushStreamData(chunk, count);
+  });
+}
+
+void Recorder::UpdateMeters(const int16_t* samples, size_t frame_count) {
+  level_meter_.Process(samples, frame_count);
+  loudness_meter_.Process(samples, frame_count);
+
+  const auto& levels = level_meter_.Levels();
+
+  meters_.current = levels.PeakDbfs();
+  meters_.rms = levels.RmsDbfs();
+  meters_.clipCount += levels.clipCount;
+  meters_.max = std::max(meters_.max, meters_.current);
+
+  meters_.numChannels = level_meter_.NumChannels();
+  for (int ch = 0; ch < meters_.numChannels; ch++) {
+    meters_.channels[ch] = level_meter_.Channel(ch);
+  }
+
+  meters_.loudness = loudness_meter_.GetLevels();
+
+  meter_snapshot_.Store(meters_);
+
+  UpdateEnvelope(samples, frame_count);
+  UpdateSpectrum(samples, frame_count);
+}
+
+void Recorder::UpdateEnvelope(const int16_t* samples, size_t frame_count) {
+  if (!envelope_.IsEnabled()) {
+    return;
+  }
+
+  // Buckets completed within this chunk are sent as a single event.
+  std::vector<float> buckets;
+  envelope_.Process(samples, frame_count,
+                    [&buckets](const record_core::EnvelopeBucket& bucket) {
+                      buckets.insert(buckets.end(),
+                                     {bucket.min, bucket.max, bucket.rms});
+                    });
+  if (buckets.empty()) {
+    return;
+  }
+
+  std::weak_ptr<Recorder> weak_recorder = weak_this_;
+
+  record_run_on_main_thread([weak_recorder, buckets]() {
+    if (auto recorder = weak_recorder.lock()) {
+      recorder->listener_->OnEnvelope(buckets);
+    }
+  });
+}
+
+void Recorder::UpdateSpectrum(const int16_t* samples, size_t frame_count) {
+  if (!spectrum_.IsEnabled()) {
+    return;
+  }
+
+  // Frame rate is capped by the analyzer, each frame is its own event.
+  std::weak_ptr<Recorder> weak_recorder = weak_this_;
+
+  spectrum_.Process(
+      samples, frame_count, [weak_recorder](const float* bands, int count) {
+        std::vector<float> frame(bands, bands + count);
+
+        record_run_on_main_thread([weak_recorder, frame]() {
+          if (auto recorder = weak_recorder.lock()) {
+            recorder->listener_->OnSpectrum(frame);
+          }
+        });
+      });
+}
+
+bool Recorder::DetectVoice(const int16_t* samples, size_t frame_count) {
+  if (!vad_.IsEnabled()) {
+    return true;
+  }
+
+  const bool was_active = vad_.IsActive();
+  const bool block_active = vad_.Process(samples, frame_count);
+  const bool active = vad_.IsActive();
+
+  if (active != was_active) {
+    std::weak_ptr<Recorder> weak_recorder = weak_this_;
+
+    record_run_on_main_thread([weak_recorder, active]() {
+      if (auto recorder = weak_recorder.lock()) {
+        recorder->listener_->OnVoiceActivity(active);
+      }
+    });
+  }
+
+  return block_active || vad_.Mode() != record_core::VadMode::skip;
+}
+
+void Recorder::Encode(const uint8_t* data,
+                      size_t size,
+                      const int16_t* samples,
+                      size_t frame_count) {
+  if (!encoded_) {
+    return;
+  }
+
+  // Compressed encoders take 16 bits samples.
+  encoded_ =
+      encoder_config_.sample_format == record_core::SampleFormat::s16
+          ? encoder_->Write(
+                reinterpret_cast<const uint8_t*>(samples),
+                frame_count * config_.num_channels * sizeof(int16_t))
+          : encoder_->Write(data, size);
+
+  if (!encoded_) {
+    OnCaptureError("Failed to encode audio.");
+  }
+}
+
+void Recorder::PushStreamData(const uint8_t* data, size_t size) {
+  bool queued;
+
+  if (pcm_ring_ != nullptr) {
+    record_core::PcmRingChunk chunk;
+    if (pcm_ring_->Write(data, size, chunk)) {
+      queued = stream_queue_.PushShared(chunk);
+    } else {
+      stream_queue_.AddDropped(size);
+      queued = false;
+    }
+  } else {
+    queued = stream_queue_.Push(data, size);
+  }
+
+  if (queued) {
+    ScheduleStreamDrain();
+  }
+}
+
+void Recorder::PushStreamPacket(const uint8_t* data,
+                                size_t size,
+                                const record_core::StreamPacketInfo& info) {
+  if (stream_queue_.PushPacket(data, size, info)) {
+    ScheduleStreamDrain();
+  }
+}
+
+void Recorder::FlushStreamData() {
+  stream_coalescer_.Flush([this](const uint8_t* data, size_t size) {
+    PushStreamData(data, size);
+  });
+
+  if (stream_queue_.FlushSpill()) {
+    ScheduleStreamDrain();
+  }
+}
+
+void Recorder::ScheduleStreamDrain() {
+  // Only one drain is scheduled at a time, it takes everything pushed until
+  // it runs.
+  if (!stream_drain_pending_.exchange(true, std::memory_order_acq_rel)) {
+    std::weak_ptr<Recorder> weak_recorder = weak_this_;
+
+    record_run_on_main_thread([weak_recorder]() {
+      if (auto recorder = weak_recorder.lock()) {
+        recorder->DrainStreamData();
+      }
+    });
+  }
+}
+
+void Recorder::AcknowledgeStream(size_t count) {
+  stream_queue_.Acknowledge(count);
+  DrainStreamData();
+}
+
+std::vector<uint8_t> Recorder::GetCodecConfig() const {
+  return codec_config_;
+}
+
+record_core::PcmRing* Recorder::GetPcmRing() {
+  if (pcm_ring_ != nullptr) {
+    pcm_ring_->Retain();
+  }
+  return pcm_ring_;
+}
+
+void Recorder::SetStreamListening(bool listening) {
+  stream_listening_ = listening;
+  if (listening) {
+    DrainStreamData();
+  }
+}
+
+void Recorder::DrainStreamData() {
+  // Held until the listener comes, SetStreamListening drains then.
+  if (!stream_listening_) {
+    stream_drain_pending_.store(true, std::memory_order_release);
+    return;
+  }
+
+  // Cleared before draining so data pushed meanwhile schedules another drain.
+  stream_drain_pending_.exchange(false, std::memory_order_acq_rel);
+
+  stream_queue_.Drain([this](record_core::StreamQueueItem& chunk) {
+    if (chunk.bytes.empty()) {
+      // Zero copy stream, only the chunk location is sent.
+      listener_->OnSharedStreamData(chunk.shared);
+    } else if (chunk.isPacket) {
+      listener_->OnStreamPacket(chunk.bytes, chunk.packet);
+      chunk.bytes.clear();
+    } else {
+      listener_->OnStreamData(chunk.bytes);
+      chunk.bytes.clear();
+    }
+  });
+
+  // Out of credit, the next acknowledgement drains instead of producers.
+  if (!stream_queue_.HasCredit()) {
+    stream_drain_pending_.store(true, std::memory_order_release);
+  }
+}
+
+void Recorder::DropStreamData() {
+  stream_queue_.Drain([this](record_core::StreamQueueItem& chunk) {
+    stream_queue_.AddDropped(chunk.bytes.empty()
+                                 ? static_cast<size_t>(chunk.shared.length)
+                                 : chunk.bytes.size());
+    chunk.bytes.clear();
+  });
+}
+
+}  // namespace record_linux
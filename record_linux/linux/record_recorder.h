@@ -0,0 +1,254 @@
+#ifndef FLUTTER_PLUGIN_RECORD_RECORDER_H_
+#define FLUTTER_PLUGIN_RECORD_RECORDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/envelope_generator.h"
+#include "core/level_meter.h"
+#include "core/loudness_meter.h"
+#include "core/meter_snapshot.h"
+#include "core/pcm_ring.h"
+#include "core/sample_format.h"
+#include "core/seqlock.h"
+#include "core/spectrum_analyzer.h"
+#include "core/spsc_ring.h"
+#include "core/stream_coalescer.h"
+#include "core/stream_queue.h"
+#include "core/voice_activity_detector.h"
+#include "record_capture.h"
+#include "record_encoder.h"
+
+namespace record_linux {
+
+// Values are shared with Dart (RecordState index).
+enum class RecordState { kPause = 0, kRecord = 1, kStop = 2 };
+
+struct RecordConfig {
+  std::string encoder;
+  std::string device_id;
+  int bit_rate = 128000;
+  int sample_rate = 44100;
+  int num_channels = 2;
+  // Capture period, clamped to [kMinLatencyMs, kMaxLatencyMs].
+  int latency_ms = 100;
+  // Clamped to [kMinBufferPeriods, kMaxBufferPeriods].
+  int buffer_periods = 4;
+  bool auto_gain = false;
+  bool echo_cancel = false;
+  bool noise_suppress = false;
+  int stream_buffer_size = 0;
+  // Longest wait of streamed data for its chunk, unbounded when 0.
+  int stream_max_delay_ms = 0;
+  // Streamed PCM is written to a PcmRing shared with Dart, chunks are sent
+  // as their location.
+  bool zero_copy_stream = false;
+  record_core::StreamOverflowPolicy stream_overflow_policy =
+      record_core::StreamOverflowPolicy::dropNewest;
+  record_core::SampleFormat sample_format = record_core::SampleFormat::s16;
+  // Waveform envelope bucket duration, disabled when 0.
+  int envelope_interval_ms = 0;
+  // Disabled when spectrum.fftSize is 0.
+  record_core::SpectrumConfig spectrum;
+  // Silent chunks are neither encoded nor streamed with VadMode::skip.
+  record_core::VadConfig vad;
+};
+
+// Receives recorder events, always on the main thread.
+class RecorderListener {
+ public:
+  virtual ~RecorderListener() = default;
+
+  virtual void OnStateChanged(RecordState state) = 0;
+  virtual void OnStreamData(const std::vector<uint8_t>& data) = 0;
+  // Chunk written in the ring of a zero copy stream (see GetPcmRing).
+  virtual void OnSharedStreamData(const record_core::PcmRingChunk& chunk) = 0;
+  // Encoded packet of a stream with a compressed encoder.
+  virtual void OnStreamPacket(const std::vector<uint8_t>& data,
+                              const record_core::StreamPacketInfo& info) = 0;
+  // Envelope buckets completed by a captured chunk, as [min, max, rms]
+  // triplets.
+  virtual void OnEnvelope(const std::vector<float>& buckets) = 0;
+  // Band magnitudes in dBFS of an analyzed frame.
+  virtual void OnSpectrum(const std::vector<float>& bands) = 0;
+  // Voice activity changed, true when voice starts.
+  virtual void OnVoiceActivity(bool active) = 0;
+  // Stream ended, after its last data.
+  virtual void OnStreamEnd() = 0;
+  // Capture failed, the recorder is stopped afterwards.
+  virtual void OnError(const std::string& message) = 0;
+};
+
+// Native recorder of a recorder id.
+//
+// Recorders are independent, each has its own capture stream on the shared
+// server connection, its own processing thread and encoder. A thread per
+// recorder keeps a stream consumer blocking one recorder (see
+// StreamOverflowPolicy::block) from delaying the others.
+//
+// The capture thread only copies captured buffers into a ring. A
+// processing thread meters them and encodes them to the file, or queues
+// stream chunks or packets sent to the listener on the main thread.
+//
+// Public methods must be called from the main thread. Recorders are owned
+// by a shared_ptr (see Create) so pending main thread tasks can tell when
+// their recorder is gone.
+class Recorder {
+ public:
+  static std::shared_ptr<Recorder> Create(
+      const std::string& id,
+      std::shared_ptr<RecorderListener> listener);
+
+  ~Recorder();
+
+  Recorder(const Recorder&) = delete;
+  Recorder& operator=(const Recorder&) = delete;
+
+  // Opens the capture of config ahead of Start or StartStream, so they only
+  // keep frames from their call instead of opening the device. The device
+  // runs, its frames dropped, until started with the same capture settings,
+  // stopped or prepared again. Fails while started.
+  bool Prepare(const RecordConfig& config, std::string* error);
+
+  // Starts capture, audio is encoded to path.
+  bool Start(const RecordConfig& config,
+             const std::string& path,
+             std::string* error);
+  // Starts capture, streamed to the listener: PCM data with the pcm16bits
+  // encoder, packets of the other encoders but wav. The listener receives
+  // record_core::kStreamCredit chunks ahead of AcknowledgeStream.
+  bool StartStream(const RecordConfig& config, std::string* error);
+  // Consumer handled count more chunks, sends the ones waiting for it.
+  void AcknowledgeStream(size_t count);
+  // The listener consumes stream data or not. Until it does, chunks wait
+  // in the queue without using credit, so none are sent to nobody. Reset
+  // at the end of each stream.
+  void SetStreamListening(bool listening);
+  // Returns the file path, empty when streaming or when encoding failed.
+  std::string Stop();
+  void Pause();
+  void Resume();
+
+  bool IsRecording() const { return state_ == RecordState::kRecord; }
+  bool IsPaused() const { return state_ == RecordState::kPause; }
+
+  // Time spent paused by the current or last recording.
+  std::chrono::microseconds GetPausedDuration() const;
+
+  // Measured capture latency, false when not recording.
+  bool GetLatency(record_core::CaptureLatency* latency) const;
+
+  // Any thread.
+  record_core::MeterSnapshot GetMeters() const {
+    return meter_snapshot_.Load();
+  }
+  record_core::StreamQueueStats GetStreamStats() const {
+    return stream_queue_.Stats();
+  }
+
+  // Setup data of the encoder of a packet stream, sent ahead of packets.
+  // Empty when there is none.
+  std::vector<uint8_t> GetCodecConfig() const;
+
+  // Returns a new reference to the ring of the zero copy stream, if any.
+  record_core::PcmRing* GetPcmRing();
+
+ private:
+  // Captured buffer handed to the processing thread.
+  struct CaptureChunk {
+    std::vector<uint8_t> data;
+  };
+
+  Recorder(const std::string& id, std::shared_ptr<RecorderListener> listener);
+
+  bool StartCapture(const RecordConfig& config,
+                    const std::string& path,
+                    std::string* error);
+  CaptureConfig MakeCaptureConfig(const RecordConfig& config) const;
+  bool OpenCapture(CaptureBackend* capture,
+                   const CaptureConfig& config,
+                   std::string* error);
+  void UpdateState(RecordState state);
+
+  // Capture thread.
+  void OnCaptureData(const uint8_t* data, size_t size);
+  void OnCaptureError(const std::string& message);
+  void WakeProcessing();
+
+  // Processing thread.
+  void ProcessLoop();
+  void Process(const uint8_t* data, size_t size);
+  void UpdateMeters(const int16_t* samples, size_t frame_count);
+  void UpdateEnvelope(const int16_t* samples, size_t frame_count);
+  void UpdateSpectrum(const int16_t* samples, size_t frame_count);
+  // Returns false when the chunk is skipped as silence.
+  bool DetectVoice(const int16_t* samples, size_t frame_count);
+  void Encode(const uint8_t* data,
+              size_t size,
+              const int16_t* samples,
+              size_t frame_count);
+  void PushStreamData(const uint8_t* data, size_t size);
+  void PushStreamPacket(const uint8_t* data,
+                        size_t size,
+                        const record_core::StreamPacketInfo& info);
+  void FlushStreamData();
+  void ScheduleStreamDrain();
+
+  // Main thread.
+  void DrainStreamData();
+  void DropStreamData();
+
+  std::weak_ptr<Recorder> weak_this_;
+  const std::string id_;
+  std::shared_ptr<RecorderListener> listener_;
+  std::unique_ptr<CaptureBackend> capture_;
+  // Opened by Prepare, frames are dropped until it becomes capture_.
+  std::unique_ptr<CaptureBackend> prepared_capture_;
+  CaptureConfig prepared_config_;
+  RecordConfig config_;
+  size_t frame_bytes_ = 2;
+  std::atomic<RecordState> state_{RecordState::kStop};
+  std::chrono::steady_clock::time_point pause_time_;
+  std::chrono::microseconds paused_duration_{0};
+
+  record_core::SpscRing<CaptureChunk> capture_ring_{64};
+  // eventfd counting capture wakeups.
+  int wakeup_fd_ = -1;
+  std::thread processing_thread_;
+  std::atomic<bool> stopping_{false};
+
+  // Processing thread state.
+  // Encodes to path_, or to stream packets when there is no path.
+  std::unique_ptr<AudioEncoder> encoder_;
+  EncoderConfig encoder_config_;
+  std::string path_;
+  bool encoded_ = false;
+  record_core::SampleConverter sample_converter_;
+  record_core::LevelMeter level_meter_;
+  record_core::LoudnessMeter loudness_meter_;
+  record_core::MeterSnapshot meters_;
+  record_core::SeqLock<record_core::MeterSnapshot> meter_snapshot_;
+  record_core::EnvelopeGenerator envelope_;
+  record_core::SpectrumAnalyzer spectrum_;
+  record_core::VoiceActivityDetector vad_;
+  record_core::StreamCoalescer stream_coalescer_;
+
+  // Stream chunks handed from the processing thread to the main thread.
+  record_core::StreamQueue stream_queue_{256};
+  std::atomic<bool> stream_drain_pending_{false};
+  // Written by the processing thread, set and released while it's stopped.
+  record_core::PcmRing* pcm_ring_ = nullptr;
+  // Main thread.
+  bool stream_listening_ = false;
+  std::vector<uint8_t> codec_config_;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_RECORDER_H_
@@ -0,0 +1,104 @@
+#include "record_wav_encoder.h"
+
+#include <cerrno>
+#include <cstring>
+
+namespace record_linux {
+
+namespace {
+
+constexpr uint16_t kWaveFormatPcm = 1;
+constexpr uint16_t kWaveFormatIeeeFloat = 3;
+constexpr size_t kHeaderSize = 44;
+
+void PutU16(uint8_t* out, uint16_t value) {
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void PutU32(uint8_t* out, uint32_t value) {
+  PutU16(out, static_cast<uint16_t>(value));
+  PutU16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+}  // namespace
+
+WavEncoder::~WavEncoder() {
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+}
+
+bool WavEncoder::Open(const std::string& path,
+                      const EncoderConfig& config,
+                      std::string* error) {
+  config_ = config;
+  data_size_ = 0;
+
+  file_ = fopen(path.c_str(), "wb");
+  if (file_ == nullptr) {
+    *error = "Failed to create " + path + ": " + strerror(errno);
+    return false;
+  }
+
+  // Placeholder, completed by Finish.
+  if (with_header_ && !WriteHeader()) {
+    *error = "Failed to write " + path;
+    return false;
+  }
+
+  return true;
+}
+
+bool WavEncoder::Write(const uint8_t* data, size_t size) {
+  if (fwrite(data, 1, size, file_) != size) {
+    return false;
+  }
+
+  data_size_ += size;
+  return true;
+}
+
+bool WavEncoder::Finish() {
+  bool written = true;
+
+  if (with_header_) {
+    written = fseek(file_, 0, SEEK_SET) == 0 && WriteHeader();
+  }
+
+  written = fclose(file_) == 0 && written;
+  file_ = nullptr;
+
+  return written;
+}
+
+bool WavEncoder::WriteHeader() {
+  const uint16_t channels = static_cast<uint16_t>(config_.num_channels);
+  const uint16_t sample_bytes = static_cast<uint16_t>(
+      record_core::BytesPerSample(config_.sample_format));
+  const uint16_t block_align = channels * sample_bytes;
+  // Sizes are capped, readers then read up to the end of file.
+  const uint32_t data_size = data_size_ > UINT32_MAX - kHeaderSize
+                                 ? UINT32_MAX - kHeaderSize
+                                 : static_cast<uint32_t>(data_size_);
+
+  uint8_t header[kHeaderSize];
+  memcpy(header, "RIFF", 4);
+  PutU32(header + 4, static_cast<uint32_t>(kHeaderSize - 8) + data_size);
+  memcpy(header + 8, "WAVEfmt ", 8);
+  PutU32(header + 16, 16);
+  PutU16(header + 20, config_.sample_format == record_core::SampleFormat::f32
+                          ? kWaveFormatIeeeFloat
+                          : kWaveFormatPcm);
+  PutU16(header + 22, channels);
+  PutU32(header + 24, static_cast<uint32_t>(config_.sample_rate));
+  PutU32(header + 28, static_cast<uint32_t>(config_.sample_rate) * block_align);
+  PutU16(header + 32, block_align);
+  PutU16(header + 34, static_cast<uint16_t>(sample_bytes * 8));
+  memcpy(header + 36, "data", 4);
+  PutU32(header + 40, data_size);
+
+  return fwrite(header, 1, kHeaderSize, file_) == kHeaderSize;
+}
+
+}  // namespace record_linux
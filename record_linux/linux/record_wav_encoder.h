@@ -0,0 +1,34 @@
+#ifndef FLUTTER_PLUGIN_RECORD_WAV_ENCODER_H_
+#define FLUTTER_PLUGIN_RECORD_WAV_ENCODER_H_
+
+#include <cstdio>
+
+#include "record_encoder.h"
+
+namespace record_linux {
+
+// Writes PCM as is, in a WAVE container or raw (pcm16bits).
+class WavEncoder : public AudioEncoder {
+ public:
+  explicit WavEncoder(bool with_header) : with_header_(with_header) {}
+  ~WavEncoder() override;
+
+  bool Open(const std::string& path,
+            const EncoderConfig& config,
+            std::string* error) override;
+  bool Write(const uint8_t* data, size_t size) override;
+  bool Finish() override;
+
+ private:
+  // Header sizes are known once data is written.
+  bool WriteHeader();
+
+  const bool with_header_;
+  EncoderConfig config_;
+  FILE* file_ = nullptr;
+  uint64_t data_size_ = 0;
+};
+
+}  // namespace record_linux
+
+#endif  // FLUTTER_PLUGIN_RECORD_WAV_ENCODER_H_
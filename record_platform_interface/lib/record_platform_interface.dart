@@ -1,2 +1,4 @@
 export 'src/record_platform_interface.dart';
+export 'src/shared_pcm_stream.dart';
+export 'src/stream_credit.dart';
 export 'src/types/types.dart';
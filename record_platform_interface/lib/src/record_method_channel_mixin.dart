@@ -4,6 +4,8 @@ import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 
 import 'record_platform_interface.dart';
+import 'shared_pcm_stream.dart';
+import 'stream_credit.dart';
 import 'types/types.dart';
 
 mixin RecordMethodChannel implements RecordMethodChannelPlatformInterface {
@@ -62,6 +64,18 @@ mixin RecordMethodChannel implements RecordMethodChannelPlatformInterface {
     );
   }
 
+  @override
+  Future<void> prepare(String recorderId, RecordConfig config) async {
+    try {
+      await _methodChannel.invokeMethod('prepare', {
+        'recorderId': recorderId,
+        ...config.toMap(),
+      });
+    } on MissingPluginException {
+      // Starting opens the device.
+    }
+  }
+
   @override
   Future<void> start(String recorderId, RecordConfig config,
       {required String path}) {
@@ -76,19 +90,91 @@ mixin RecordMethodChannel implements RecordMethodChannelPlatformInterface {
   Future<Stream<Uint8List>> startStream(
     String recorderId,
     RecordConfig config,
+  ) async {
+    final (_, events) = await _startStreamEvents(recorderId, config);
+
+    // Encoded packets are sent with their timing.
+    return events.map<Uint8List>(
+      (event) => event is Uint8List ? event : (event as List).first,
+    );
+  }
+
+  @override
+  Future<Stream<EncodedPacket>> startPacketStream(
+    String recorderId,
+    RecordConfig config,
+  ) async {
+    final (codecConfig, events) = await _startStreamEvents(recorderId, config);
+
+    if (config.encoder == AudioEncoder.pcm16bits) {
+      return EncodedPacket.fromPcmStream(
+        events.cast<Uint8List>(),
+        sampleRate: config.sampleRate,
+        numChannels: config.numChannels,
+        sampleFormat: config.sampleFormat,
+      );
+    }
+
+    final packets = events.map<EncodedPacket>(
+      (event) => EncodedPacket.fromList(event as List),
+    );
+
+    if (codecConfig == null) return packets;
+
+    return Stream.multi((controller) {
+      controller.add(EncodedPacket(
+        data: codecConfig,
+        timestamp: Duration.zero,
+        duration: Duration.zero,
+        isConfig: true,
+      ));
+      controller.addStream(packets).whenComplete(controller.close);
+    });
+  }
+
+  /// Starts the native stream.
+  ///
+  /// Returns codec setup data if any, and events, either PCM chunks or
+  /// `[data, timestamp, duration]` packets.
+  Future<(Uint8List?, Stream<dynamic>)> _startStreamEvents(
+    String recorderId,
+    RecordConfig config,
   ) async {
     final eventRecordChannel = EventChannel(
       'com.llfbandit.record/eventsRecord/$recorderId',
     );
 
-    await _methodChannel.invokeMethod('startStream', {
+    final result = await _methodChannel.invokeMethod('startStream', {
       'recorderId': recorderId,
       ...config.toMap(),
     });
 
-    return eventRecordChannel
-        .receiveBroadcastStream()
-        .map<Uint8List>((data) => data);
+    var events = eventRecordChannel.receiveBroadcastStream();
+
+    // Native side waits for acknowledgements when it gives a credit.
+    if (result is Map && result['credit'] is int) {
+      events = acknowledgeEvents(
+        events,
+        result['credit'] as int,
+        (count) => _acknowledgeStream(recorderId, count),
+      );
+    }
+
+    if (result is Map && result.containsKey('ring')) {
+      // Zero copy stream, events are chunk locations in the shared ring.
+      return (null, readSharedPcmChunks(result, events));
+    }
+
+    return (result is Map ? result['codecConfig'] as Uint8List? : null, events);
+  }
+
+  void _acknowledgeStream(String recorderId, int count) {
+    _methodChannel.invokeMethod<void>('ackStream', {
+      'recorderId': recorderId,
+      'count': count,
+    }).catchError((_) {
+      // Recorder is gone, e.g. disposed while its last chunks were handled.
+    });
   }
 
   @override
@@ -124,10 +210,63 @@ mixin RecordMethodChannel implements RecordMethodChannelPlatformInterface {
       {'recorderId': recorderId},
     );
 
-    return Amplitude(
-      current: result?['current'] ?? 0.0,
-      max: result?['max'] ?? 0.0,
-    );
+    return Amplitude.fromMap(result ?? const {});
+  }
+
+  @override
+  Future<Loudness?> getLoudness(String recorderId) async {
+    try {
+      final result = await _methodChannel.invokeMethod(
+        'getLoudness',
+        {'recorderId': recorderId},
+      );
+
+      return result != null ? Loudness.fromMap(result) : null;
+    } on MissingPluginException {
+      return null;
+    }
+  }
+
+  @override
+  Future<StreamStats?> getStreamStats(String recorderId) async {
+    try {
+      final result = await _methodChannel.invokeMethod(
+        'getStreamStats',
+        {'recorderId': recorderId},
+      );
+
+      return result != null ? StreamStats.fromMap(result) : null;
+    } on MissingPluginException {
+      return null;
+    }
+  }
+
+  @override
+  Future<Duration?> getPausedDuration(String recorderId) async {
+    try {
+      final result = await _methodChannel.invokeMethod<int>(
+        'getPausedDuration',
+        {'recorderId': recorderId},
+      );
+
+      return result != null ? Duration(microseconds: result) : null;
+    } on MissingPluginException {
+      return null;
+    }
+  }
+
+  @override
+  Future<CaptureLatency?> getLatency(String recorderId) async {
+    try {
+      final result = await _methodChannel.invokeMethod(
+        'getLatency',
+        {'recorderId': recorderId},
+      );
+
+      return result != null ? CaptureLatency.fromMap(result) : null;
+    } on MissingPluginException {
+      return null;
+    }
   }
 
   @override
@@ -175,6 +314,48 @@ mixin RecordEventChannel implements RecordEventChannelPlatformInterface {
           (state) => RecordState.values.firstWhere((e) => e.index == state),
         );
   }
+
+  @override
+  Stream<EnvelopeBucket> onEnvelope(String recorderId) {
+    final eventChannel = EventChannel(
+      'com.llfbandit.record/eventsEnvelope/$recorderId',
+    );
+
+    return eventChannel
+        .receiveBroadcastStream()
+        .expand<EnvelopeBucket>((data) => EnvelopeBucket.fromFloat32List(data));
+  }
+
+  @override
+  Stream<Float32List> onSpectrum(String recorderId) {
+    final eventChannel = EventChannel(
+      'com.llfbandit.record/eventsSpectrum/$recorderId',
+    );
+
+    return eventChannel.receiveBroadcastStream().cast<Float32List>();
+  }
+
+  @override
+  Stream<bool> onVoiceActivity(String recorderId) {
+    final eventChannel = EventChannel(
+      'com.llfbandit.record/eventsVad/$recorderId',
+    );
+
+    return eventChannel.receiveBroadcastStream().cast<bool>();
+  }
+
+  // A channel has a single listener on platform side, so it is shared.
+  Stream<InputDeviceChange>? _inputDevicesChanges;
+
+  @override
+  Stream<InputDeviceChange> onInputDevicesChanged(String recorderId) {
+    return _inputDevicesChanges ??=
+        const EventChannel('com.llfbandit.record/eventsDevices')
+            .receiveBroadcastStream()
+            .map<InputDeviceChange>(
+              (change) => InputDeviceChange.fromMap(change),
+            );
+  }
 }
 
 class _RecordIosImpl implements RecordIos {
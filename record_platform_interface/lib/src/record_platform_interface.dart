@@ -21,6 +21,49 @@ abstract class RecordPlatform extends PlatformInterface
   /// Defaults to [RecordPlatformImpl].
   static RecordPlatform instance = RecordPlatformImpl();
 
+  @override
+  Future<Stream<EncodedPacket>> startPacketStream(
+    String recorderId,
+    RecordConfig config,
+  ) async {
+    final stream = await startStream(recorderId, config);
+
+    return EncodedPacket.fromPcmStream(
+      stream,
+      sampleRate: config.sampleRate,
+      numChannels: config.numChannels,
+      sampleFormat: config.sampleFormat,
+    );
+  }
+
+  @override
+  Future<void> prepare(String recorderId, RecordConfig config) async {}
+
+  @override
+  Future<Loudness?> getLoudness(String recorderId) async => null;
+
+  @override
+  Future<StreamStats?> getStreamStats(String recorderId) async => null;
+
+  @override
+  Future<Duration?> getPausedDuration(String recorderId) async => null;
+
+  @override
+  Future<CaptureLatency?> getLatency(String recorderId) async => null;
+
+  @override
+  Stream<EnvelopeBucket> onEnvelope(String recorderId) => const Stream.empty();
+
+  @override
+  Stream<Float32List> onSpectrum(String recorderId) => const Stream.empty();
+
+  @override
+  Stream<bool> onVoiceActivity(String recorderId) => const Stream.empty();
+
+  @override
+  Stream<InputDeviceChange> onInputDevicesChanged(String recorderId) =>
+      const Stream.empty();
+
   @override
   RecordIos? getIos(String recorderId) => null;
 }
@@ -30,6 +73,18 @@ abstract class RecordMethodChannelPlatformInterface {
   /// Create a recorder
   Future<void> create(String recorderId);
 
+  /// Opens the capture of [config] ahead of [start] or [startStream].
+  ///
+  /// Starting with the same device, sample rate, channels, sample format
+  /// and latency then only keeps audio from the start call, without opening
+  /// the device again. The device is in use until started, stopped or
+  /// disposed. Audio before the start call is not recorded.
+  ///
+  /// Does nothing on unsupported platforms.
+  ///
+  /// Platforms: Linux & Windows.
+  Future<void> prepare(String recorderId, RecordConfig config);
+
   /// Starts new recording session.
   ///
   /// [path]: The output path file. Required on all IO platforms.
@@ -45,6 +100,20 @@ abstract class RecordMethodChannelPlatformInterface {
   /// full recorded data.
   Future<Stream<Uint8List>> startStream(String recorderId, RecordConfig config);
 
+  /// Same as [startStream] with packets and their timing.
+  ///
+  /// Compressed encoders give one packet per encoder output, without
+  /// container. Decoder setup data, when required, is sent first
+  /// (see [EncodedPacket.isConfig]).
+  ///
+  /// With [AudioEncoder.pcm16bits], each chunk is a packet.
+  ///
+  /// Platforms: Linux & Windows (compressed encoders), others (PCM).
+  Future<Stream<EncodedPacket>> startPacketStream(
+    String recorderId,
+    RecordConfig config,
+  );
+
   /// Stops recording session and release internal recorder resource.
   ///
   /// Returns the output path.
@@ -80,6 +149,37 @@ abstract class RecordMethodChannelPlatformInterface {
   /// Always returns zeros on unsupported platforms
   Future<Amplitude> getAmplitude(String recorderId);
 
+  /// Gets current loudness measurements.
+  ///
+  /// Values of the last recording remain available after [stop]
+  /// until a new recording is started.
+  ///
+  /// Returns [null] on unsupported platforms.
+  ///
+  /// Platforms: Windows & Linux.
+  Future<Loudness?> getLoudness(String recorderId);
+
+  /// Gets stream delivery counters (e.g. dropped audio).
+  ///
+  /// Returns [null] on unsupported platforms.
+  ///
+  /// Platforms: Windows & Linux.
+  Future<StreamStats?> getStreamStats(String recorderId);
+
+  /// Gets the time spent paused by the current or last recording.
+  ///
+  /// Returns [null] on unsupported platforms.
+  ///
+  /// Platforms: Linux.
+  Future<Duration?> getPausedDuration(String recorderId);
+
+  /// Gets the capture latency and period measured by the current recording.
+  ///
+  /// Returns [null] when not recording or on unsupported platforms.
+  ///
+  /// Platforms: Linux & Windows.
+  Future<CaptureLatency?> getLatency(String recorderId);
+
   /// Checks if the given encoder is supported on the current platform.
   Future<bool> isEncoderSupported(String recorderId, AudioEncoder encoder);
 
@@ -106,6 +206,36 @@ abstract class RecordEventChannelPlatformInterface {
   ///
   /// Provides pause, resume and stop states.
   Stream<RecordState> onStateChanged(String recorderId);
+
+  /// Listen to waveform envelope buckets.
+  ///
+  /// Requires [RecordConfig.envelopeInterval] to be set when starting.
+  ///
+  /// Platforms: Linux & Windows.
+  Stream<EnvelopeBucket> onEnvelope(String recorderId);
+
+  /// Listen to spectrum frames of band magnitudes in dBFS.
+  ///
+  /// Requires [RecordConfig.spectrum] to be set when starting.
+  ///
+  /// Platforms: Linux & Windows.
+  Stream<Float32List> onSpectrum(String recorderId);
+
+  /// Listen to voice activity changes, `true` when voice starts.
+  ///
+  /// Requires [RecordConfig.vad] to be set when starting.
+  ///
+  /// Platforms: Linux & Windows.
+  Stream<bool> onVoiceActivity(String recorderId);
+
+  /// Listen to input devices being added or removed and to default input
+  /// device changes.
+  ///
+  /// Devices are shared by all recorders, the stream is the same for each of
+  /// them.
+  ///
+  /// Platforms: Linux & Windows.
+  Stream<InputDeviceChange> onInputDevicesChanged(String recorderId);
 }
 
 /// iOS platform specific methods.
@@ -0,0 +1,2 @@
+export 'shared_pcm_ring_stub.dart'
+    if (dart.library.ffi) 'shared_pcm_ring_ffi.dart';
@@ -0,0 +1,68 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+/// Native byte ring shared with the recorder, streamed chunks are viewed
+/// in place instead of being copied through the platform channel.
+///
+/// The native reference is released once the ring and all views given by
+/// [view] are garbage collected.
+class SharedPcmRing {
+  SharedPcmRing._(this._data, this._cursor);
+
+  factory SharedPcmRing.fromMap(Map<dynamic, dynamic> map) {
+    final capacity = map['capacity'] as int;
+    final release = Pointer<NativeFinalizerFunction>.fromAddress(
+      map['release'] as int,
+    );
+
+    final data = Pointer<Uint8>.fromAddress(map['data'] as int).asTypedList(
+      capacity,
+      finalizer: release,
+      token: Pointer<Void>.fromAddress(map['ring'] as int),
+    );
+
+    return SharedPcmRing._(
+      data,
+      Pointer<Uint64>.fromAddress(map['cursor'] as int),
+    );
+  }
+
+  final Uint8List _data;
+  // Native cursor of the next overwritten byte, alive as long as _data.
+  final Pointer<Uint64> _cursor;
+
+  /// Returns a view on the chunk at given location
+  /// ([position, length, sequence]) or null if it was already overwritten.
+  ///
+  /// The recorder doesn't wait for readers, the chunk may be overwritten
+  /// while the view is read. Check [isValid] once done reading, or use
+  /// [copy].
+  Uint8List? view(Int64List location) {
+    if (!isValid(location)) {
+      return null;
+    }
+
+    final capacity = _data.length;
+    final offset = location[0] % capacity;
+    return Uint8List.sublistView(_data, offset, offset + location[1]);
+  }
+
+  /// Whether the chunk at given location is not overwritten yet.
+  ///
+  /// Data read from a view before this returned true is intact.
+  bool isValid(Int64List location) {
+    return _cursor.value <= location[0] + _data.length;
+  }
+
+  /// Returns a copy of the chunk at given location, or null if it was
+  /// overwritten before or while copying.
+  Uint8List? copy(Int64List location) {
+    final chunk = view(location);
+    if (chunk == null) {
+      return null;
+    }
+
+    final copy = Uint8List.fromList(chunk);
+    return isValid(location) ? copy : null;
+  }
+}
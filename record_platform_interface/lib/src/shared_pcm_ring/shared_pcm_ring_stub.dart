@@ -0,0 +1,14 @@
+import 'dart:typed_data';
+
+/// Shared PCM ring is only available with `dart:ffi`.
+class SharedPcmRing {
+  factory SharedPcmRing.fromMap(Map<dynamic, dynamic> map) {
+    throw UnsupportedError('Zero copy stream is not supported.');
+  }
+
+  Uint8List? view(Int64List location) => null;
+
+  bool isValid(Int64List location) => false;
+
+  Uint8List? copy(Int64List location) => null;
+}
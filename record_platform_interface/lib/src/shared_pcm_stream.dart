@@ -0,0 +1,41 @@
+import 'dart:async';
+import 'dart:typed_data';
+
+import 'shared_pcm_ring/shared_pcm_ring.dart';
+
+/// Views chunks of a zero copy stream (see `RecordConfig.zeroCopyStream`).
+///
+/// [ring] describes the native ring, as returned by `startStream`, and
+/// [locations] are the native events, chunk locations in the ring.
+/// Views are given synchronously, so a chunk overwritten while the
+/// listener reads it can be reported.
+Stream<Uint8List> readSharedPcmChunks(
+  Map<dynamic, dynamic> ring,
+  Stream<dynamic> locations,
+) {
+  final sharedRing = SharedPcmRing.fromMap(ring);
+
+  return Stream.multi((controller) {
+    final subscription = locations.listen(
+      (location) {
+        final view = sharedRing.view(location);
+        if (view == null) return;
+
+        controller.addSync(view);
+
+        if (!sharedRing.isValid(location)) {
+          controller.addErrorSync(
+            StateError('Streamed chunk was overwritten while being read.'),
+          );
+        }
+      },
+      onError: controller.addErrorSync,
+      onDone: controller.closeSync,
+    );
+
+    controller
+      ..onPause = subscription.pause
+      ..onResume = subscription.resume
+      ..onCancel = subscription.cancel;
+  });
+}
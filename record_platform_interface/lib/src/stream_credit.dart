@@ -0,0 +1,38 @@
+import 'dart:async';
+
+/// Acknowledges native stream events once given to the listener.
+///
+/// Native side sends [credit] events ahead of acknowledgements, so a
+/// listener which doesn't keep up makes the native queue overflow (see
+/// `RecordConfig.streamOverflowPolicy`) instead of buffering events here.
+/// Events are acknowledged by half of [credit] with [acknowledge].
+Stream<T> acknowledgeEvents<T>(
+  Stream<T> events,
+  int credit,
+  void Function(int count) acknowledge,
+) {
+  final batch = credit > 1 ? credit ~/ 2 : 1;
+
+  return Stream.multi((controller) {
+    var consumed = 0;
+
+    final subscription = events.listen(
+      (event) {
+        // Given synchronously, so it is counted once handled by the listener.
+        controller.addSync(event);
+
+        if (++consumed >= batch) {
+          acknowledge(consumed);
+          consumed = 0;
+        }
+      },
+      onError: controller.addErrorSync,
+      onDone: controller.closeSync,
+    );
+
+    controller
+      ..onPause = subscription.pause
+      ..onResume = subscription.resume
+      ..onCancel = subscription.cancel;
+  });
+}
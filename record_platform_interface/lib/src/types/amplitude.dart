@@ -1,10 +1,73 @@
 /// dBFS amplitude
 class Amplitude {
-  Amplitude({required this.current, required this.max});
+  Amplitude({
+    required this.current,
+    required this.max,
+    this.rms,
+    this.clipCount,
+    this.channels = const [],
+  });
 
   /// Current max amplitude
   final double current;
 
   /// Top max amplitude
   final double max;
+
+  /// Current RMS amplitude over all channels.
+  ///
+  /// Platforms: Windows & Linux.
+  final double? rms;
+
+  /// Number of samples which reached full scale since recording started.
+  ///
+  /// Platforms: Windows & Linux.
+  final int? clipCount;
+
+  /// Per channel amplitudes in channel order.
+  ///
+  /// Empty when not available.
+  ///
+  /// Platforms: Windows & Linux.
+  final List<ChannelAmplitude> channels;
+
+  factory Amplitude.fromMap(Map map) => Amplitude(
+        current: map['current'] ?? 0.0,
+        max: map['max'] ?? 0.0,
+        rms: map['rms'],
+        clipCount: (map['clipCount'] as num?)?.toInt(),
+        channels: (map['channels'] as List?)
+                ?.map((c) => ChannelAmplitude.fromMap(c as Map))
+                .toList(growable: false) ??
+            const [],
+      );
+}
+
+/// dBFS amplitude of a single channel.
+class ChannelAmplitude {
+  const ChannelAmplitude({
+    required this.peak,
+    required this.rms,
+    required this.truePeak,
+    required this.peakHold,
+  });
+
+  /// Current sample peak
+  final double peak;
+
+  /// Current RMS amplitude
+  final double rms;
+
+  /// Current true peak (4x oversampled, ITU-R BS.1770)
+  final double truePeak;
+
+  /// Peak held for a short time before decaying.
+  final double peakHold;
+
+  factory ChannelAmplitude.fromMap(Map map) => ChannelAmplitude(
+        peak: map['peak'] ?? 0.0,
+        rms: map['rms'] ?? 0.0,
+        truePeak: map['truePeak'] ?? 0.0,
+        peakHold: map['peakHold'] ?? 0.0,
+      );
 }
@@ -0,0 +1,31 @@
+/// Capture delays measured while recording.
+class CaptureLatency {
+  const CaptureLatency({
+    this.latency,
+    required this.period,
+  });
+
+  /// Age of captured audio when the platform delivers it to the recorder
+  /// (device period and buffering), if known.
+  final Duration? latency;
+
+  /// Mean duration of audio delivered at once, the actual capture period.
+  final Duration period;
+
+  factory CaptureLatency.fromMap(Map map) {
+    final latency = map['latency'] as int?;
+
+    return CaptureLatency(
+      latency: latency != null ? Duration(microseconds: latency) : null,
+      period: Duration(microseconds: map['period'] ?? 0),
+    );
+  }
+
+  @override
+  String toString() {
+    return '''
+      latency: $latency
+      period: $period
+      ''';
+  }
+}
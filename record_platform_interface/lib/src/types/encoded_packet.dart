@@ -0,0 +1,63 @@
+import 'dart:typed_data';
+
+import 'sample_format.dart';
+
+/// Audio packet of a stream, as produced by the encoder.
+///
+/// Each packet can be given as is to a decoder or a muxer.
+class EncodedPacket {
+  const EncodedPacket({
+    required this.data,
+    required this.timestamp,
+    required this.duration,
+    this.isConfig = false,
+  });
+
+  /// Packet bytes.
+  final Uint8List data;
+
+  /// Time of the first sample of the packet, from the start of the recording.
+  final Duration timestamp;
+
+  /// Audio duration of the packet.
+  final Duration duration;
+
+  /// Decoder setup data (e.g. AAC AudioSpecificConfig) instead of audio.
+  ///
+  /// When available, it is the first packet of the stream.
+  final bool isConfig;
+
+  /// Packet from a native `[data, timestamp, duration]` event.
+  /// Times are in microseconds.
+  factory EncodedPacket.fromList(List<dynamic> list) => EncodedPacket(
+        data: list[0] as Uint8List,
+        timestamp: Duration(microseconds: list[1] as int),
+        duration: Duration(microseconds: list[2] as int),
+      );
+
+  /// Wraps PCM chunks as packets, timing is given by their size.
+  static Stream<EncodedPacket> fromPcmStream(
+    Stream<Uint8List> stream, {
+    required int sampleRate,
+    required int numChannels,
+    SampleFormat sampleFormat = SampleFormat.s16,
+  }) {
+    final frameBytes = sampleFormat.bytesPerSample * numChannels;
+    var frames = 0;
+
+    Duration time(int frames) => Duration(
+          microseconds: frames * Duration.microsecondsPerSecond ~/ sampleRate,
+        );
+
+    return stream.map((data) {
+      final start = frames;
+      frames += data.lengthInBytes ~/ frameBytes;
+
+      return EncodedPacket(
+        data: data,
+        timestamp: time(start),
+        duration: time(frames) - time(start),
+      );
+    });
+  }
+}
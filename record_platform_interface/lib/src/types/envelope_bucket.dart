@@ -0,0 +1,34 @@
+import 'dart:typed_data';
+
+/// Waveform envelope of a time slice, all channels mixed.
+///
+/// Values are normalized in [-1, 1].
+class EnvelopeBucket {
+  const EnvelopeBucket({
+    required this.min,
+    required this.max,
+    required this.rms,
+  });
+
+  /// Lowest sample value
+  final double min;
+
+  /// Highest sample value
+  final double max;
+
+  /// Root mean square value
+  final double rms;
+
+  /// Splits packed [min, max, rms] triplets into buckets.
+  static List<EnvelopeBucket> fromFloat32List(Float32List data) {
+    return List.generate(
+      data.length ~/ 3,
+      (i) => EnvelopeBucket(
+        min: data[i * 3],
+        max: data[i * 3 + 1],
+        rms: data[i * 3 + 2],
+      ),
+      growable: false,
+    );
+  }
+}
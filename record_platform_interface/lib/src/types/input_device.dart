@@ -1,3 +1,5 @@
+import 'sample_format.dart';
+
 class InputDevice {
   /// The ID used to select the device on the platform.
   final String id;
@@ -5,19 +7,73 @@ class InputDevice {
   /// The label text representation.
   final String label;
 
+  /// Native sample rate of the device.
+  ///
+  /// Platforms: Linux.
+  final int? sampleRate;
+
+  /// Native channel count of the device.
+  ///
+  /// Platforms: Linux.
+  final int? numChannels;
+
+  /// Native sample format of the device, when it is a [SampleFormat].
+  ///
+  /// Platforms: Linux.
+  final SampleFormat? sampleFormat;
+
+  /// Current latency of the device.
+  ///
+  /// Platforms: Linux.
+  final Duration? latency;
+
+  /// Whether the device captures an output (e.g. a monitor source).
+  ///
+  /// Platforms: Linux.
+  final bool isMonitor;
+
+  /// Whether the device is the current default input of the platform.
+  ///
+  /// Platforms: Linux & Windows.
+  final bool isDefault;
+
   const InputDevice({
     required this.id,
     required this.label,
+    this.sampleRate,
+    this.numChannels,
+    this.sampleFormat,
+    this.latency,
+    this.isMonitor = false,
+    this.isDefault = false,
   });
 
-  factory InputDevice.fromMap(Map map) => InputDevice(
-        id: map['id'],
-        label: map['label'],
-      );
+  factory InputDevice.fromMap(Map map) {
+    final sampleFormat = map['sampleFormat'] as int?;
+    final latency = map['latency'] as int?;
+
+    return InputDevice(
+      id: map['id'],
+      label: map['label'],
+      sampleRate: map['sampleRate'],
+      numChannels: map['numChannels'],
+      sampleFormat:
+          sampleFormat != null ? SampleFormat.values[sampleFormat] : null,
+      latency: latency != null ? Duration(microseconds: latency) : null,
+      isMonitor: map['isMonitor'] ?? false,
+      isDefault: map['isDefault'] ?? false,
+    );
+  }
 
   Map<String, dynamic> toMap() => {
         'id': id,
         'label': label,
+        if (sampleRate != null) 'sampleRate': sampleRate,
+        if (numChannels != null) 'numChannels': numChannels,
+        if (sampleFormat != null) 'sampleFormat': sampleFormat!.index,
+        if (latency != null) 'latency': latency!.inMicroseconds,
+        'isMonitor': isMonitor,
+        'isDefault': isDefault,
       };
 
   @override
@@ -25,6 +81,12 @@ class InputDevice {
     return '''
       id: $id
       label: $label
+      sampleRate: $sampleRate
+      numChannels: $numChannels
+      sampleFormat: $sampleFormat
+      latency: $latency
+      isMonitor: $isMonitor
+      isDefault: $isDefault
       ''';
   }
 
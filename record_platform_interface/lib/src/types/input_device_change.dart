@@ -0,0 +1,46 @@
+import 'input_device.dart';
+
+/// Changes of available input devices.
+class InputDeviceChange {
+  /// Devices plugged or created since last change.
+  final List<InputDevice> added;
+
+  /// Devices unplugged or removed since last change.
+  final List<InputDevice> removed;
+
+  /// Whether the default input device changed.
+  final bool defaultChanged;
+
+  /// The ID of the current default input device, if any.
+  final String? defaultDeviceId;
+
+  const InputDeviceChange({
+    this.added = const [],
+    this.removed = const [],
+    this.defaultChanged = false,
+    this.defaultDeviceId,
+  });
+
+  factory InputDeviceChange.fromMap(Map map) {
+    List<InputDevice> devices(dynamic list) => (list as List? ?? [])
+        .map((device) => InputDevice.fromMap(device as Map))
+        .toList();
+
+    return InputDeviceChange(
+      added: devices(map['added']),
+      removed: devices(map['removed']),
+      defaultChanged: map['defaultChanged'] ?? false,
+      defaultDeviceId: map['defaultDeviceId'],
+    );
+  }
+
+  @override
+  String toString() {
+    return '''
+      added: $added
+      removed: $removed
+      defaultChanged: $defaultChanged
+      defaultDeviceId: $defaultDeviceId
+      ''';
+  }
+}
@@ -0,0 +1,28 @@
+/// Loudness measurements (ITU-R BS.1770 / EBU R128).
+class Loudness {
+  const Loudness({
+    required this.momentary,
+    required this.shortTerm,
+    required this.integrated,
+    required this.range,
+  });
+
+  /// Loudness of the last 400ms (LUFS)
+  final double momentary;
+
+  /// Loudness of the last 3s (LUFS)
+  final double shortTerm;
+
+  /// Gated loudness of the whole recording (LUFS)
+  final double integrated;
+
+  /// Loudness range of the whole recording (LU)
+  final double range;
+
+  factory Loudness.fromMap(Map map) => Loudness(
+        momentary: map['momentary'] ?? -160.0,
+        shortTerm: map['shortTerm'] ?? -160.0,
+        integrated: map['integrated'] ?? -160.0,
+        range: map['range'] ?? 0.0,
+      );
+}
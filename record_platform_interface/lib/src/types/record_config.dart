@@ -72,9 +72,96 @@ class RecordConfig {
   ///
   /// Underlying implementations may adjust to other value or throw exception if under miminum size required.
   ///
-  /// Platforms: Android, iOS, macOS & web.
+  /// On Windows and Linux, this is the size in bytes of each streamed chunk.
+  /// Captured audio is gathered until it is reached so fewer, larger events
+  /// are sent. Remaining audio is sent on stop.
+  ///
+  /// Platforms: Android, iOS, Linux, macOS, web & Windows.
   final int? streamBufferSize;
 
+  /// Longest time captured audio waits for its [streamBufferSize] chunk.
+  ///
+  /// Once reached, the incomplete chunk is sent with the next captured
+  /// audio. Not limited by default.
+  ///
+  /// Platforms: Linux & Windows.
+  final Duration? streamMaxDelay;
+
+  /// Duration of each waveform envelope bucket.
+  ///
+  /// When set, min/max/RMS buckets are computed natively and delivered by
+  /// `onEnvelope`, for both file and stream recordings.
+  /// Durations under 5ms are raised to 5ms.
+  ///
+  /// Platforms: Linux & Windows.
+  final Duration? envelopeInterval;
+
+  /// Spectrum analysis settings.
+  ///
+  /// When set, band magnitudes are computed natively and delivered by
+  /// `onSpectrum`, for both file and stream recordings.
+  ///
+  /// Platforms: Linux & Windows.
+  final SpectrumConfig? spectrum;
+
+  /// Voice activity detection settings.
+  ///
+  /// When set, activity changes are delivered by `onVoiceActivity` and
+  /// silent audio may be skipped, for both file and stream recordings.
+  ///
+  /// Platforms: Linux & Windows.
+  final VadConfig? vad;
+
+  /// Streamed audio is written by the recorder to native memory shared
+  /// with Dart, chunks are given as views on it instead of being copied
+  /// through the platform channel.
+  ///
+  /// A chunk is valid until about 2 seconds of audio are recorded after it,
+  /// read or copy it from the stream listener.
+  /// Chunks overwritten before being delivered are skipped. A chunk
+  /// overwritten while the listener reads it is followed by a [StateError]
+  /// on the stream.
+  ///
+  /// Platforms: Linux & Windows (PCM streams). Ignored on other platforms,
+  /// chunks are copied.
+  final bool zeroCopyStream;
+
+  /// Behaviour when streamed audio is not consumed fast enough.
+  ///
+  /// Platforms: Linux & Windows.
+  final StreamOverflowPolicy streamOverflowPolicy;
+
+  /// PCM sample format of [AudioEncoder.pcm16bits] and [AudioEncoder.wav].
+  ///
+  /// Audio is captured in this format, so no conversion is needed to get
+  /// e.g. float samples. Other encoders always use [SampleFormat.s16].
+  ///
+  /// Platforms: Windows & Linux.
+  final SampleFormat sampleFormat;
+
+  /// Requested capture period, from 5ms to 200ms.
+  ///
+  /// Lower values reduce the time to first sample and the duration of each
+  /// captured buffer, at the cost of more wakeups.
+  /// Use `getLatency` to get the achieved values.
+  ///
+  /// On Linux, this is the fragment size of the sound server (100ms when
+  /// null).
+  /// On Windows, low latency processing of Media Foundation is requested
+  /// when set, the period is chosen by the device.
+  ///
+  /// Platforms: Linux & Windows.
+  final Duration? latency;
+
+  /// Capture buffer size, in periods of [latency], from 2 to 32 (4 when
+  /// null).
+  ///
+  /// More periods tolerate longer stalls of the app before audio is lost,
+  /// at the cost of memory.
+  ///
+  /// Platforms: Linux (ALSA devices, sound servers choose their own buffer).
+  final int? bufferPeriods;
+
   const RecordConfig({
     this.encoder = AudioEncoder.aacLc,
     this.bitRate = 128000,
@@ -88,6 +175,15 @@ class RecordConfig {
     this.iosConfig = const IosRecordConfig(),
     this.audioInterruption = AudioInterruptionMode.pause,
     this.streamBufferSize,
+    this.streamMaxDelay,
+    this.envelopeInterval,
+    this.spectrum,
+    this.vad,
+    this.zeroCopyStream = false,
+    this.streamOverflowPolicy = StreamOverflowPolicy.dropNewest,
+    this.sampleFormat = SampleFormat.s16,
+    this.latency,
+    this.bufferPeriods,
   });
 
   Map<String, dynamic> toMap() {
@@ -104,6 +200,15 @@ class RecordConfig {
       'iosConfig': iosConfig.toMap(),
       'audioInterruption': audioInterruption.index,
       'streamBufferSize': streamBufferSize,
+      'streamMaxDelay': streamMaxDelay?.inMilliseconds,
+      'envelopeInterval': envelopeInterval?.inMilliseconds,
+      'spectrum': spectrum?.toMap(),
+      'vad': vad?.toMap(),
+      'zeroCopyStream': zeroCopyStream,
+      'streamOverflowPolicy': streamOverflowPolicy.index,
+      'sampleFormat': sampleFormat.index,
+      'latency': latency?.inMilliseconds,
+      'bufferPeriods': bufferPeriods,
     };
   }
 }
@@ -0,0 +1,19 @@
+/// PCM sample format, interleaved little endian.
+enum SampleFormat {
+  /// Signed 16 bits.
+  s16(2),
+
+  /// Signed 24 bits, packed on 3 bytes.
+  s24(3),
+
+  /// Signed 32 bits.
+  s32(4),
+
+  /// Float 32 bits, full scale is [-1, 1].
+  f32(4);
+
+  const SampleFormat(this.bytesPerSample);
+
+  /// Size of a sample of a single channel.
+  final int bytesPerSample;
+}
@@ -0,0 +1,42 @@
+/// Native spectrum analysis configuration.
+///
+/// Each frame is a list of [numBands] log spaced band magnitudes in dBFS,
+/// from [minFrequency] to half of the sample rate.
+class SpectrumConfig {
+  /// FFT size in samples, rounded to a power of 2 between 64 and 16384.
+  final int fftSize;
+
+  /// Samples between two analyzed frames.
+  ///
+  /// Defaults to half of [fftSize] when null.
+  final int? hopSize;
+
+  /// Number of log spaced bands.
+  final int numBands;
+
+  /// Lowest band frequency in Hz.
+  final double minFrequency;
+
+  /// Maximum number of frames per second.
+  ///
+  /// Frames above this rate are not computed.
+  final double maxFrameRate;
+
+  const SpectrumConfig({
+    this.fftSize = 2048,
+    this.hopSize,
+    this.numBands = 32,
+    this.minFrequency = 20.0,
+    this.maxFrameRate = 30.0,
+  });
+
+  Map<String, dynamic> toMap() {
+    return {
+      'fftSize': fftSize,
+      'hopSize': hopSize,
+      'numBands': numBands,
+      'minFrequency': minFrequency,
+      'maxFrameRate': maxFrameRate,
+    };
+  }
+}
@@ -0,0 +1,22 @@
+/// Behaviour when streamed audio is produced faster than it is consumed.
+///
+/// Native memory used by the stream queue is bounded whatever the policy.
+/// Chunks are sent a few ahead of the ones handled by the stream listener,
+/// the queue overflows when the listener doesn't keep up.
+enum StreamOverflowPolicy {
+  /// Capture waits for the consumer, overflowing audio is then gathered up
+  /// to 1s like [coalesce].
+  ///
+  /// Audio may be lost by the device itself if the consumer stalls for long.
+  block,
+
+  /// Overflowing audio is gathered up to 1s, the oldest audio is dropped.
+  dropOldest,
+
+  /// Overflowing audio is dropped.
+  dropNewest,
+
+  /// Overflowing audio is gathered up to 1s and sent as a single chunk,
+  /// new audio is dropped beyond.
+  coalesce,
+}
@@ -0,0 +1,41 @@
+/// Stream delivery counters of the current or last recording.
+class StreamStats {
+  const StreamStats({
+    required this.droppedBytes,
+    required this.droppedChunks,
+    required this.queuedChunks,
+    this.dispatchQueueDepth = 0,
+    this.dispatchLatency = Duration.zero,
+    this.maxDispatchLatency = Duration.zero,
+  });
+
+  /// Bytes dropped because the consumer didn't keep up.
+  final int droppedBytes;
+
+  /// Number of drop events.
+  final int droppedChunks;
+
+  /// Chunks waiting to be sent.
+  final int queuedChunks;
+
+  /// Native tasks waiting for the platform thread, all recorders included.
+  final int dispatchQueueDepth;
+
+  /// Mean delay for native tasks to reach the platform thread.
+  final Duration dispatchLatency;
+
+  /// Highest delay for native tasks to reach the platform thread.
+  final Duration maxDispatchLatency;
+
+  factory StreamStats.fromMap(Map map) => StreamStats(
+        droppedBytes: map['droppedBytes'] ?? 0,
+        droppedChunks: map['droppedChunks'] ?? 0,
+        queuedChunks: map['queuedChunks'] ?? 0,
+        dispatchQueueDepth: map['dispatchQueueDepth'] ?? 0,
+        dispatchLatency: _microseconds(map['dispatchLatency']),
+        maxDispatchLatency: _microseconds(map['maxDispatchLatency']),
+      );
+
+  static Duration _microseconds(num? value) =>
+      Duration(microseconds: value?.round() ?? 0);
+}
@@ -2,8 +2,18 @@ export 'amplitude.dart';
 export 'android_record_config.dart';
 export 'audio_encoder.dart';
 export 'audio_interruption_mode.dart';
+export 'capture_latency.dart';
+export 'encoded_packet.dart';
+export 'envelope_bucket.dart';
 export 'input_device.dart';
+export 'input_device_change.dart';
 export 'ios_audio_session.dart';
 export 'ios_record_config.dart';
+export 'loudness.dart';
 export 'record_config.dart';
 export 'record_state.dart';
+export 'sample_format.dart';
+export 'spectrum_config.dart';
+export 'stream_overflow_policy.dart';
+export 'stream_stats.dart';
+export 'vad_config.dart';
@@ -0,0 +1,42 @@
+/// Voice activity detection behaviour.
+enum VadMode {
+  /// Voice activity is detected and reported, all audio is recorded.
+  flag,
+
+  /// Silent blocks are dropped from file and stream outputs.
+  skip,
+}
+
+/// Native voice activity detection configuration.
+class VadConfig {
+  /// Detection behaviour.
+  final VadMode mode;
+
+  /// Energy above the estimated noise floor for audio to be voiced, in dB.
+  final double threshold;
+
+  /// Audio under this energy is never voiced, in dBFS.
+  final double minEnergy;
+
+  /// Activity duration kept after the last voiced audio.
+  ///
+  /// Avoids cutting word endings and short pauses.
+  final Duration hangover;
+
+  const VadConfig({
+    this.mode = VadMode.flag,
+    this.threshold = 12.0,
+    this.minEnergy = -55.0,
+    this.hangover = const Duration(milliseconds: 300),
+  });
+
+  Map<String, dynamic> toMap() {
+    return {
+      // Index 0 is reserved to disabled detection.
+      'mode': mode.index + 1,
+      'threshold': threshold,
+      'minEnergy': minEnergy,
+      'hangover': hangover.inMilliseconds,
+    };
+  }
+}
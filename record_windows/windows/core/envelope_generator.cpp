@@ -0,0 +1,41 @@
+#include "envelope_generator.h"
+
+namespace record_core
+{
+	void EnvelopeGenerator::Configure(int sampleRate, int numChannels, int intervalMs)
+	{
+		m_frameStride = std::max(1, numChannels);
+
+		if (intervalMs <= 0 || sampleRate <= 0)
+		{
+			m_bucketFrames = 0;
+		}
+		else
+		{
+			intervalMs = std::max(kMinEnvelopeIntervalMs, intervalMs);
+			m_bucketFrames = std::max<size_t>(1, static_cast<size_t>(sampleRate) * intervalMs / 1000);
+		}
+
+		Reset();
+	}
+
+	void EnvelopeGenerator::Reset()
+	{
+		m_min = INT16_MAX;
+		m_max = INT16_MIN;
+		m_sumSquares = 0;
+		m_sampleCount = 0;
+	}
+
+	EnvelopeBucket EnvelopeGenerator::TakeBucket()
+	{
+		EnvelopeBucket bucket;
+		bucket.min = m_min / 32768.0f;
+		bucket.max = m_max / 32768.0f;
+		bucket.rms = static_cast<float>(std::sqrt(static_cast<double>(m_sumSquares) / m_sampleCount) / 32768.0);
+
+		Reset();
+
+		return bucket;
+	}
+};
@@ -0,0 +1,288 @@
+#include "loudness_meter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace record_core
+{
+	static constexpr double kPi = 3.14159265358979323846;
+
+	// Absolute gate and histograms lowest value.
+	static constexpr double kAbsoluteGate = -70.0;
+	// Relative gate of integrated loudness.
+	static constexpr double kIntegratedGate = -10.0;
+	// Relative gate of loudness range.
+	static constexpr double kRangeGate = -20.0;
+	// Histograms resolution.
+	static constexpr double kBinsPerLu = 10.0;
+
+	static double EnergyToLufs(double energy)
+	{
+		if (energy <= 0.0)
+		{
+			return kMinLufs;
+		}
+
+		return std::max(kMinLufs, -0.691 + 10 * std::log10(energy));
+	}
+
+	static double BinLufs(int bin)
+	{
+		return kAbsoluteGate + (bin + 0.5) / kBinsPerLu;
+	}
+
+	// Channel weights as defined by ITU-R BS.1770-4, assuming WAVE channels order
+	// (L, R, C, LFE, surrounds...) for 5.1 layouts and above.
+	static double ChannelWeight(int channel, int numChannels)
+	{
+		if (numChannels < 6 || channel < 3)
+		{
+			return 1.0;
+		}
+
+		return channel == 3 ? 0.0 : 1.41;
+	}
+
+	void LoudnessMeter::Histogram::Add(double blockEnergy)
+	{
+		const double lufs = EnergyToLufs(blockEnergy);
+		if (lufs < kAbsoluteGate)
+		{
+			return;
+		}
+
+		const int bin = std::min(kHistogramBins - 1, static_cast<int>((lufs - kAbsoluteGate) * kBinsPerLu));
+
+		counts[bin]++;
+		energies[bin] += blockEnergy;
+		count++;
+		energy += blockEnergy;
+	}
+
+	void LoudnessMeter::Histogram::Clear()
+	{
+		counts.fill(0);
+		energies.fill(0.0);
+		count = 0;
+		energy = 0.0;
+	}
+
+	void LoudnessMeter::Configure(int sampleRate, int numChannels)
+	{
+		const double rate = std::max(1, sampleRate);
+
+		m_frameStride = std::max(1, numChannels);
+		m_numChannels = std::min(m_frameStride, kMaxMeterChannels);
+		m_stepFrames = std::max<size_t>(1, static_cast<size_t>(std::lround(rate / 10)));
+
+		// K-weighting pre-filter (high shelf), coefficients adapted to the sample rate.
+		{
+			const double f0 = 1681.974450955533;
+			const double gain = 3.999843853973347;
+			const double q = 0.7071752369554196;
+
+			const double k = std::tan(kPi * f0 / rate);
+			const double vh = std::pow(10.0, gain / 20.0);
+			const double vb = std::pow(vh, 0.4996667741545416);
+			const double a0 = 1.0 + k / q + k * k;
+
+			m_shelf.b0 = (vh + vb * k / q + k * k) / a0;
+			m_shelf.b1 = 2.0 * (k * k - vh) / a0;
+			m_shelf.b2 = (vh - vb * k / q + k * k) / a0;
+			m_shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+			m_shelf.a2 = (1.0 - k / q + k * k) / a0;
+		}
+
+		// K-weighting RLB high pass filter.
+		{
+			const double f0 = 38.13547087602444;
+			const double q = 0.5003270373238773;
+
+			const double k = std::tan(kPi * f0 / rate);
+			const double a0 = 1.0 + k / q + k * k;
+
+			m_highPass.b0 = 1.0;
+			m_highPass.b1 = -2.0;
+			m_highPass.b2 = 1.0;
+			m_highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+			m_highPass.a2 = (1.0 - k / q + k * k) / a0;
+		}
+
+		Reset();
+	}
+
+	void LoudnessMeter::Reset()
+	{
+		m_channels.fill(ChannelState());
+		for (int ch = 0; ch < m_numChannels; ch++)
+		{
+			m_channels[ch].weight = ChannelWeight(ch, m_frameStride);
+		}
+
+		m_stepPosition = 0;
+		m_stepEnergies.fill(0.0);
+		m_stepCount = 0;
+
+		m_blocks.Clear();
+		m_shortTermBlocks.Clear();
+	}
+
+	void LoudnessMeter::Process(const int16_t* samples, size_t frameCount)
+	{
+		size_t frame = 0;
+
+		while (frame < frameCount)
+		{
+			const size_t frames = std::min(frameCount - frame, m_stepFrames - m_stepPosition);
+
+			for (int ch = 0; ch < m_numChannels; ch++)
+			{
+				auto& state = m_channels[ch];
+				const int16_t* input = samples + frame * m_frameStride + ch;
+
+				double shelf1 = state.shelf1, shelf2 = state.shelf2;
+				double highPass1 = state.highPass1, highPass2 = state.highPass2;
+				double sumSquares = state.sumSquares;
+
+				for (size_t i = 0; i < frames; i++)
+				{
+					const double x = input[i * m_frameStride] / 32768.0;
+
+					const double y = m_shelf.b0 * x + shelf1;
+					shelf1 = m_shelf.b1 * x - m_shelf.a1 * y + shelf2;
+					shelf2 = m_shelf.b2 * x - m_shelf.a2 * y;
+
+					const double z = m_highPass.b0 * y + highPass1;
+					highPass1 = m_highPass.b1 * y - m_highPass.a1 * z + highPass2;
+					highPass2 = m_highPass.b2 * y - m_highPass.a2 * z;
+
+					sumSquares += z * z;
+				}
+
+				state.shelf1 = shelf1;
+				state.shelf2 = shelf2;
+				state.highPass1 = highPass1;
+				state.highPass2 = highPass2;
+				state.sumSquares = sumSquares;
+			}
+
+			frame += frames;
+			m_stepPosition += frames;
+
+			if (m_stepPosition == m_stepFrames)
+			{
+				EndStep();
+			}
+		}
+	}
+
+	void LoudnessMeter::EndStep()
+	{
+		double energy = 0.0;
+
+		for (int ch = 0; ch < m_numChannels; ch++)
+		{
+			auto& state = m_channels[ch];
+			energy += state.weight * state.sumSquares / m_stepFrames;
+			state.sumSquares = 0.0;
+		}
+
+		m_stepEnergies[m_stepCount % kShortTermSteps] = energy;
+		m_stepCount++;
+		m_stepPosition = 0;
+
+		// Gating blocks of 400ms with 75% overlap.
+		if (m_stepCount >= kMomentarySteps)
+		{
+			m_blocks.Add(WindowEnergy(kMomentarySteps));
+		}
+		// Short-term blocks of 3s at 10Hz for loudness range.
+		if (m_stepCount >= kShortTermSteps)
+		{
+			m_shortTermBlocks.Add(WindowEnergy(kShortTermSteps));
+		}
+	}
+
+	double LoudnessMeter::WindowEnergy(int steps) const
+	{
+		double energy = 0.0;
+
+		for (int i = 1; i <= steps; i++)
+		{
+			energy += m_stepEnergies[(m_stepCount - i) % kShortTermSteps];
+		}
+
+		return energy / steps;
+	}
+
+	LoudnessLevels LoudnessMeter::GetLevels() const
+	{
+		LoudnessLevels levels;
+
+		if (m_stepCount >= kMomentarySteps)
+		{
+			levels.momentary = EnergyToLufs(WindowEnergy(kMomentarySteps));
+		}
+		if (m_stepCount >= kShortTermSteps)
+		{
+			levels.shortTerm = EnergyToLufs(WindowEnergy(kShortTermSteps));
+		}
+
+		if (m_blocks.count != 0)
+		{
+			const double gate = EnergyToLufs(m_blocks.energy / m_blocks.count) + kIntegratedGate;
+
+			uint64_t count = 0;
+			double energy = 0.0;
+			for (int bin = 0; bin < kHistogramBins; bin++)
+			{
+				if (BinLufs(bin) >= gate)
+				{
+					count += m_blocks.counts[bin];
+					energy += m_blocks.energies[bin];
+				}
+			}
+
+			if (count != 0)
+			{
+				levels.integrated = EnergyToLufs(energy / count);
+			}
+		}
+
+		if (m_shortTermBlocks.count != 0)
+		{
+			const double gate = EnergyToLufs(m_shortTermBlocks.energy / m_shortTermBlocks.count) + kRangeGate;
+
+			int firstBin = 0;
+			uint64_t count = 0;
+			for (int bin = kHistogramBins - 1; bin >= 0 && BinLufs(bin) >= gate; bin--)
+			{
+				count += m_shortTermBlocks.counts[bin];
+				firstBin = bin;
+			}
+
+			if (count != 0)
+			{
+				// 10th and 95th percentiles (EBU Tech 3342).
+				const uint64_t lowRank = static_cast<uint64_t>((count - 1) * 0.10 + 0.5);
+				const uint64_t highRank = static_cast<uint64_t>((count - 1) * 0.95 + 0.5);
+
+				int lowBin = firstBin, highBin = firstBin;
+				uint64_t rank = 0;
+				for (int bin = firstBin; bin < kHistogramBins; bin++)
+				{
+					const uint64_t binCount = m_shortTermBlocks.counts[bin];
+					if (binCount == 0) continue;
+
+					if (rank <= lowRank && lowRank < rank + binCount) lowBin = bin;
+					if (rank <= highRank && highRank < rank + binCount) highBin = bin;
+					rank += binCount;
+				}
+
+				levels.range = BinLufs(highBin) - BinLufs(lowBin);
+			}
+		}
+
+		return levels;
+	}
+};
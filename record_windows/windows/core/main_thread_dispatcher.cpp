@@ -0,0 +1,119 @@
+#include "main_thread_dispatcher.h"
+
+#include <algorithm>
+
+namespace record_core
+{
+	// Initial task slots, grown if needed.
+	static constexpr size_t kInitialSlots = 256;
+
+	MainThreadDispatcher::MainThreadDispatcher()
+	{
+		m_pending.reserve(kInitialSlots);
+		m_running.reserve(kInitialSlots);
+	}
+
+	void MainThreadDispatcher::SetWakeup(WakeupFunction wakeup, void* context)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_wakeup = wakeup;
+		m_wakeupContext = context;
+	}
+
+	void MainThreadDispatcher::Enqueue(MainThreadTask&& task)
+	{
+		bool wakeup = false;
+		WakeupFunction wakeupFunction;
+		void* wakeupContext;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending.push_back(Slot{ std::move(task), Clock::now() });
+
+			const size_t depth = m_queueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+			if (depth > m_maxQueueDepth.load(std::memory_order_relaxed))
+			{
+				m_maxQueueDepth.store(depth, std::memory_order_relaxed);
+			}
+
+			if (!m_wakeupPending)
+			{
+				m_wakeupPending = true;
+				wakeup = true;
+			}
+			wakeupFunction = m_wakeup;
+			wakeupContext = m_wakeupContext;
+		}
+
+		// Wake up outside of the lock, the adapter may be slow (e.g. PostMessage).
+		if (wakeup && wakeupFunction)
+		{
+			wakeupFunction(wakeupContext);
+		}
+	}
+
+	size_t MainThreadDispatcher::Drain()
+	{
+		size_t count = 0;
+		m_wakeups.fetch_add(1, std::memory_order_relaxed);
+
+		for (;;)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_pending.empty())
+				{
+					m_wakeupPending = false;
+					break;
+				}
+				std::swap(m_pending, m_running);
+			}
+
+			const auto now = Clock::now();
+			uint64_t totalLatencyUs = 0;
+			uint64_t maxLatencyUs = 0;
+
+			for (auto& slot : m_running)
+			{
+				const auto latencyUs = static_cast<uint64_t>(
+					std::chrono::duration_cast<std::chrono::microseconds>(now - slot.posted).count());
+				totalLatencyUs += latencyUs;
+				maxLatencyUs = std::max(maxLatencyUs, latencyUs);
+
+				m_queueDepth.fetch_sub(1, std::memory_order_relaxed);
+				slot.task();
+				slot.task.Reset();
+			}
+
+			count += m_running.size();
+			m_tasksRun.fetch_add(m_running.size(), std::memory_order_relaxed);
+			m_totalLatencyUs.fetch_add(totalLatencyUs, std::memory_order_relaxed);
+			if (maxLatencyUs > m_maxLatencyUs.load(std::memory_order_relaxed))
+			{
+				m_maxLatencyUs.store(maxLatencyUs, std::memory_order_relaxed);
+			}
+
+			// Keeps slots capacity.
+			m_running.clear();
+		}
+
+		return count;
+	}
+
+	DispatcherStats MainThreadDispatcher::Stats() const
+	{
+		DispatcherStats stats;
+		stats.queueDepth = m_queueDepth.load(std::memory_order_relaxed);
+		stats.maxQueueDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+		stats.tasksRun = m_tasksRun.load(std::memory_order_relaxed);
+		stats.wakeups = m_wakeups.load(std::memory_order_relaxed);
+		stats.maxLatencyUs = static_cast<double>(m_maxLatencyUs.load(std::memory_order_relaxed));
+
+		if (stats.tasksRun > 0)
+		{
+			stats.meanLatencyUs = static_cast<double>(m_totalLatencyUs.load(std::memory_order_relaxed)) / stats.tasksRun;
+		}
+
+		return stats;
+	}
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include "level_meter.h"
+#include "loudness_meter.h"
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	//////////////////////////////////////////////////////////////////////////
+	//  MeterSnapshot
+	//  Description: Meters values published by the capture thread once per
+	//               block. Trivially copyable so it can be held by SeqLock.
+	//////////////////////////////////////////////////////////////////////////
+	struct MeterSnapshot
+	{
+		// Peak of the last block in dBFS.
+		double current = kMinDbfs;
+		// Highest peak since recording started in dBFS.
+		double max = kMinDbfs;
+		// RMS of the last block in dBFS.
+		double rms = kMinDbfs;
+		// Samples at full scale since recording started.
+		uint64_t clipCount = 0;
+
+		int numChannels = 0;
+		ChannelLevels channels[kMaxMeterChannels];
+
+		LoudnessLevels loudness;
+	};
+};
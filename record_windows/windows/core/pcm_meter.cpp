@@ -0,0 +1,279 @@
+#include "pcm_meter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(RECORD_CORE_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(RECORD_CORE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define RECORD_CORE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define RECORD_CORE_TARGET(isa)
+#endif
+
+namespace record_core
+{
+	// Full scale reference for dBFS computation (16 signed bits 2^15 - 1).
+	static constexpr double kFullScale = 32767.0;
+
+	// Vector lanes can count at most this many iterations before being flushed.
+	static constexpr size_t kMaxLaneIterations = INT16_MAX;
+
+	void PcmLevels::Reset()
+	{
+		peak = 0;
+		sumSquares = 0;
+		clipCount = 0;
+		sampleCount = 0;
+	}
+
+	double PcmLevels::PeakDbfs() const
+	{
+		if (peak == 0)
+		{
+			return kMinDbfs;
+		}
+
+		return 20 * std::log10(peak / kFullScale);
+	}
+
+	double PcmLevels::RmsDbfs() const
+	{
+		if (sumSquares == 0 || sampleCount == 0)
+		{
+			return kMinDbfs;
+		}
+
+		auto rms = std::sqrt(static_cast<double>(sumSquares) / sampleCount);
+		return std::max(kMinDbfs, 20 * std::log10(rms / kFullScale));
+	}
+
+	void MeasurePcm16Scalar(const int16_t* samples, size_t count, PcmLevels& levels)
+	{
+		int32_t peak = levels.peak;
+		uint64_t sumSquares = 0;
+		uint64_t clipCount = 0;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const int32_t sample = samples[i];
+			const int32_t absSample = sample < 0 ? -sample : sample;
+
+			if (absSample > peak)
+			{
+				peak = absSample;
+			}
+			sumSquares += static_cast<uint64_t>(sample * sample);
+			clipCount += (sample == INT16_MAX || sample == INT16_MIN) ? 1 : 0;
+		}
+
+		levels.peak = peak;
+		levels.sumSquares += sumSquares;
+		levels.clipCount += clipCount;
+		levels.sampleCount += count;
+	}
+
+#if defined(RECORD_CORE_X86)
+	template <typename T, size_t N>
+	static T HorizontalSum(const T(&values)[N])
+	{
+		T sum = 0;
+		for (size_t i = 0; i < N; i++) sum += values[i];
+		return sum;
+	}
+
+	// Peak is the highest of max and -min so -32768 doesn't overflow.
+	template <size_t N>
+	static int32_t HorizontalPeak(const int16_t(&maxValues)[N], const int16_t(&minValues)[N])
+	{
+		int32_t peak = 0;
+		for (size_t i = 0; i < N; i++)
+		{
+			peak = std::max(peak, static_cast<int32_t>(maxValues[i]));
+			peak = std::max(peak, -static_cast<int32_t>(minValues[i]));
+		}
+		return peak;
+	}
+
+	RECORD_CORE_TARGET("sse2")
+	void MeasurePcm16Sse2(const int16_t* samples, size_t count, PcmLevels& levels)
+	{
+		constexpr size_t kLanes = 8;
+
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i ones = _mm_set1_epi16(1);
+		const __m128i fullScaleHigh = _mm_set1_epi16(INT16_MAX);
+		const __m128i fullScaleLow = _mm_set1_epi16(INT16_MIN);
+
+		__m128i maxValues = zero;
+		__m128i minValues = zero;
+		__m128i squares = zero;
+		uint64_t clipCount = 0;
+
+		size_t i = 0;
+		while (i + kLanes <= count)
+		{
+			const size_t blockEnd = std::min(count - (count - i) % kLanes, i + kLanes * kMaxLaneIterations);
+			__m128i clips = zero;
+
+			for (; i < blockEnd; i += kLanes)
+			{
+				const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+
+				maxValues = _mm_max_epi16(maxValues, x);
+				minValues = _mm_min_epi16(minValues, x);
+
+				// Pairs of squares fit in unsigned 32 bits, widen them before accumulating.
+				const __m128i pairs = _mm_madd_epi16(x, x);
+				squares = _mm_add_epi64(squares, _mm_unpacklo_epi32(pairs, zero));
+				squares = _mm_add_epi64(squares, _mm_unpackhi_epi32(pairs, zero));
+
+				// Matching lanes are -1, so subtracting counts them.
+				const __m128i clipped = _mm_or_si128(_mm_cmpeq_epi16(x, fullScaleHigh), _mm_cmpeq_epi16(x, fullScaleLow));
+				clips = _mm_sub_epi16(clips, clipped);
+			}
+
+			int32_t clipSums[4];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(clipSums), _mm_madd_epi16(clips, ones));
+			clipCount += HorizontalSum(clipSums);
+		}
+
+		int16_t maxLanes[kLanes], minLanes[kLanes];
+		uint64_t squareLanes[2];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(maxLanes), maxValues);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(minLanes), minValues);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(squareLanes), squares);
+
+		levels.peak = std::max(levels.peak, HorizontalPeak(maxLanes, minLanes));
+		levels.sumSquares += HorizontalSum(squareLanes);
+		levels.clipCount += clipCount;
+		levels.sampleCount += i;
+
+		MeasurePcm16Scalar(samples + i, count - i, levels);
+	}
+
+	RECORD_CORE_TARGET("avx2")
+	void MeasurePcm16Avx2(const int16_t* samples, size_t count, PcmLevels& levels)
+	{
+		constexpr size_t kLanes = 16;
+
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i ones = _mm256_set1_epi16(1);
+		const __m256i fullScaleHigh = _mm256_set1_epi16(INT16_MAX);
+		const __m256i fullScaleLow = _mm256_set1_epi16(INT16_MIN);
+
+		__m256i maxValues = zero;
+		__m256i minValues = zero;
+		__m256i squares = zero;
+		uint64_t clipCount = 0;
+
+		size_t i = 0;
+		while (i + kLanes <= count)
+		{
+			const size_t blockEnd = std::min(count - (count - i) % kLanes, i + kLanes * kMaxLaneIterations);
+			__m256i clips = zero;
+
+			for (; i < blockEnd; i += kLanes)
+			{
+				const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+
+				maxValues = _mm256_max_epi16(maxValues, x);
+				minValues = _mm256_min_epi16(minValues, x);
+
+				const __m256i pairs = _mm256_madd_epi16(x, x);
+				squares = _mm256_add_epi64(squares, _mm256_unpacklo_epi32(pairs, zero));
+				squares = _mm256_add_epi64(squares, _mm256_unpackhi_epi32(pairs, zero));
+
+				const __m256i clipped = _mm256_or_si256(_mm256_cmpeq_epi16(x, fullScaleHigh), _mm256_cmpeq_epi16(x, fullScaleLow));
+				clips = _mm256_sub_epi16(clips, clipped);
+			}
+
+			int32_t clipSums[8];
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(clipSums), _mm256_madd_epi16(clips, ones));
+			clipCount += HorizontalSum(clipSums);
+		}
+
+		int16_t maxLanes[kLanes], minLanes[kLanes];
+		uint64_t squareLanes[4];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(maxLanes), maxValues);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(minLanes), minValues);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(squareLanes), squares);
+
+		levels.peak = std::max(levels.peak, HorizontalPeak(maxLanes, minLanes));
+		levels.sumSquares += HorizontalSum(squareLanes);
+		levels.clipCount += clipCount;
+		levels.sampleCount += i;
+
+		MeasurePcm16Scalar(samples + i, count - i, levels);
+	}
+
+	static bool CpuSupportsAvx2()
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		// OS must save YMM registers.
+		__cpuid(info, 1);
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	static bool CpuSupportsSse2()
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+		return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+#else
+		return __builtin_cpu_supports("sse2");
+#endif
+	}
+#endif
+
+	struct Pcm16Kernel
+	{
+		void (*measure)(const int16_t*, size_t, PcmLevels&);
+		const char* name;
+	};
+
+	static Pcm16Kernel SelectPcm16Kernel()
+	{
+#if defined(RECORD_CORE_X86)
+		if (CpuSupportsAvx2()) return { MeasurePcm16Avx2, "avx2" };
+		if (CpuSupportsSse2()) return { MeasurePcm16Sse2, "sse2" };
+#endif
+		return { MeasurePcm16Scalar, "scalar" };
+	}
+
+	static const Pcm16Kernel& GetPcm16Kernel()
+	{
+		static const Pcm16Kernel kernel = SelectPcm16Kernel();
+		return kernel;
+	}
+
+	void MeasurePcm16(const int16_t* samples, size_t count, PcmLevels& levels)
+	{
+		GetPcm16Kernel().measure(samples, count, levels);
+	}
+
+	const char* MeasurePcm16KernelName()
+	{
+		return GetPcm16Kernel().name;
+	}
+};
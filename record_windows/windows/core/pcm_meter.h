@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	// Lowest reported level in dBFS.
+	constexpr double kMinDbfs = -160.0;
+
+	//////////////////////////////////////////////////////////////////////////
+	//  PcmLevels
+	//  Description: Levels of interleaved signed 16 bits PCM samples.
+	//               Values are accumulated by MeasurePcm16 until Reset.
+	//////////////////////////////////////////////////////////////////////////
+	struct PcmLevels
+	{
+		// Highest absolute sample value [0, 32768].
+		int32_t peak = 0;
+		// Sum of squared sample values.
+		uint64_t sumSquares = 0;
+		// Number of samples at full scale (-32768 or 32767).
+		uint64_t clipCount = 0;
+		// Number of measured samples.
+		uint64_t sampleCount = 0;
+
+		void Reset();
+
+		double PeakDbfs() const;
+		double RmsDbfs() const;
+	};
+
+	// Accumulates levels of the given samples into levels.
+	//
+	// No allocation is done and samples don't need to be 16 bytes aligned.
+	// The best available kernel is selected at runtime on first call.
+	void MeasurePcm16(const int16_t* samples, size_t count, PcmLevels& levels);
+
+	// Returns the name of the kernel used by MeasurePcm16 ("avx2", "sse2" or "scalar").
+	const char* MeasurePcm16KernelName();
+
+	// Kernels, exposed to validate and benchmark them against each other.
+	// Calling an unsupported kernel on the running CPU is undefined behaviour.
+	void MeasurePcm16Scalar(const int16_t* samples, size_t count, PcmLevels& levels);
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define RECORD_CORE_X86 1
+	void MeasurePcm16Sse2(const int16_t* samples, size_t count, PcmLevels& levels);
+	void MeasurePcm16Avx2(const int16_t* samples, size_t count, PcmLevels& levels);
+#endif
+};
@@ -0,0 +1,94 @@
+#include "pcm_ring.h"
+
+#include <cstring>
+#include <new>
+
+namespace record_core
+{
+	// static
+	PcmRing* PcmRing::Create(size_t capacity)
+	{
+		if (capacity == 0)
+		{
+			return nullptr;
+		}
+
+		auto data = new (std::nothrow) uint8_t[capacity];
+		if (data == nullptr)
+		{
+			return nullptr;
+		}
+
+		auto ring = new (std::nothrow) PcmRing(data, capacity);
+		if (ring == nullptr)
+		{
+			delete[] data;
+		}
+
+		return ring;
+	}
+
+	// static
+	void PcmRing::ReleaseCallback(void* ring)
+	{
+		static_cast<PcmRing*>(ring)->Release();
+	}
+
+	PcmRing::PcmRing(uint8_t* data, size_t capacity)
+		: m_data(data),
+		m_capacity(capacity)
+	{
+	}
+
+	PcmRing::~PcmRing()
+	{
+		delete[] m_data;
+	}
+
+	void PcmRing::Retain()
+	{
+		m_refCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void PcmRing::Release()
+	{
+		if (m_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			delete this;
+		}
+	}
+
+	bool PcmRing::Write(const uint8_t* data, size_t size, PcmRingChunk& chunk)
+	{
+		if (size == 0 || size > m_capacity)
+		{
+			return false;
+		}
+
+		uint64_t position = m_writeCursor;
+		size_t offset = static_cast<size_t>(position % m_capacity);
+
+		if (offset + size > m_capacity)
+		{
+			// Skip ring end so the chunk is contiguous.
+			position += m_capacity - offset;
+			offset = 0;
+		}
+
+		// Publish before overwriting so readers of older chunks can detect it.
+		m_reservedCursor.store(position + size, std::memory_order_seq_cst);
+		std::memcpy(m_data + offset, data, size);
+		m_writeCursor = position + size;
+
+		chunk.position = position;
+		chunk.length = size;
+		chunk.sequence = m_sequence++;
+
+		return true;
+	}
+
+	bool PcmRing::IsValid(const PcmRingChunk& chunk) const
+	{
+		return m_reservedCursor.load(std::memory_order_acquire) <= chunk.position + m_capacity;
+	}
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	//////////////////////////////////////////////////////////////////////////
+	//  PcmRingChunk
+	//  Description: Location of a chunk written in a PcmRing.
+	//               Position is the absolute stream position in bytes, the
+	//               chunk starts at position % capacity in ring data.
+	//////////////////////////////////////////////////////////////////////////
+	struct PcmRingChunk
+	{
+		uint64_t position = 0;
+		uint64_t length = 0;
+		// Incremented for each written chunk.
+		uint64_t sequence = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  PcmRing
+	//  Description: Reference counted byte ring shared with a consumer
+	//               reading memory directly (e.g. Dart FFI views).
+	//               Chunks are always contiguous, the ring end is skipped
+	//               when a chunk doesn't fit.
+	//
+	//               The producer never waits on the consumer: a chunk stays
+	//               valid until `capacity` more bytes are written. Before
+	//               overwriting data, the producer publishes the reserved
+	//               cursor so consumers can check a chunk after reading it:
+	//               valid while reservedCursor <= position + capacity.
+	//
+	//  Note: Writes must be serialized by the caller.
+	//////////////////////////////////////////////////////////////////////////
+	class PcmRing
+	{
+	public:
+		// Returns a ring with a reference count of 1, or nullptr on failure.
+		static PcmRing* Create(size_t capacity);
+
+		// Releases a reference, matches Dart NativeFinalizer callbacks.
+		static void ReleaseCallback(void* ring);
+
+		PcmRing(const PcmRing&) = delete;
+		PcmRing& operator=(const PcmRing&) = delete;
+
+		void Retain();
+		void Release();
+
+		size_t Capacity() const { return m_capacity; }
+		const uint8_t* Data() const { return m_data; }
+		// Reserved cursor word, readable directly by consumers.
+		const std::atomic<uint64_t>* ReservedCursor() const { return &m_reservedCursor; }
+
+		// Copies data as a single chunk.
+		// Returns false if the chunk is empty or larger than capacity.
+		bool Write(const uint8_t* data, size_t size, PcmRingChunk& chunk);
+
+		// Checks whether a chunk was overwritten.
+		bool IsValid(const PcmRingChunk& chunk) const;
+
+	private:
+		PcmRing(uint8_t* data, size_t capacity);
+		~PcmRing();
+
+		std::atomic<uint32_t> m_refCount{ 1 };
+		std::atomic<uint64_t> m_reservedCursor{ 0 };
+		uint64_t m_writeCursor = 0;
+		uint64_t m_sequence = 0;
+		uint8_t* m_data;
+		size_t m_capacity;
+	};
+};
@@ -0,0 +1,192 @@
+#include "sample_format.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(RECORD_CORE_X86)
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(RECORD_CORE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define RECORD_CORE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define RECORD_CORE_TARGET(isa)
+#endif
+
+namespace record_core
+{
+	// Float full scale, -1 maps to INT16_MIN.
+	static constexpr float kS16Scale = 32768.0f;
+
+	size_t BytesPerSample(SampleFormat format)
+	{
+		switch (format)
+		{
+		case SampleFormat::s24:
+			return 3;
+		case SampleFormat::s32:
+		case SampleFormat::f32:
+			return 4;
+		case SampleFormat::s16:
+		default:
+			return 2;
+		}
+	}
+
+	static int16_t FloatToS16(float sample)
+	{
+		// Same clamping as SIMD min/max, NaN becomes full scale.
+		float value = sample < 1.0f ? sample : 1.0f;
+		value = value > -1.0f ? value : -1.0f;
+
+		const long rounded = std::lrint(value * kS16Scale);
+		return static_cast<int16_t>(rounded > INT16_MAX ? INT16_MAX : rounded);
+	}
+
+	void ConvertToS16Scalar(const uint8_t* src, SampleFormat format, size_t count, int16_t* dst)
+	{
+		switch (format)
+		{
+		case SampleFormat::s16:
+			memcpy(dst, src, count * sizeof(int16_t));
+			break;
+
+		case SampleFormat::s24:
+			// Keep the two most significant bytes.
+			for (size_t i = 0; i < count; i++, src += 3)
+			{
+				dst[i] = static_cast<int16_t>(src[1] | (src[2] << 8));
+			}
+			break;
+
+		case SampleFormat::s32:
+			for (size_t i = 0; i < count; i++)
+			{
+				int32_t sample;
+				memcpy(&sample, src + i * sizeof(int32_t), sizeof(int32_t));
+				dst[i] = static_cast<int16_t>(sample >> 16);
+			}
+			break;
+
+		case SampleFormat::f32:
+			for (size_t i = 0; i < count; i++)
+			{
+				float sample;
+				memcpy(&sample, src + i * sizeof(float), sizeof(float));
+				dst[i] = FloatToS16(sample);
+			}
+			break;
+		}
+	}
+
+#if defined(RECORD_CORE_X86)
+	RECORD_CORE_TARGET("sse2")
+	void ConvertToS16Sse2(const uint8_t* src, SampleFormat format, size_t count, int16_t* dst)
+	{
+		constexpr size_t kLanes = 8;
+		size_t i = 0;
+
+		if (format == SampleFormat::f32)
+		{
+			const auto* samples = reinterpret_cast<const float*>(src);
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 minusOne = _mm_set1_ps(-1.0f);
+			const __m128 scale = _mm_set1_ps(kS16Scale);
+
+			for (; i + kLanes <= count; i += kLanes)
+			{
+				__m128 low = _mm_loadu_ps(samples + i);
+				__m128 high = _mm_loadu_ps(samples + i + 4);
+
+				// Clamp before scaling so out of range values can't wrap.
+				low = _mm_max_ps(_mm_min_ps(low, one), minusOne);
+				high = _mm_max_ps(_mm_min_ps(high, one), minusOne);
+
+				// Rounds to nearest, +1 becomes 32768 and is saturated by packing.
+				const __m128i lowInt = _mm_cvtps_epi32(_mm_mul_ps(low, scale));
+				const __m128i highInt = _mm_cvtps_epi32(_mm_mul_ps(high, scale));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lowInt, highInt));
+			}
+		}
+		else if (format == SampleFormat::s32)
+		{
+			const auto* samples = reinterpret_cast<const __m128i*>(src);
+
+			for (; i + kLanes <= count; i += kLanes)
+			{
+				const __m128i low = _mm_srai_epi32(_mm_loadu_si128(samples + i / 4), 16);
+				const __m128i high = _mm_srai_epi32(_mm_loadu_si128(samples + i / 4 + 1), 16);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(low, high));
+			}
+		}
+
+		// 16 bits is a copy and packed 24 bits needs byte shuffles missing in SSE2.
+		ConvertToS16Scalar(src + i * BytesPerSample(format), format, count - i, dst + i);
+	}
+
+	static bool CpuSupportsSse2()
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+		return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+#else
+		return __builtin_cpu_supports("sse2");
+#endif
+	}
+#endif
+
+	struct ConvertKernel
+	{
+		void (*convert)(const uint8_t*, SampleFormat, size_t, int16_t*);
+		const char* name;
+	};
+
+	static ConvertKernel SelectConvertKernel()
+	{
+#if defined(RECORD_CORE_X86)
+		if (CpuSupportsSse2()) return { ConvertToS16Sse2, "sse2" };
+#endif
+		return { ConvertToS16Scalar, "scalar" };
+	}
+
+	static const ConvertKernel& GetConvertKernel()
+	{
+		static const ConvertKernel kernel = SelectConvertKernel();
+		return kernel;
+	}
+
+	void ConvertToS16(const uint8_t* src, SampleFormat format, size_t count, int16_t* dst)
+	{
+		GetConvertKernel().convert(src, format, count, dst);
+	}
+
+	const char* ConvertToS16KernelName()
+	{
+		return GetConvertKernel().name;
+	}
+
+	const int16_t* SampleConverter::ToS16(const uint8_t* data, size_t count)
+	{
+		if (m_format == SampleFormat::s16)
+		{
+			return reinterpret_cast<const int16_t*>(data);
+		}
+
+		if (m_buffer.size() < count)
+		{
+			m_buffer.resize(count);
+		}
+
+		ConvertToS16(data, m_format, count, m_buffer.data());
+
+		return m_buffer.data();
+	}
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	// Interleaved little endian PCM sample formats.
+	// Values are shared with Dart (SampleFormat index).
+	enum class SampleFormat
+	{
+		// Signed 16 bits.
+		s16,
+		// Signed 24 bits, packed on 3 bytes.
+		s24,
+		// Signed 32 bits.
+		s32,
+		// Float 32 bits, full scale is [-1, 1].
+		f32,
+	};
+
+	size_t BytesPerSample(SampleFormat format);
+
+	// Converts count samples to signed 16 bits.
+	//
+	// Integer samples are truncated, float samples are rounded and saturated.
+	// The best available kernel is selected at runtime on first call.
+	void ConvertToS16(const uint8_t* src, SampleFormat format, size_t count, int16_t* dst);
+
+	// Returns the name of the kernel used by ConvertToS16 ("sse2" or "scalar").
+	const char* ConvertToS16KernelName();
+
+	// Kernels, exposed to validate and benchmark them against each other.
+	// Calling an unsupported kernel on the running CPU is undefined behaviour.
+	void ConvertToS16Scalar(const uint8_t* src, SampleFormat format, size_t count, int16_t* dst);
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define RECORD_CORE_X86 1
+	void ConvertToS16Sse2(const uint8_t* src, SampleFormat format, size_t count, int16_t* dst);
+#endif
+
+	//////////////////////////////////////////////////////////////////////////
+	//  SampleConverter
+	//  Description: Gives captured samples as signed 16 bits to meters and
+	//               analyzers, whatever the capture format.
+	//               16 bits samples are given as is, others are converted
+	//               into a buffer reused across calls.
+	//////////////////////////////////////////////////////////////////////////
+	class SampleConverter
+	{
+	public:
+		void Configure(SampleFormat format) { m_format = format; }
+		SampleFormat Format() const { return m_format; }
+
+		// Returned samples are valid until next call.
+		const int16_t* ToS16(const uint8_t* data, size_t count);
+
+	private:
+		SampleFormat m_format = SampleFormat::s16;
+		std::vector<int16_t> m_buffer;
+	};
+};
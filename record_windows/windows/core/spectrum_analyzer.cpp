@@ -0,0 +1,199 @@
+#include "spectrum_analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "pcm_meter.h"
+
+namespace record_core
+{
+	static constexpr double kPi = 3.14159265358979323846;
+
+	static constexpr size_t kMinFftSize = 64;
+	static constexpr size_t kMaxFftSize = 16384;
+	static constexpr int kMaxBands = 256;
+
+	static size_t RoundUpPowerOfTwo(size_t value)
+	{
+		size_t result = kMinFftSize;
+		while (result < value && result < kMaxFftSize) result <<= 1;
+		return result;
+	}
+
+	void SpectrumAnalyzer::Configure(int sampleRate, int numChannels, const SpectrumConfig& config)
+	{
+		m_frameStride = std::max(1, numChannels);
+
+		if (config.fftSize <= 0 || sampleRate <= 0)
+		{
+			m_fftSize = 0;
+			return;
+		}
+
+		const size_t n = RoundUpPowerOfTwo(config.fftSize);
+		const size_t half = n / 2;
+		const double rate = sampleRate;
+
+		m_fftSize = n;
+		m_hopSize = config.hopSize > 0 ? static_cast<size_t>(config.hopSize) : half;
+		m_minFrameInterval = config.maxFrameRate > 0.0 ? static_cast<size_t>(rate / config.maxFrameRate) : 0;
+		m_inputScale = 1.0f / (32768.0f * m_frameStride);
+
+		m_input.assign(n, 0.0f);
+
+		// Periodic Hann window.
+		m_window.resize(n);
+		double windowSum = 0.0;
+		for (size_t i = 0; i < n; i++)
+		{
+			m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / n));
+			windowSum += m_window[i];
+		}
+		// Full scale sine gives 0 dBFS.
+		m_magnitudeScale = static_cast<float>(2.0 / windowSum);
+
+		m_re.assign(half, 0.0f);
+		m_im.assign(half, 0.0f);
+
+		m_twiddleRe.resize(half / 2);
+		m_twiddleIm.resize(half / 2);
+		for (size_t k = 0; k < half / 2; k++)
+		{
+			m_twiddleRe[k] = static_cast<float>(std::cos(-2.0 * kPi * k / half));
+			m_twiddleIm[k] = static_cast<float>(std::sin(-2.0 * kPi * k / half));
+		}
+
+		int bits = 0;
+		while ((static_cast<size_t>(1) << bits) < half) bits++;
+		m_bitReverse.resize(half);
+		for (size_t k = 0; k < half; k++)
+		{
+			uint32_t reversed = 0;
+			for (int b = 0; b < bits; b++)
+			{
+				reversed |= ((k >> b) & 1) << (bits - 1 - b);
+			}
+			m_bitReverse[k] = reversed;
+		}
+
+		m_splitRe.resize(half + 1);
+		m_splitIm.resize(half + 1);
+		for (size_t k = 0; k <= half; k++)
+		{
+			m_splitRe[k] = static_cast<float>(std::cos(-2.0 * kPi * k / n));
+			m_splitIm[k] = static_cast<float>(std::sin(-2.0 * kPi * k / n));
+		}
+
+		m_magnitudes.assign(half + 1, 0.0f);
+
+		// Log spaced bands from minFrequency to Nyquist.
+		const int numBands = std::min(std::max(1, config.numBands), kMaxBands);
+		const double nyquist = rate / 2;
+		const double minFrequency = std::min(std::max(config.minFrequency, rate / n), nyquist / 2);
+		const double binsPerHz = n / rate;
+
+		m_bandFirstBin.resize(numBands);
+		m_bandLastBin.resize(numBands);
+		for (int b = 0; b < numBands; b++)
+		{
+			const double low = minFrequency * std::pow(nyquist / minFrequency, static_cast<double>(b) / numBands);
+			const double high = minFrequency * std::pow(nyquist / minFrequency, static_cast<double>(b + 1) / numBands);
+
+			const int first = std::min(static_cast<int>(half), static_cast<int>(std::floor(low * binsPerHz)));
+			const int last = std::min(static_cast<int>(half), static_cast<int>(std::ceil(high * binsPerHz)) - 1);
+
+			m_bandFirstBin[b] = first;
+			m_bandLastBin[b] = std::max(first, last);
+		}
+		m_bands.assign(numBands, static_cast<float>(kMinDbfs));
+
+		Reset();
+	}
+
+	void SpectrumAnalyzer::Reset()
+	{
+		std::fill(m_input.begin(), m_input.end(), 0.0f);
+		m_inputPos = 0;
+		m_inputCount = 0;
+		m_sinceLastHop = 0;
+		m_sinceLastFrame = m_minFrameInterval;
+	}
+
+	void SpectrumAnalyzer::Analyze()
+	{
+		const size_t n = m_fftSize;
+		const size_t half = n / 2;
+
+		// Window the last n samples and pack even/odd samples as
+		// real/imaginary parts, in bit reversed order.
+		for (size_t i = 0; i < n; i++)
+		{
+			const float value = m_input[(m_inputPos + i) % n] * m_window[i];
+			const uint32_t k = m_bitReverse[i >> 1];
+
+			if (i & 1) m_im[k] = value;
+			else m_re[k] = value;
+		}
+
+		Fft();
+
+		// Split the half size complex spectrum into the real input spectrum.
+		for (size_t k = 0; k <= half; k++)
+		{
+			const size_t a = k % half;
+			const size_t b = (half - k) % half;
+
+			const float evenRe = (m_re[a] + m_re[b]) * 0.5f;
+			const float evenIm = (m_im[a] - m_im[b]) * 0.5f;
+			const float oddRe = (m_im[a] + m_im[b]) * 0.5f;
+			const float oddIm = (m_re[b] - m_re[a]) * 0.5f;
+
+			const float re = evenRe + m_splitRe[k] * oddRe - m_splitIm[k] * oddIm;
+			const float im = evenIm + m_splitRe[k] * oddIm + m_splitIm[k] * oddRe;
+
+			m_magnitudes[k] = std::sqrt(re * re + im * im) * m_magnitudeScale;
+		}
+
+		for (size_t b = 0; b < m_bands.size(); b++)
+		{
+			const auto first = m_magnitudes.begin() + m_bandFirstBin[b];
+			const auto last = m_magnitudes.begin() + m_bandLastBin[b] + 1;
+			const float peak = *std::max_element(first, last);
+
+			m_bands[b] = peak > 0.0f
+				? std::max(static_cast<float>(kMinDbfs), 20.0f * std::log10(peak))
+				: static_cast<float>(kMinDbfs);
+		}
+	}
+
+	void SpectrumAnalyzer::Fft()
+	{
+		// Iterative radix-2 decimation in time, input in bit reversed order.
+		const size_t half = m_fftSize / 2;
+
+		for (size_t size = 2; size <= half; size <<= 1)
+		{
+			const size_t step = half / size;
+			const size_t halfSize = size / 2;
+
+			for (size_t start = 0; start < half; start += size)
+			{
+				for (size_t j = 0; j < halfSize; j++)
+				{
+					const float wr = m_twiddleRe[j * step];
+					const float wi = m_twiddleIm[j * step];
+					const size_t a = start + j;
+					const size_t b = a + halfSize;
+
+					const float tr = m_re[b] * wr - m_im[b] * wi;
+					const float ti = m_re[b] * wi + m_im[b] * wr;
+
+					m_re[b] = m_re[a] - tr;
+					m_im[b] = m_im[a] - ti;
+					m_re[a] += tr;
+					m_im[a] += ti;
+				}
+			}
+		}
+	}
+};
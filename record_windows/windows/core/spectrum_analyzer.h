@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	//////////////////////////////////////////////////////////////////////////
+	//  SpectrumConfig
+	//  Description: Spectrum analyzer settings. A zero fftSize disables it.
+	//////////////////////////////////////////////////////////////////////////
+	struct SpectrumConfig
+	{
+		// FFT size, rounded to a power of 2 in [64, 16384].
+		int fftSize = 0;
+		// Samples between two analyzed frames, fftSize / 2 when zero or negative.
+		int hopSize = 0;
+		// Number of log spaced bands.
+		int numBands = 32;
+		// Lowest band frequency.
+		double minFrequency = 20.0;
+		// Highest frame rate, frames above it are skipped (and not computed).
+		double maxFrameRate = 30.0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  SpectrumAnalyzer
+	//  Description: Hann windowed real FFT of interleaved signed 16 bits PCM
+	//               (channels are mixed) aggregated into log spaced bands.
+	//               All buffers are allocated by Configure.
+	//////////////////////////////////////////////////////////////////////////
+	class SpectrumAnalyzer
+	{
+	public:
+		void Configure(int sampleRate, int numChannels, const SpectrumConfig& config);
+		void Reset();
+
+		bool IsEnabled() const { return m_fftSize != 0; }
+		int NumBands() const { return static_cast<int>(m_bandFirstBin.size()); }
+
+		// Processes interleaved frames and calls onFrame(const float* bands, int numBands)
+		// for each analyzed frame. Band values are peak magnitudes in dBFS.
+		template <typename OnFrame>
+		void Process(const int16_t* samples, size_t frameCount, OnFrame&& onFrame)
+		{
+			if (!IsEnabled()) return;
+
+			for (size_t frame = 0; frame < frameCount; frame++)
+			{
+				int32_t mix = 0;
+				for (size_t ch = 0; ch < m_frameStride; ch++)
+				{
+					mix += samples[frame * m_frameStride + ch];
+				}
+
+				m_input[m_inputPos] = mix * m_inputScale;
+				m_inputPos = (m_inputPos + 1) % m_fftSize;
+				m_sinceLastHop++;
+				m_sinceLastFrame++;
+
+				if (m_inputCount < m_fftSize)
+				{
+					m_inputCount++;
+				}
+
+				if (m_inputCount == m_fftSize && m_sinceLastHop >= m_hopSize)
+				{
+					m_sinceLastHop = 0;
+
+					if (m_sinceLastFrame >= m_minFrameInterval)
+					{
+						m_sinceLastFrame = 0;
+						Analyze();
+						onFrame(m_bands.data(), NumBands());
+					}
+				}
+			}
+		}
+
+	private:
+		void Analyze();
+		void Fft();
+
+		size_t m_frameStride = 1;
+		size_t m_fftSize = 0;
+		size_t m_hopSize = 0;
+		size_t m_minFrameInterval = 0;
+		float m_inputScale = 1.0f;
+
+		// Input ring buffer, oldest sample at m_inputPos.
+		std::vector<float> m_input;
+		size_t m_inputPos = 0;
+		size_t m_inputCount = 0;
+		size_t m_sinceLastHop = 0;
+		size_t m_sinceLastFrame = 0;
+
+		std::vector<float> m_window;
+		float m_magnitudeScale = 1.0f;
+
+		// Half size complex FFT buffers & tables.
+		std::vector<float> m_re;
+		std::vector<float> m_im;
+		std::vector<float> m_twiddleRe;
+		std::vector<float> m_twiddleIm;
+		std::vector<uint32_t> m_bitReverse;
+		// Real FFT split twiddles.
+		std::vector<float> m_splitRe;
+		std::vector<float> m_splitIm;
+
+		std::vector<float> m_magnitudes;
+		std::vector<int> m_bandFirstBin;
+		std::vector<int> m_bandLastBin;
+		std::vector<float> m_bands;
+	};
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Platform neutral code. Must not depend on Windows or Flutter headers.
+namespace record_core
+{
+	//////////////////////////////////////////////////////////////////////////
+	//  StreamCoalescer
+	//  Description: Accumulates captured PCM into fixed size chunks so
+	//               streamed data is dispatched once per chunk instead of
+	//               once per captured buffer. Chunks always hold whole
+	//               frames. The pending buffer is reused between chunks.
+	//               A max delay bounds the time data waits for its chunk.
+	//////////////////////////////////////////////////////////////////////////
+	class StreamCoalescer
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		// Chunk size is rounded down to whole frames.
+		// A zero chunk size disables coalescing, buffers are passed as is.
+		// Pending data older than maxDelay is sent by the next append, in an
+		// incomplete chunk. Zero disables the delay.
+		void Configure(size_t chunkBytes, size_t frameBytes,
+			std::chrono::milliseconds maxDelay = std::chrono::milliseconds(0))
+		{
+			frameBytes = frameBytes > 0 ? frameBytes : 1;
+			m_chunkBytes = chunkBytes / frameBytes * frameBytes;
+			if (chunkBytes > 0 && m_chunkBytes == 0) m_chunkBytes = frameBytes;
+			m_maxDelay = maxDelay;
+
+			Reset();
+		}
+
+		// Drops pending data.
+		void Reset()
+		{
+			m_pending.clear();
+			m_pending.reserve(m_chunkBytes);
+		}
+
+		bool IsEnabled() const { return m_chunkBytes != 0; }
+
+		// Appends data and calls onChunk(const uint8_t* data, size_t size) for
+		// each completed chunk. Data is only valid during the call.
+		template <typename OnChunk>
+		void Append(const uint8_t* data, size_t size, OnChunk&& onChunk)
+		{
+			Append(data, size, Clock::now(), onChunk);
+		}
+
+		// Same as above, data is appended at now.
+		template <typename OnChunk>
+		void Append(const uint8_t* data, size_t size, Clock::time_point now, OnChunk&& onChunk)
+		{
+			if (!IsEnabled())
+			{
+				if (size > 0) onChunk(data, size);
+				return;
+			}
+
+			while (size > 0)
+			{
+				if (m_pending.empty())
+				{
+					m_pendingSince = now;
+				}
+
+				const size_t count = std::min(size, m_chunkBytes - m_pending.size());
+				m_pending.insert(m_pending.end(), data, data + count);
+				data += count;
+				size -= count;
+
+				if (m_pending.size() == m_chunkBytes)
+				{
+					TakeChunk(onChunk);
+				}
+			}
+
+			if (m_maxDelay.count() > 0 && !m_pending.empty() && now - m_pendingSince >= m_maxDelay)
+			{
+				TakeChunk(onChunk);
+			}
+		}
+
+		// Calls onChunk with pending data, if any (e.g. on stop).
+		template <typename OnChunk>
+		void Flush(OnChunk&& onChunk)
+		{
+			if (!m_pending.empty())
+			{
+				TakeChunk(onChunk);
+			}
+		}
+
+	private:
+		template <typename OnChunk>
+		void TakeChunk(OnChunk& onChunk)
+		{
+			onChunk(m_pending.data(), m_pending.size());
+			m_pending.clear();
+		}
+
+		size_t m_chunkBytes = 0;
+		std::chrono::milliseconds m_maxDelay{ 0 };
+		std::vector<uint8_t> m_pending;
+		// Append time of the oldest pending data.
+		Clock::time_point m_pendingSince;
+	};
+};
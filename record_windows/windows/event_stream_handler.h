@@ -1,6 +1,8 @@
 #include <flutter/event_channel.h>
 #include <flutter/encodable_value.h>
 
+#include <functional>
+
 using namespace flutter;
 
 template <typename T = EncodableValue>
@@ -8,8 +10,22 @@ class EventStreamHandler : public StreamHandler<T> {
 public:
     EventStreamHandler() = default;
 
+    // onListen is called when Dart starts listening.
+    explicit EventStreamHandler(std::function<void()> onListen)
+        : m_onListen(std::move(onListen)) {}
+
     virtual ~EventStreamHandler() = default;
 
+    // Replaces the callback given at construction.
+    void SetOnListen(std::function<void()> onListen) {
+        m_onListen = std::move(onListen);
+    }
+
+    // Events are dropped while false.
+    bool IsListening() const {
+        return m_sink != nullptr;
+    }
+
     void Success(std::unique_ptr<T> _data) {
         auto sink = m_sink.get();
         if (sink && _data) {
@@ -27,6 +43,9 @@ protected:
     std::unique_ptr<StreamHandlerError<T>> OnListenInternal(
         const T* arguments, std::unique_ptr<EventSink<T>>&& events) override {
         m_sink = std::move(events);
+        if (m_onListen) {
+            m_onListen();
+        }
         return nullptr;
     }
 
@@ -38,4 +57,5 @@ protected:
 
 private:
     std::unique_ptr<EventSink<T>> m_sink;
+    std::function<void()> m_onListen;
 };
\ No newline at end of file
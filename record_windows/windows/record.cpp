@@ -4,9 +4,9 @@
 namespace record_windows
 {
 	// static
-	HRESULT Recorder::CreateInstance(EventStreamHandler<>* stateEventHandler, EventStreamHandler<>* recordEventHandler, Recorder** ppRecorder)
+	HRESULT Recorder::CreateInstance(EventStreamHandler<>* stateEventHandler, EventStreamHandler<>* recordEventHandler, EventStreamHandler<>* envelopeEventHandler, EventStreamHandler<>* spectrumEventHandler, EventStreamHandler<>* vadEventHandler, Recorder** ppRecorder)
 	{
-		auto pRecorder = new (std::nothrow) Recorder(stateEventHandler, recordEventHandler);
+		auto pRecorder = new (std::nothrow) Recorder(stateEventHandler, recordEventHandler, envelopeEventHandler, spectrumEventHandler, vadEventHandler);
 
 		if (pRecorder == NULL)
 		{
@@ -19,7 +19,7 @@ namespace record_windows
 		return S_OK;
 	}
 
-	Recorder::Recorder(EventStreamHandler<>* stateEventHandler, EventStreamHandler<>* recordEventHandler)
+	Recorder::Recorder(EventStreamHandler<>* stateEventHandler, EventStreamHandler<>* recordEventHandler, EventStreamHandler<>* envelopeEventHandler, EventStreamHandler<>* spectrumEventHandler, EventStreamHandler<>* vadEventHandler)
 		: m_nRefCount(1),
 		m_critsec(),
 		m_pConfig(nullptr),
@@ -29,9 +29,19 @@ namespace record_windows
 		m_pPresentationDescriptor(NULL),
 		m_stateEventHandler(stateEventHandler),
 		m_recordEventHandler(recordEventHandler),
+		m_envelopeEventHandler(envelopeEventHandler),
+		m_spectrumEventHandler(spectrumEventHandler),
+		m_vadEventHandler(vadEventHandler),
 		m_recordingPath(std::wstring()),
 		m_pMediaType(NULL)
 	{
+		// Stream data held until Dart listens is sent then.
+		if (m_recordEventHandler)
+		{
+			m_recordEventHandler->SetOnListen([this]() -> void {
+				DrainStreamData();
+			});
+		}
 	}
 
 	Recorder::~Recorder()
@@ -39,6 +49,40 @@ namespace record_windows
 		Dispose();
 	}
 
+	HRESULT Recorder::Prepare(std::unique_ptr<RecordConfig> config)
+	{
+		if (IsRecording() || IsPaused())
+		{
+			return MF_E_INVALIDREQUEST;
+		}
+
+		HRESULT hr = InitRecording(std::move(config));
+
+		if (SUCCEEDED(hr))
+		{
+			AutoLock lock(m_critsec);
+
+			// Reader kept from a previous prepare with the same settings is already reading.
+			if (!m_prepared)
+			{
+				hr = m_pReader->ReadSample((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM,
+					0,
+					NULL, NULL, NULL, NULL
+				);
+			}
+			if (SUCCEEDED(hr))
+			{
+				m_prepared = true;
+			}
+		}
+		if (FAILED(hr))
+		{
+			EndRecording();
+		}
+
+		return hr;
+	}
+
 	HRESULT Recorder::Start(std::unique_ptr<RecordConfig> config, std::wstring path)
 	{
 		bool supported = false;
@@ -58,11 +102,7 @@ namespace record_windows
 		}
 		if (SUCCEEDED(hr))
 		{
-			// Request the first sample
-			hr = m_pReader->ReadSample((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM,
-				0,
-				NULL, NULL, NULL, NULL
-			);
+			hr = StartReading();
 		}
 		if (SUCCEEDED(hr))
 		{
@@ -78,20 +118,35 @@ namespace record_windows
 
 	HRESULT Recorder::StartStream(std::unique_ptr<RecordConfig> config)
 	{
-		if (config->encoderName != AudioEncoder().pcm16bits)
+		// WAV is a container, other encoders are streamed as raw packets.
+		bool supported = false;
+		HRESULT hr = isEncoderSupported(config->encoderName, &supported);
+
+		if (FAILED(hr) || !supported || config->encoderName == AudioEncoder().wav)
 		{
 			return E_NOTIMPL;
 		}
 
-		HRESULT hr = InitRecording(std::move(config));
+		hr = InitRecording(std::move(config));
 
 		if (SUCCEEDED(hr))
 		{
-			// Request the first sample
-			hr = m_pReader->ReadSample((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM,
-				0,
-				NULL, NULL, NULL, NULL
-			);
+			if (m_pConfig->encoderName != AudioEncoder().pcm16bits)
+			{
+				AutoLock lock(m_critsec);
+				hr = CreateStreamEncoder();
+			}
+			else if (m_pConfig->zeroCopyStream)
+			{
+				hr = CreatePcmRing();
+			}
+		}
+		if (SUCCEEDED(hr))
+		{
+			m_streamQueue.SetCredit(record_core::kStreamCredit);
+			m_streamDrainPending = false;
+
+			hr = StartReading();
 		}
 		if (SUCCEEDED(hr))
 		{
@@ -105,11 +160,62 @@ namespace record_windows
 		return hr;
 	}
 
+	HRESULT Recorder::CreatePcmRing()
+	{
+		AutoLock lock(m_critsec);
+
+		// At least 2s of audio and 16 chunks, so consumers have time to read chunks.
+		const size_t frameBytes = FrameBytes();
+		const size_t capacity = std::max(
+			frameBytes * m_pConfig->sampleRate * 2,
+			static_cast<size_t>(std::max(0, m_pConfig->streamBufferSize)) * 16
+		);
+
+		m_pcmRing = record_core::PcmRing::Create(capacity);
+
+		return m_pcmRing ? S_OK : E_OUTOFMEMORY;
+	}
+
+	record_core::StreamQueueStats Recorder::GetStreamStats()
+	{
+		return m_streamQueue.Stats();
+	}
+
+	record_core::CaptureLatency Recorder::GetLatency()
+	{
+		return m_captureTiming.Get();
+	}
+
+	record_core::PcmRing* Recorder::GetPcmRing()
+	{
+		AutoLock lock(m_critsec);
+
+		if (m_pcmRing)
+		{
+			m_pcmRing->Retain();
+		}
+
+		return m_pcmRing;
+	}
+
 	HRESULT Recorder::InitRecording(std::unique_ptr<RecordConfig> config)
 	{
+		if (IsPreparedFor(*config))
+		{
+			// Reader of the prepare is kept, processing follows the new config.
+			AutoLock lock(m_critsec);
+			m_pConfig = std::move(config);
+			ConfigureProcessing();
+			return S_OK;
+		}
+
 		HRESULT hr = EndRecording();
 
-		m_pConfig = std::move(config);
+		{
+			AutoLock lock(m_critsec);
+			m_pConfig = std::move(config);
+			ConfigureProcessing();
+		}
 
 		if (SUCCEEDED(hr))
 		{
@@ -143,6 +249,55 @@ namespace record_windows
 		return hr;
 	}
 
+	void Recorder::ConfigureProcessing()
+	{
+		m_levelMeter.Configure(m_pConfig->sampleRate, m_pConfig->numChannels);
+		m_loudnessMeter.Configure(m_pConfig->sampleRate, m_pConfig->numChannels);
+		m_envelope.Configure(m_pConfig->sampleRate, m_pConfig->numChannels, m_pConfig->envelopeIntervalMs);
+		m_spectrum.Configure(m_pConfig->sampleRate, m_pConfig->numChannels, m_pConfig->spectrum);
+		m_vad.Configure(m_pConfig->sampleRate, m_pConfig->numChannels, m_pConfig->vad);
+		m_sampleConverter.Configure(m_pConfig->sampleFormat);
+		m_captureTiming.Reset();
+		const size_t frameBytes = FrameBytes();
+		m_streamCoalescer.Configure(std::max(0, m_pConfig->streamBufferSize), frameBytes,
+			std::chrono::milliseconds(std::max(0, m_pConfig->streamMaxDelayMs)));
+		// Spilled stream data is bounded to 1s of audio.
+		m_streamQueue.Configure(m_pConfig->streamOverflowPolicy, frameBytes * m_pConfig->sampleRate, frameBytes);
+		m_meters = record_core::MeterSnapshot();
+		m_meterSnapshot.Store(m_meters);
+	}
+
+	bool Recorder::IsPreparedFor(const RecordConfig& config)
+	{
+		AutoLock lock(m_critsec);
+
+		// Settings of the device and its source reader.
+		return m_prepared &&
+			m_pConfig->deviceId == config.deviceId &&
+			m_pConfig->sampleRate == config.sampleRate &&
+			m_pConfig->numChannels == config.numChannels &&
+			m_pConfig->sampleFormat == config.sampleFormat &&
+			m_pConfig->latencyMs == config.latencyMs;
+	}
+
+	HRESULT Recorder::StartReading()
+	{
+		AutoLock lock(m_critsec);
+
+		// Reading since Prepare, samples are kept from now on.
+		if (m_prepared)
+		{
+			m_prepared = false;
+			return S_OK;
+		}
+
+		// Request the first sample
+		return m_pReader->ReadSample((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM,
+			0,
+			NULL, NULL, NULL, NULL
+		);
+	}
+
 	HRESULT Recorder::Pause()
 	{
 		HRESULT hr = S_OK;
@@ -242,6 +397,9 @@ namespace record_windows
 
 	HRESULT Recorder::EndRecording()
 	{
+		// Release a capture thread waiting for stream consumer before locking.
+		m_streamQueue.Abort();
+
 		AutoLock lock(m_critsec);
 		HRESULT hr = S_OK;
 
@@ -262,17 +420,32 @@ namespace record_windows
 		{
 			hr = m_pWriter->Finalize();
 		}
+		else
+		{
+			FinishStreamEncoder();
+			FlushStreamData();
+		}
+
+		if (m_pcmRing)
+		{
+			m_pcmRing->Release();
+			m_pcmRing = nullptr;
+		}
 
 		if (m_pConfig && m_pConfig->encoderName == AudioEncoder().wav) {
 			FillWavHeader();
 		}
 
+		m_prepared = false;
 		m_bFirstSample = true;
 		m_llBaseTime = 0;
 		m_llLastTime = 0;
 
-		m_amplitude = -160;
-		m_maxAmplitude = -160;
+		auto loudness = m_meters.loudness;
+		m_meters = record_core::MeterSnapshot();
+		m_meters.loudness = loudness;
+		m_meterSnapshot.Store(m_meters);
+		m_levelMeter.Reset();
 
 		if (m_mfStarted)
 		{
@@ -287,6 +460,7 @@ namespace record_windows
 		SafeRelease(m_pPresentationDescriptor);
 		SafeRelease(m_pWriter);
 		SafeRelease(m_pMediaType);
+		m_codecConfig.clear();
 		m_pConfig = nullptr;
 		m_recordingPath = std::wstring();
 
@@ -297,8 +471,16 @@ namespace record_windows
 	{
 		HRESULT hr = EndRecording();
 
+		if (m_recordEventHandler)
+		{
+			m_recordEventHandler->SetOnListen(nullptr);
+		}
+
 		m_stateEventHandler = nullptr;
 		m_recordEventHandler = nullptr;
+		m_envelopeEventHandler = nullptr;
+		m_spectrumEventHandler = nullptr;
+		m_vadEventHandler = nullptr;
 
 		return hr;
 	}
@@ -364,11 +546,16 @@ namespace record_windows
 		IMFAttributes* pAttributes = NULL;
 		IMFMediaType* pMediaTypeIn = NULL;
 
-		hr = MFCreateAttributes(&pAttributes, 1);
+		hr = MFCreateAttributes(&pAttributes, 2);
 		if (SUCCEEDED(hr))
 		{
 			hr = pAttributes->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, this);
 		}
+		// The capture source has no period setting, its low latency mode is the closest.
+		if (SUCCEEDED(hr) && m_pConfig->latencyMs > 0)
+		{
+			hr = pAttributes->SetUINT32(MF_LOW_LATENCY, TRUE);
+		}
 		if (SUCCEEDED(hr))
 		{
 			hr = MFCreateSourceReaderFromMediaSource(m_pSource, pAttributes, &m_pReader);
@@ -437,70 +624,234 @@ namespace record_windows
 		return hr;
 	}
 
-	std::map<std::string, double> Recorder::GetAmplitude()
+	record_core::MeterSnapshot Recorder::GetMeters()
+	{
+		return m_meterSnapshot.Load();
+	}
+
+	size_t Recorder::FrameBytes()
 	{
-		return {
-			{"current", m_amplitude},
-			{"max" , m_maxAmplitude},
-		};
+		return record_core::BytesPerSample(m_pConfig->sampleFormat) * std::max(1, m_pConfig->numChannels);
 	}
 
-	void Recorder::GetAmplitude(BYTE* chunk, DWORD size, int bytesPerSample) {
-		int maxSample = -160;
+	void Recorder::UpdateMeters(const int16_t* samples, size_t frameCount) {
+		m_levelMeter.Process(samples, frameCount);
+		m_loudnessMeter.Process(samples, frameCount);
 
-		if (bytesPerSample == 2) { // PCM 16 bits
-			auto values = convertBytesToInt16(chunk, size);
+		const auto& levels = m_levelMeter.Levels();
 
-			for (DWORD i = 0; i < size; i++) {
-				int curSample = std::abs(values[i]);
-				if (curSample > maxSample) {
-					maxSample = curSample;
-				}
-			}
+		m_meters.current = levels.PeakDbfs();
+		m_meters.rms = levels.RmsDbfs();
+		m_meters.clipCount += levels.clipCount;
 
-			m_amplitude = 20 * std::log10(maxSample / 32767.0); // 16 signed bits 2^15 - 1
+		if (m_meters.current > m_meters.max) {
+			m_meters.max = m_meters.current;
 		}
-		else /* if (bytesPerSample == 1) */ { // PCM 8 bits
-			for (DWORD i = 0; i < size; i++) {
-				byte curSample = chunk[i];
-				if (curSample > maxSample) {
-					maxSample = curSample;
-				}
+
+		m_meters.numChannels = m_levelMeter.NumChannels();
+		for (int ch = 0; ch < m_meters.numChannels; ch++)
+		{
+			m_meters.channels[ch] = m_levelMeter.Channel(ch);
+		}
+
+		m_meters.loudness = m_loudnessMeter.GetLevels();
+
+		m_meterSnapshot.Store(m_meters);
+
+		if (m_envelopeEventHandler && m_envelope.IsEnabled())
+		{
+			// Buckets completed within this chunk are sent as a single event
+			// of [min, max, rms] triplets.
+			std::vector<float> buckets;
+			m_envelope.Process(samples, frameCount, [&buckets](const record_core::EnvelopeBucket& bucket) {
+				buckets.insert(buckets.end(), { bucket.min, bucket.max, bucket.rms });
+			});
+
+			if (!buckets.empty())
+			{
+				EventStreamHandler<>* handlerPtr = m_envelopeEventHandler;
+				RecordWindowsPlugin::RunOnMainThread([handlerPtr, buckets]() -> void {
+					handlerPtr->Success(std::make_unique<flutter::EncodableValue>(buckets));
+				});
 			}
+		}
+
+		if (m_spectrumEventHandler && m_spectrum.IsEnabled())
+		{
+			// Frame rate is capped by the analyzer, each frame is its own event.
+			EventStreamHandler<>* handlerPtr = m_spectrumEventHandler;
+			m_spectrum.Process(samples, frameCount, [handlerPtr](const float* bands, int numBands) {
+				std::vector<float> frame(bands, bands + numBands);
 
-			m_amplitude = 20 * std::log10(maxSample / 256.0); // 8 unsigned bits 2^8
+				RecordWindowsPlugin::RunOnMainThread([handlerPtr, frame]() -> void {
+					handlerPtr->Success(std::make_unique<flutter::EncodableValue>(frame));
+				});
+			});
+		}
+	}
+
+	bool Recorder::DetectVoice(const int16_t* samples, size_t frameCount)
+	{
+		if (!m_vad.IsEnabled())
+		{
+			return true;
 		}
 
-		if (m_amplitude > m_maxAmplitude) {
-			m_maxAmplitude = m_amplitude;
+		const bool wasActive = m_vad.IsActive();
+		const bool blockActive = m_vad.Process(samples, frameCount);
+		const bool active = m_vad.IsActive();
+
+		if (m_vadEventHandler && active != wasActive)
+		{
+			EventStreamHandler<>* handlerPtr = m_vadEventHandler;
+			RecordWindowsPlugin::RunOnMainThread([handlerPtr, active]() -> void {
+				handlerPtr->Success(std::make_unique<flutter::EncodableValue>(active));
+			});
 		}
+
+		return blockActive || m_vad.Mode() != record_core::VadMode::skip;
 	}
 
-	std::wstring Recorder::GetRecordingPath()
+	void Recorder::SendStreamData(BYTE* chunk, DWORD size)
 	{
-		return m_recordingPath;
+		if (!m_recordEventHandler)
+		{
+			return;
+		}
+
+		m_streamCoalescer.Append(chunk, size, [this](const uint8_t* data, size_t count) {
+			PushStreamData(data, count);
+		});
 	}
 
-	std::vector<int16_t> Recorder::convertBytesToInt16(BYTE* bytes, DWORD size)
+	void Recorder::FlushStreamData()
 	{
-		// Convert to int16
-		std::vector<int16_t> values(size / 2);
+		if (!m_recordEventHandler)
+		{
+			m_streamCoalescer.Reset();
+			return;
+		}
 
-		int n = 1;
-		if (*(char*)&n == 1) {
-			// We're on little endian host
-			for (DWORD i = 0; i < size; i += 2) {
-				values.push_back(int16_t(bytes[i] << 0 | bytes[i + 1] << 8));
+		m_streamCoalescer.Flush([this](const uint8_t* data, size_t count) {
+			PushStreamData(data, count);
+		});
+
+		m_streamQueue.FlushSpill();
+
+		// The queue is aborted, the last drain takes everything whatever the credit.
+		// A pending drain may be waiting for an acknowledgement which won't come.
+		PostStreamDrain();
+	}
+
+	void Recorder::PushStreamData(const uint8_t* data, size_t size)
+	{
+		bool queued = false;
+
+		if (m_pcmRing)
+		{
+			record_core::PcmRingChunk shared;
+			if (m_pcmRing->Write(data, size, shared))
+			{
+				queued = m_streamQueue.PushShared(shared);
+			}
+			else
+			{
+				m_streamQueue.AddDropped(size);
 			}
 		}
-		else {
-			// We're on big endian host
-			for (DWORD i = 0; i < size; i += 2) {
-				values.push_back(int16_t(bytes[i + 1] | bytes[i] << 8));
+		else
+		{
+			queued = m_streamQueue.Push(data, size);
+		}
+
+		if (queued)
+		{
+			ScheduleStreamDrain();
+		}
+	}
+
+	void Recorder::ScheduleStreamDrain()
+	{
+		// Only one drain is scheduled at a time, it takes everything pushed until it runs.
+		if (!m_streamDrainPending.exchange(true, std::memory_order_acq_rel))
+		{
+			PostStreamDrain();
+		}
+	}
+
+	void Recorder::PostStreamDrain()
+	{
+		// The task keeps the recorder alive, it may run after dispose.
+		AddRef();
+		RecordWindowsPlugin::RunOnMainThread([this]() -> void {
+			DrainStreamData();
+			Release();
+		});
+	}
+
+	void Recorder::AcknowledgeStream(size_t count)
+	{
+		m_streamQueue.Acknowledge(count);
+		DrainStreamData();
+	}
+
+	void Recorder::DrainStreamData()
+	{
+		// Cleared before draining so data pushed meanwhile schedules another drain.
+		m_streamDrainPending.exchange(false, std::memory_order_acq_rel);
+
+		// Reset by Dispose, before the channel is destroyed.
+		EventStreamHandler<>* handlerPtr = m_recordEventHandler;
+
+		// Held until Dart listens, events sent before would be dropped with their credit.
+		// Data left when the recording ends without listener is dropped.
+		if (handlerPtr && !handlerPtr->IsListening() && m_recordState != RecordState::stop)
+		{
+			m_streamDrainPending.store(true, std::memory_order_release);
+			return;
+		}
+
+		m_streamQueue.Drain([handlerPtr](record_core::StreamQueueItem& chunk) {
+			if (!handlerPtr)
+			{
+				chunk.bytes.clear();
+			}
+			else if (chunk.bytes.empty())
+			{
+				// Zero copy stream, only send the chunk location.
+				std::vector<int64_t> location{
+					static_cast<int64_t>(chunk.shared.position),
+					static_cast<int64_t>(chunk.shared.length),
+					static_cast<int64_t>(chunk.shared.sequence)
+				};
+				handlerPtr->Success(std::make_unique<flutter::EncodableValue>(location));
 			}
+			else if (chunk.isPacket)
+			{
+				// Encoded packet with its timing in microseconds.
+				handlerPtr->Success(std::make_unique<flutter::EncodableValue>(flutter::EncodableList{
+					flutter::EncodableValue(chunk.bytes),
+					flutter::EncodableValue(chunk.packet.timestampUs),
+					flutter::EncodableValue(chunk.packet.durationUs)
+				}));
+			}
+			else
+			{
+				handlerPtr->Success(std::make_unique<flutter::EncodableValue>(chunk.bytes));
+				chunk.bytes.clear();
+			}
+		});
+
+		// Out of credit, the next acknowledgement drains instead of producers.
+		if (!m_streamQueue.HasCredit())
+		{
+			m_streamDrainPending.store(true, std::memory_order_release);
 		}
+	}
 
-		return values;
+	std::wstring Recorder::GetRecordingPath()
+	{
+		return m_recordingPath;
 	}
 
 	HRESULT Recorder::isEncoderSupported(const std::string encoderName, bool* supported)
@@ -16,6 +16,19 @@
 
 #include "event_stream_handler.h"
 
+#include "core/level_meter.h"
+#include "core/loudness_meter.h"
+#include "core/meter_snapshot.h"
+#include "core/seqlock.h"
+#include "core/envelope_generator.h"
+#include "core/spectrum_analyzer.h"
+#include "core/voice_activity_detector.h"
+#include "core/stream_coalescer.h"
+#include "core/stream_queue.h"
+#include "core/pcm_ring.h"
+#include "core/sample_format.h"
+#include "core/capture_timing.h"
+
 using namespace flutter;
 
 namespace record_windows
@@ -27,13 +40,19 @@ namespace record_windows
 	class Recorder : public IMFSourceReaderCallback
 	{
 	public:
-		static HRESULT CreateInstance(EventStreamHandler<>* stateEventHandler, EventStreamHandler<>* recordEventHandler, Recorder** recorder);
+		static HRESULT CreateInstance(EventStreamHandler<>* stateEventHandler, EventStreamHandler<>* recordEventHandler, EventStreamHandler<>* envelopeEventHandler, EventStreamHandler<>* spectrumEventHandler, EventStreamHandler<>* vadEventHandler, Recorder** recorder);
 
-		Recorder(EventStreamHandler<>* stateEventHandler, EventStreamHandler<>* recordEventHandler);
+		Recorder(EventStreamHandler<>* stateEventHandler, EventStreamHandler<>* recordEventHandler, EventStreamHandler<>* envelopeEventHandler, EventStreamHandler<>* spectrumEventHandler, EventStreamHandler<>* vadEventHandler);
 		virtual ~Recorder();
 
+		// Opens and reads the device ahead of Start or StartStream, samples are dropped until then.
+		// Starting with the same capture settings only keeps samples from the start call.
+		HRESULT Prepare(std::unique_ptr<RecordConfig> config);
 		HRESULT Start(std::unique_ptr<RecordConfig> config, std::wstring path);
+		// Stream chunks are sent record_core::kStreamCredit ahead of AcknowledgeStream.
 		HRESULT StartStream(std::unique_ptr<RecordConfig> config);
+		// Main thread. The consumer handled count more chunks, sends the ones waiting for it.
+		void AcknowledgeStream(size_t count);
 		HRESULT Pause();
 		HRESULT Resume();
 		HRESULT Stop();
@@ -41,7 +60,13 @@ namespace record_windows
 		bool IsPaused();
 		bool IsRecording();
 		HRESULT Dispose();
-		std::map<std::string, double> GetAmplitude();
+		record_core::MeterSnapshot GetMeters();
+		// Returns a new reference to the shared PCM ring of the stream, if any.
+		record_core::PcmRing* GetPcmRing();
+		record_core::StreamQueueStats GetStreamStats();
+		record_core::CaptureLatency GetLatency();
+		// Decoder setup data of the encoded stream (e.g. AAC AudioSpecificConfig), if any.
+		std::vector<uint8_t> GetCodecConfig();
 		std::wstring GetRecordingPath();
 		HRESULT isEncoderSupported(std::string encoderName, bool* supported);
 		
@@ -66,13 +91,34 @@ namespace record_windows
 		HRESULT CreateFlacProfile( IMFMediaType* pMediaType);
 		HRESULT CreateAmrNbProfile( IMFMediaType* pMediaType);
 		HRESULT CreatePcmProfile( IMFMediaType* pMediaType);
+		GUID SampleFormatSubtype();
 		HRESULT FillWavHeader();
 
+		HRESULT CreateStreamEncoder();
+		HRESULT SelectEncoderOutputType(const GUID& subtype, IMFMediaType** ppMediaType);
+		HRESULT CreateEncoderOutputSample();
+		void ReadCodecConfig(IMFMediaType* pMediaType, const GUID& subtype);
+		HRESULT EncodeStreamSample(IMFSample* pSample);
+		HRESULT DrainStreamEncoder();
+		HRESULT SendEncodedSample(IMFSample* pSample);
+		void FinishStreamEncoder();
+
 		HRESULT InitRecording(std::unique_ptr<RecordConfig> config);
+		void ConfigureProcessing();
+		bool IsPreparedFor(const RecordConfig& config);
+		HRESULT StartReading();
+		HRESULT CreatePcmRing();
 		void UpdateState(RecordState state);
 		HRESULT EndRecording();
-		void GetAmplitude(BYTE* chunk, DWORD size, int bytesPerSample);
-		std::vector<int16_t> convertBytesToInt16(BYTE* bytes, DWORD size);
+		size_t FrameBytes();
+		void UpdateMeters(const int16_t* samples, size_t frameCount);
+		bool DetectVoice(const int16_t* samples, size_t frameCount);
+		void SendStreamData(BYTE* chunk, DWORD size);
+		void FlushStreamData();
+		void PushStreamData(const uint8_t* data, size_t size);
+		void ScheduleStreamDrain();
+		void PostStreamDrain();
+		void DrainStreamData();
 
 		long                m_nRefCount;        // Reference count.
 		CritSec				m_critsec;
@@ -84,17 +130,46 @@ namespace record_windows
 		std::wstring m_recordingPath;
 		bool m_mfStarted = false;
 		IMFMediaType* m_pMediaType;
+		// Encoder of compressed streams, packets are sent instead of PCM.
+		IMFTransform* m_pEncoder = NULL;
+		// Output sample given to the encoder when it doesn't provide its own.
+		IMFSample* m_pEncoderSample = NULL;
+		std::vector<uint8_t> m_codecConfig;
+
+		// Reader runs since Prepare and drops samples until started, under m_critsec.
+		bool m_prepared = false;
 
 		bool m_bFirstSample = true;
 		LONGLONG m_llBaseTime = 0;
 		LONGLONG m_llLastTime = 0;
 
-		double m_amplitude = -160;
-		double m_maxAmplitude = -160;
+		record_core::LevelMeter m_levelMeter;
+		record_core::LoudnessMeter m_loudnessMeter;
+		// Meters values, written under m_critsec by the capture thread.
+		// Loudness is kept after stop until next recording so final values can be retrieved.
+		record_core::MeterSnapshot m_meters;
+		// Published copy of m_meters, read without locking.
+		record_core::SeqLock<record_core::MeterSnapshot> m_meterSnapshot;
+		// 16 bits view of captured samples for meters and analyzers.
+		record_core::SampleConverter m_sampleConverter;
+		// Latency and period of read samples, written under m_critsec.
+		record_core::CaptureTiming m_captureTiming;
+		record_core::EnvelopeGenerator m_envelope;
+		record_core::SpectrumAnalyzer m_spectrum;
+		record_core::VoiceActivityDetector m_vad;
+		record_core::StreamCoalescer m_streamCoalescer;
+		// Stream chunks handed from the capture thread to the main thread.
+		record_core::StreamQueue m_streamQueue{ 256 };
+		// Shared ring for zero copy streams, written under m_critsec.
+		record_core::PcmRing* m_pcmRing = nullptr;
+		std::atomic<bool> m_streamDrainPending{ false };
 		DWORD m_dataWritten = 0;
 
 		EventStreamHandler<>* m_stateEventHandler;
 		EventStreamHandler<>* m_recordEventHandler;
+		EventStreamHandler<>* m_envelopeEventHandler;
+		EventStreamHandler<>* m_spectrumEventHandler;
+		EventStreamHandler<>* m_vadEventHandler;
 
 		RecordState m_recordState = RecordState::stop;
 		std::unique_ptr<RecordConfig> m_pConfig;
@@ -2,6 +2,11 @@
 
 #include <string>
 
+#include "core/spectrum_analyzer.h"
+#include "core/voice_activity_detector.h"
+#include "core/stream_queue.h"
+#include "core/sample_format.h"
+
 namespace record_windows
 {
 
@@ -28,6 +33,24 @@ namespace record_windows
 		bool autoGain = false;
 		bool echoCancel = false;
 		bool noiseSuppress = false;
+		// Waveform envelope bucket duration, 0 to disable.
+		int envelopeIntervalMs = 0;
+		// Spectrum analysis, disabled when fftSize is 0.
+		record_core::SpectrumConfig spectrum;
+		// Voice activity detection, disabled by default.
+		record_core::VadConfig vad;
+		// Streamed chunk size in bytes, 0 to send each captured buffer.
+		int streamBufferSize = 0;
+		// Longest wait of streamed data for its chunk in ms, 0 for no limit.
+		int streamMaxDelayMs = 0;
+		// Streamed data is written to a shared ring and only its location is sent.
+		bool zeroCopyStream = false;
+		// Behaviour when the stream consumer doesn't keep up.
+		record_core::StreamOverflowPolicy streamOverflowPolicy = record_core::StreamOverflowPolicy::dropNewest;
+		// Captured, written and streamed PCM format.
+		record_core::SampleFormat sampleFormat = record_core::SampleFormat::s16;
+		// Requested capture period in ms, 0 for the source defaults.
+		int latencyMs = 0;
 
 		RecordConfig(
 			const std::string& encoderName,
@@ -37,7 +60,16 @@ namespace record_windows
 			int numChannels,
 			bool autoGain,
 			bool echoCancel,
-			bool noiseSuppress)
+			bool noiseSuppress,
+			int envelopeIntervalMs,
+			const record_core::SpectrumConfig& spectrum,
+			const record_core::VadConfig& vad,
+			int streamBufferSize,
+			int streamMaxDelayMs,
+			bool zeroCopyStream,
+			record_core::StreamOverflowPolicy streamOverflowPolicy,
+			record_core::SampleFormat sampleFormat,
+			int latencyMs)
 			: encoderName(encoderName),
 			deviceId(deviceId),
 			bitRate(bitRate),
@@ -45,7 +77,16 @@ namespace record_windows
 			numChannels(numChannels),
 			autoGain(autoGain),
 			echoCancel(echoCancel),
-			noiseSuppress(noiseSuppress)
+			noiseSuppress(noiseSuppress),
+			envelopeIntervalMs(envelopeIntervalMs),
+			spectrum(spectrum),
+			vad(vad),
+			streamBufferSize(streamBufferSize),
+			streamMaxDelayMs(streamMaxDelayMs),
+			zeroCopyStream(zeroCopyStream),
+			streamOverflowPolicy(streamOverflowPolicy),
+			sampleFormat(sampleFormat),
+			latencyMs(latencyMs)
 		{
 		}
 	};
@@ -0,0 +1,160 @@
+#include "record_devicewatcher.h"
+
+namespace record_windows
+{
+	// static
+	HRESULT DeviceWatcher::CreateInstance(std::function<void()> onChanged, DeviceWatcher** watcher)
+	{
+		auto pWatcher = new (std::nothrow) DeviceWatcher(std::move(onChanged));
+
+		if (pWatcher == NULL)
+		{
+			return E_OUTOFMEMORY;
+		}
+
+		*watcher = pWatcher;
+		return S_OK;
+	}
+
+	// static
+	HRESULT DeviceWatcher::GetDefaultDeviceId(std::string& deviceId)
+	{
+		IMMDeviceEnumerator* pEnumerator = NULL;
+		IMMDevice* pDevice = NULL;
+		LPWSTR id = NULL;
+
+		HRESULT hr = CoCreateInstance(
+			__uuidof(MMDeviceEnumerator), NULL, CLSCTX_ALL,
+			IID_PPV_ARGS(&pEnumerator));
+
+		if (SUCCEEDED(hr))
+		{
+			hr = pEnumerator->GetDefaultAudioEndpoint(eCapture, eConsole, &pDevice);
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = pDevice->GetId(&id);
+		}
+		if (SUCCEEDED(hr))
+		{
+			deviceId = toString(id);
+			CoTaskMemFree(id);
+		}
+		else if (hr == E_NOTFOUND)
+		{
+			// No capture device
+			deviceId.clear();
+			hr = S_OK;
+		}
+
+		SafeRelease(pDevice);
+		SafeRelease(pEnumerator);
+
+		return hr;
+	}
+
+	DeviceWatcher::DeviceWatcher(std::function<void()> onChanged)
+		: m_onChanged(std::move(onChanged))
+	{
+	}
+
+	DeviceWatcher::~DeviceWatcher()
+	{
+		Unregister();
+	}
+
+	HRESULT DeviceWatcher::Register()
+	{
+		if (m_pEnumerator)
+		{
+			return S_OK;
+		}
+
+		HRESULT hr = CoCreateInstance(
+			__uuidof(MMDeviceEnumerator), NULL, CLSCTX_ALL,
+			IID_PPV_ARGS(&m_pEnumerator));
+
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pEnumerator->RegisterEndpointNotificationCallback(this);
+		}
+		if (FAILED(hr))
+		{
+			SafeRelease(m_pEnumerator);
+		}
+
+		return hr;
+	}
+
+	HRESULT DeviceWatcher::Unregister()
+	{
+		if (!m_pEnumerator)
+		{
+			return S_OK;
+		}
+
+		// Waits for running callbacks
+		HRESULT hr = m_pEnumerator->UnregisterEndpointNotificationCallback(this);
+		SafeRelease(m_pEnumerator);
+
+		return hr;
+	}
+
+	STDMETHODIMP DeviceWatcher::QueryInterface(REFIID iid, void** ppv)
+	{
+		static const QITAB qit[] =
+		{
+			QITABENT(DeviceWatcher, IMMNotificationClient),
+			{ 0 },
+		};
+		return QISearch(this, qit, iid, ppv);
+	}
+
+	STDMETHODIMP_(ULONG) DeviceWatcher::AddRef()
+	{
+		return InterlockedIncrement(&m_nRefCount);
+	}
+
+	STDMETHODIMP_(ULONG) DeviceWatcher::Release()
+	{
+		ULONG uCount = InterlockedDecrement(&m_nRefCount);
+		if (uCount == 0)
+		{
+			delete this;
+		}
+		return uCount;
+	}
+
+	STDMETHODIMP DeviceWatcher::OnDeviceStateChanged(LPCWSTR pwstrDeviceId, DWORD dwNewState)
+	{
+		m_onChanged();
+		return S_OK;
+	}
+
+	STDMETHODIMP DeviceWatcher::OnDeviceAdded(LPCWSTR pwstrDeviceId)
+	{
+		m_onChanged();
+		return S_OK;
+	}
+
+	STDMETHODIMP DeviceWatcher::OnDeviceRemoved(LPCWSTR pwstrDeviceId)
+	{
+		m_onChanged();
+		return S_OK;
+	}
+
+	STDMETHODIMP DeviceWatcher::OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR pwstrDefaultDeviceId)
+	{
+		// Called for each role, the console one is the default input device.
+		if (flow == eCapture && role == eConsole)
+		{
+			m_onChanged();
+		}
+		return S_OK;
+	}
+
+	STDMETHODIMP DeviceWatcher::OnPropertyValueChanged(LPCWSTR pwstrDeviceId, const PROPERTYKEY key)
+	{
+		return S_OK;
+	}
+};
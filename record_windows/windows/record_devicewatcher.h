@@ -0,0 +1,48 @@
+#pragma once
+
+#include <windows.h>
+#include <mmdeviceapi.h>
+#include <shlwapi.h>
+
+#include <functional>
+#include <string>
+
+#include "utils.h"
+
+namespace record_windows
+{
+	// Watches audio endpoints and notifies when capture devices may have changed
+	// (added, removed, enabled/disabled or new default device).
+	// Callback is called from a system thread.
+	class DeviceWatcher : public IMMNotificationClient
+	{
+	public:
+		static HRESULT CreateInstance(std::function<void()> onChanged, DeviceWatcher** watcher);
+
+		// Gets the ID of the default capture endpoint (console role).
+		static HRESULT GetDefaultDeviceId(std::string& deviceId);
+
+		HRESULT Register();
+		HRESULT Unregister();
+
+		// IUnknown methods
+		STDMETHODIMP QueryInterface(REFIID iid, void** ppv);
+		STDMETHODIMP_(ULONG) AddRef();
+		STDMETHODIMP_(ULONG) Release();
+
+		// IMMNotificationClient methods
+		STDMETHODIMP OnDeviceStateChanged(LPCWSTR pwstrDeviceId, DWORD dwNewState);
+		STDMETHODIMP OnDeviceAdded(LPCWSTR pwstrDeviceId);
+		STDMETHODIMP OnDeviceRemoved(LPCWSTR pwstrDeviceId);
+		STDMETHODIMP OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR pwstrDefaultDeviceId);
+		STDMETHODIMP OnPropertyValueChanged(LPCWSTR pwstrDeviceId, const PROPERTYKEY key);
+
+	private:
+		DeviceWatcher(std::function<void()> onChanged);
+		virtual ~DeviceWatcher();
+
+		long m_nRefCount = 1;
+		std::function<void()> m_onChanged;
+		IMMDeviceEnumerator* m_pEnumerator = NULL;
+	};
+};
@@ -17,13 +17,17 @@ namespace record_windows
 		{
 			hr = pMediaType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Audio);
 		}
+		// The source reader converts from the device format.
+		const UINT32 bitsPerSample = static_cast<UINT32>(record_core::BytesPerSample(m_pConfig->sampleFormat) * 8);
+		const UINT32 blockAlign = m_pConfig->numChannels * (bitsPerSample / 8);
+
 		if (SUCCEEDED(hr))
 		{
-			hr = pMediaType->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_PCM);
+			hr = pMediaType->SetGUID(MF_MT_SUBTYPE, SampleFormatSubtype());
 		}
 		if (SUCCEEDED(hr))
 		{
-			hr = pMediaType->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, 16);
+			hr = pMediaType->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, bitsPerSample);
 		}
 		if (SUCCEEDED(hr))
 		{
@@ -34,6 +38,14 @@ namespace record_windows
 			hr = pMediaType->SetUINT32(MF_MT_AUDIO_NUM_CHANNELS, m_pConfig->numChannels);
 		}
 		if (SUCCEEDED(hr))
+		{
+			hr = pMediaType->SetUINT32(MF_MT_AUDIO_BLOCK_ALIGNMENT, blockAlign);
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = pMediaType->SetUINT32(MF_MT_AUDIO_AVG_BYTES_PER_SECOND, blockAlign * m_pConfig->sampleRate);
+		}
+		if (SUCCEEDED(hr))
 		{
 			hr = pMediaType->SetUINT32(MF_MT_AVG_BITRATE, m_pConfig->bitRate);
 		}
@@ -162,11 +174,16 @@ namespace record_windows
 		return hr;
 	}
 
+	GUID Recorder::SampleFormatSubtype()
+	{
+		return m_pConfig->sampleFormat == record_core::SampleFormat::f32 ? MFAudioFormat_Float : MFAudioFormat_PCM;
+	}
+
 	HRESULT Recorder::CreatePcmProfile(IMFMediaType* pMediaType)
 	{
-		HRESULT hr = pMediaType->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_PCM);
+		HRESULT hr = pMediaType->SetGUID(MF_MT_SUBTYPE, SampleFormatSubtype());
 
-		auto bitsPerSample = 16;
+		auto bitsPerSample = static_cast<UINT32>(record_core::BytesPerSample(m_pConfig->sampleFormat) * 8);
 
 		if (SUCCEEDED(hr))
 		{
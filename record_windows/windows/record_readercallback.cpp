@@ -21,13 +21,24 @@ namespace record_windows
 		IMFSample* pSample      // Can be NULL
 	)
 	{
+		// With the block policy, waits for the stream consumer before locking so
+		// Stop, Pause and getters aren't held up meanwhile.
+		m_streamQueue.WaitForSpace();
+
 		AutoLock lock(m_critsec);
 
+		// Callback queued before the recording ended.
+		if (!m_pReader || !m_pConfig)
+		{
+			return S_OK;
+		}
+
 		HRESULT hr = S_OK;
 
 		if (SUCCEEDED(hrStatus))
 		{
-			if (pSample)
+			// Samples of a prepared reader are dropped until started.
+			if (pSample && !m_prepared)
 			{
 				if (m_bFirstSample)
 				{
@@ -39,48 +50,72 @@ namespace record_windows
 				// Save current timestamp in case of Pause
 				m_llLastTime = llTimestamp;
 
-				// rebase the time stamp
-				llTimestamp -= m_llBaseTime;
+				// Capture timestamps are on the system clock. When the age is out of range
+				// they aren't, and the latency is unknown.
+				LONGLONG llDuration = 0;
+				pSample->GetSampleDuration(&llDuration);
+				const LONGLONG llAge = MFGetSystemTime() - llTimestamp;
+				m_captureTiming.AddBuffer(llDuration / 10, llAge >= 0 && llAge < 10000000 ? llAge / 10 : -1);
 
-				hr = pSample->SetSampleTime(llTimestamp);
+				bool keepSample = true;
 
-				// Write to file if there's a writer
-				if (SUCCEEDED(hr) && m_pWriter)
-				{
-					hr = m_pWriter->WriteSample(dwStreamIndex, pSample);
-				}
+				IMFMediaBuffer* pBuffer = NULL;
+				hr = pSample->ConvertToContiguousBuffer(&pBuffer);
 
 				if (SUCCEEDED(hr))
 				{
-					IMFMediaBuffer* pBuffer = NULL;
-					hr = pSample->ConvertToContiguousBuffer(&pBuffer);
+					BYTE* pChunk = NULL;
+					DWORD size = 0;
+					hr = pBuffer->Lock(&pChunk, NULL, &size);
 
 					if (SUCCEEDED(hr))
 					{
-						BYTE* pChunk = NULL;
-						DWORD size = 0;
-						hr = pBuffer->Lock(&pChunk, NULL, &size);
+						// Meters and analyzers work on 16 bits whatever the capture format.
+						const size_t frameCount = size / FrameBytes();
+						const int16_t* samples = m_sampleConverter.ToS16(pChunk, frameCount * std::max(1, m_pConfig->numChannels));
 
-						if (SUCCEEDED(hr))
+						UpdateMeters(samples, frameCount);
+						keepSample = DetectVoice(samples, frameCount);
+
+						if (keepSample)
 						{
 							// Update total data written
 							m_dataWritten += size;
 
-							// Send data to stream when there's no writer
-							if (m_recordEventHandler && !m_pWriter) {
-								std::vector<uint8_t> bytes(pChunk, pChunk + size);
-
-								RecordWindowsPlugin::RunOnMainThread([this, bytes]() -> void {
-									m_recordEventHandler->Success(std::make_unique<flutter::EncodableValue>(bytes));
-								});
+							// Send PCM data to stream when there's no writer nor encoder
+							if (!m_pWriter && !m_pEncoder) {
+								SendStreamData(pChunk, size);
 							}
+						}
 
-							GetAmplitude(pChunk, size, 2);
+						pBuffer->Unlock();
+					}
 
-							pBuffer->Unlock();
-						}
+					SafeRelease(pBuffer);
+				}
+
+				if (SUCCEEDED(hr))
+				{
+					if (keepSample)
+					{
+						// rebase the time stamp
+						hr = pSample->SetSampleTime(llTimestamp - m_llBaseTime);
 
-						SafeRelease(pBuffer);
+						// Write to file if there's a writer
+						if (SUCCEEDED(hr) && m_pWriter)
+						{
+							hr = m_pWriter->WriteSample(dwStreamIndex, pSample);
+						}
+						// Or encode it to stream packets
+						else if (SUCCEEDED(hr) && m_pEncoder)
+						{
+							hr = EncodeStreamSample(pSample);
+						}
+					}
+					else
+					{
+						// Skipped silence, shift base time so written samples stay contiguous.
+						m_llBaseTime += llDuration;
 					}
 				}
 			}
@@ -0,0 +1,354 @@
+#include "record.h"
+
+namespace record_windows
+{
+	// Size of HEAACWAVEINFO fields preceding AudioSpecificConfig in AAC user data.
+	static const UINT32 kAacUserDataHeaderSize = 12;
+
+	HRESULT Recorder::CreateStreamEncoder()
+	{
+		IMFMediaType* pProfile = NULL;
+		IMFMediaType* pMediaTypeIn = NULL;
+		IMFMediaType* pMediaTypeOut = NULL;
+		IMFActivate** ppActivate = NULL;
+		UINT32 count = 0;
+		GUID subtype{};
+
+		// Requested format, used to pick the encoder and its output type.
+		HRESULT hr = CreateAudioProfileOut(&pProfile);
+
+		if (SUCCEEDED(hr))
+		{
+			hr = pProfile->GetGUID(MF_MT_SUBTYPE, &subtype);
+		}
+		if (SUCCEEDED(hr))
+		{
+			MFT_REGISTER_TYPE_INFO inputInfo = { MFMediaType_Audio, MFAudioFormat_PCM };
+			MFT_REGISTER_TYPE_INFO outputInfo = { MFMediaType_Audio, subtype };
+
+			hr = MFTEnumEx(
+				MFT_CATEGORY_AUDIO_ENCODER,
+				(MFT_ENUM_FLAG_ALL & (~MFT_ENUM_FLAG_FIELDOFUSE)) | MFT_ENUM_FLAG_SORTANDFILTER,
+				&inputInfo,
+				&outputInfo,
+				&ppActivate,
+				&count
+			);
+		}
+		if (SUCCEEDED(hr) && count == 0)
+		{
+			hr = MF_E_TOPO_CODEC_NOT_FOUND;
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = ppActivate[0]->ActivateObject(IID_PPV_ARGS(&m_pEncoder));
+		}
+
+		// Encoders require output type first.
+		if (SUCCEEDED(hr))
+		{
+			hr = SelectEncoderOutputType(subtype, &pMediaTypeOut);
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pEncoder->SetOutputType(0, pMediaTypeOut, 0);
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pReader->GetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM, &pMediaTypeIn);
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pEncoder->SetInputType(0, pMediaTypeIn, 0);
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = CreateEncoderOutputSample();
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pEncoder->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, 0);
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pEncoder->ProcessMessage(MFT_MESSAGE_NOTIFY_START_OF_STREAM, 0);
+		}
+		if (SUCCEEDED(hr))
+		{
+			ReadCodecConfig(pMediaTypeOut, subtype);
+		}
+
+		for (UINT32 i = 0; i < count; i++)
+		{
+			SafeRelease(&ppActivate[i]);
+		}
+		CoTaskMemFree(ppActivate);
+
+		SafeRelease(&pProfile);
+		SafeRelease(&pMediaTypeIn);
+		SafeRelease(&pMediaTypeOut);
+
+		return hr;
+	}
+
+	HRESULT Recorder::SelectEncoderOutputType(const GUID& subtype, IMFMediaType** ppMediaType)
+	{
+		// Encoders only accept their own output types (e.g. fixed AAC byte rates),
+		// so take the available one closest to the requested bit rate.
+		IMFMediaType* pBest = NULL;
+		UINT32 bestDistance = UINT32_MAX;
+		HRESULT hr = S_OK;
+
+		for (DWORD i = 0; ; i++)
+		{
+			IMFMediaType* pType = NULL;
+			hr = m_pEncoder->GetOutputAvailableType(0, i, &pType);
+
+			if (hr == MF_E_NO_MORE_TYPES)
+			{
+				hr = S_OK;
+				break;
+			}
+			if (FAILED(hr))
+			{
+				break;
+			}
+
+			GUID typeSubtype{};
+			UINT32 rate = 0, channels = 0, bytesPerSecond = 0;
+			pType->GetGUID(MF_MT_SUBTYPE, &typeSubtype);
+			pType->GetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, &rate);
+			pType->GetUINT32(MF_MT_AUDIO_NUM_CHANNELS, &channels);
+			pType->GetUINT32(MF_MT_AUDIO_AVG_BYTES_PER_SECOND, &bytesPerSecond);
+
+			if (typeSubtype == subtype && rate == (UINT32)m_pConfig->sampleRate && channels == (UINT32)m_pConfig->numChannels)
+			{
+				const UINT32 requested = (UINT32)m_pConfig->bitRate / 8;
+				const UINT32 distance = bytesPerSecond > requested ? bytesPerSecond - requested : requested - bytesPerSecond;
+
+				if (!pBest || distance < bestDistance)
+				{
+					SafeRelease(&pBest);
+					pBest = pType;
+					pBest->AddRef();
+					bestDistance = distance;
+				}
+			}
+
+			SafeRelease(&pType);
+		}
+
+		if (SUCCEEDED(hr) && !pBest)
+		{
+			hr = MF_E_INVALIDMEDIATYPE;
+		}
+		if (SUCCEEDED(hr))
+		{
+			*ppMediaType = pBest;
+			(*ppMediaType)->AddRef();
+		}
+
+		SafeRelease(&pBest);
+
+		return hr;
+	}
+
+	HRESULT Recorder::CreateEncoderOutputSample()
+	{
+		MFT_OUTPUT_STREAM_INFO info = {};
+		IMFMediaBuffer* pBuffer = NULL;
+
+		HRESULT hr = m_pEncoder->GetOutputStreamInfo(0, &info);
+
+		// Otherwise output samples are allocated by the encoder.
+		if (SUCCEEDED(hr) && !(info.dwFlags & MFT_OUTPUT_STREAM_PROVIDES_SAMPLES))
+		{
+			// Reused for every packet.
+			hr = MFCreateMemoryBuffer(std::max<DWORD>(info.cbSize, 4096), &pBuffer);
+
+			if (SUCCEEDED(hr))
+			{
+				hr = MFCreateSample(&m_pEncoderSample);
+			}
+			if (SUCCEEDED(hr))
+			{
+				hr = m_pEncoderSample->AddBuffer(pBuffer);
+			}
+		}
+
+		SafeRelease(&pBuffer);
+
+		return hr;
+	}
+
+	void Recorder::ReadCodecConfig(IMFMediaType* pMediaType, const GUID& subtype)
+	{
+		m_codecConfig.clear();
+
+		UINT32 size = 0;
+		if (FAILED(pMediaType->GetBlobSize(MF_MT_USER_DATA, &size)) || size == 0)
+		{
+			return;
+		}
+
+		std::vector<uint8_t> userData(size);
+		if (FAILED(pMediaType->GetBlob(MF_MT_USER_DATA, userData.data(), size, NULL)))
+		{
+			return;
+		}
+
+		// Keep AudioSpecificConfig only, as expected by AAC decoders.
+		const UINT32 skip = subtype == MFAudioFormat_AAC ? kAacUserDataHeaderSize : 0;
+
+		if (size > skip)
+		{
+			m_codecConfig.assign(userData.begin() + skip, userData.end());
+		}
+	}
+
+	std::vector<uint8_t> Recorder::GetCodecConfig()
+	{
+		AutoLock lock(m_critsec);
+
+		return m_codecConfig;
+	}
+
+	HRESULT Recorder::EncodeStreamSample(IMFSample* pSample)
+	{
+		HRESULT hr = m_pEncoder->ProcessInput(0, pSample, 0);
+
+		if (hr == MF_E_NOTACCEPTING)
+		{
+			// Pending output must be collected first.
+			hr = DrainStreamEncoder();
+
+			if (SUCCEEDED(hr))
+			{
+				hr = m_pEncoder->ProcessInput(0, pSample, 0);
+			}
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = DrainStreamEncoder();
+		}
+
+		return hr;
+	}
+
+	HRESULT Recorder::DrainStreamEncoder()
+	{
+		HRESULT hr = S_OK;
+
+		while (SUCCEEDED(hr))
+		{
+			MFT_OUTPUT_DATA_BUFFER output = {};
+			DWORD status = 0;
+
+			if (m_pEncoderSample)
+			{
+				IMFMediaBuffer* pBuffer = NULL;
+				if (SUCCEEDED(m_pEncoderSample->GetBufferByIndex(0, &pBuffer)))
+				{
+					pBuffer->SetCurrentLength(0);
+					SafeRelease(&pBuffer);
+				}
+				output.pSample = m_pEncoderSample;
+			}
+
+			hr = m_pEncoder->ProcessOutput(0, 1, &output, &status);
+			SafeRelease(&output.pEvents);
+
+			if (hr == MF_E_TRANSFORM_NEED_MORE_INPUT)
+			{
+				hr = S_OK;
+				break;
+			}
+			if (hr == MF_E_TRANSFORM_STREAM_CHANGE)
+			{
+				IMFMediaType* pMediaType = NULL;
+				hr = m_pEncoder->GetOutputAvailableType(0, 0, &pMediaType);
+
+				if (SUCCEEDED(hr))
+				{
+					hr = m_pEncoder->SetOutputType(0, pMediaType, 0);
+				}
+
+				SafeRelease(&pMediaType);
+				continue;
+			}
+			if (SUCCEEDED(hr) && output.pSample)
+			{
+				hr = SendEncodedSample(output.pSample);
+			}
+
+			// Samples provided by the encoder are ours.
+			if (output.pSample != m_pEncoderSample)
+			{
+				SafeRelease(&output.pSample);
+			}
+		}
+
+		return hr;
+	}
+
+	HRESULT Recorder::SendEncodedSample(IMFSample* pSample)
+	{
+		IMFMediaBuffer* pBuffer = NULL;
+		record_core::StreamPacketInfo info;
+		LONGLONG llTime = 0;
+		LONGLONG llDuration = 0;
+
+		// MF times are in 100ns units.
+		if (SUCCEEDED(pSample->GetSampleTime(&llTime)))
+		{
+			info.timestampUs = llTime / 10;
+		}
+		if (SUCCEEDED(pSample->GetSampleDuration(&llDuration)))
+		{
+			info.durationUs = llDuration / 10;
+		}
+
+		HRESULT hr = pSample->ConvertToContiguousBuffer(&pBuffer);
+
+		if (SUCCEEDED(hr))
+		{
+			BYTE* pData = NULL;
+			DWORD size = 0;
+			hr = pBuffer->Lock(&pData, NULL, &size);
+
+			if (SUCCEEDED(hr))
+			{
+				if (m_recordEventHandler && m_streamQueue.PushPacket(pData, size, info))
+				{
+					ScheduleStreamDrain();
+				}
+
+				pBuffer->Unlock();
+			}
+		}
+
+		SafeRelease(&pBuffer);
+
+		return hr;
+	}
+
+	void Recorder::FinishStreamEncoder()
+	{
+		if (!m_pEncoder)
+		{
+			return;
+		}
+
+		// Collect the packets of buffered audio.
+		if (SUCCEEDED(m_pEncoder->ProcessMessage(MFT_MESSAGE_NOTIFY_END_OF_STREAM, 0)) &&
+			SUCCEEDED(m_pEncoder->ProcessMessage(MFT_MESSAGE_COMMAND_DRAIN, 0)))
+		{
+			DrainStreamEncoder();
+		}
+
+		m_pEncoder->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, 0);
+
+		SafeRelease(m_pEncoderSample);
+		SafeRelease(m_pEncoder);
+	}
+};
@@ -1,9 +1,9 @@
 #include "record_windows_plugin.h"
+#include <algorithm>
 #include <mfreadwrite.h>
 #include <Mferror.h>
 #include "record_config.h"
 #include <flutter/event_stream_handler_functions.h>
-#include <mutex>
 
 using namespace flutter;
 
@@ -58,28 +58,17 @@ namespace record_windows {
 				plugin_pointer->HandleMethodCall(call, std::move(result));
 			});
 
+		plugin->StartDeviceWatcher();
+
 		registrar->AddPlugin(std::move(plugin));
 	}
 
 	// static
-	std::queue<std::function<void()>> RecordWindowsPlugin::callbacks{};
-
-	// static
-	std::mutex RecordWindowsPlugin::callbacks_mutex{};
+	record_core::MainThreadDispatcher RecordWindowsPlugin::dispatcher{};
 
 	// static
 	FlutterRootWindowProvider RecordWindowsPlugin::get_root_window{};
 
-	// static
-	void RecordWindowsPlugin::RunOnMainThread(std::function<void()> callback) {
-		// Lock only while pushing the callback, then release before posting the message.
-		{
-			std::lock_guard<std::mutex> lock(callbacks_mutex);
-			callbacks.push(callback);
-		}
-		PostMessage(get_root_window(), WM_RUN_DELEGATE, 0, 0);
-	}
-
 	RecordWindowsPlugin::RecordWindowsPlugin(
 		WindowProcDelegateRegistrator registrator,
 		WindowProcDelegateUnregistrator unregistrator,
@@ -89,6 +78,11 @@ namespace record_windows {
 
 		get_root_window = std::move(window_provider);
 
+		// Win32 adapter, a single message is posted until the dispatcher is drained.
+		dispatcher.SetWakeup([](void*) {
+			PostMessage(get_root_window(), WM_RUN_DELEGATE, 0, 0);
+		}, nullptr);
+
 		m_window_proc_id = m_win_proc_delegate_registrator(
 			[this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
 				return HandleWindowProc(hwnd, message, wparam, lparam);
@@ -102,6 +96,12 @@ namespace record_windows {
 			recorder->Dispose();
 		}
 
+		if (m_pDeviceWatcher)
+		{
+			m_pDeviceWatcher->Unregister();
+			SafeRelease(m_pDeviceWatcher);
+		}
+
 		m_win_proc_delegate_unregistrator(m_window_proc_id);
 	}
 
@@ -112,18 +112,8 @@ namespace record_windows {
 		std::optional<LRESULT> result;
 		switch (message) {
 		case WM_RUN_DELEGATE:
-			{
-				std::function<void()> cb;
-				{
-					std::lock_guard<std::mutex> lock(callbacks_mutex);
-					if (!callbacks.empty()) {
-						cb = std::move(callbacks.front());
-						callbacks.pop();
-					}
-				}
-				if (cb) cb();
-				result = 0;
-			}
+			dispatcher.Drain();
+			result = 0;
 			break;
 		}
 		return result;
@@ -195,6 +185,15 @@ namespace record_windows {
 			if (SUCCEEDED(hr)) { result->Success(EncodableValue()); }
 			else { ErrorFromHR(hr, *result); }
 		}
+		else if (method_call.method_name().compare("prepare") == 0)
+		{
+			auto config = InitRecordConfig(mapArgs);
+
+			HRESULT hr = recorder->Prepare(std::move(config));
+
+			if (SUCCEEDED(hr)) { result->Success(EncodableValue()); }
+			else { ErrorFromHR(hr, *result); }
+		}
 		else if (method_call.method_name().compare("start") == 0)
 		{
 			auto config = InitRecordConfig(mapArgs);
@@ -213,8 +212,46 @@ namespace record_windows {
 
 			HRESULT hr = recorder->StartStream(std::move(config));
 
-			if (SUCCEEDED(hr)) { result->Success(EncodableValue()); }
-			else { ErrorFromHR(hr, *result); }
+			if (FAILED(hr))
+			{
+				ErrorFromHR(hr, *result);
+				return;
+			}
+
+			// Chunks sent ahead of "ackStream" calls.
+			EncodableMap stream({
+				{EncodableValue("credit"), EncodableValue(static_cast<int64_t>(record_core::kStreamCredit))}
+			});
+
+			// Shared ring, the reference is handed over to Dart.
+			if (auto ring = recorder->GetPcmRing())
+			{
+				stream[EncodableValue("ring")] = EncodableValue(reinterpret_cast<int64_t>(ring));
+				stream[EncodableValue("data")] = EncodableValue(reinterpret_cast<int64_t>(ring->Data()));
+				stream[EncodableValue("cursor")] = EncodableValue(reinterpret_cast<int64_t>(ring->ReservedCursor()));
+				stream[EncodableValue("capacity")] = EncodableValue(static_cast<int64_t>(ring->Capacity()));
+				stream[EncodableValue("release")] = EncodableValue(reinterpret_cast<int64_t>(&record_core::PcmRing::ReleaseCallback));
+			}
+			else
+			{
+				// Encoded stream, decoders may require setup data before packets.
+				auto codecConfig = recorder->GetCodecConfig();
+
+				if (!codecConfig.empty())
+				{
+					stream[EncodableValue("codecConfig")] = EncodableValue(codecConfig);
+				}
+			}
+
+			result->Success(EncodableValue(stream));
+		}
+		else if (method_call.method_name().compare("ackStream") == 0)
+		{
+			int count = 0;
+			GetValueFromEncodableMap(mapArgs, "count", count);
+
+			recorder->AcknowledgeStream(static_cast<size_t>(std::max(0, count)));
+			result->Success(EncodableValue());
 		}
 		else if (method_call.method_name().compare("stop") == 0)
 		{
@@ -254,22 +291,92 @@ namespace record_windows {
 				m_recorders.erase(recorderId);
 				m_state_event_channels.erase(recorderId);
 				m_record_event_channels.erase(recorderId);
+				m_envelope_event_channels.erase(recorderId);
+				m_spectrum_event_channels.erase(recorderId);
+				m_vad_event_channels.erase(recorderId);
 			});
 
 			result->Success(EncodableValue());
 		}
 		else if (method_call.method_name().compare("getAmplitude") == 0)
 		{
-			auto amp = recorder->GetAmplitude();
+			auto meters = recorder->GetMeters();
+
+			EncodableList channels;
+			for (int ch = 0; ch < meters.numChannels; ch++)
+			{
+				const auto& levels = meters.channels[ch];
+
+				channels.push_back(EncodableMap({
+					{EncodableValue("peak"), EncodableValue(levels.peak)},
+					{EncodableValue("rms"), EncodableValue(levels.rms)},
+					{EncodableValue("truePeak"), EncodableValue(levels.truePeak)},
+					{EncodableValue("peakHold"), EncodableValue(levels.peakHold)}
+					}));
+			}
+
+			result->Success(EncodableValue(
+				EncodableMap({
+					{EncodableValue("current"), EncodableValue(meters.current)},
+					{EncodableValue("max"), EncodableValue(meters.max)},
+					{EncodableValue("rms"), EncodableValue(meters.rms)},
+					{EncodableValue("clipCount"), EncodableValue(static_cast<int64_t>(meters.clipCount))},
+					{EncodableValue("channels"), EncodableValue(channels)}
+					}
+				))
+			);
+		}
+		else if (method_call.method_name().compare("getLoudness") == 0)
+		{
+			auto loudness = recorder->GetMeters().loudness;
 
 			result->Success(EncodableValue(
 				EncodableMap({
-					{EncodableValue("current"), EncodableValue(amp["current"])},
-					{EncodableValue("max"), EncodableValue(amp["max"])}
+					{EncodableValue("momentary"), EncodableValue(loudness.momentary)},
+					{EncodableValue("shortTerm"), EncodableValue(loudness.shortTerm)},
+					{EncodableValue("integrated"), EncodableValue(loudness.integrated)},
+					{EncodableValue("range"), EncodableValue(loudness.range)}
 					}
 				))
 			);
 		}
+		else if (method_call.method_name().compare("getStreamStats") == 0)
+		{
+			auto stats = recorder->GetStreamStats();
+			auto dispatcherStats = dispatcher.Stats();
+
+			result->Success(EncodableValue(
+				EncodableMap({
+					{EncodableValue("droppedBytes"), EncodableValue(static_cast<int64_t>(stats.droppedBytes))},
+					{EncodableValue("droppedChunks"), EncodableValue(static_cast<int64_t>(stats.droppedChunks))},
+					{EncodableValue("queuedChunks"), EncodableValue(static_cast<int64_t>(stats.queuedChunks))},
+					{EncodableValue("dispatchQueueDepth"), EncodableValue(static_cast<int64_t>(dispatcherStats.queueDepth))},
+					{EncodableValue("dispatchLatency"), EncodableValue(dispatcherStats.meanLatencyUs)},
+					{EncodableValue("maxDispatchLatency"), EncodableValue(dispatcherStats.maxLatencyUs)}
+					}
+				))
+			);
+		}
+		else if (method_call.method_name().compare("getLatency") == 0)
+		{
+			if (!recorder->IsRecording() && !recorder->IsPaused())
+			{
+				result->Success(EncodableValue());
+				return;
+			}
+
+			auto latency = recorder->GetLatency();
+
+			EncodableMap map({
+				{EncodableValue("period"), EncodableValue(latency.periodUs)}
+				});
+			if (latency.latencyUs > 0)
+			{
+				map[EncodableValue("latency")] = EncodableValue(latency.latencyUs);
+			}
+
+			result->Success(EncodableValue(map));
+		}
 		else if (method_call.method_name().compare("isEncoderSupported") == 0)
 		{
 			std::string encoderName;
@@ -321,6 +428,46 @@ namespace record_windows {
 		GetValueFromEncodableMap(args, "echoCancel", echoCancel);
 		bool noiseSuppress;
 		GetValueFromEncodableMap(args, "noiseSuppress", noiseSuppress);
+		int envelopeInterval = 0;
+		GetValueFromEncodableMap(args, "envelopeInterval", envelopeInterval);
+		EncodableMap spectrumMap;
+		record_core::SpectrumConfig spectrum;
+		if (GetValueFromEncodableMap(args, "spectrum", spectrumMap))
+		{
+			GetValueFromEncodableMap(&spectrumMap, "fftSize", spectrum.fftSize);
+			GetValueFromEncodableMap(&spectrumMap, "hopSize", spectrum.hopSize);
+			GetValueFromEncodableMap(&spectrumMap, "numBands", spectrum.numBands);
+			GetValueFromEncodableMap(&spectrumMap, "minFrequency", spectrum.minFrequency);
+			GetValueFromEncodableMap(&spectrumMap, "maxFrameRate", spectrum.maxFrameRate);
+		}
+		EncodableMap vadMap;
+		record_core::VadConfig vad;
+		if (GetValueFromEncodableMap(args, "vad", vadMap))
+		{
+			int mode = 0;
+			GetValueFromEncodableMap(&vadMap, "mode", mode);
+			vad.mode = static_cast<record_core::VadMode>(mode);
+			GetValueFromEncodableMap(&vadMap, "threshold", vad.thresholdDb);
+			GetValueFromEncodableMap(&vadMap, "minEnergy", vad.minEnergyDb);
+			GetValueFromEncodableMap(&vadMap, "hangover", vad.hangoverMs);
+		}
+		int streamBufferSize = 0;
+		GetValueFromEncodableMap(args, "streamBufferSize", streamBufferSize);
+		int streamMaxDelay = 0;
+		GetValueFromEncodableMap(args, "streamMaxDelay", streamMaxDelay);
+		bool zeroCopyStream = false;
+		GetValueFromEncodableMap(args, "zeroCopyStream", zeroCopyStream);
+		int streamOverflowPolicy = static_cast<int>(record_core::StreamOverflowPolicy::dropNewest);
+		GetValueFromEncodableMap(args, "streamOverflowPolicy", streamOverflowPolicy);
+		int sampleFormat = static_cast<int>(record_core::SampleFormat::s16);
+		GetValueFromEncodableMap(args, "sampleFormat", sampleFormat);
+		// Compressed encoders are fed with 16 bits samples.
+		if (encoderName != AudioEncoder().pcm16bits && encoderName != AudioEncoder().wav)
+		{
+			sampleFormat = static_cast<int>(record_core::SampleFormat::s16);
+		}
+		int latency = 0;
+		GetValueFromEncodableMap(args, "latency", latency);
 
 		auto config = std::make_unique<RecordConfig>(
 			encoderName,
@@ -330,7 +477,16 @@ namespace record_windows {
 			numChannels,
 			autoGain,
 			echoCancel,
-			noiseSuppress
+			noiseSuppress,
+			envelopeInterval,
+			spectrum,
+			vad,
+			streamBufferSize,
+			streamMaxDelay,
+			zeroCopyStream,
+			static_cast<record_core::StreamOverflowPolicy>(streamOverflowPolicy),
+			static_cast<record_core::SampleFormat>(sampleFormat),
+			latency > 0 ? std::clamp(latency, 5, 200) : 0
 		);
 
 		return config;
@@ -356,14 +512,44 @@ namespace record_windows {
 		std::unique_ptr<StreamHandler<EncodableValue>> pRecordEventHandler{static_cast<StreamHandler<EncodableValue>*>(eventRecordHandler)};
 		eventRecordChannel->SetStreamHandler(std::move(pRecordEventHandler));
 
+		// Waveform envelope event channel
+		auto eventEnvelopeChannel = std::make_unique<EventChannel<EncodableValue>>(
+			m_binaryMessenger, "com.llfbandit.record/eventsEnvelope/" + recorderId,
+			&StandardMethodCodec::GetInstance());
+
+		auto eventEnvelopeHandler = new EventStreamHandler<>();
+		std::unique_ptr<StreamHandler<EncodableValue>> pEnvelopeEventHandler{static_cast<StreamHandler<EncodableValue>*>(eventEnvelopeHandler)};
+		eventEnvelopeChannel->SetStreamHandler(std::move(pEnvelopeEventHandler));
+
+		// Spectrum event channel
+		auto eventSpectrumChannel = std::make_unique<EventChannel<EncodableValue>>(
+			m_binaryMessenger, "com.llfbandit.record/eventsSpectrum/" + recorderId,
+			&StandardMethodCodec::GetInstance());
+
+		auto eventSpectrumHandler = new EventStreamHandler<>();
+		std::unique_ptr<StreamHandler<EncodableValue>> pSpectrumEventHandler{static_cast<StreamHandler<EncodableValue>*>(eventSpectrumHandler)};
+		eventSpectrumChannel->SetStreamHandler(std::move(pSpectrumEventHandler));
+
+		// Voice activity event channel
+		auto eventVadChannel = std::make_unique<EventChannel<EncodableValue>>(
+			m_binaryMessenger, "com.llfbandit.record/eventsVad/" + recorderId,
+			&StandardMethodCodec::GetInstance());
+
+		auto eventVadHandler = new EventStreamHandler<>();
+		std::unique_ptr<StreamHandler<EncodableValue>> pVadEventHandler{static_cast<StreamHandler<EncodableValue>*>(eventVadHandler)};
+		eventVadChannel->SetStreamHandler(std::move(pVadEventHandler));
+
 		// Keep channels alive for the recorder lifetime and also keep shared
 		// ownership of handlers so Recorder's weak_ptr captures remain valid
 		m_state_event_channels.insert(std::make_pair(recorderId, std::move(eventChannel)));
 		m_record_event_channels.insert(std::make_pair(recorderId, std::move(eventRecordChannel)));
+		m_envelope_event_channels.insert(std::make_pair(recorderId, std::move(eventEnvelopeChannel)));
+		m_spectrum_event_channels.insert(std::make_pair(recorderId, std::move(eventSpectrumChannel)));
+		m_vad_event_channels.insert(std::make_pair(recorderId, std::move(eventVadChannel)));
 
 		Recorder* pRecorder = NULL;
 
-		HRESULT hr = Recorder::CreateInstance(eventHandler, eventRecordHandler, &pRecorder);
+		HRESULT hr = Recorder::CreateInstance(eventHandler, eventRecordHandler, eventEnvelopeHandler, eventSpectrumHandler, eventVadHandler, &pRecorder);
 		if (SUCCEEDED(hr))
 		{
 			m_recorders.insert(std::make_pair(recorderId, std::move(pRecorder)));
@@ -381,15 +567,147 @@ namespace record_windows {
 		return searchedRecorder->second.get();
 	}
 
-	HRESULT RecordWindowsPlugin::ListInputDevices(MethodResult<EncodableValue>& result)
+	void RecordWindowsPlugin::StartDeviceWatcher()
+	{
+		m_devices_event_channel = std::make_unique<EventChannel<EncodableValue>>(
+			m_binaryMessenger, "com.llfbandit.record/eventsDevices",
+			&StandardMethodCodec::GetInstance());
+
+		// Changes are reported from the list known when listening.
+		m_devicesEventHandler = new EventStreamHandler<>([this]() -> void {
+			RefreshInputDevices();
+		});
+		std::unique_ptr<StreamHandler<EncodableValue>> pDevicesEventHandler{static_cast<StreamHandler<EncodableValue>*>(m_devicesEventHandler)};
+		m_devices_event_channel->SetStreamHandler(std::move(pDevicesEventHandler));
+
+		HRESULT hr = DeviceWatcher::CreateInstance([this]() -> void {
+			OnInputDevicesChanged();
+		}, &m_pDeviceWatcher);
+
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pDeviceWatcher->Register();
+		}
+		if (FAILED(hr))
+		{
+			// Devices are then enumerated on each call.
+			SafeRelease(m_pDeviceWatcher);
+		}
+	}
+
+	// Called from a system thread.
+	void RecordWindowsPlugin::OnInputDevicesChanged()
 	{
+		m_inputDevicesStale = true;
+
+		// A single refresh is scheduled at a time, it sees every earlier change.
+		if (!m_inputDevicesRefreshPending.exchange(true))
+		{
+			RecordWindowsPlugin::RunOnMainThread([this]() -> void {
+				m_inputDevicesRefreshPending = false;
+				RefreshInputDevices();
+			});
+		}
+	}
+
+	static bool ContainsDevice(const EncodableList& devices, const EncodableValue& device)
+	{
+		const auto& id = std::get<EncodableMap>(device).at(EncodableValue("id"));
+
+		return std::any_of(devices.begin(), devices.end(), [&id](const EncodableValue& other) {
+			return std::get<EncodableMap>(other).at(EncodableValue("id")) == id;
+		});
+	}
+
+	HRESULT RecordWindowsPlugin::RefreshInputDevices()
+	{
+		if (m_pDeviceWatcher && !m_inputDevicesStale.exchange(false))
+		{
+			return S_OK;
+		}
+
 		EncodableList devices;
+		std::string defaultDeviceId;
+
+		HRESULT hr = EnumerateInputDevices(devices, defaultDeviceId);
+		if (FAILED(hr))
+		{
+			m_inputDevicesStale = true;
+			return hr;
+		}
+
+		EncodableList added;
+		EncodableList removed;
+
+		for (const auto& device : devices)
+		{
+			if (!ContainsDevice(m_inputDevices, device))
+			{
+				added.push_back(device);
+			}
+		}
+		for (const auto& device : m_inputDevices)
+		{
+			if (!ContainsDevice(devices, device))
+			{
+				removed.push_back(device);
+			}
+		}
+
+		bool defaultChanged = defaultDeviceId != m_defaultInputDeviceId;
+		bool report = m_inputDevicesEnumerated && (!added.empty() || !removed.empty() || defaultChanged);
+
+		m_inputDevices = std::move(devices);
+		m_defaultInputDeviceId = defaultDeviceId;
+		m_inputDevicesEnumerated = true;
+
+		if (report && m_devicesEventHandler)
+		{
+			EncodableMap change({
+				{EncodableValue("added"), EncodableValue(added)},
+				{EncodableValue("removed"), EncodableValue(removed)},
+				{EncodableValue("defaultChanged"), EncodableValue(defaultChanged)}
+				});
+
+			if (!defaultDeviceId.empty())
+			{
+				change[EncodableValue("defaultDeviceId")] = EncodableValue(defaultDeviceId);
+			}
 
+			m_devicesEventHandler->Success(std::make_unique<EncodableValue>(change));
+		}
+
+		return S_OK;
+	}
+
+	HRESULT RecordWindowsPlugin::ListInputDevices(MethodResult<EncodableValue>& result)
+	{
+		HRESULT hr = RefreshInputDevices();
+
+		if (SUCCEEDED(hr))
+		{
+			result.Success(EncodableValue(m_inputDevices));
+		}
+		else
+		{
+			ErrorFromHR(hr, result);
+		}
+
+		return hr;
+	}
+
+	HRESULT RecordWindowsPlugin::EnumerateInputDevices(EncodableList& devices, std::string& defaultDeviceId)
+	{
 		IMFAttributes* pDeviceAttributes = NULL;
 		IMFActivate** ppDevices = NULL;
 		UINT32 deviceCount = 0;
 
-		HRESULT hr = MFCreateAttributes(&pDeviceAttributes, 1);
+		HRESULT hr = DeviceWatcher::GetDefaultDeviceId(defaultDeviceId);
+
+		if (SUCCEEDED(hr))
+		{
+			hr = MFCreateAttributes(&pDeviceAttributes, 1);
+		}
 		if (SUCCEEDED(hr))
 		{
 			// Request audio capture devices
@@ -410,6 +728,7 @@ namespace record_windows {
 			LPWSTR id;
 			UINT32 idLength = 0;
 
+			// Endpoint ID, same as the one of the IMMDevice.
 			hr = ppDevices[i]->GetAllocatedString(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_AUDCAP_ENDPOINT_ID, &id, &idLength);
 			if (SUCCEEDED(hr))
 			{
@@ -417,9 +736,12 @@ namespace record_windows {
 			}
 			if (SUCCEEDED(hr))
 			{
+				std::string deviceId = toString(id);
+
 				devices.push_back(EncodableMap({
-				{EncodableValue("id"), EncodableValue(toString(id))},
-				{EncodableValue("label"), EncodableValue(toString(friendlyName))}
+				{EncodableValue("id"), EncodableValue(deviceId)},
+				{EncodableValue("label"), EncodableValue(toString(friendlyName))},
+				{EncodableValue("isDefault"), EncodableValue(deviceId == defaultDeviceId)}
 					}));
 
 				CoTaskMemFree(id);
@@ -427,15 +749,6 @@ namespace record_windows {
 			}
 		}
 
-		if (SUCCEEDED(hr))
-		{
-			result.Success(std::move(EncodableValue(devices)));
-		}
-		else
-		{
-			ErrorFromHR(hr, result);
-		}
-
 		for (UINT32 i = 0; i < deviceCount; i++)
 		{
 			SafeRelease(ppDevices[i]);
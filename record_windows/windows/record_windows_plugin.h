@@ -9,8 +9,8 @@
 #include <flutter/event_stream_handler_functions.h>
 #include <flutter/method_channel.h>
 #include <flutter/standard_method_codec.h>
+#include <atomic>
 #include <memory>
-#include <mutex>
 
 #include <windows.h>
 #include <mfidl.h>
@@ -19,7 +19,8 @@
 
 #include "utils.h"
 #include "record.h"
-#include <queue>
+#include "record_devicewatcher.h"
+#include "core/main_thread_dispatcher.h"
 
 using namespace flutter;
 
@@ -52,13 +53,15 @@ namespace record_windows {
 		// The function to call to get the root window.
 		static FlutterRootWindowProvider get_root_window;
 
-		// A queue of callbacks to run on the main thread.
-		static std::queue<std::function<void()>> callbacks;
-		// Mutex protecting access to the callbacks queue.
-		static std::mutex callbacks_mutex;
+		// Callbacks to run on the main thread, drained on WM_RUN_DELEGATE.
+		static record_core::MainThreadDispatcher dispatcher;
 
 		// Runs the given callback on the main thread.
-		static void RunOnMainThread(std::function<void()> callback);
+		template <typename Callback>
+		static void RunOnMainThread(Callback&& callback)
+		{
+			dispatcher.Post(std::forward<Callback>(callback));
+		}
 
 	private:
 		static inline BinaryMessenger* m_binaryMessenger;
@@ -70,15 +73,38 @@ namespace record_windows {
 		HRESULT CreateRecorder(std::string recorderId);
 		Recorder* GetRecorder(std::string recorderId);
 		HRESULT ListInputDevices(MethodResult<EncodableValue>& result);
+		HRESULT EnumerateInputDevices(EncodableList& devices, std::string& defaultDeviceId);
+		HRESULT RefreshInputDevices();
+		void StartDeviceWatcher();
+		void OnInputDevicesChanged();
 
 		std::unique_ptr<RecordConfig> InitRecordConfig(const EncodableMap* args);
 
-		std::map<std::string, std::unique_ptr<Recorder>> m_recorders{};
+		// Recorders are reference counted, main thread tasks may hold their own reference.
+		struct RecorderRelease
+		{
+			void operator()(Recorder* recorder) const { recorder->Release(); }
+		};
+		std::map<std::string, std::unique_ptr<Recorder, RecorderRelease>> m_recorders{};
 
 		// Keep event channels alive for each recorder so StreamHandler pointers
 		// stored by Recorder remain valid while the recorder exists.
 		std::map<std::string, std::unique_ptr<EventChannel<EncodableValue>>> m_state_event_channels{};
 		std::map<std::string, std::unique_ptr<EventChannel<EncodableValue>>> m_record_event_channels{};
+		std::map<std::string, std::unique_ptr<EventChannel<EncodableValue>>> m_envelope_event_channels{};
+		std::map<std::string, std::unique_ptr<EventChannel<EncodableValue>>> m_spectrum_event_channels{};
+		std::map<std::string, std::unique_ptr<EventChannel<EncodableValue>>> m_vad_event_channels{};
+
+		// Input devices are shared by recorders, changes are sent on a global channel.
+		// The list is enumerated again only when the watcher reported a change.
+		std::unique_ptr<EventChannel<EncodableValue>> m_devices_event_channel;
+		EventStreamHandler<>* m_devicesEventHandler = nullptr;
+		DeviceWatcher* m_pDeviceWatcher = nullptr;
+		EncodableList m_inputDevices{};
+		std::string m_defaultInputDeviceId;
+		bool m_inputDevicesEnumerated = false;
+		std::atomic<bool> m_inputDevicesStale{ true };
+		std::atomic<bool> m_inputDevicesRefreshPending{ false };
 
 		// Called for top-level WindowProc delegation.
 		std::optional<LRESULT> HandleWindowProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "check.h"
+#include "level_meter.h"
+#include "pcm_meter.h"
+
+// Compares the amplitude loop record_linux ran in Dart on each captured
+// chunk with the native meters which replaced it. The Dart loop is
+// ported as is; the Dart VM only adds to its cost (boxing, bounds checks),
+// and it ran on the UI isolate while the native meters run on the
+// recorder processing thread.
+namespace
+{
+	constexpr int kSampleRate = 44100;
+	constexpr int kChannels = 2;
+	// 10ms chunks.
+	constexpr size_t kChunkFrames = 441;
+
+	size_t ChunkCount()
+	{
+		const char* count = std::getenv("RECORD_BENCHMARK_CHUNKS");
+		return count ? std::strtoul(count, nullptr, 10) : 20000;
+	}
+
+	double Seconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// _calculateAmplitude of the previous record_linux.dart.
+	double DartLoopAmplitude(const uint8_t* data, size_t size)
+	{
+		double maxSample = 0;
+		for (size_t i = 0; i + 1 < size; i += 2)
+		{
+			int sample = data[i] | (data[i + 1] << 8);
+			if (sample > 32767) sample -= 65536;
+
+			const double absSample = static_cast<double>(std::abs(sample));
+			if (absSample > maxSample)
+			{
+				maxSample = absSample;
+			}
+		}
+
+		return maxSample > 0 ? 20 * std::log10(maxSample / 32767.0) : -160.0;
+	}
+
+	// Little endian s16 bytes of a noisy sine, as captured.
+	std::vector<uint8_t> CapturedBytes(size_t frames)
+	{
+		std::vector<uint8_t> bytes(frames * kChannels * sizeof(int16_t));
+		uint32_t noise = 1;
+		for (size_t i = 0; i < frames * kChannels; i++)
+		{
+			noise = noise * 1664525u + 1013904223u;
+			const double value = 0.5 * std::sin(i * 0.01) + ((noise >> 16) / 65536.0 - 0.5) * 0.1;
+			const int16_t sample = static_cast<int16_t>(std::lround(value * 32767.0));
+			std::memcpy(&bytes[i * sizeof(int16_t)], &sample, sizeof(sample));
+		}
+		return bytes;
+	}
+
+	void Report(const char* name, double seconds, size_t chunks)
+	{
+		const double bytes = static_cast<double>(chunks) * kChunkFrames * kChannels * sizeof(int16_t);
+		std::printf("%-22s %9.1f ns/chunk %9.1f MB/s\n", name, seconds * 1e9 / chunks, bytes / seconds / 1e6);
+	}
+}
+
+RECORD_TEST(DartLoopVersusNativeMeters)
+{
+	const size_t chunks = ChunkCount();
+	const auto captured = CapturedBytes(kChunkFrames * 64);
+	const size_t chunkBytes = kChunkFrames * kChannels * sizeof(int16_t);
+	const size_t chunkCount = captured.size() / chunkBytes;
+
+	// Chunks cycle over 64 distinct captured chunks.
+	double dartPeak = -160.0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < chunks; i++)
+	{
+		dartPeak = std::max(dartPeak, DartLoopAmplitude(&captured[(i % chunkCount) * chunkBytes], chunkBytes));
+	}
+	const double dartSeconds = Seconds(start);
+
+	// Peak, RMS and clip count over all channels.
+	record_core::PcmLevels levels;
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < chunks; i++)
+	{
+		const auto* samples = reinterpret_cast<const int16_t*>(&captured[(i % chunkCount) * chunkBytes]);
+		record_core::MeasurePcm16(samples, kChunkFrames * kChannels, levels);
+	}
+	const double measureSeconds = Seconds(start);
+
+	// Everything getAmplitude reports, per channel levels and true peak
+	// included, as run by the recorder.
+	record_core::LevelMeter meter;
+	meter.Configure(kSampleRate, kChannels);
+	double meterPeak = record_core::kMinDbfs;
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < chunks; i++)
+	{
+		const auto* samples = reinterpret_cast<const int16_t*>(&captured[(i % chunkCount) * chunkBytes]);
+		meter.Process(samples, kChunkFrames);
+		meterPeak = std::max(meterPeak, meter.Levels().PeakDbfs());
+	}
+	const double meterSeconds = Seconds(start);
+
+	// Same peak, full scale is 32767 in Dart and 32768 natively.
+	CHECK_NEAR(dartPeak, levels.PeakDbfs(), 0.01);
+	CHECK_NEAR(dartPeak, meterPeak, 0.01);
+
+	std::printf("%zu chunks of %zu stereo frames\n", chunks, kChunkFrames);
+	Report("dart loop (ported)", dartSeconds, chunks);
+	Report("MeasurePcm16", measureSeconds, chunks);
+	Report("LevelMeter", meterSeconds, chunks);
+	std::printf("MeasurePcm16 kernel: %s\n", record_core::MeasurePcm16KernelName());
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,101 @@
+#include <atomic>
+#include <thread>
+
+#include "capture_timing.h"
+#include "check.h"
+
+using record_core::CaptureLatency;
+using record_core::CaptureTiming;
+
+RECORD_TEST(NothingMeasuredAfterReset)
+{
+	CaptureTiming timing;
+	timing.Reset();
+
+	CaptureLatency latency = timing.Get();
+	CHECK(latency.latencyUs == 0);
+	CHECK(latency.periodUs == 0);
+}
+
+RECORD_TEST(PeriodIsMeanBufferDuration)
+{
+	CaptureTiming timing;
+	timing.Reset();
+
+	timing.AddBuffer(10000, -1);
+	timing.AddBuffer(20000, -1);
+	timing.AddBuffer(30000, -1);
+
+	CHECK(timing.Get().periodUs == 20000);
+	// Unknown latency is not measured.
+	CHECK(timing.Get().latencyUs == 0);
+}
+
+RECORD_TEST(EmptyBuffersAreIgnored)
+{
+	CaptureTiming timing;
+	timing.Reset();
+
+	timing.AddBuffer(10000, 5000);
+	timing.AddBuffer(0, 80000);
+
+	CHECK(timing.Get().periodUs == 10000);
+	CHECK(timing.Get().latencyUs == 5000);
+}
+
+RECORD_TEST(LatencyIsSmoothed)
+{
+	CaptureTiming timing;
+	timing.Reset();
+
+	// First value is taken as is.
+	timing.AddBuffer(10000, 20000);
+	CHECK(timing.Get().latencyUs == 20000);
+
+	// A single late buffer moves latency by an eighth of the difference.
+	timing.AddBuffer(10000, 100000);
+	CHECK(timing.Get().latencyUs == 30000);
+
+	// Converges to a steady latency.
+	for (int i = 0; i < 100; i++) timing.AddBuffer(10000, 40000);
+	CHECK_NEAR(timing.Get().latencyUs, 40000, 10);
+}
+
+RECORD_TEST(ResetForgetsMeasures)
+{
+	CaptureTiming timing;
+	timing.Reset();
+	timing.AddBuffer(10000, 20000);
+
+	timing.Reset();
+	CHECK(timing.Get().periodUs == 0);
+
+	timing.AddBuffer(4000, 8000);
+	CHECK(timing.Get().periodUs == 4000);
+	CHECK(timing.Get().latencyUs == 8000);
+}
+
+RECORD_TEST(ValuesAreReadWhileBuffersAreAdded)
+{
+	CaptureTiming timing;
+	timing.Reset();
+
+	std::atomic<bool> done{ false };
+	std::thread capture([&]() {
+		for (int i = 0; i < 100000; i++) timing.AddBuffer(10000, 20000);
+		done = true;
+	});
+
+	bool consistent = true;
+	while (!done)
+	{
+		CaptureLatency latency = timing.Get();
+		consistent = consistent && (latency.periodUs == 0 || latency.periodUs == 10000)
+			&& (latency.latencyUs == 0 || latency.latencyUs == 20000);
+	}
+	capture.join();
+
+	CHECK(consistent);
+}
+
+RECORD_TEST_MAIN()
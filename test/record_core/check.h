@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// Minimal test runner, the tests have no dependency but the core.
+namespace record_core_test
+{
+	struct TestCase
+	{
+		const char* name;
+		std::function<void()> run;
+	};
+
+	inline std::vector<TestCase>& Tests()
+	{
+		static std::vector<TestCase> tests;
+		return tests;
+	}
+
+	inline int& Failures()
+	{
+		static int failures = 0;
+		return failures;
+	}
+
+	struct Registration
+	{
+		Registration(const char* name, std::function<void()> run) { Tests().push_back({ name, std::move(run) }); }
+	};
+
+	inline int RunAll()
+	{
+		for (const auto& test : Tests())
+		{
+			const int failures = Failures();
+			test.run();
+			std::printf("%s %s\n", Failures() == failures ? "[ OK ]" : "[FAIL]", test.name);
+		}
+
+		return Failures() == 0 ? 0 : 1;
+	}
+};
+
+#define RECORD_TEST(name)                                                          \
+	static void name();                                                            \
+	static record_core_test::Registration name##_registration(#name, name);        \
+	static void name()
+
+#define CHECK(condition)                                                           \
+	do                                                                             \
+	{                                                                              \
+		if (!(condition))                                                          \
+		{                                                                          \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			record_core_test::Failures()++;                                        \
+		}                                                                          \
+	} while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                    \
+	do                                                                             \
+	{                                                                              \
+		const double checkActual = (actual);                                       \
+		const double checkExpected = (expected);                                   \
+		if (!(std::fabs(checkActual - checkExpected) <= (tolerance)))              \
+		{                                                                          \
+			std::printf("%s:%d: %s is %f, expected %f\n", __FILE__, __LINE__,      \
+				#actual, checkActual, checkExpected);                              \
+			record_core_test::Failures()++;                                        \
+		}                                                                          \
+	} while (0)
+
+#define RECORD_TEST_MAIN()                                                         \
+	int main()                                                                     \
+	{                                                                              \
+		return record_core_test::RunAll();                                         \
+	}
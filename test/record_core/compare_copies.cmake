@@ -0,0 +1,24 @@
+# Fails when a core file of the Linux plugin differs from its Windows copy,
+# or exists in one plugin only.
+file(GLOB linux_sources RELATIVE "${LINUX_DIR}" "${LINUX_DIR}/*.h" "${LINUX_DIR}/*.cpp")
+file(GLOB windows_sources RELATIVE "${WINDOWS_DIR}" "${WINDOWS_DIR}/*.h" "${WINDOWS_DIR}/*.cpp")
+
+foreach(source ${windows_sources})
+  if(NOT EXISTS "${LINUX_DIR}/${source}")
+    message(FATAL_ERROR "core/${source} is missing in the Linux plugin.")
+  endif()
+endforeach()
+
+foreach(source ${linux_sources})
+  if(NOT EXISTS "${WINDOWS_DIR}/${source}")
+    message(FATAL_ERROR "core/${source} is missing in the Windows plugin.")
+  endif()
+
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files
+      "${LINUX_DIR}/${source}" "${WINDOWS_DIR}/${source}"
+    RESULT_VARIABLE different)
+  if(different)
+    message(FATAL_ERROR "core/${source} differs between Linux and Windows.")
+  endif()
+endforeach()
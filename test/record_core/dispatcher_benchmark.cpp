@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "main_thread_dispatcher.h"
+
+using record_core::MainThreadDispatcher;
+
+// Compares the dispatcher with the queue of std::function guarded by a
+// mutex it replaced in the Windows plugin, where each posted task was one
+// WM_RUN_DELEGATE message running one task. Both wake up the same main
+// loop, standing for the platform message queue. Recorder tasks capture
+// the recorder and a few values, too big for std::function inline storage.
+namespace
+{
+	constexpr size_t kProducers = 4;
+	// Time between two posts of a producer when paced, as chunk callbacks.
+	constexpr auto kPacedPeriod = std::chrono::microseconds(100);
+
+	using Clock = std::chrono::steady_clock;
+
+	size_t TaskCount()
+	{
+		const char* count = std::getenv("RECORD_BENCHMARK_CHUNKS");
+		return count ? std::strtoul(count, nullptr, 10) : 100000;
+	}
+
+	double Seconds(Clock::time_point start)
+	{
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	// Platform message queue of the main thread (PostMessage, g_idle_add).
+	class MessageLoop
+	{
+	public:
+		static void Wakeup(void* context)
+		{
+			static_cast<MessageLoop*>(context)->Post();
+		}
+
+		void Post()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_pending++;
+			}
+			m_condition.notify_one();
+		}
+
+		// Waits for a message and takes it.
+		void Wait()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_pending > 0; });
+			m_pending--;
+			m_messages++;
+		}
+
+		uint64_t Messages() const { return m_messages; }
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		size_t m_pending = 0;
+		uint64_t m_messages = 0;
+	};
+
+	// Previous path: one locked std::function and one message per task.
+	class TaskQueue
+	{
+	public:
+		explicit TaskQueue(MessageLoop& loop) : m_loop(loop) {}
+
+		void Post(std::function<void()> task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_tasks.push(std::move(task));
+			}
+			m_loop.Post();
+		}
+
+		// WM_RUN_DELEGATE handler.
+		void RunOne()
+		{
+			std::function<void()> task;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_tasks.empty())
+				{
+					task = std::move(m_tasks.front());
+					m_tasks.pop();
+				}
+			}
+			if (task) task();
+		}
+
+	private:
+		MessageLoop& m_loop;
+		std::mutex m_mutex;
+		std::queue<std::function<void()>> m_tasks;
+	};
+
+	// State of the main thread, updated by the tasks.
+	struct Sink
+	{
+		uint64_t tasks = 0;
+		uint64_t sum = 0;
+		double totalLatencyUs = 0;
+		double maxLatencyUs = 0;
+
+		void Run(Clock::time_point posted, uint64_t value)
+		{
+			const double latencyUs = std::chrono::duration<double, std::micro>(Clock::now() - posted).count();
+			totalLatencyUs += latencyUs;
+			maxLatencyUs = std::max(maxLatencyUs, latencyUs);
+			sum += value;
+			tasks++;
+		}
+	};
+
+	struct Result
+	{
+		double seconds = 0;
+		uint64_t messages = 0;
+		uint64_t tasks = 0;
+		uint64_t sum = 0;
+		double meanLatencyUs = 0;
+		double maxLatencyUs = 0;
+	};
+
+	// Posts tasks from kProducers threads with post, and runs the main
+	// loop with handle until all of them ran.
+	template <typename PostFunction, typename HandleFunction>
+	Result Run(size_t tasks, bool paced, MessageLoop& loop, const std::shared_ptr<Sink>& sink, PostFunction post, HandleFunction handle)
+	{
+		const size_t perProducer = tasks / kProducers;
+		const auto start = Clock::now();
+
+		std::vector<std::thread> producers;
+		for (size_t p = 0; p < kProducers; p++)
+		{
+			producers.emplace_back([&, p]()
+				{
+					auto next = start;
+					for (size_t i = 0; i < perProducer; i++)
+					{
+						post(sink, Clock::now(), p * perProducer + i);
+						if (paced)
+						{
+							next += kPacedPeriod;
+							std::this_thread::sleep_until(next);
+						}
+					}
+				});
+		}
+
+		while (sink->tasks < perProducer * kProducers)
+		{
+			loop.Wait();
+			handle();
+		}
+
+		Result result;
+		result.seconds = Seconds(start);
+		for (auto& producer : producers) producer.join();
+
+		result.messages = loop.Messages();
+		result.tasks = sink->tasks;
+		result.sum = sink->sum;
+		result.meanLatencyUs = sink->totalLatencyUs / sink->tasks;
+		result.maxLatencyUs = sink->maxLatencyUs;
+		return result;
+	}
+
+	Result RunTaskQueue(size_t tasks, bool paced)
+	{
+		MessageLoop loop;
+		TaskQueue queue(loop);
+		auto sink = std::make_shared<Sink>();
+
+		return Run(tasks, paced, loop, sink,
+			[&queue](const std::shared_ptr<Sink>& target, Clock::time_point posted, uint64_t value)
+			{
+				queue.Post([target, posted, value]() { target->Run(posted, value); });
+			},
+			[&queue]() { queue.RunOne(); });
+	}
+
+	Result RunDispatcher(size_t tasks, bool paced)
+	{
+		MessageLoop loop;
+		MainThreadDispatcher dispatcher;
+		dispatcher.SetWakeup(&MessageLoop::Wakeup, &loop);
+		auto sink = std::make_shared<Sink>();
+
+		return Run(tasks, paced, loop, sink,
+			[&dispatcher](const std::shared_ptr<Sink>& target, Clock::time_point posted, uint64_t value)
+			{
+				dispatcher.Post([target, posted, value]() { target->Run(posted, value); });
+			},
+			[&dispatcher]() { dispatcher.Drain(); });
+	}
+
+	void Report(const char* name, const Result& result)
+	{
+		std::printf("%-22s %9.1f ns/task %7.3f msg/task %9.1f us mean %9.1f us max\n", name, result.seconds * 1e9 / result.tasks,
+			static_cast<double>(result.messages) / result.tasks, result.meanLatencyUs, result.maxLatencyUs);
+	}
+
+	uint64_t ExpectedSum(size_t tasks)
+	{
+		const uint64_t count = tasks / kProducers * kProducers;
+		return count * (count - 1) / 2;
+	}
+}
+
+RECORD_TEST(BurstDispatcherVersusTaskQueue)
+{
+	const size_t tasks = TaskCount();
+
+	const auto queue = RunTaskQueue(tasks, false);
+	const auto dispatcher = RunDispatcher(tasks, false);
+
+	CHECK(queue.sum == ExpectedSum(tasks));
+	CHECK(dispatcher.sum == ExpectedSum(tasks));
+	// One message per task before, at most one per drain now.
+	CHECK(queue.messages == queue.tasks);
+	CHECK(dispatcher.messages <= dispatcher.tasks);
+
+	std::printf("%zu tasks posted at once by %zu threads\n", tasks / kProducers * kProducers, kProducers);
+	Report("queue + mutex", queue);
+	Report("MainThreadDispatcher", dispatcher);
+}
+
+RECORD_TEST(PacedDispatcherVersusTaskQueue)
+{
+	// Paced posts take kPacedPeriod each, keep the run short.
+	const size_t tasks = std::max<size_t>(TaskCount() / 10, kProducers);
+
+	const auto queue = RunTaskQueue(tasks, true);
+	const auto dispatcher = RunDispatcher(tasks, true);
+
+	CHECK(queue.sum == ExpectedSum(tasks));
+	CHECK(dispatcher.sum == ExpectedSum(tasks));
+
+	std::printf("%zu tasks posted every %lld us by %zu threads\n", tasks / kProducers * kProducers,
+		static_cast<long long>(kPacedPeriod.count()), kProducers);
+	Report("queue + mutex", queue);
+	Report("MainThreadDispatcher", dispatcher);
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,199 @@
+#include <sys/resource.h>
+#include <time.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+#include "record_encoder.h"
+
+using record_core_test::ReadFile;
+using record_core_test::TempPath;
+using record_linux::CreateAudioEncoder;
+using record_linux::EncoderConfig;
+
+// Compares the in-process encoders with the ffmpeg process record_linux
+// piped the recording to. Both are fed the same 10ms chunks, and report
+// the CPU time of the encoding (ffmpeg included) and the time from the
+// end of the recording to a complete file. ffmpeg runs only when found;
+// otherwise the native encoders are measured alone.
+// RECORD_BENCHMARK_SECONDS sets the recorded duration.
+namespace
+{
+	constexpr int kSampleRate = 44100;
+	constexpr int kChannels = 2;
+	constexpr size_t kChunkFrames = 441;
+	constexpr size_t kFrameBytes = kChannels * sizeof(int16_t);
+
+	double RecordedSeconds()
+	{
+		const char* value = std::getenv("RECORD_BENCHMARK_SECONDS");
+		return value ? std::strtod(value, nullptr) : 30.0;
+	}
+
+	double Seconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// CPU time of the calling thread.
+	double ThreadCpuSeconds()
+	{
+		timespec time = {};
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+		return time.tv_sec + time.tv_nsec / 1e9;
+	}
+
+	// CPU time of the waited for child processes.
+	double ChildrenCpuSeconds()
+	{
+		rusage usage = {};
+		getrusage(RUSAGE_CHILDREN, &usage);
+		return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+	}
+
+	bool HasFfmpeg()
+	{
+		return std::system("command -v ffmpeg > /dev/null 2>&1") == 0;
+	}
+
+	// Noisy sine, as captured.
+	std::vector<uint8_t> Recording(double seconds)
+	{
+		const size_t frames = static_cast<size_t>(seconds * kSampleRate) / kChunkFrames * kChunkFrames;
+		std::vector<uint8_t> bytes(frames * kFrameBytes);
+		uint32_t noise = 1;
+		for (size_t i = 0; i < frames * kChannels; i++)
+		{
+			noise = noise * 1664525u + 1013904223u;
+			const double value = 0.5 * std::sin(i * 0.01) + ((noise >> 16) / 65536.0 - 0.5) * 0.1;
+			const int16_t sample = static_cast<int16_t>(std::lround(value * 32767.0));
+			std::memcpy(&bytes[i * sizeof(int16_t)], &sample, sizeof(sample));
+		}
+		return bytes;
+	}
+
+	struct Result
+	{
+		bool ok = false;
+		double cpuSeconds = 0;
+		double finalizeSeconds = 0;
+		size_t fileBytes = 0;
+	};
+
+	Result RunNative(const std::string& encoder, const std::vector<uint8_t>& recording)
+	{
+		Result result;
+		auto audioEncoder = CreateAudioEncoder(encoder);
+		if (!audioEncoder) return result;
+
+		EncoderConfig config;
+		config.sample_rate = kSampleRate;
+		config.num_channels = kChannels;
+
+		const std::string path = TempPath("encoder_benchmark_native." + encoder);
+		std::string error;
+		if (!audioEncoder->Open(path, config, &error))
+		{
+			std::printf("%s: %s\n", encoder.c_str(), error.c_str());
+			return result;
+		}
+
+		const double cpuStart = ThreadCpuSeconds();
+		bool written = true;
+		for (size_t offset = 0; offset < recording.size(); offset += kChunkFrames * kFrameBytes)
+		{
+			written = audioEncoder->Write(&recording[offset], kChunkFrames * kFrameBytes) && written;
+		}
+
+		const auto finalizeStart = std::chrono::steady_clock::now();
+		const bool finished = audioEncoder->Finish();
+		result.finalizeSeconds = Seconds(finalizeStart);
+		result.cpuSeconds = ThreadCpuSeconds() - cpuStart;
+
+		result.fileBytes = ReadFile(path).size();
+		result.ok = written && finished && result.fileBytes > 0;
+		std::remove(path.c_str());
+		return result;
+	}
+
+	// Previous path: raw PCM piped to ffmpeg, which encodes to extension.
+	Result RunFfmpeg(const std::string& extension, const std::vector<uint8_t>& recording)
+	{
+		Result result;
+		const std::string path = TempPath("encoder_benchmark_ffmpeg." + extension);
+		const std::string command = "ffmpeg -hide_banner -loglevel error -y -f s16le -ar " + std::to_string(kSampleRate)
+			+ " -ac " + std::to_string(kChannels) + " -i pipe:0 " + path;
+
+		const double childrenStart = ChildrenCpuSeconds();
+		const double cpuStart = ThreadCpuSeconds();
+		FILE* pipe = popen(command.c_str(), "w");
+		if (!pipe) return result;
+
+		bool written = true;
+		for (size_t offset = 0; offset < recording.size(); offset += kChunkFrames * kFrameBytes)
+		{
+			written = std::fwrite(&recording[offset], 1, kChunkFrames * kFrameBytes, pipe) == kChunkFrames * kFrameBytes && written;
+			std::fflush(pipe);
+		}
+
+		// Closing stdin ends the recording, ffmpeg completes the file and exits.
+		const auto finalizeStart = std::chrono::steady_clock::now();
+		const int status = pclose(pipe);
+		result.finalizeSeconds = Seconds(finalizeStart);
+		result.cpuSeconds = ThreadCpuSeconds() - cpuStart + ChildrenCpuSeconds() - childrenStart;
+
+		result.fileBytes = ReadFile(path).size();
+		result.ok = written && status == 0 && result.fileBytes > 0;
+		std::remove(path.c_str());
+		return result;
+	}
+
+	void Report(const std::string& name, const Result& result, double seconds)
+	{
+		std::printf("%-16s %9.3f %% cpu %9.3f ms finalize %10zu bytes\n", name.c_str(), result.cpuSeconds / seconds * 100,
+			result.finalizeSeconds * 1e3, result.fileBytes);
+	}
+}
+
+RECORD_TEST(NativeEncodersVersusFfmpeg)
+{
+	const double seconds = RecordedSeconds();
+	const auto recording = Recording(seconds);
+	std::printf("%.1f s of %d Hz stereo in %zu frames chunks, cpu in %% of the recording duration\n", seconds, kSampleRate, kChunkFrames);
+
+	// Encoders linked in this build, wav at least.
+	for (const std::string encoder : { "wav", "pcm16bits", "flac", "opus" })
+	{
+		const auto result = RunNative(encoder, recording);
+		if (encoder == "wav")
+		{
+			CHECK(result.ok);
+			CHECK(result.fileBytes == recording.size() + 44);
+		}
+		if (result.ok) Report("native " + encoder, result, seconds);
+	}
+
+	if (!HasFfmpeg())
+	{
+		std::printf("ffmpeg not found, skipped\n");
+		return;
+	}
+
+	for (const std::string extension : { "wav", "flac", "ogg" })
+	{
+		const auto result = RunFfmpeg(extension, recording);
+		if (extension == "wav") CHECK(result.ok);
+		if (result.ok) Report("ffmpeg " + extension, result, seconds);
+	}
+}
+
+RECORD_TEST_MAIN()
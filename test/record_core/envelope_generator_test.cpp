@@ -0,0 +1,114 @@
+#include <cstdint>
+#include <vector>
+
+#include "check.h"
+#include "envelope_generator.h"
+
+using record_core::EnvelopeBucket;
+using record_core::EnvelopeGenerator;
+
+namespace
+{
+	std::vector<EnvelopeBucket> Process(EnvelopeGenerator& generator, const std::vector<int16_t>& samples, size_t frameCount)
+	{
+		std::vector<EnvelopeBucket> buckets;
+		generator.Process(samples.data(), frameCount, [&buckets](const EnvelopeBucket& bucket) {
+			buckets.push_back(bucket);
+		});
+		return buckets;
+	}
+}
+
+RECORD_TEST(DisabledWithoutInterval)
+{
+	EnvelopeGenerator generator;
+	generator.Configure(1000, 1, 0);
+	CHECK(!generator.IsEnabled());
+
+	const std::vector<int16_t> samples(100, 1000);
+	CHECK(Process(generator, samples, samples.size()).empty());
+}
+
+RECORD_TEST(BucketHoldsMinMaxRms)
+{
+	// 10ms at 1kHz, 10 frames per bucket.
+	EnvelopeGenerator generator;
+	generator.Configure(1000, 1, 10);
+
+	std::vector<int16_t> samples;
+	for (int i = 0; i < 10; i++)
+	{
+		samples.push_back(i % 2 == 0 ? 16384 : -16384);
+	}
+	samples[3] = -32768;
+
+	const auto buckets = Process(generator, samples, samples.size());
+	CHECK(buckets.size() == 1);
+	CHECK_NEAR(buckets[0].min, -1.0, 1e-6);
+	CHECK_NEAR(buckets[0].max, 0.5, 1e-6);
+	// Nine samples at 0.5 and one at 1.
+	CHECK_NEAR(buckets[0].rms, std::sqrt((9 * 0.25 + 1.0) / 10), 1e-6);
+}
+
+RECORD_TEST(BucketSpansBlocks)
+{
+	EnvelopeGenerator generator;
+	generator.Configure(1000, 1, 10);
+
+	const std::vector<int16_t> samples(7, 3277);
+	CHECK(Process(generator, samples, samples.size()).empty());
+
+	// Completes the first bucket, the second one stays pending.
+	const auto buckets = Process(generator, samples, samples.size());
+	CHECK(buckets.size() == 1);
+	CHECK_NEAR(buckets[0].max, 0.1, 1e-4);
+	CHECK_NEAR(buckets[0].rms, 0.1, 1e-4);
+}
+
+RECORD_TEST(ChannelsAreMixed)
+{
+	EnvelopeGenerator generator;
+	generator.Configure(1000, 2, 10);
+
+	// Left silent, right at full scale: one bucket of 10 stereo frames.
+	std::vector<int16_t> samples;
+	for (int i = 0; i < 10; i++)
+	{
+		samples.push_back(0);
+		samples.push_back(INT16_MAX);
+	}
+
+	const auto buckets = Process(generator, samples, 10);
+	CHECK(buckets.size() == 1);
+	CHECK_NEAR(buckets[0].min, 0.0, 1e-6);
+	CHECK_NEAR(buckets[0].max, INT16_MAX / 32768.0, 1e-6);
+	CHECK_NEAR(buckets[0].rms, INT16_MAX / 32768.0 / std::sqrt(2.0), 1e-6);
+}
+
+RECORD_TEST(ShortIntervalIsRaised)
+{
+	// 1ms is raised to 5ms, 240 frames at 48kHz.
+	EnvelopeGenerator generator;
+	generator.Configure(48000, 1, 1);
+
+	const std::vector<int16_t> samples(480, 0);
+	CHECK(Process(generator, samples, samples.size()).size() == 2);
+}
+
+RECORD_TEST(ResetDropsPendingBucket)
+{
+	EnvelopeGenerator generator;
+	generator.Configure(1000, 1, 10);
+
+	const std::vector<int16_t> loud(5, INT16_MIN);
+	Process(generator, loud, loud.size());
+	generator.Reset();
+
+	const std::vector<int16_t> quiet(10, 0);
+	const auto buckets = Process(generator, quiet, quiet.size());
+	CHECK(buckets.size() == 1);
+	CHECK_NEAR(buckets[0].min, 0.0, 1e-6);
+	CHECK_NEAR(buckets[0].rms, 0.0, 1e-6);
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+
+using record_core_test::FakeCapture;
+using record_core_test::PcmConfig;
+using record_core_test::RunMainThreadUntil;
+using record_linux::Recorder;
+
+// Measures the latency achieved by each latency_ms setting. The capture is
+// fed one period at a time in real time, as a device would, and each
+// period is timed until its last byte is streamed on the main thread.
+// Latency of a sample is the age of the first sample of its period when
+// streamed: the period itself plus the recorder pipeline. The device
+// buffering reported by GetLatency comes on top with a sound server.
+// RECORD_BENCHMARK_SECONDS sets the duration of each run.
+namespace
+{
+	constexpr int kSampleRate = 48000;
+	constexpr size_t kFrameBytes = 4;
+
+	using Clock = std::chrono::steady_clock;
+
+	double Seconds()
+	{
+		const char* value = std::getenv("RECORD_BENCHMARK_SECONDS");
+		return value ? std::strtod(value, nullptr) : 1.0;
+	}
+
+	double Microseconds(Clock::duration duration)
+	{
+		return std::chrono::duration<double, std::micro>(duration).count();
+	}
+
+	// Times streamed chunks without keeping them.
+	class TimingListener : public record_linux::RecorderListener
+	{
+	public:
+		struct Delivery
+		{
+			Clock::time_point time;
+			// Bytes streamed so far, this chunk included.
+			size_t bytes;
+		};
+
+		void OnStateChanged(record_linux::RecordState) override {}
+		void OnStreamData(const std::vector<uint8_t>& data) override
+		{
+			bytes += data.size();
+			deliveries.push_back({ Clock::now(), bytes });
+		}
+		void OnSharedStreamData(const record_core::PcmRingChunk&) override {}
+		void OnStreamPacket(const std::vector<uint8_t>&, const record_core::StreamPacketInfo&) override {}
+		void OnEnvelope(const std::vector<float>&) override {}
+		void OnSpectrum(const std::vector<float>&) override {}
+		void OnVoiceActivity(bool) override {}
+		void OnStreamEnd() override {}
+		void OnError(const std::string&) override {}
+
+		size_t bytes = 0;
+		std::vector<Delivery> deliveries;
+	};
+
+	struct Result
+	{
+		bool complete = false;
+		record_core::CaptureLatency reported;
+		// From start to the first streamed period.
+		double firstChunkUs = 0;
+		// Age of the first sample of each period when streamed.
+		std::vector<double> latenciesUs;
+	};
+
+	Result Run(int latencyMs, double seconds)
+	{
+		Result result;
+		auto listener = std::make_shared<TimingListener>();
+		auto recorder = Recorder::Create("1", listener);
+
+		auto config = PcmConfig();
+		config.sample_rate = kSampleRate;
+		config.latency_ms = latencyMs;
+
+		std::string error;
+		if (!recorder->StartStream(config, &error))
+		{
+			std::printf("start failed: %s\n", error.c_str());
+			return result;
+		}
+		recorder->SetStreamListening(true);
+		FakeCapture* capture = FakeCapture::Instances().back();
+
+		const size_t periodFrames = static_cast<size_t>(kSampleRate) * latencyMs / 1000;
+		const auto period = std::chrono::milliseconds(latencyMs);
+		const size_t periods = std::max<size_t>(static_cast<size_t>(seconds * 1000 / latencyMs), 8);
+		const size_t total = periods * periodFrames * kFrameBytes;
+
+		// Capture thread, delivering each period once filled.
+		std::vector<Clock::time_point> filled(periods);
+		const auto start = Clock::now();
+		std::thread feeder([&]()
+			{
+				auto next = start;
+				for (size_t i = 0; i < periods; i++)
+				{
+					next += period;
+					std::this_thread::sleep_until(next);
+					filled[i] = Clock::now();
+					capture->Feed(periodFrames);
+				}
+			});
+
+		// Main thread, woken by the recorder, acknowledging each chunk.
+		size_t acknowledged = 0;
+		result.complete = RunMainThreadUntil([&]()
+			{
+				const size_t count = listener->deliveries.size();
+				if (count > acknowledged)
+				{
+					recorder->AcknowledgeStream(count - acknowledged);
+					acknowledged = count;
+				}
+				return listener->bytes >= total;
+			},
+			std::chrono::milliseconds(static_cast<int64_t>(periods * latencyMs) + 5000));
+		feeder.join();
+
+		recorder->GetLatency(&result.reported);
+		recorder->Stop();
+
+		if (!result.complete || listener->deliveries.empty()) return result;
+		result.firstChunkUs = Microseconds(listener->deliveries.front().time - start);
+
+		// Each period is streamed with the chunk holding its last byte.
+		auto delivery = listener->deliveries.begin();
+		for (size_t i = 0; i < periods; i++)
+		{
+			const size_t end = (i + 1) * periodFrames * kFrameBytes;
+			while (delivery->bytes < end) delivery++;
+			result.latenciesUs.push_back(Microseconds(delivery->time - (filled[i] - period)));
+		}
+		return result;
+	}
+
+	double Percentile(std::vector<double> values, double percentile)
+	{
+		std::sort(values.begin(), values.end());
+		const size_t index = std::min(values.size() - 1, static_cast<size_t>(percentile / 100 * values.size()));
+		return values[index];
+	}
+}
+
+RECORD_TEST(LatencyPerSetting)
+{
+	const double seconds = Seconds();
+
+	std::printf("%10s %12s %12s %12s %12s %12s %14s\n", "latency ms", "period ms", "first ms", "mean ms", "p99 ms",
+		"max ms", "+ device ms");
+	for (const int latencyMs : { record_linux::kMinLatencyMs, 10, 20, 50, 100, record_linux::kMaxLatencyMs })
+	{
+		const auto result = Run(latencyMs, seconds);
+		CHECK(result.complete);
+		if (!result.complete || result.latenciesUs.empty()) continue;
+
+		double sum = 0;
+		for (double latencyUs : result.latenciesUs) sum += latencyUs;
+		const double meanUs = sum / result.latenciesUs.size();
+
+		// A sample is never streamed before its period is filled.
+		CHECK(Percentile(result.latenciesUs, 0) >= latencyMs * 1000.0);
+		CHECK(result.reported.periodUs == latencyMs * 1000);
+
+		std::printf("%10d %12.1f %12.2f %12.2f %12.2f %12.2f %14.1f\n", latencyMs, result.reported.periodUs / 1e3,
+			result.firstChunkUs / 1e3, meanUs / 1e3, Percentile(result.latenciesUs, 99) / 1e3,
+			Percentile(result.latenciesUs, 100) / 1e3, result.reported.latencyUs / 1e3);
+	}
+}
+
+RECORD_TEST_MAIN()
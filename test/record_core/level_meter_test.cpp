@@ -0,0 +1,134 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "check.h"
+#include "level_meter.h"
+
+using record_core::LevelMeter;
+
+namespace
+{
+	constexpr double kPi = 3.14159265358979323846;
+	constexpr int kSampleRate = 48000;
+
+	// Interleaved sines, one amplitude (linear) per channel.
+	std::vector<int16_t> Sines(double frequency, double phase, const std::vector<double>& amplitudes, size_t frameCount)
+	{
+		std::vector<int16_t> samples;
+		for (size_t i = 0; i < frameCount; i++)
+		{
+			for (double amplitude : amplitudes)
+			{
+				const double value = amplitude * std::sin(2.0 * kPi * frequency * i / kSampleRate + phase);
+				samples.push_back(static_cast<int16_t>(std::lround(value * 32768.0)));
+			}
+		}
+		return samples;
+	}
+}
+
+RECORD_TEST(ChannelsAreMeasuredSeparately)
+{
+	LevelMeter meter;
+	meter.Configure(kSampleRate, 2);
+
+	// 1 kHz sine, left at -6 dBFS and right at -20 dBFS.
+	const auto samples = Sines(1000.0, 0.0, { 0.5, 0.1 }, 4800);
+	meter.Process(samples.data(), 4800);
+
+	CHECK(meter.NumChannels() == 2);
+	CHECK_NEAR(meter.Channel(0).peak, -6.02, 0.05);
+	CHECK_NEAR(meter.Channel(0).rms, -6.02 - 3.01, 0.05);
+	CHECK_NEAR(meter.Channel(1).peak, -20.0, 0.05);
+	CHECK_NEAR(meter.Channel(1).rms, -23.01, 0.05);
+	// Block levels are over all channels.
+	CHECK_NEAR(meter.Levels().PeakDbfs(), -6.02, 0.05);
+}
+
+RECORD_TEST(TruePeakFindsInterSamplePeaks)
+{
+	LevelMeter meter;
+	meter.Configure(kSampleRate, 1);
+
+	// fs/4 sine sampled 45 degrees off its peaks: samples are 3 dB under the
+	// -6 dBFS true peak (EBU Tech 3341 true peak case).
+	const auto samples = Sines(kSampleRate / 4.0, kPi / 4, { 0.5 }, 4800);
+	meter.Process(samples.data(), 4800);
+
+	CHECK_NEAR(meter.Channel(0).peak, -9.03, 0.05);
+	CHECK_NEAR(meter.Channel(0).truePeak, -6.02, 0.3);
+}
+
+RECORD_TEST(TruePeakMatchesSamplePeakOfLowFrequencies)
+{
+	LevelMeter meter;
+	meter.Configure(kSampleRate, 1);
+
+	const auto samples = Sines(997.0, 0.0, { 0.5 }, 4800);
+	meter.Process(samples.data(), 4800);
+
+	CHECK_NEAR(meter.Channel(0).truePeak, meter.Channel(0).peak, 0.1);
+	CHECK(meter.Channel(0).truePeak >= meter.Channel(0).peak - 0.01);
+}
+
+RECORD_TEST(PeakIsHeldThenDecays)
+{
+	LevelMeter meter;
+	meter.Configure(kSampleRate, 1);
+
+	// 100ms blocks.
+	const size_t blockFrames = kSampleRate / 10;
+	const auto loud = Sines(1000.0, 0.0, { 0.5 }, blockFrames);
+	const auto quiet = Sines(1000.0, 0.0, { 0.01 }, blockFrames);
+
+	meter.Process(loud.data(), blockFrames);
+	CHECK_NEAR(meter.Channel(0).peakHold, -6.02, 0.05);
+
+	// Held for 1.5s.
+	for (int i = 0; i < 15; i++)
+	{
+		meter.Process(quiet.data(), blockFrames);
+	}
+	CHECK_NEAR(meter.Channel(0).peakHold, -6.02, 0.05);
+
+	// Then decays at 20 dB/s, 2 dB per block.
+	meter.Process(quiet.data(), blockFrames);
+	meter.Process(quiet.data(), blockFrames);
+	CHECK_NEAR(meter.Channel(0).peakHold, -6.02 - 4.0, 0.05);
+
+	// Down to the current peak.
+	for (int i = 0; i < 50; i++)
+	{
+		meter.Process(quiet.data(), blockFrames);
+	}
+	CHECK_NEAR(meter.Channel(0).peakHold, meter.Channel(0).peak, 1e-9);
+}
+
+RECORD_TEST(ChannelsAboveMaximumAreIgnored)
+{
+	LevelMeter meter;
+	meter.Configure(kSampleRate, record_core::kMaxMeterChannels + 2);
+	CHECK(meter.NumChannels() == record_core::kMaxMeterChannels);
+
+	std::vector<double> amplitudes(record_core::kMaxMeterChannels + 2, 0.25);
+	const auto samples = Sines(1000.0, 0.0, amplitudes, 480);
+	meter.Process(samples.data(), 480);
+	CHECK_NEAR(meter.Channel(record_core::kMaxMeterChannels - 1).peak, -12.04, 0.05);
+}
+
+RECORD_TEST(ResetClearsLevels)
+{
+	LevelMeter meter;
+	meter.Configure(kSampleRate, 1);
+
+	const auto samples = Sines(1000.0, 0.0, { 0.5 }, 480);
+	meter.Process(samples.data(), 480);
+	meter.Reset();
+
+	CHECK_NEAR(meter.Channel(0).peak, record_core::kMinDbfs, 0.0);
+	CHECK_NEAR(meter.Channel(0).peakHold, record_core::kMinDbfs, 0.0);
+	CHECK(meter.Levels().sampleCount == 0);
+}
+
+RECORD_TEST_MAIN()
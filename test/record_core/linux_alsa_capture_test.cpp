@@ -0,0 +1,139 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+#include "record_alsa_capture.h"
+
+using record_core_test::WaitUntil;
+using record_linux::AlsaCapture;
+using record_linux::CaptureConfig;
+
+// Captures from the null PCM of alsa-lib, no device or server is needed.
+namespace
+{
+	// Stereo 16 bits.
+	constexpr size_t kFrameSize = 4;
+
+	CaptureConfig NullConfig()
+	{
+		CaptureConfig config;
+		config.device_id = "null";
+		config.sample_rate = 48000;
+		config.num_channels = 2;
+		config.latency_ms = 10;
+		return config;
+	}
+
+	struct Received
+	{
+		std::atomic<size_t> bytes{ 0 };
+		std::atomic<bool> partialFrame{ false };
+		std::mutex mutex;
+		std::string error;
+	};
+
+	bool Open(AlsaCapture* capture, const CaptureConfig& config, Received* received, std::string* error)
+	{
+		return capture->Open(
+			config,
+			[received](const uint8_t*, size_t size)
+			{
+				if (size % kFrameSize != 0)
+				{
+					received->partialFrame = true;
+				}
+				received->bytes += size;
+			},
+			[received](const std::string& message)
+			{
+				std::lock_guard<std::mutex> lock(received->mutex);
+				received->error = message;
+			},
+			error);
+	}
+}
+
+RECORD_TEST(NullDeviceDeliversWholeFrames)
+{
+	AlsaCapture capture;
+	Received received;
+
+	std::string error;
+	CHECK(Open(&capture, NullConfig(), &received, &error));
+	CHECK(WaitUntil([&] { return received.bytes >= 48000 * kFrameSize / 10; }));
+	CHECK(!received.partialFrame);
+
+	capture.Close();
+	CHECK(received.error.empty());
+}
+
+RECORD_TEST(BufferPeriodsAreAccepted)
+{
+	for (int periods : { 2, 4, 32 })
+	{
+		AlsaCapture capture;
+		Received received;
+
+		auto config = NullConfig();
+		config.buffer_periods = periods;
+
+		std::string error;
+		CHECK(Open(&capture, config, &received, &error));
+		CHECK(WaitUntil([&] { return received.bytes > 0; }));
+		capture.Close();
+	}
+}
+
+RECORD_TEST(StartPausedDropsFrames)
+{
+	AlsaCapture capture;
+	Received received;
+
+	auto config = NullConfig();
+	config.start_paused = true;
+
+	std::string error;
+	CHECK(Open(&capture, config, &received, &error));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(received.bytes == 0);
+
+	CHECK(capture.SetPaused(false));
+	CHECK(WaitUntil([&] { return received.bytes > 0; }));
+
+	capture.Close();
+}
+
+RECORD_TEST(MissingDeviceFailsToOpen)
+{
+	AlsaCapture capture;
+	Received received;
+
+	auto config = NullConfig();
+	config.device_id = "record_test_missing";
+
+	std::string error;
+	CHECK(!Open(&capture, config, &received, &error));
+	CHECK(!error.empty());
+	CHECK(!capture.SetPaused(true));
+}
+
+RECORD_TEST(CloseIsRepeatable)
+{
+	AlsaCapture capture;
+	Received received;
+
+	std::string error;
+	CHECK(Open(&capture, NullConfig(), &received, &error));
+	capture.Close();
+	capture.Close();
+
+	CHECK(Open(&capture, NullConfig(), &received, &error));
+	CHECK(WaitUntil([&] { return received.bytes > 0; }));
+}
+
+RECORD_TEST_MAIN()
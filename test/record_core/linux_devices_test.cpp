@@ -0,0 +1,84 @@
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "record_devices.h"
+
+using record_linux::DiffInputDevices;
+using record_linux::InputDeviceChange;
+using record_linux::InputDeviceInfo;
+
+namespace
+{
+	InputDeviceInfo Device(const std::string& id, bool isDefault = false)
+	{
+		InputDeviceInfo device;
+		device.id = id;
+		device.label = id + " label";
+		device.is_default = isDefault;
+		return device;
+	}
+
+	std::vector<std::string> Ids(const std::vector<InputDeviceInfo>& devices)
+	{
+		std::vector<std::string> ids;
+		for (const auto& device : devices) ids.push_back(device.id);
+		return ids;
+	}
+}
+
+RECORD_TEST(SameDevicesGiveNoChange)
+{
+	const std::vector<InputDeviceInfo> devices = { Device("mic", true), Device("usb") };
+
+	InputDeviceChange change = DiffInputDevices(devices, devices);
+	CHECK(change.empty());
+	CHECK(change.default_id == "mic");
+}
+
+RECORD_TEST(FirstListAddsAllDevices)
+{
+	InputDeviceChange change = DiffInputDevices({}, { Device("mic", true), Device("usb") });
+
+	CHECK((Ids(change.added) == std::vector<std::string>{ "mic", "usb" }));
+	CHECK(change.removed.empty());
+	CHECK(change.default_changed);
+	CHECK(change.default_id == "mic");
+}
+
+RECORD_TEST(PluggedAndUnpluggedDevices)
+{
+	InputDeviceChange change = DiffInputDevices(
+		{ Device("mic", true), Device("usb"), Device("bluetooth") },
+		{ Device("mic", true), Device("headset"), Device("usb") });
+
+	CHECK(Ids(change.added) == std::vector<std::string>{ "headset" });
+	CHECK(Ids(change.removed) == std::vector<std::string>{ "bluetooth" });
+	CHECK(change.added[0].label == "headset label");
+	CHECK(!change.default_changed);
+	CHECK(!change.empty());
+}
+
+RECORD_TEST(DefaultDeviceChange)
+{
+	InputDeviceChange change = DiffInputDevices(
+		{ Device("mic", true), Device("usb") },
+		{ Device("mic"), Device("usb", true) });
+
+	CHECK(change.added.empty());
+	CHECK(change.removed.empty());
+	CHECK(change.default_changed);
+	CHECK(change.default_id == "usb");
+	CHECK(!change.empty());
+}
+
+RECORD_TEST(DefaultDeviceUnplugged)
+{
+	InputDeviceChange change = DiffInputDevices({ Device("usb", true), Device("mic") }, { Device("mic") });
+
+	CHECK(Ids(change.removed) == std::vector<std::string>{ "usb" });
+	CHECK(change.default_changed);
+	CHECK(change.default_id.empty());
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+#include "record_encoder.h"
+
+using record_core::SampleFormat;
+using record_core_test::FakeCapture;
+using record_core_test::FrameValue;
+using record_core_test::PcmConfig;
+using record_core_test::ReadFile;
+using record_core_test::RecordingListener;
+using record_core_test::TempPath;
+using record_core_test::WaitUntil;
+using record_linux::CreateAudioEncoder;
+using record_linux::EncoderConfig;
+using record_linux::Recorder;
+
+namespace
+{
+	constexpr size_t kHeaderSize = 44;
+	constexpr size_t kChunkFrames = 441;
+
+	uint32_t GetU32(const std::vector<uint8_t>& bytes, size_t offset)
+	{
+		return bytes[offset] | bytes[offset + 1] << 8 | bytes[offset + 2] << 16
+			| static_cast<uint32_t>(bytes[offset + 3]) << 24;
+	}
+
+	uint16_t GetU16(const std::vector<uint8_t>& bytes, size_t offset)
+	{
+		return static_cast<uint16_t>(bytes[offset] | bytes[offset + 1] << 8);
+	}
+
+	// Records frameCount frames of config to a file, returns its content.
+	std::vector<uint8_t> Record(const record_linux::RecordConfig& config, const std::string& name, size_t frameCount)
+	{
+		auto recorder = Recorder::Create("1", std::make_shared<RecordingListener>());
+		const std::string path = TempPath(name);
+
+		std::string error;
+		CHECK(recorder->Start(config, path, &error));
+		auto captures = FakeCapture::Instances();
+		CHECK(captures.size() == 1);
+		if (captures.size() != 1) return {};
+
+		for (size_t fed = 0; fed < frameCount; fed += kChunkFrames)
+		{
+			captures[0]->Feed(std::min(kChunkFrames, frameCount - fed));
+		}
+
+		// File is completed by Stop.
+		CHECK(recorder->Stop() == path);
+
+		auto bytes = ReadFile(path);
+		std::remove(path.c_str());
+		return bytes;
+	}
+
+	void CheckWavHeader(const std::vector<uint8_t>& bytes, uint16_t formatTag, uint16_t channels, uint32_t sampleRate,
+		uint16_t bitsPerSample)
+	{
+		CHECK(bytes.size() >= kHeaderSize);
+		if (bytes.size() < kHeaderSize) return;
+
+		const uint16_t blockAlign = static_cast<uint16_t>(channels * bitsPerSample / 8);
+		CHECK(std::memcmp(bytes.data(), "RIFF", 4) == 0);
+		CHECK(GetU32(bytes, 4) == bytes.size() - 8);
+		CHECK(std::memcmp(bytes.data() + 8, "WAVEfmt ", 8) == 0);
+		CHECK(GetU32(bytes, 16) == 16);
+		CHECK(GetU16(bytes, 20) == formatTag);
+		CHECK(GetU16(bytes, 22) == channels);
+		CHECK(GetU32(bytes, 24) == sampleRate);
+		CHECK(GetU32(bytes, 28) == sampleRate * blockAlign);
+		CHECK(GetU16(bytes, 32) == blockAlign);
+		CHECK(GetU16(bytes, 34) == bitsPerSample);
+		CHECK(std::memcmp(bytes.data() + 36, "data", 4) == 0);
+		CHECK(GetU32(bytes, 40) == bytes.size() - kHeaderSize);
+	}
+}
+
+RECORD_TEST(BuiltInEncodersAreSupported)
+{
+	CHECK(record_linux::IsEncoderSupported("wav"));
+	CHECK(record_linux::IsEncoderSupported("pcm16bits"));
+	CHECK(!record_linux::IsEncoderSupported("amrNb"));
+	CHECK(CreateAudioEncoder("") == nullptr);
+	CHECK(record_linux::EncoderSampleRate("wav", 22050) == 22050);
+}
+
+RECORD_TEST(WavEncoderCompletesHeaderOnFinish)
+{
+	const std::string path = TempPath("encoder.wav");
+	auto encoder = CreateAudioEncoder("wav");
+
+	EncoderConfig config;
+	config.sample_rate = 16000;
+	config.num_channels = 1;
+
+	std::string error;
+	CHECK(encoder->Open(path, config, &error));
+
+	const int16_t samples[] = { 1, -2, 3, -4 };
+	CHECK(encoder->Write(reinterpret_cast<const uint8_t*>(samples), sizeof(samples)));
+	CHECK(encoder->Write(reinterpret_cast<const uint8_t*>(samples), sizeof(samples)));
+	CHECK(encoder->Finish());
+
+	auto bytes = ReadFile(path);
+	std::remove(path.c_str());
+
+	CHECK(bytes.size() == kHeaderSize + 2 * sizeof(samples));
+	CheckWavHeader(bytes, 1, 1, 16000, 16);
+	if (bytes.size() == kHeaderSize + 2 * sizeof(samples))
+	{
+		CHECK(std::memcmp(bytes.data() + kHeaderSize, samples, sizeof(samples)) == 0);
+	}
+}
+
+RECORD_TEST(EncoderOpenFailureIsReported)
+{
+	auto encoder = CreateAudioEncoder("wav");
+
+	std::string error;
+	CHECK(!encoder->Open(TempPath("missing/encoder.wav"), EncoderConfig(), &error));
+	CHECK(error.find("Failed to create ") == 0);
+}
+
+RECORD_TEST(RecorderWritesWavFile)
+{
+	auto config = PcmConfig();
+	config.encoder = "wav";
+
+	const size_t frameCount = 10 * kChunkFrames + 100;
+	auto bytes = Record(config, "recorder.wav", frameCount);
+
+	CHECK(bytes.size() == kHeaderSize + frameCount * 2 * sizeof(int16_t));
+	CheckWavHeader(bytes, 1, 2, 44100, 16);
+
+	bool sameFrames = bytes.size() == kHeaderSize + frameCount * 2 * sizeof(int16_t);
+	for (size_t frame = 0; sameFrames && frame < frameCount; frame++)
+	{
+		int16_t sample[2];
+		std::memcpy(sample, bytes.data() + kHeaderSize + frame * sizeof(sample), sizeof(sample));
+		sameFrames = sample[0] == FrameValue(frame) && sample[1] == FrameValue(frame);
+	}
+	CHECK(sameFrames);
+}
+
+RECORD_TEST(RecorderWritesRawPcm)
+{
+	const size_t frameCount = 5 * kChunkFrames;
+	auto bytes = Record(PcmConfig(), "recorder.pcm", frameCount);
+
+	CHECK(bytes.size() == frameCount * 2 * sizeof(int16_t));
+
+	bool sameFrames = bytes.size() == frameCount * 2 * sizeof(int16_t);
+	for (size_t frame = 0; sameFrames && frame < frameCount; frame++)
+	{
+		int16_t sample;
+		std::memcpy(&sample, bytes.data() + frame * 2 * sizeof(int16_t), sizeof(sample));
+		sameFrames = sample == FrameValue(frame);
+	}
+	CHECK(sameFrames);
+}
+
+RECORD_TEST(RecorderWrites24BitsWav)
+{
+	auto config = PcmConfig();
+	config.encoder = "wav";
+	config.num_channels = 1;
+	config.sample_format = SampleFormat::s24;
+
+	const size_t frameCount = 3 * kChunkFrames;
+	auto bytes = Record(config, "recorder24.wav", frameCount);
+
+	CHECK(bytes.size() == kHeaderSize + frameCount * 3);
+	CheckWavHeader(bytes, 1, 1, 44100, 24);
+
+	bool sameFrames = bytes.size() == kHeaderSize + frameCount * 3;
+	for (size_t frame = 0; sameFrames && frame < frameCount; frame++)
+	{
+		const uint8_t* sample = bytes.data() + kHeaderSize + frame * 3;
+		const int32_t value = static_cast<int32_t>(sample[0] << 8 | sample[1] << 16 | sample[2] << 24) >> 8;
+		sameFrames = value == FrameValue(frame) * 256;
+	}
+	CHECK(sameFrames);
+}
+
+RECORD_TEST(RecorderWritesFloatWav)
+{
+	auto config = PcmConfig();
+	config.encoder = "wav";
+	config.sample_format = SampleFormat::f32;
+
+	const size_t frameCount = 3 * kChunkFrames;
+	auto bytes = Record(config, "recorderf32.wav", frameCount);
+
+	CHECK(bytes.size() == kHeaderSize + frameCount * 2 * sizeof(float));
+	CheckWavHeader(bytes, 3, 2, 44100, 32);
+
+	bool sameFrames = bytes.size() == kHeaderSize + frameCount * 2 * sizeof(float);
+	for (size_t frame = 0; sameFrames && frame < frameCount; frame++)
+	{
+		float sample;
+		std::memcpy(&sample, bytes.data() + kHeaderSize + frame * 2 * sizeof(float), sizeof(sample));
+		sameFrames = sample == FrameValue(frame) / 32768.0f;
+	}
+	CHECK(sameFrames);
+}
+
+RECORD_TEST(RecorderRejectsUnknownEncoder)
+{
+	auto recorder = Recorder::Create("1", std::make_shared<RecordingListener>());
+
+	auto config = PcmConfig();
+	config.encoder = "amrNb";
+
+	std::string error;
+	CHECK(!recorder->Start(config, TempPath("recorder.amr"), &error));
+	CHECK(error == "Encoder amrNb is not supported.");
+	CHECK(!recorder->IsRecording());
+	CHECK(FakeCapture::Instances().empty());
+}
+
+RECORD_TEST(MetersUse24BitsAndFloatCaptures)
+{
+	const double peak = 20.0 * std::log10(FrameValue(4 * kChunkFrames - 1) / 32768.0);
+
+	for (auto format : { SampleFormat::s24, SampleFormat::s32, SampleFormat::f32 })
+	{
+		auto recorder = Recorder::Create("1", std::make_shared<RecordingListener>());
+
+		auto config = PcmConfig();
+		config.encoder = "wav";
+		config.sample_format = format;
+
+		const std::string path = TempPath("meters.wav");
+		std::string error;
+		CHECK(recorder->Start(config, path, &error));
+		auto captures = FakeCapture::Instances();
+		CHECK(captures.size() == 1);
+		if (captures.size() != 1) continue;
+
+		CHECK(captures[0]->Config().sample_format == format);
+		captures[0]->Feed(4 * kChunkFrames);
+
+		// Samples are converted from format before metering.
+		CHECK(WaitUntil([&]() { return recorder->GetMeters().numChannels != 0; }));
+		CHECK_NEAR(recorder->GetMeters().max, peak, 0.01);
+
+		recorder->Stop();
+		std::remove(path.c_str());
+	}
+}
+
+RECORD_TEST_MAIN()
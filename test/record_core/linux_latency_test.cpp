@@ -0,0 +1,89 @@
+#include <memory>
+#include <string>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+
+using record_core_test::FakeCapture;
+using record_core_test::PcmConfig;
+using record_core_test::RecordingListener;
+using record_linux::Recorder;
+
+namespace
+{
+	// Capture period requested for latency_ms.
+	int OpenedLatency(int latencyMs)
+	{
+		auto recorder = Recorder::Create("1", std::make_shared<RecordingListener>());
+
+		auto config = PcmConfig();
+		config.latency_ms = latencyMs;
+
+		std::string error;
+		CHECK(recorder->StartStream(config, &error));
+		auto captures = FakeCapture::Instances();
+		const int opened = captures.size() == 1 ? captures[0]->Config().latency_ms : -1;
+
+		recorder->Stop();
+		return opened;
+	}
+
+	// Device buffer requested for buffer_periods.
+	int OpenedBufferPeriods(int periods)
+	{
+		auto recorder = Recorder::Create("1", std::make_shared<RecordingListener>());
+
+		auto config = PcmConfig();
+		config.buffer_periods = periods;
+
+		std::string error;
+		CHECK(recorder->StartStream(config, &error));
+		auto captures = FakeCapture::Instances();
+		const int opened = captures.size() == 1 ? captures[0]->Config().buffer_periods : -1;
+
+		recorder->Stop();
+		return opened;
+	}
+}
+
+RECORD_TEST(LatencyIsClamped)
+{
+	CHECK(OpenedLatency(20) == 20);
+	CHECK(OpenedLatency(0) == record_linux::kMinLatencyMs);
+	CHECK(OpenedLatency(-10) == record_linux::kMinLatencyMs);
+	CHECK(OpenedLatency(1000) == record_linux::kMaxLatencyMs);
+	CHECK(OpenedLatency(record_linux::kMinLatencyMs) == 5);
+	CHECK(OpenedLatency(record_linux::kMaxLatencyMs) == 200);
+}
+
+RECORD_TEST(BufferPeriodsAreClamped)
+{
+	CHECK(OpenedBufferPeriods(4) == 4);
+	CHECK(OpenedBufferPeriods(0) == record_linux::kMinBufferPeriods);
+	CHECK(OpenedBufferPeriods(100) == record_linux::kMaxBufferPeriods);
+	CHECK(OpenedBufferPeriods(record_linux::kMinBufferPeriods) == 2);
+	CHECK(OpenedBufferPeriods(record_linux::kMaxBufferPeriods) == 32);
+}
+
+RECORD_TEST(LatencyIsMeasuredWhileRecording)
+{
+	auto recorder = Recorder::Create("1", std::make_shared<RecordingListener>());
+
+	record_core::CaptureLatency latency;
+	CHECK(!recorder->GetLatency(&latency));
+
+	auto config = PcmConfig();
+	config.latency_ms = 10;
+
+	std::string error;
+	CHECK(recorder->StartStream(config, &error));
+	CHECK(recorder->GetLatency(&latency));
+	// Fake capture measures twice its period.
+	CHECK(latency.periodUs == 10000);
+	CHECK(latency.latencyUs == 20000);
+
+	recorder->Stop();
+	CHECK(!recorder->GetLatency(&latency));
+}
+
+RECORD_TEST_MAIN()
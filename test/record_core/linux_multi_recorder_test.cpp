@@ -0,0 +1,130 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+
+using record_core_test::FakeCapture;
+using record_core_test::FrameValue;
+using record_core_test::PcmConfig;
+using record_core_test::RecordingListener;
+using record_core_test::RunMainThreadTasks;
+using record_core_test::RunMainThreadUntil;
+using record_linux::RecordState;
+using record_linux::Recorder;
+
+namespace
+{
+	struct TestRecorder
+	{
+		std::shared_ptr<RecordingListener> listener = std::make_shared<RecordingListener>();
+		std::shared_ptr<Recorder> recorder;
+		FakeCapture* capture = nullptr;
+
+		explicit TestRecorder(const std::string& id) : recorder(Recorder::Create(id, listener)) {}
+
+		bool StartStream()
+		{
+			std::string error;
+			if (!recorder->StartStream(PcmConfig(), &error)) return false;
+			recorder->SetStreamListening(true);
+
+			// Newest capture is the one just opened.
+			capture = FakeCapture::Instances().back();
+			return true;
+		}
+
+		size_t Frames() const { return listener->samples.size() / 2; }
+	};
+}
+
+RECORD_TEST(RecordersHaveTheirOwnCapture)
+{
+	TestRecorder first("1");
+	TestRecorder second("2");
+
+	CHECK(first.StartStream());
+	CHECK(second.StartStream());
+	CHECK(FakeCapture::Instances().size() == 2);
+	CHECK(first.capture != second.capture);
+
+	// Streams can be told apart on the server.
+	CHECK(first.capture->Config().stream_name == "record 1");
+	CHECK(second.capture->Config().stream_name == "record 2");
+
+	first.capture->Feed(100);
+	second.capture->Feed(300);
+	CHECK(RunMainThreadUntil([&]() { return first.Frames() == 100 && second.Frames() == 300; }));
+
+	CHECK(first.listener->samples[2 * 99] == FrameValue(99));
+	CHECK(second.listener->samples[2 * 299] == FrameValue(299));
+
+	first.recorder->Stop();
+	second.recorder->Stop();
+}
+
+RECORD_TEST(StoppingOneRecorderKeepsTheOther)
+{
+	TestRecorder first("1");
+	TestRecorder second("2");
+
+	CHECK(first.StartStream());
+	CHECK(second.StartStream());
+
+	first.recorder->Stop();
+	CHECK(!first.recorder->IsRecording());
+	CHECK(second.recorder->IsRecording());
+	CHECK((FakeCapture::Instances() == std::vector<FakeCapture*>{ second.capture }));
+	CHECK(second.capture->IsOpen());
+
+	second.capture->Feed(100);
+	CHECK(RunMainThreadUntil([&]() { return second.Frames() == 100; }));
+	CHECK(first.Frames() == 0);
+	CHECK(first.listener->streamEnds == 1);
+	CHECK(second.listener->streamEnds == 0);
+
+	second.recorder->Stop();
+}
+
+RECORD_TEST(CaptureErrorOnlyStopsItsRecorder)
+{
+	TestRecorder first("1");
+	TestRecorder second("2");
+
+	CHECK(first.StartStream());
+	CHECK(second.StartStream());
+
+	second.capture->Fail("Source removed.");
+	CHECK(RunMainThreadUntil([&]() { return !second.listener->errors.empty(); }));
+
+	CHECK(first.recorder->IsRecording());
+	CHECK(first.listener->errors.empty());
+	CHECK(!second.recorder->IsRecording());
+	CHECK(second.listener->states.back() == RecordState::kStop);
+
+	first.capture->Feed(100);
+	CHECK(RunMainThreadUntil([&]() { return first.Frames() == 100; }));
+
+	first.recorder->Stop();
+}
+
+RECORD_TEST(PendingEventsOfDestroyedRecorderAreDropped)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	FakeCapture* capture = FakeCapture::Instances().back();
+
+	capture->Fail("Server gone.");
+	// Error task is queued, the recorder is gone when it runs.
+	recorder.reset();
+	RunMainThreadTasks();
+
+	CHECK(listener->errors.empty());
+	CHECK(FakeCapture::Instances().empty());
+}
+
+RECORD_TEST_MAIN()
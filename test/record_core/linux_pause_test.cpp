@@ -0,0 +1,193 @@
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+
+using record_core_test::FakeCapture;
+using record_core_test::FrameValue;
+using record_core_test::PcmConfig;
+using record_core_test::RecordingListener;
+using record_core_test::RunMainThreadUntil;
+using record_linux::PausedFrames;
+using record_linux::RecordState;
+using record_linux::Recorder;
+
+namespace
+{
+	constexpr size_t kFrameSize = 2;
+
+	// Frame positions given by PausedFrames::Deliver for frameCount frames
+	// read at position, whose bytes hold their position.
+	std::vector<int64_t> Deliver(PausedFrames& paused, int64_t position, size_t frameCount)
+	{
+		std::vector<uint8_t> data(frameCount * kFrameSize);
+		for (size_t i = 0; i < frameCount; i++)
+		{
+			data[i * kFrameSize] = static_cast<uint8_t>(position + static_cast<int64_t>(i));
+		}
+
+		std::vector<int64_t> positions;
+		paused.Deliver(position, data.data(), data.size(), kFrameSize, [&](const uint8_t* frames, size_t size) {
+			CHECK(size > 0 && size % kFrameSize == 0);
+			for (size_t i = 0; i < size; i += kFrameSize) positions.push_back(frames[i]);
+		});
+		return positions;
+	}
+
+	std::vector<int64_t> Range(int64_t start, int64_t end)
+	{
+		std::vector<int64_t> values;
+		for (int64_t i = start; i < end; i++) values.push_back(i);
+		return values;
+	}
+
+	std::vector<int64_t> Join(std::vector<int64_t> first, const std::vector<int64_t>& second)
+	{
+		first.insert(first.end(), second.begin(), second.end());
+		return first;
+	}
+}
+
+RECORD_TEST(PausedFramesDeliversAllWhenNotPaused)
+{
+	PausedFrames paused;
+	CHECK(Deliver(paused, 0, 10) == Range(0, 10));
+	CHECK(Deliver(paused, 10, 5) == Range(10, 15));
+}
+
+RECORD_TEST(PausedFramesDropsFromPauseToResume)
+{
+	PausedFrames paused;
+	paused.Pause(4);
+	paused.Resume(12);
+
+	// Buffer overlapping both ends of the paused range.
+	CHECK(Deliver(paused, 0, 16) == Join(Range(0, 4), Range(12, 16)));
+	// Range is forgotten once passed.
+	CHECK(Deliver(paused, 16, 4) == Range(16, 20));
+}
+
+RECORD_TEST(PausedFramesDropsUntilResumed)
+{
+	PausedFrames paused;
+	paused.Pause(6);
+
+	CHECK(Deliver(paused, 0, 8) == Range(0, 6));
+	CHECK(Deliver(paused, 8, 8).empty());
+
+	paused.Resume(20);
+	CHECK(Deliver(paused, 16, 8) == Range(20, 24));
+}
+
+RECORD_TEST(PausedFramesHandlesSeveralRangesInOneBuffer)
+{
+	PausedFrames paused;
+	paused.Pause(2);
+	paused.Resume(4);
+	paused.Pause(6);
+	paused.Resume(7);
+	// Resumed before the pause position, nothing is dropped.
+	paused.Pause(9);
+	paused.Resume(8);
+
+	CHECK(Deliver(paused, 0, 12) == Join(Join(Range(0, 2), Range(4, 6)), Range(7, 12)));
+}
+
+RECORD_TEST(PausedFramesClearForgetsRanges)
+{
+	PausedFrames paused;
+	paused.Pause(0);
+	paused.Clear();
+
+	CHECK(Deliver(paused, 0, 4) == Range(0, 4));
+}
+
+RECORD_TEST(RecorderDropsFramesWhilePaused)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+	auto captures = FakeCapture::Instances();
+	CHECK(captures.size() == 1);
+	if (captures.size() != 1) return;
+	FakeCapture* capture = captures[0];
+
+	capture->Feed(100);
+	recorder->Pause();
+	CHECK(recorder->IsPaused());
+	CHECK(capture->IsPaused());
+
+	capture->Feed(300);
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	CHECK(recorder->GetPausedDuration() >= std::chrono::milliseconds(20));
+
+	recorder->Resume();
+	CHECK(recorder->IsRecording());
+	CHECK(!capture->IsPaused());
+	capture->Feed(50);
+
+	CHECK(RunMainThreadUntil([&]() { return listener->samples.size() == 150 * 2; }));
+
+	bool sameFrames = listener->samples.size() == 150 * 2;
+	for (size_t i = 0; sameFrames && i < listener->samples.size(); i++)
+	{
+		const size_t frame = i / 2;
+		sameFrames = listener->samples[i] == FrameValue(frame < 100 ? frame : frame + 300);
+	}
+	CHECK(sameFrames);
+
+	const auto pausedDuration = recorder->GetPausedDuration();
+	CHECK(pausedDuration >= std::chrono::milliseconds(20));
+	// Frozen once resumed.
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	CHECK(recorder->GetPausedDuration() == pausedDuration);
+
+	recorder->Stop();
+	CHECK((listener->states
+		== std::vector<RecordState>{ RecordState::kRecord, RecordState::kPause, RecordState::kRecord, RecordState::kStop }));
+}
+
+RECORD_TEST(StopWhilePausedCountsPausedTime)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+	recorder->Pause();
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	recorder->Stop();
+
+	CHECK(recorder->GetPausedDuration() >= std::chrono::milliseconds(10));
+	CHECK(listener->states.back() == RecordState::kStop);
+
+	// Paused time restarts with the next recording.
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+	CHECK(recorder->GetPausedDuration() == std::chrono::microseconds(0));
+	recorder->Stop();
+}
+
+RECORD_TEST(PauseAndResumeAreIgnoredWhenStopped)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	recorder->Pause();
+	recorder->Resume();
+
+	CHECK(!recorder->IsPaused());
+	CHECK(!recorder->IsRecording());
+	CHECK(listener->states.empty());
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,77 @@
+#include <cstdint>
+
+#include "check.h"
+#include "record_pipewire_capture.h"
+
+using record_linux::ChunkFrameBytes;
+using record_linux::PipeWireTarget;
+using record_linux::ToPipeWireTarget;
+
+namespace
+{
+	// Stereo 16 bits.
+	constexpr size_t kFrameSize = 4;
+
+	size_t FrameBytes(uint32_t offset, uint32_t size, uint32_t maxSize, uint32_t* start)
+	{
+		spa_chunk chunk = {};
+		chunk.offset = offset;
+		chunk.size = size;
+
+		spa_data data = {};
+		data.maxsize = maxSize;
+		data.chunk = &chunk;
+
+		return ChunkFrameBytes(data, kFrameSize, start);
+	}
+}
+
+RECORD_TEST(SourceIsTargetedByName)
+{
+	PipeWireTarget target = ToPipeWireTarget("alsa_input.pci-0000_00_1f.3.analog-stereo");
+
+	CHECK(target.object == "alsa_input.pci-0000_00_1f.3.analog-stereo");
+	CHECK(!target.capture_sink);
+}
+
+RECORD_TEST(MonitorTargetsItsSink)
+{
+	PipeWireTarget target = ToPipeWireTarget("alsa_output.pci-0000_00_1f.3.analog-stereo.monitor");
+
+	CHECK(target.object == "alsa_output.pci-0000_00_1f.3.analog-stereo");
+	CHECK(target.capture_sink);
+}
+
+RECORD_TEST(MonitorSuffixAloneIsAName)
+{
+	PipeWireTarget target = ToPipeWireTarget(".monitor");
+
+	CHECK(target.object == ".monitor");
+	CHECK(!target.capture_sink);
+}
+
+RECORD_TEST(ChunkGivesWholeFrames)
+{
+	uint32_t start = 1;
+	CHECK(FrameBytes(0, 1024, 4096, &start) == 1024);
+	CHECK(start == 0);
+
+	// Partial frame is left out.
+	CHECK(FrameBytes(8, 1026, 4096, &start) == 1024);
+	CHECK(start == 8);
+}
+
+RECORD_TEST(ChunkIsClampedToMapping)
+{
+	uint32_t start = 0;
+	CHECK(FrameBytes(4000, 400, 4096, &start) == 96);
+	CHECK(start == 4000);
+
+	CHECK(FrameBytes(5000, 400, 4096, &start) == 0);
+	CHECK(start == 4096);
+
+	CHECK(FrameBytes(0, 8192, 4096, &start) == 4096);
+	CHECK(start == 0);
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,167 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+
+using record_core_test::FakeCapture;
+using record_core_test::FrameValue;
+using record_core_test::PcmConfig;
+using record_core_test::RecordingListener;
+using record_core_test::RunMainThreadUntil;
+using record_linux::Recorder;
+
+namespace
+{
+	FakeCapture* OnlyCapture()
+	{
+		auto captures = FakeCapture::Instances();
+		return captures.size() == 1 ? captures[0] : nullptr;
+	}
+}
+
+RECORD_TEST(PrepareOpensCapturePaused)
+{
+	FakeCapture::Reset();
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	std::string error;
+	CHECK(recorder->Prepare(PcmConfig(), &error));
+
+	FakeCapture* capture = OnlyCapture();
+	CHECK(capture != nullptr);
+	if (!capture) return;
+
+	CHECK(capture->IsOpen());
+	CHECK(capture->IsPaused());
+	CHECK(capture->Config().start_paused);
+	CHECK(capture->Config().stream_name == "record 1");
+	CHECK(!recorder->IsRecording());
+	CHECK(listener->states.empty());
+
+	// Preparing again the same way keeps the capture.
+	CHECK(recorder->Prepare(PcmConfig(), &error));
+	CHECK(OnlyCapture() == capture);
+	CHECK(FakeCapture::OpenCount() == 1);
+
+	// Closed by Stop.
+	recorder->Stop();
+	CHECK(FakeCapture::Instances().empty());
+}
+
+RECORD_TEST(StartReusesPreparedCapture)
+{
+	FakeCapture::Reset();
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	std::string error;
+	CHECK(recorder->Prepare(PcmConfig(), &error));
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	// Captured before Start, dropped.
+	capture->Feed(1000);
+
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+	CHECK(OnlyCapture() == capture);
+	CHECK(FakeCapture::OpenCount() == 1);
+	CHECK(!capture->IsPaused());
+	CHECK(recorder->IsRecording());
+
+	capture->Feed(100);
+	CHECK(RunMainThreadUntil([&]() { return listener->samples.size() == 100 * 2; }));
+	CHECK(listener->samples.front() == FrameValue(1000));
+	CHECK(listener->samples.back() == FrameValue(1099));
+
+	recorder->Stop();
+}
+
+RECORD_TEST(StartWithOtherSettingsReopensCapture)
+{
+	FakeCapture::Reset();
+	auto recorder = Recorder::Create("1", std::make_shared<RecordingListener>());
+
+	std::string error;
+	CHECK(recorder->Prepare(PcmConfig(), &error));
+
+	auto config = PcmConfig();
+	config.sample_rate = 16000;
+	config.num_channels = 1;
+	CHECK(recorder->StartStream(config, &error));
+	recorder->SetStreamListening(true);
+
+	FakeCapture* capture = OnlyCapture();
+	CHECK(capture != nullptr);
+	CHECK(FakeCapture::OpenCount() == 2);
+	if (!capture) return;
+
+	// Prepared one is closed, the new one is not paused.
+	CHECK(capture->Config().sample_rate == 16000);
+	CHECK(capture->Config().num_channels == 1);
+	CHECK(!capture->Config().start_paused);
+	CHECK(!capture->IsPaused());
+
+	recorder->Stop();
+}
+
+RECORD_TEST(PrepareWithOtherSettingsReopensCapture)
+{
+	FakeCapture::Reset();
+	auto recorder = Recorder::Create("1", std::make_shared<RecordingListener>());
+
+	std::string error;
+	CHECK(recorder->Prepare(PcmConfig(), &error));
+
+	auto config = PcmConfig();
+	config.device_id = "usb_mic";
+	CHECK(recorder->Prepare(config, &error));
+
+	FakeCapture* capture = OnlyCapture();
+	CHECK(capture != nullptr);
+	CHECK(FakeCapture::OpenCount() == 2);
+	if (capture) CHECK(capture->Config().device_id == "usb_mic");
+
+	recorder->Stop();
+}
+
+RECORD_TEST(PrepareFailsWhileStarted)
+{
+	FakeCapture::Reset();
+	auto recorder = Recorder::Create("1", std::make_shared<RecordingListener>());
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+
+	CHECK(!recorder->Prepare(PcmConfig(), &error));
+	CHECK(error == "Recorder is already started.");
+	CHECK(FakeCapture::OpenCount() == 1);
+	CHECK(recorder->IsRecording());
+
+	recorder->Stop();
+}
+
+RECORD_TEST(PrepareReportsOpenFailure)
+{
+	FakeCapture::Reset();
+	auto recorder = Recorder::Create("1", std::make_shared<RecordingListener>());
+
+	FakeCapture::FailNextOpen("Device busy.");
+
+	std::string error;
+	CHECK(!recorder->Prepare(PcmConfig(), &error));
+	CHECK(error == "Device busy.");
+	CHECK(FakeCapture::Instances().empty());
+
+	// Start opens its own capture.
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+	CHECK(FakeCapture::OpenCount() == 1);
+	recorder->Stop();
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,70 @@
+#include <string>
+
+#include "check.h"
+#include "record_pulse_devices.h"
+#include "sample_format.h"
+
+using record_core::SampleFormat;
+using record_linux::InputDeviceInfo;
+using record_linux::ToInputDevice;
+
+namespace
+{
+	pa_source_info SourceInfo(const char* name, pa_sample_format_t format)
+	{
+		pa_source_info info = {};
+		info.name = name;
+		info.description = "Built-in Audio Analog Stereo";
+		info.sample_spec.format = format;
+		info.sample_spec.rate = 48000;
+		info.sample_spec.channels = 2;
+		info.monitor_of_sink = PA_INVALID_INDEX;
+		info.latency = 21333;
+		return info;
+	}
+}
+
+RECORD_TEST(SourceInfoGivesDevice)
+{
+	auto info = SourceInfo("alsa_input.pci.analog-stereo", PA_SAMPLE_S16LE);
+	InputDeviceInfo device = ToInputDevice(info, "alsa_input.pci.analog-stereo");
+
+	CHECK(device.id == "alsa_input.pci.analog-stereo");
+	CHECK(device.label == "Built-in Audio Analog Stereo");
+	CHECK(device.sample_rate == 48000);
+	CHECK(device.num_channels == 2);
+	CHECK(device.sample_format == static_cast<int>(SampleFormat::s16));
+	CHECK(device.latency_us == 21333);
+	CHECK(!device.is_monitor);
+	CHECK(device.is_default);
+}
+
+RECORD_TEST(SourceWithoutDescriptionIsLabelledByName)
+{
+	auto info = SourceInfo("usb_mic", PA_SAMPLE_S16LE);
+	info.description = nullptr;
+
+	InputDeviceInfo device = ToInputDevice(info, "other");
+	CHECK(device.label == "usb_mic");
+	CHECK(!device.is_default);
+}
+
+RECORD_TEST(MonitorSourcesAreFlagged)
+{
+	auto info = SourceInfo("alsa_output.pci.analog-stereo.monitor", PA_SAMPLE_S16LE);
+	info.monitor_of_sink = 3;
+
+	CHECK(ToInputDevice(info, "").is_monitor);
+}
+
+RECORD_TEST(SourceFormatsMapToSampleFormats)
+{
+	CHECK(ToInputDevice(SourceInfo("a", PA_SAMPLE_S24LE), "").sample_format == static_cast<int>(SampleFormat::s24));
+	CHECK(ToInputDevice(SourceInfo("a", PA_SAMPLE_S24_32LE), "").sample_format == static_cast<int>(SampleFormat::s24));
+	CHECK(ToInputDevice(SourceInfo("a", PA_SAMPLE_S32LE), "").sample_format == static_cast<int>(SampleFormat::s32));
+	CHECK(ToInputDevice(SourceInfo("a", PA_SAMPLE_FLOAT32LE), "").sample_format == static_cast<int>(SampleFormat::f32));
+	// No capture format matches.
+	CHECK(ToInputDevice(SourceInfo("a", PA_SAMPLE_U8), "").sample_format == -1);
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,430 @@
+#include "linux_recorder_harness.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <utility>
+
+#include "record_dispatcher.h"
+#include "record_wav_encoder.h"
+
+namespace record_core_test
+{
+	namespace
+	{
+		std::mutex g_capturesMutex;
+		std::vector<FakeCapture*> g_captures;
+		std::string g_openFailure;
+		int g_openCount = 0;
+
+		// Main thread of the tests, woken by the dispatcher.
+		std::mutex g_mainMutex;
+		std::condition_variable g_mainCondition;
+		bool g_mainWakeup = false;
+
+		void WakeMainThread(void*)
+		{
+			{
+				std::lock_guard<std::mutex> lock(g_mainMutex);
+				g_mainWakeup = true;
+			}
+			g_mainCondition.notify_one();
+		}
+
+		void WriteSample(int16_t value, record_core::SampleFormat format, uint8_t* dst)
+		{
+			switch (format)
+			{
+			case record_core::SampleFormat::s16:
+				std::memcpy(dst, &value, sizeof(value));
+				break;
+			case record_core::SampleFormat::s24:
+			{
+				const int32_t sample = value * 256;
+				std::memcpy(dst, &sample, 3);
+				break;
+			}
+			case record_core::SampleFormat::s32:
+			{
+				const int32_t sample = value * 65536;
+				std::memcpy(dst, &sample, sizeof(sample));
+				break;
+			}
+			case record_core::SampleFormat::f32:
+			{
+				const float sample = value / 32768.0f;
+				std::memcpy(dst, &sample, sizeof(sample));
+				break;
+			}
+			}
+		}
+	}
+
+	FakeCapture::FakeCapture()
+	{
+		std::lock_guard<std::mutex> lock(g_capturesMutex);
+		g_captures.push_back(this);
+	}
+
+	FakeCapture::~FakeCapture()
+	{
+		Close();
+
+		std::lock_guard<std::mutex> lock(g_capturesMutex);
+		g_captures.erase(std::remove(g_captures.begin(), g_captures.end(), this), g_captures.end());
+	}
+
+	bool FakeCapture::Open(const record_linux::CaptureConfig& config,
+		record_linux::CaptureDataCallback on_data,
+		record_linux::CaptureErrorCallback on_error,
+		std::string* error)
+	{
+		{
+			std::lock_guard<std::mutex> lock(g_capturesMutex);
+			if (!g_openFailure.empty())
+			{
+				*error = g_openFailure;
+				g_openFailure.clear();
+				return false;
+			}
+			g_openCount++;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_config = config;
+		m_onData = std::move(on_data);
+		m_onError = std::move(on_error);
+		m_open = true;
+		m_paused = config.start_paused;
+		m_position = 0;
+		return true;
+	}
+
+	void FakeCapture::Close()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_open = false;
+		m_onData = nullptr;
+		m_onError = nullptr;
+	}
+
+	bool FakeCapture::SetPaused(bool paused)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_paused = paused;
+		return m_open;
+	}
+
+	record_core::CaptureLatency FakeCapture::GetLatency() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		record_core::CaptureLatency latency;
+		latency.periodUs = m_config.latency_ms * 1000;
+		latency.latencyUs = 2 * latency.periodUs;
+		return latency;
+	}
+
+	bool FakeCapture::Feed(size_t frameCount)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_open)
+		{
+			return false;
+		}
+
+		const int64_t position = m_position;
+		m_position += static_cast<int64_t>(frameCount);
+		if (m_paused)
+		{
+			return true;
+		}
+
+		const size_t sampleBytes = record_core::BytesPerSample(m_config.sample_format);
+		const size_t channels = static_cast<size_t>(m_config.num_channels);
+		m_buffer.resize(frameCount * channels * sampleBytes);
+
+		uint8_t* dst = m_buffer.data();
+		for (size_t frame = 0; frame < frameCount; frame++)
+		{
+			for (size_t ch = 0; ch < channels; ch++, dst += sampleBytes)
+			{
+				WriteSample(FrameValue(position + static_cast<int64_t>(frame)), m_config.sample_format, dst);
+			}
+		}
+
+		m_onData(m_buffer.data(), m_buffer.size());
+		return true;
+	}
+
+	void FakeCapture::Fail(const std::string& message)
+	{
+		record_linux::CaptureErrorCallback onError;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			onError = m_onError;
+		}
+
+		if (onError)
+		{
+			onError(message);
+		}
+	}
+
+	record_linux::CaptureConfig FakeCapture::Config() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_config;
+	}
+
+	bool FakeCapture::IsOpen() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_open;
+	}
+
+	bool FakeCapture::IsPaused() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_paused;
+	}
+
+	int64_t FakeCapture::Position() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_position;
+	}
+
+	void FakeCapture::FailNextOpen(const std::string& message)
+	{
+		std::lock_guard<std::mutex> lock(g_capturesMutex);
+		g_openFailure = message;
+	}
+
+	std::vector<FakeCapture*> FakeCapture::Instances()
+	{
+		std::lock_guard<std::mutex> lock(g_capturesMutex);
+		return g_captures;
+	}
+
+	int FakeCapture::OpenCount()
+	{
+		std::lock_guard<std::mutex> lock(g_capturesMutex);
+		return g_openCount;
+	}
+
+	void FakeCapture::Reset()
+	{
+		std::lock_guard<std::mutex> lock(g_capturesMutex);
+		g_openFailure.clear();
+		g_openCount = 0;
+	}
+
+	void RecordingListener::OnStreamData(const std::vector<uint8_t>& data)
+	{
+		const size_t count = data.size() / sizeof(int16_t);
+		const size_t offset = samples.size();
+		samples.resize(offset + count);
+		std::memcpy(samples.data() + offset, data.data(), count * sizeof(int16_t));
+		chunks++;
+
+		if (onStreamData)
+		{
+			onStreamData(data);
+		}
+	}
+
+	constexpr size_t FakePacketEncoder::kFramesPerPacket;
+
+	bool FakePacketEncoder::Open(const std::string&,
+		const record_linux::EncoderConfig&,
+		std::string* error)
+	{
+		*error = "Fake packet encoder only streams.";
+		return false;
+	}
+
+	bool FakePacketEncoder::OpenStream(const record_linux::EncoderConfig& config,
+		record_linux::EncodedPacketCallback on_packet,
+		std::string*)
+	{
+		m_config = config;
+		m_onPacket = std::move(on_packet);
+		m_pending.clear();
+		m_frames = 0;
+		return true;
+	}
+
+	std::vector<uint8_t> FakePacketEncoder::CodecConfig() const
+	{
+		return Config();
+	}
+
+	std::vector<uint8_t> FakePacketEncoder::Config()
+	{
+		// AudioSpecificConfig of AAC LC, 44.1kHz stereo.
+		return { 0x12, 0x10 };
+	}
+
+	bool FakePacketEncoder::Write(const uint8_t* data, size_t size)
+	{
+		const size_t packetSize = kFramesPerPacket * m_config.num_channels * sizeof(int16_t);
+
+		while (size > 0)
+		{
+			const size_t taken = std::min(size, packetSize - m_pending.size());
+			m_pending.insert(m_pending.end(), data, data + taken);
+			data += taken;
+			size -= taken;
+
+			if (m_pending.size() == packetSize)
+			{
+				SendPacket();
+			}
+		}
+
+		return true;
+	}
+
+	bool FakePacketEncoder::Finish()
+	{
+		if (!m_pending.empty())
+		{
+			SendPacket();
+		}
+		return true;
+	}
+
+	void FakePacketEncoder::SendPacket()
+	{
+		const int64_t frames = static_cast<int64_t>(m_pending.size() / (m_config.num_channels * sizeof(int16_t)));
+
+		record_core::StreamPacketInfo info;
+		info.timestampUs = m_frames * 1000000 / m_config.sample_rate;
+		info.durationUs = frames * 1000000 / m_config.sample_rate;
+		m_frames += frames;
+
+		m_onPacket(m_pending.data(), m_pending.size(), info);
+		m_pending.clear();
+	}
+
+	bool RunMainThreadUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout)
+	{
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+		for (;;)
+		{
+			RunMainThreadTasks();
+			if (done())
+			{
+				return true;
+			}
+
+			std::unique_lock<std::mutex> lock(g_mainMutex);
+			if (!g_mainCondition.wait_until(lock, deadline, []() { return g_mainWakeup; }))
+			{
+				lock.unlock();
+				RunMainThreadTasks();
+				return done();
+			}
+		}
+	}
+
+	bool WaitUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout)
+	{
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+		while (!done())
+		{
+			if (std::chrono::steady_clock::now() >= deadline)
+			{
+				return done();
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return true;
+	}
+
+	void RunMainThreadTasks()
+	{
+		{
+			std::lock_guard<std::mutex> lock(g_mainMutex);
+			g_mainWakeup = false;
+		}
+		record_dispatcher().Drain();
+	}
+
+	record_linux::RecordConfig PcmConfig()
+	{
+		record_linux::RecordConfig config;
+		config.encoder = "pcm16bits";
+		config.sample_rate = 44100;
+		config.num_channels = 2;
+		return config;
+	}
+
+	std::vector<uint8_t> ReadFile(const std::string& path)
+	{
+		std::vector<uint8_t> bytes;
+		FILE* file = std::fopen(path.c_str(), "rb");
+		if (!file)
+		{
+			return bytes;
+		}
+
+		uint8_t buffer[4096];
+		size_t read;
+		while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			bytes.insert(bytes.end(), buffer, buffer + read);
+		}
+		std::fclose(file);
+		return bytes;
+	}
+
+	std::string TempPath(const std::string& name)
+	{
+		const char* directory = std::getenv("TMPDIR");
+		return std::string(directory && *directory ? directory : "/tmp") + "/record_core_test_" + name;
+	}
+};
+
+// Platform hooks of the recorder.
+
+record_core::MainThreadDispatcher& record_dispatcher()
+{
+	static record_core::MainThreadDispatcher* dispatcher = [] {
+		auto* instance = new record_core::MainThreadDispatcher();
+		instance->SetWakeup(record_core_test::WakeMainThread, nullptr);
+		return instance;
+	}();
+
+	return *dispatcher;
+}
+
+namespace record_linux
+{
+	std::unique_ptr<CaptureBackend> CreateCaptureBackend()
+	{
+		return std::unique_ptr<CaptureBackend>(new record_core_test::FakeCapture());
+	}
+
+	std::unique_ptr<AudioEncoder> CreateAudioEncoder(const std::string& name)
+	{
+		if (name == "wav")
+		{
+			return std::unique_ptr<AudioEncoder>(new WavEncoder(true));
+		}
+		if (name == "pcm16bits")
+		{
+			return std::unique_ptr<AudioEncoder>(new WavEncoder(false));
+		}
+		if (name == "aacLc")
+		{
+			return std::unique_ptr<AudioEncoder>(new record_core_test::FakePacketEncoder());
+		}
+		return nullptr;
+	}
+}
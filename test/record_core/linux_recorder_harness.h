@@ -0,0 +1,178 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "record_capture.h"
+#include "record_encoder.h"
+#include "record_recorder.h"
+
+// Runs the Linux recorder without a sound server nor GLib: captures are
+// fakes fed by the tests, main thread tasks run when the test waits for
+// them. Encoders are the WAV ones, and a fake packet encoder.
+namespace record_core_test
+{
+	//////////////////////////////////////////////////////////////////////////
+	//  FakeCapture
+	//  Description: Capture backend returned by CreateCaptureBackend.
+	//               Frames are given by Feed, from the thread calling it
+	//               (the capture thread of the test).
+	//               Each sample holds its frame position, so delivered data
+	//               tells which frames were kept.
+	//////////////////////////////////////////////////////////////////////////
+	class FakeCapture : public record_linux::CaptureBackend
+	{
+	public:
+		FakeCapture();
+		~FakeCapture() override;
+
+		bool Open(const record_linux::CaptureConfig& config,
+			record_linux::CaptureDataCallback on_data,
+			record_linux::CaptureErrorCallback on_error,
+			std::string* error) override;
+		void Close() override;
+		bool SetPaused(bool paused) override;
+		record_core::CaptureLatency GetLatency() const override;
+
+		// Captures frameCount more frames in the opened format. Frames
+		// captured while paused are dropped. Returns false when closed.
+		bool Feed(size_t frameCount);
+		// Reports a capture failure.
+		void Fail(const std::string& message);
+
+		record_linux::CaptureConfig Config() const;
+		bool IsOpen() const;
+		bool IsPaused() const;
+		// Frames captured since Open, paused ones included.
+		int64_t Position() const;
+
+		// Next Open fails with this message when not empty.
+		static void FailNextOpen(const std::string& message);
+		// Captures created by CreateCaptureBackend and still alive, oldest
+		// first.
+		static std::vector<FakeCapture*> Instances();
+		// Number of captures opened since the last Reset.
+		static int OpenCount();
+		static void Reset();
+
+	private:
+		mutable std::mutex m_mutex;
+		record_linux::CaptureConfig m_config;
+		record_linux::CaptureDataCallback m_onData;
+		record_linux::CaptureErrorCallback m_onError;
+		bool m_open = false;
+		bool m_paused = false;
+		int64_t m_position = 0;
+		std::vector<uint8_t> m_buffer;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//  FakePacketEncoder
+	//  Description: Encoder returned by CreateAudioEncoder for "aacLc", it
+	//               only streams. Packets hold kFramesPerPacket s16 frames
+	//               as given, the last one the remaining frames, so they
+	//               tell which frames were encoded.
+	//////////////////////////////////////////////////////////////////////////
+	class FakePacketEncoder : public record_linux::AudioEncoder
+	{
+	public:
+		static constexpr size_t kFramesPerPacket = 1024;
+
+		bool Open(const std::string& path,
+			const record_linux::EncoderConfig& config,
+			std::string* error) override;
+		bool OpenStream(const record_linux::EncoderConfig& config,
+			record_linux::EncodedPacketCallback on_packet,
+			std::string* error) override;
+		std::vector<uint8_t> CodecConfig() const override;
+		bool Write(const uint8_t* data, size_t size) override;
+		bool Finish() override;
+
+		// Codec config of all fake packet streams.
+		static std::vector<uint8_t> Config();
+
+	private:
+		void SendPacket();
+
+		record_linux::EncoderConfig m_config;
+		record_linux::EncodedPacketCallback m_onPacket;
+		std::vector<uint8_t> m_pending;
+		int64_t m_frames = 0;
+	};
+
+	// Sample value of frame position, see FakeCapture.
+	inline int16_t FrameValue(int64_t position)
+	{
+		return static_cast<int16_t>(position % 30000);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	//  RecordingListener
+	//  Description: Keeps recorder events. Only used from the test thread,
+	//               which runs the main thread tasks.
+	//////////////////////////////////////////////////////////////////////////
+	class RecordingListener : public record_linux::RecorderListener
+	{
+	public:
+		void OnStateChanged(record_linux::RecordState state) override { states.push_back(state); }
+		void OnStreamData(const std::vector<uint8_t>& data) override;
+		void OnSharedStreamData(const record_core::PcmRingChunk& chunk) override { sharedChunks.push_back(chunk); }
+		void OnStreamPacket(const std::vector<uint8_t>& data, const record_core::StreamPacketInfo& info) override { packets.push_back({ data, info }); }
+		void OnStreamEnd() override { streamEnds++; }
+		void OnError(const std::string& message) override { errors.push_back(message); }
+		void OnEnvelope(const std::vector<float>& buckets) override { envelopeBuckets += buckets.size() / 3; }
+		void OnSpectrum(const std::vector<float>&) override { spectrumFrames++; }
+		void OnVoiceActivity(bool active) override { voiceActivity.push_back(active); }
+
+		// Streamed s16 samples, in order.
+		std::vector<int16_t> samples;
+		size_t chunks = 0;
+		// Called for each streamed chunk.
+		std::function<void(const std::vector<uint8_t>&)> onStreamData;
+		// Chunk locations of a zero copy stream.
+		std::vector<record_core::PcmRingChunk> sharedChunks;
+
+		struct Packet
+		{
+			std::vector<uint8_t> data;
+			record_core::StreamPacketInfo info;
+		};
+		// Packets of an encoded stream.
+		std::vector<Packet> packets;
+
+		std::vector<record_linux::RecordState> states;
+		int streamEnds = 0;
+		std::vector<std::string> errors;
+		size_t envelopeBuckets = 0;
+		size_t spectrumFrames = 0;
+		std::vector<bool> voiceActivity;
+	};
+
+	// Runs main thread tasks until done returns true or timeout elapses.
+	// Returns done().
+	bool RunMainThreadUntil(const std::function<bool()>& done,
+		std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+	// Polls done, without running main thread tasks, until it returns true or
+	// timeout elapses. For state changed by other threads without posting
+	// (e.g. stream queue contents). Returns done().
+	bool WaitUntil(const std::function<bool()>& done,
+		std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+	// Runs main thread tasks posted so far, and those they post.
+	void RunMainThreadTasks();
+
+	// Record config of 16 bits stereo PCM at 44.1kHz.
+	record_linux::RecordConfig PcmConfig();
+
+	// Reads a whole file, empty when it can't be read.
+	std::vector<uint8_t> ReadFile(const std::string& path);
+
+	// Path of a file in the temporary directory.
+	std::string TempPath(const std::string& name);
+};
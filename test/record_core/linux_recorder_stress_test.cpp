@@ -0,0 +1,128 @@
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+
+using record_core_test::FakeCapture;
+using record_core_test::FrameValue;
+using record_core_test::PcmConfig;
+using record_core_test::RecordingListener;
+using record_core_test::RunMainThreadUntil;
+using record_linux::Recorder;
+
+// Capture thread pushes as fast as it can through the capture ring and the
+// stream queue, while the main thread drains and acknowledges. Meant to
+// run under ThreadSanitizer too (RECORD_CORE_TSAN).
+namespace
+{
+	constexpr size_t kChunks = 5000;
+	// Not a divisor of the FrameValue period, so gaps of dropped chunks are
+	// told apart (up to 10000 chunks).
+	constexpr size_t kChunkFrames = 441;
+	constexpr size_t kChannels = 2;
+	constexpr int64_t kValuePeriod = 30000;
+
+	struct StreamCheck
+	{
+		size_t frames = 0;
+		bool torn = false;
+		// Gaps between received chunks, in chunks.
+		std::vector<int64_t> gaps;
+		int64_t nextValue = 0;
+
+		void Add(const std::vector<uint8_t>& data)
+		{
+			const size_t count = data.size() / sizeof(int16_t);
+			std::vector<int16_t> samples(count);
+			std::memcpy(samples.data(), data.data(), count * sizeof(int16_t));
+
+			if (count != kChunkFrames * kChannels)
+			{
+				torn = true;
+				return;
+			}
+
+			// Whole chunk of consecutive frames, same value on each channel.
+			for (size_t i = 0; i < count; i++)
+			{
+				const int64_t expected = (samples[0] + static_cast<int64_t>(i / kChannels)) % kValuePeriod;
+				torn = torn || samples[i] != expected;
+			}
+
+			int64_t gap = 0;
+			while (gap <= static_cast<int64_t>(kChunks)
+				&& (nextValue + gap * static_cast<int64_t>(kChunkFrames)) % kValuePeriod != samples[0])
+			{
+				gap++;
+			}
+			gaps.push_back(gap);
+
+			frames += kChunkFrames;
+			nextValue = (samples[0] + static_cast<int64_t>(kChunkFrames)) % kValuePeriod;
+		}
+	};
+}
+
+RECORD_TEST(FastCaptureKeepsOrderAndAccountsForDrops)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	StreamCheck check;
+	listener->onStreamData = [&check](const std::vector<uint8_t>& data) { check.Add(data); };
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+	auto captures = FakeCapture::Instances();
+	CHECK(captures.size() == 1);
+	if (captures.size() != 1) return;
+
+	FakeCapture* capture = captures[0];
+	std::atomic<bool> fed{ false };
+
+	std::thread captureThread([&]() {
+		for (size_t i = 0; i < kChunks; i++)
+		{
+			capture->Feed(kChunkFrames);
+			// Interleaves with the other threads on few cores, so the rings
+			// are not only full.
+			if (i % 4 == 0) std::this_thread::yield();
+		}
+		fed = true;
+	});
+
+	size_t acknowledged = 0;
+	while (!fed)
+	{
+		RunMainThreadUntil([&]() { return listener->chunks != acknowledged || fed; }, std::chrono::milliseconds(50));
+		recorder->AcknowledgeStream(listener->chunks - acknowledged);
+		acknowledged = listener->chunks;
+	}
+	captureThread.join();
+
+	// Stop drains what is left.
+	recorder->Stop();
+
+	const auto stats = recorder->GetStreamStats();
+	const size_t chunkBytes = kChunkFrames * kChannels * sizeof(int16_t);
+
+	CHECK(!check.torn);
+	CHECK(check.frames + stats.droppedBytes / chunkBytes * kChunkFrames == kChunks * kChunkFrames);
+	CHECK(stats.droppedBytes % chunkBytes == 0);
+	CHECK(listener->chunks + stats.droppedChunks == kChunks);
+
+	int64_t missing = 0;
+	for (int64_t gap : check.gaps) missing += gap;
+	// Chunks dropped after the last received one are not gaps.
+	CHECK(missing <= static_cast<int64_t>(stats.droppedChunks));
+
+	std::printf("received %zu chunks, dropped %llu\n", listener->chunks,
+		static_cast<unsigned long long>(stats.droppedChunks));
+}
+
+RECORD_TEST_MAIN()
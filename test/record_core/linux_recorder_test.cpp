@@ -0,0 +1,492 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+
+using record_core_test::FakeCapture;
+using record_core_test::FrameValue;
+using record_core_test::PcmConfig;
+using record_core_test::RecordingListener;
+using record_core_test::RunMainThreadTasks;
+using record_core_test::RunMainThreadUntil;
+using record_core_test::WaitUntil;
+using record_linux::RecordState;
+using record_linux::Recorder;
+
+namespace
+{
+	// 10ms at 44.1kHz.
+	constexpr size_t kChunkFrames = 441;
+	constexpr size_t kChannels = 2;
+
+	FakeCapture* OnlyCapture()
+	{
+		auto captures = FakeCapture::Instances();
+		return captures.size() == 1 ? captures[0] : nullptr;
+	}
+
+	// Streamed frames hold the values of consecutive capture positions,
+	// from start, on each channel.
+	bool StreamedInOrder(const RecordingListener& listener, int64_t start)
+	{
+		for (size_t i = 0; i < listener.samples.size(); i++)
+		{
+			if (listener.samples[i] != FrameValue(start + static_cast<int64_t>(i / kChannels)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+RECORD_TEST(StreamDeliversCapturedFramesInOrder)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+	CHECK(recorder->IsRecording());
+
+	FakeCapture* capture = OnlyCapture();
+	CHECK(capture != nullptr);
+	if (!capture) return;
+
+	for (int i = 0; i < 20; i++) CHECK(capture->Feed(kChunkFrames));
+
+	CHECK(RunMainThreadUntil([&]() { return listener->samples.size() == 20 * kChunkFrames * kChannels; }));
+	CHECK(StreamedInOrder(*listener, 0));
+
+	CHECK(recorder->Stop().empty());
+	CHECK(FakeCapture::Instances().empty());
+	CHECK(listener->streamEnds == 1);
+	CHECK((listener->states == std::vector<RecordState>{ RecordState::kRecord, RecordState::kStop }));
+}
+
+RECORD_TEST(StreamChunksHoldBufferSize)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	// 1000 frames per chunk.
+	auto config = PcmConfig();
+	config.stream_buffer_size = 1000 * kChannels * sizeof(int16_t);
+
+	std::vector<size_t> sizes;
+	listener->onStreamData = [&sizes](const std::vector<uint8_t>& data) { sizes.push_back(data.size()); };
+
+	std::string error;
+	CHECK(recorder->StartStream(config, &error));
+	recorder->SetStreamListening(true);
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	for (int i = 0; i < 10; i++) capture->Feed(kChunkFrames);
+	CHECK(RunMainThreadUntil([&]() { return listener->chunks == 4; }));
+
+	// Remaining 410 frames are sent on stop.
+	recorder->Stop();
+	CHECK((sizes == std::vector<size_t>{ 4000, 4000, 4000, 4000, 1640 }));
+	CHECK(StreamedInOrder(*listener, 0));
+}
+
+RECORD_TEST(StreamMaxDelaySendsIncompleteChunks)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	// Chunks of 10s, never completed.
+	auto config = PcmConfig();
+	config.stream_buffer_size = 441000 * kChannels * sizeof(int16_t);
+	config.stream_max_delay_ms = 5;
+
+	std::string error;
+	CHECK(recorder->StartStream(config, &error));
+	recorder->SetStreamListening(true);
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	// Pending data is sent once it waited long enough, when more is
+	// captured.
+	int fed = 0;
+	while (listener->chunks == 0 && fed < 100)
+	{
+		capture->Feed(kChunkFrames);
+		fed++;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		RunMainThreadTasks();
+	}
+	CHECK(listener->chunks > 0);
+	CHECK(fed >= 2);
+	CHECK(listener->samples.size() % (kChunkFrames * kChannels) == 0);
+	CHECK(StreamedInOrder(*listener, 0));
+
+	recorder->Stop();
+}
+
+RECORD_TEST(StreamWaitsForAcknowledgements)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	// Batches fit in the capture ring, nothing is dropped.
+	for (size_t batch = 1; batch <= 2; batch++)
+	{
+		for (int i = 0; i < 30; i++) capture->Feed(kChunkFrames);
+		CHECK(RunMainThreadUntil([&]() { return listener->chunks == 30 * batch; }));
+	}
+
+	// Credit is exhausted after 4 more, the others wait in the queue and
+	// don't wake the main thread anymore.
+	for (int i = 0; i < 10; i++) capture->Feed(kChunkFrames);
+	CHECK(WaitUntil([&]() { return recorder->GetStreamStats().queuedChunks == 10; }));
+	RunMainThreadTasks();
+	CHECK(listener->chunks == record_core::kStreamCredit);
+	CHECK(recorder->GetStreamStats().queuedChunks == 6);
+
+	// Acknowledging drains again, and later data flows.
+	recorder->AcknowledgeStream(record_core::kStreamCredit);
+	CHECK(listener->chunks == 70);
+	capture->Feed(kChunkFrames);
+	CHECK(RunMainThreadUntil([&]() { return listener->chunks == 71; }));
+	CHECK(StreamedInOrder(*listener, 0));
+	CHECK(recorder->GetStreamStats().droppedChunks == 0);
+
+	recorder->Stop();
+}
+
+RECORD_TEST(StreamIsHeldUntilListening)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	// More than a batch of acknowledgements is captured before the listener
+	// comes, it waits in the queue without using credit.
+	for (size_t batch = 1; batch <= 2; batch++)
+	{
+		for (int i = 0; i < 20; i++) capture->Feed(kChunkFrames);
+		CHECK(WaitUntil([&]() { return recorder->GetStreamStats().queuedChunks == 20 * batch; }));
+	}
+	RunMainThreadTasks();
+	CHECK(listener->chunks == 0);
+
+	recorder->SetStreamListening(true);
+	CHECK(listener->chunks == 40);
+
+	// Acknowledged by 32 as Dart does, data keeps flowing.
+	size_t acknowledged = 0;
+	for (size_t batch = 3; batch <= 8; batch++)
+	{
+		for (int i = 0; i < 20; i++) capture->Feed(kChunkFrames);
+		CHECK(RunMainThreadUntil([&]() {
+			while (listener->chunks - acknowledged >= 32)
+			{
+				acknowledged += 32;
+				recorder->AcknowledgeStream(32);
+			}
+			return listener->chunks == 20 * batch;
+		}));
+	}
+	CHECK(StreamedInOrder(*listener, 0));
+	CHECK(recorder->GetStreamStats().droppedChunks == 0);
+
+	recorder->Stop();
+}
+
+RECORD_TEST(StopWithoutListenerDropsStreamData)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	for (int i = 0; i < 5; i++) capture->Feed(kChunkFrames);
+	recorder->Stop();
+	RunMainThreadTasks();
+
+	CHECK(listener->chunks == 0);
+	CHECK(listener->streamEnds == 1);
+	CHECK(recorder->GetStreamStats().droppedChunks == 5);
+
+	// Listening ended with the stream, the next one starts clean.
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	capture = OnlyCapture();
+	if (!capture) return;
+	capture->Feed(kChunkFrames);
+	CHECK(WaitUntil([&]() { return recorder->GetStreamStats().queuedChunks == 1; }));
+	RunMainThreadTasks();
+	CHECK(listener->chunks == 0);
+
+	recorder->SetStreamListening(true);
+	CHECK(listener->chunks == 1);
+	CHECK(StreamedInOrder(*listener, 0));
+
+	recorder->Stop();
+}
+
+RECORD_TEST(ZeroCopyStreamSharesChunks)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	auto config = PcmConfig();
+	config.zero_copy_stream = true;
+
+	std::string error;
+	CHECK(recorder->StartStream(config, &error));
+	recorder->SetStreamListening(true);
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	// Reference kept by the consumer, as Dart does.
+	record_core::PcmRing* ring = recorder->GetPcmRing();
+	CHECK(ring != nullptr);
+	if (!ring) return;
+	CHECK(ring->Capacity() >= 44100 * 4 * 2);
+
+	for (int i = 0; i < 5; i++) capture->Feed(kChunkFrames);
+	CHECK(RunMainThreadUntil([&]() { return listener->sharedChunks.size() == 5; }));
+	CHECK(listener->chunks == 0);
+
+	bool sameFrames = true;
+	int64_t frame = 0;
+	for (const auto& chunk : listener->sharedChunks)
+	{
+		CHECK(ring->IsValid(chunk));
+		const auto* samples = reinterpret_cast<const int16_t*>(ring->Data() + chunk.position % ring->Capacity());
+		for (size_t i = 0; i < chunk.length / sizeof(int16_t); i++)
+		{
+			sameFrames = sameFrames && samples[i] == FrameValue(frame + static_cast<int64_t>(i / kChannels));
+		}
+		frame += static_cast<int64_t>(chunk.length / (kChannels * sizeof(int16_t)));
+	}
+	CHECK(sameFrames);
+	CHECK(frame == 5 * static_cast<int64_t>(kChunkFrames));
+
+	recorder->Stop();
+	CHECK(recorder->GetPcmRing() == nullptr);
+
+	// Data stays readable until the consumer releases it.
+	CHECK(ring->IsValid(listener->sharedChunks.front()));
+	ring->Release();
+}
+
+RECORD_TEST(StopSendsRemainingDataBeforeStreamEnd)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	size_t samplesAtEnd = 0;
+	listener->onStreamData = [&](const std::vector<uint8_t>&) { samplesAtEnd = listener->samples.size(); };
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	for (int i = 0; i < 5; i++) capture->Feed(kChunkFrames);
+	recorder->Stop();
+
+	// Processing thread handled all captured frames before Stop returned.
+	CHECK(listener->samples.size() == 5 * kChunkFrames * kChannels);
+	CHECK(samplesAtEnd == listener->samples.size());
+	CHECK(listener->streamEnds == 1);
+}
+
+RECORD_TEST(CaptureErrorStopsRecorder)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	std::string error;
+	CHECK(recorder->StartStream(PcmConfig(), &error));
+	recorder->SetStreamListening(true);
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	capture->Fail("Server gone.");
+	CHECK(RunMainThreadUntil([&]() { return !listener->errors.empty(); }));
+
+	CHECK(listener->errors == std::vector<std::string>{ "Server gone." });
+	CHECK(!recorder->IsRecording());
+	CHECK(FakeCapture::Instances().empty());
+	CHECK(listener->streamEnds == 1);
+	CHECK(listener->states.back() == RecordState::kStop);
+}
+
+RECORD_TEST(CaptureOpenFailureIsReported)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	FakeCapture::FailNextOpen("No such source.");
+
+	std::string error;
+	CHECK(!recorder->StartStream(PcmConfig(), &error));
+	CHECK(error == "No such source.");
+	CHECK(!recorder->IsRecording());
+	CHECK(FakeCapture::Instances().empty());
+	CHECK(listener->states.empty());
+}
+
+RECORD_TEST(StreamRejectsEncoders)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	auto config = PcmConfig();
+	config.encoder = "wav";
+
+	std::string error;
+	CHECK(!recorder->StartStream(config, &error));
+	CHECK(error == "Encoder wav is not supported for streams.");
+	CHECK(FakeCapture::Instances().empty());
+}
+
+RECORD_TEST(PacketStreamSendsEncodedPackets)
+{
+	using record_core_test::FakePacketEncoder;
+
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	// Packets keep their own bytes, the ring is not used.
+	auto config = PcmConfig();
+	config.encoder = "aacLc";
+	config.zero_copy_stream = true;
+
+	std::string error;
+	CHECK(recorder->StartStream(config, &error));
+	recorder->SetStreamListening(true);
+	CHECK(recorder->GetCodecConfig() == FakePacketEncoder::Config());
+	CHECK(recorder->GetPcmRing() == nullptr);
+
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	// 3 whole packets, the last one is completed on stop.
+	const size_t frames = 3 * FakePacketEncoder::kFramesPerPacket + 100;
+	for (size_t fed = 0; fed < frames; fed += kChunkFrames)
+	{
+		capture->Feed(std::min(kChunkFrames, frames - fed));
+	}
+	CHECK(RunMainThreadUntil([&]() { return listener->packets.size() == 3; }));
+
+	CHECK(recorder->Stop().empty());
+	CHECK(listener->packets.size() == 4);
+	CHECK(listener->chunks == 0);
+	CHECK(listener->streamEnds == 1);
+
+	int64_t position = 0;
+	for (const auto& packet : listener->packets)
+	{
+		const int64_t packetFrames = static_cast<int64_t>(packet.data.size() / (kChannels * sizeof(int16_t)));
+		CHECK(packet.info.timestampUs == position * 1000000 / 44100);
+		CHECK(packet.info.durationUs == packetFrames * 1000000 / 44100);
+
+		for (int64_t i = 0; i < packetFrames * static_cast<int64_t>(kChannels); i++)
+		{
+			int16_t sample;
+			std::memcpy(&sample, packet.data.data() + i * sizeof(int16_t), sizeof(sample));
+			CHECK(sample == FrameValue(position + i / static_cast<int64_t>(kChannels)));
+		}
+		position += packetFrames;
+	}
+	CHECK(position == static_cast<int64_t>(frames));
+}
+
+RECORD_TEST(PacketsAreHeldUntilListening)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	auto config = PcmConfig();
+	config.encoder = "aacLc";
+
+	std::string error;
+	CHECK(recorder->StartStream(config, &error));
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	// 10 packets.
+	for (int i = 0; i < 10 * 1024 / 256; i++) capture->Feed(256);
+	CHECK(WaitUntil([&]() { return recorder->GetStreamStats().queuedChunks == 10; }));
+	RunMainThreadTasks();
+	CHECK(listener->packets.empty());
+
+	recorder->SetStreamListening(true);
+	CHECK(listener->packets.size() == 10);
+
+	recorder->Stop();
+	CHECK(recorder->GetStreamStats().droppedChunks == 0);
+}
+
+RECORD_TEST(UnknownStreamEncoderIsRejected)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	auto config = PcmConfig();
+	config.encoder = "amrNb";
+
+	std::string error;
+	CHECK(!recorder->StartStream(config, &error));
+	CHECK(error == "Encoder amrNb is not supported.");
+	CHECK(FakeCapture::Instances().empty());
+}
+
+RECORD_TEST(MetersFollowCapturedFrames)
+{
+	auto listener = std::make_shared<RecordingListener>();
+	auto recorder = Recorder::Create("1", listener);
+
+	auto config = PcmConfig();
+	config.envelope_interval_ms = 10;
+
+	std::string error;
+	CHECK(recorder->StartStream(config, &error));
+	recorder->SetStreamListening(true);
+	FakeCapture* capture = OnlyCapture();
+	if (!capture) return;
+
+	for (int i = 0; i < 10; i++) capture->Feed(kChunkFrames);
+
+	// Meters are updated before data is streamed.
+	CHECK(RunMainThreadUntil([&]() { return listener->samples.size() == 10 * kChunkFrames * kChannels; }));
+
+	const double peak = 20.0 * std::log10(FrameValue(10 * kChunkFrames - 1) / 32768.0);
+	auto meters = recorder->GetMeters();
+	CHECK(meters.numChannels == 2);
+	CHECK_NEAR(meters.max, peak, 0.1);
+	CHECK_NEAR(meters.channels[1].peak, peak, 0.1);
+	CHECK(listener->envelopeBuckets == 10);
+
+	recorder->Stop();
+	CHECK(recorder->GetMeters().max <= record_core::kMinDbfs);
+}
+
+RECORD_TEST_MAIN()
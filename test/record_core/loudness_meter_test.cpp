@@ -0,0 +1,144 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "check.h"
+#include "loudness_meter.h"
+
+using record_core::LoudnessLevels;
+using record_core::LoudnessMeter;
+
+namespace
+{
+	constexpr double kPi = 3.14159265358979323846;
+	constexpr int kSampleRate = 48000;
+	// Tolerance of EBU Tech 3341 and 3342 compliance tests.
+	constexpr double kLufsTolerance = 0.1;
+	constexpr double kLraTolerance = 1.0;
+
+	struct Segment
+	{
+		// Peak level of the 1 kHz sine in dBFS, on both channels.
+		double levelDbfs;
+		int seconds;
+	};
+
+	// Feeds stereo 1 kHz sine segments by 100ms blocks, the phase continues
+	// across segments.
+	LoudnessLevels Measure(LoudnessMeter& meter, const std::vector<Segment>& segments)
+	{
+		const size_t blockFrames = kSampleRate / 10;
+		std::vector<int16_t> block(blockFrames * 2);
+		size_t frame = 0;
+
+		for (const auto& segment : segments)
+		{
+			const double amplitude = std::pow(10.0, segment.levelDbfs / 20.0) * 32768.0;
+
+			for (int b = 0; b < segment.seconds * 10; b++)
+			{
+				for (size_t i = 0; i < blockFrames; i++, frame++)
+				{
+					const auto value = static_cast<int16_t>(std::lround(amplitude * std::sin(2.0 * kPi * 1000.0 * frame / kSampleRate)));
+					block[i * 2] = value;
+					block[i * 2 + 1] = value;
+				}
+				meter.Process(block.data(), blockFrames);
+			}
+		}
+
+		return meter.GetLevels();
+	}
+
+	LoudnessLevels Measure(const std::vector<Segment>& segments)
+	{
+		LoudnessMeter meter;
+		meter.Configure(kSampleRate, 2);
+		return Measure(meter, segments);
+	}
+}
+
+// EBU Tech 3341 test case 1.
+RECORD_TEST(SineAtMinus23DbfsIsMinus23Lufs)
+{
+	const auto levels = Measure({ { -23.0, 20 } });
+	CHECK_NEAR(levels.momentary, -23.0, kLufsTolerance);
+	CHECK_NEAR(levels.shortTerm, -23.0, kLufsTolerance);
+	CHECK_NEAR(levels.integrated, -23.0, kLufsTolerance);
+}
+
+// EBU Tech 3341 test case 2.
+RECORD_TEST(SineAtMinus33DbfsIsMinus33Lufs)
+{
+	const auto levels = Measure({ { -33.0, 20 } });
+	CHECK_NEAR(levels.momentary, -33.0, kLufsTolerance);
+	CHECK_NEAR(levels.shortTerm, -33.0, kLufsTolerance);
+	CHECK_NEAR(levels.integrated, -33.0, kLufsTolerance);
+}
+
+// EBU Tech 3341 test case 3, quiet parts are under the relative gate.
+RECORD_TEST(RelativeGateIgnoresQuietParts)
+{
+	const auto levels = Measure({ { -36.0, 10 }, { -23.0, 60 }, { -36.0, 10 } });
+	CHECK_NEAR(levels.integrated, -23.0, kLufsTolerance);
+}
+
+// EBU Tech 3341 test case 4, silent parts are under the absolute gate.
+RECORD_TEST(AbsoluteGateIgnoresSilence)
+{
+	const auto levels = Measure({ { -72.0, 10 }, { -36.0, 10 }, { -23.0, 60 }, { -36.0, 10 }, { -72.0, 10 } });
+	CHECK_NEAR(levels.integrated, -23.0, kLufsTolerance);
+}
+
+// EBU Tech 3342 test case 1.
+RECORD_TEST(LoudnessRangeOf10Lu)
+{
+	const auto levels = Measure({ { -20.0, 20 }, { -30.0, 20 } });
+	CHECK_NEAR(levels.range, 10.0, kLraTolerance);
+}
+
+// EBU Tech 3342 test case 2.
+RECORD_TEST(LoudnessRangeOf5Lu)
+{
+	const auto levels = Measure({ { -20.0, 20 }, { -15.0, 20 } });
+	CHECK_NEAR(levels.range, 5.0, kLraTolerance);
+}
+
+RECORD_TEST(MomentaryFollowsTheLast400ms)
+{
+	LoudnessMeter meter;
+	meter.Configure(kSampleRate, 2);
+
+	// Short-term still holds part of the loud second.
+	const auto levels = Measure(meter, { { -20.0, 3 }, { -40.0, 1 } });
+	CHECK_NEAR(levels.momentary, -40.0, kLufsTolerance);
+	CHECK(levels.shortTerm > -30.0);
+}
+
+RECORD_TEST(SilenceIsFloor)
+{
+	LoudnessMeter meter;
+	meter.Configure(kSampleRate, 2);
+
+	const std::vector<int16_t> silence(kSampleRate * 2, 0);
+	meter.Process(silence.data(), kSampleRate);
+
+	const auto levels = meter.GetLevels();
+	CHECK_NEAR(levels.momentary, record_core::kMinLufs, 0.0);
+	CHECK_NEAR(levels.integrated, record_core::kMinLufs, 0.0);
+	CHECK_NEAR(levels.range, 0.0, 0.0);
+}
+
+RECORD_TEST(ResetStartsANewMeasurement)
+{
+	LoudnessMeter meter;
+	meter.Configure(kSampleRate, 2);
+
+	Measure(meter, { { -20.0, 5 } });
+	meter.Reset();
+
+	const auto levels = Measure(meter, { { -30.0, 5 } });
+	CHECK_NEAR(levels.integrated, -30.0, kLufsTolerance);
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,178 @@
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "main_thread_dispatcher.h"
+
+using record_core::MainThreadDispatcher;
+using record_core::MainThreadTask;
+
+namespace
+{
+	constexpr int kPosters = 4;
+	constexpr int kTasksPerPoster = 20000;
+
+	// Adapter waking a test loop instead of a platform one.
+	struct Wakeups
+	{
+		std::mutex mutex;
+		std::condition_variable condition;
+		int count = 0;
+		bool pending = false;
+
+		static void Wake(void* context)
+		{
+			auto* self = static_cast<Wakeups*>(context);
+			{
+				std::lock_guard<std::mutex> lock(self->mutex);
+				self->count++;
+				self->pending = true;
+			}
+			self->condition.notify_one();
+		}
+
+		// Returns false on timeout.
+		bool Wait()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			const bool woken = condition.wait_for(lock, std::chrono::seconds(10), [this]() { return pending; });
+			pending = false;
+			return woken;
+		}
+	};
+}
+
+RECORD_TEST(InlineAndAllocatedTasksAreDestroyed)
+{
+	auto resource = std::make_shared<int>(0);
+
+	{
+		// Fits inline.
+		MainThreadTask small([resource]() { (*resource)++; });
+		// Too big to fit inline.
+		std::array<char, MainThreadTask::kInlineSize * 2> padding{};
+		MainThreadTask big([resource, padding]() { *resource += 10 + padding[0]; });
+		CHECK(resource.use_count() == 3);
+
+		MainThreadTask moved(std::move(big));
+		CHECK(!big);
+		small();
+		moved();
+		CHECK(*resource == 11);
+
+		moved = std::move(small);
+		CHECK(resource.use_count() == 2);
+	}
+
+	CHECK(resource.use_count() == 1);
+}
+
+RECORD_TEST(TasksRunInOrderOnDrain)
+{
+	Wakeups wakeups;
+	MainThreadDispatcher dispatcher;
+	dispatcher.SetWakeup(Wakeups::Wake, &wakeups);
+
+	std::vector<int> order;
+	for (int i = 0; i < 5; i++)
+	{
+		dispatcher.Post([&order, i]() { order.push_back(i); });
+	}
+	CHECK(order.empty());
+	// Wakeups are coalesced until drained.
+	CHECK(wakeups.count == 1);
+
+	CHECK(dispatcher.Drain() == 5);
+	CHECK((order == std::vector<int>{ 0, 1, 2, 3, 4 }));
+
+	dispatcher.Post([]() {});
+	CHECK(wakeups.count == 2);
+	dispatcher.Drain();
+}
+
+RECORD_TEST(TasksPostedByTasksRunInTheSameDrain)
+{
+	MainThreadDispatcher dispatcher;
+	int runs = 0;
+
+	dispatcher.Post([&]() {
+		runs++;
+		dispatcher.Post([&runs]() { runs++; });
+	});
+
+	CHECK(dispatcher.Drain() == 2);
+	CHECK(runs == 2);
+	CHECK(dispatcher.Drain() == 0);
+}
+
+RECORD_TEST(StatsCountTasksAndWakeups)
+{
+	MainThreadDispatcher dispatcher;
+	for (int i = 0; i < 3; i++)
+	{
+		dispatcher.Post([]() {});
+	}
+	CHECK(dispatcher.Stats().queueDepth == 3);
+
+	dispatcher.Drain();
+	const auto stats = dispatcher.Stats();
+	CHECK(stats.queueDepth == 0);
+	CHECK(stats.maxQueueDepth == 3);
+	CHECK(stats.tasksRun == 3);
+	CHECK(stats.wakeups == 1);
+	CHECK(stats.meanLatencyUs <= stats.maxLatencyUs);
+}
+
+RECORD_TEST(ConcurrentPostersKeepTheirOrder)
+{
+	Wakeups wakeups;
+	MainThreadDispatcher dispatcher;
+	dispatcher.SetWakeup(Wakeups::Wake, &wakeups);
+
+	// Only touched by tasks, on this thread.
+	std::array<int, kPosters> next{};
+	int errors = 0;
+	int runs = 0;
+
+	std::vector<std::thread> posters;
+	for (int p = 0; p < kPosters; p++)
+	{
+		posters.emplace_back([&, p]() {
+			for (int i = 0; i < kTasksPerPoster; i++)
+			{
+				dispatcher.Post([&, p, i]() {
+					if (next[p] != i) errors++;
+					next[p] = i + 1;
+					runs++;
+				});
+			}
+		});
+	}
+
+	while (runs < kPosters * kTasksPerPoster)
+	{
+		if (!wakeups.Wait())
+		{
+			break;
+		}
+		dispatcher.Drain();
+	}
+
+	for (auto& poster : posters)
+	{
+		poster.join();
+	}
+
+	CHECK(errors == 0);
+	CHECK(runs == kPosters * kTasksPerPoster);
+	// Each wakeup drained a batch of tasks.
+	CHECK(wakeups.count <= runs);
+	std::printf("%d tasks run by %d wakeups\n", runs, wakeups.count);
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,220 @@
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "linux_recorder_harness.h"
+
+using record_core_test::FakeCapture;
+using record_core_test::PcmConfig;
+using record_core_test::RunMainThreadTasks;
+using record_linux::Recorder;
+
+// Runs N recorders streaming at once, captures fed in real time by 10ms
+// periods, and reports the CPU time and memory of the process per
+// recorder. RECORD_BENCHMARK_RECORDERS sets the recorder counts, as a
+// comma separated list, RECORD_BENCHMARK_SECONDS the duration of each run.
+namespace
+{
+	// 10ms at 44.1kHz.
+	constexpr size_t kPeriodFrames = 441;
+	constexpr size_t kFrameBytes = 4;
+
+	std::vector<size_t> RecorderCounts()
+	{
+		const char* value = std::getenv("RECORD_BENCHMARK_RECORDERS");
+		std::string list = value ? value : "1,8,32";
+
+		std::vector<size_t> counts;
+		char* end = &list[0];
+		while (*end != '\0')
+		{
+			const size_t count = std::strtoul(end, &end, 10);
+			if (count > 0) counts.push_back(count);
+			if (*end == ',') end++;
+			else if (*end != '\0') break;
+		}
+		return counts;
+	}
+
+	double Seconds()
+	{
+		const char* value = std::getenv("RECORD_BENCHMARK_SECONDS");
+		return value ? std::strtod(value, nullptr) : 1.0;
+	}
+
+	double CpuSeconds()
+	{
+		rusage usage = {};
+		getrusage(RUSAGE_SELF, &usage);
+		return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+	}
+
+	// Resident set size in bytes.
+	size_t ResidentBytes()
+	{
+		FILE* statm = std::fopen("/proc/self/statm", "r");
+		if (!statm) return 0;
+
+		unsigned long size = 0, resident = 0;
+		const int read = std::fscanf(statm, "%lu %lu", &size, &resident);
+		std::fclose(statm);
+
+		return read == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+	}
+
+	// Counts streamed bytes without keeping them.
+	class CountingListener : public record_linux::RecorderListener
+	{
+	public:
+		void OnStateChanged(record_linux::RecordState) override {}
+		void OnStreamData(const std::vector<uint8_t>& data) override
+		{
+			bytes += data.size();
+			chunks++;
+		}
+		void OnSharedStreamData(const record_core::PcmRingChunk&) override {}
+		void OnStreamPacket(const std::vector<uint8_t>&, const record_core::StreamPacketInfo&) override {}
+		void OnEnvelope(const std::vector<float>&) override {}
+		void OnSpectrum(const std::vector<float>&) override {}
+		void OnVoiceActivity(bool) override {}
+		void OnStreamEnd() override {}
+		void OnError(const std::string&) override {}
+
+		size_t bytes = 0;
+		size_t chunks = 0;
+	};
+
+	struct BenchRecorder
+	{
+		std::shared_ptr<CountingListener> listener = std::make_shared<CountingListener>();
+		std::shared_ptr<Recorder> recorder;
+		FakeCapture* capture = nullptr;
+		size_t acknowledged = 0;
+	};
+
+	struct Result
+	{
+		double cpuSeconds = 0;
+		double wallSeconds = 0;
+		size_t residentBytes = 0;
+		uint64_t droppedBytes = 0;
+		bool complete = true;
+	};
+
+	Result Run(size_t count, double seconds)
+	{
+		Result result;
+		const size_t residentBefore = ResidentBytes();
+
+		// Metering, envelope and stream, as a recording screen would.
+		auto config = PcmConfig();
+		config.envelope_interval_ms = 50;
+
+		std::vector<BenchRecorder> recorders(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			auto& bench = recorders[i];
+			bench.recorder = Recorder::Create(std::to_string(i), bench.listener);
+
+			std::string error;
+			if (!bench.recorder->StartStream(config, &error))
+			{
+				std::printf("start failed: %s\n", error.c_str());
+				result.complete = false;
+				return result;
+			}
+			bench.recorder->SetStreamListening(true);
+			bench.capture = FakeCapture::Instances().back();
+		}
+
+		const size_t periods = static_cast<size_t>(seconds * 100);
+		const double cpuStart = CpuSeconds();
+		const auto start = std::chrono::steady_clock::now();
+
+		// Capture thread of all recorders, as the sound server's thread.
+		std::thread feeder([&]() {
+			auto next = start;
+			for (size_t period = 0; period < periods; period++)
+			{
+				for (auto& bench : recorders) bench.capture->Feed(kPeriodFrames);
+				next += std::chrono::milliseconds(10);
+				std::this_thread::sleep_until(next);
+			}
+		});
+
+		// Main thread, acknowledging as Dart does, until the recorders caught
+		// up with the capture, or a second after it when overloaded.
+		const size_t total = periods * kPeriodFrames * kFrameBytes;
+		const auto end = start + std::chrono::milliseconds(static_cast<int64_t>(periods * 10));
+		const auto deadline = end + std::chrono::seconds(1);
+		for (;;)
+		{
+			RunMainThreadTasks();
+			bool received = true;
+			for (auto& bench : recorders)
+			{
+				while (bench.listener->chunks - bench.acknowledged >= 32)
+				{
+					bench.acknowledged += 32;
+					bench.recorder->AcknowledgeStream(32);
+				}
+				received = received && bench.listener->bytes >= total;
+			}
+
+			const auto now = std::chrono::steady_clock::now();
+			if ((now >= end && received) || now >= deadline) break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		feeder.join();
+
+		const size_t resident = ResidentBytes();
+		result.residentBytes = resident - std::min(residentBefore, resident);
+
+		for (auto& bench : recorders)
+		{
+			bench.recorder->Stop();
+
+			// Overloaded recorders drop capture data, every byte is accounted for.
+			const uint64_t dropped = bench.recorder->GetStreamStats().droppedBytes;
+			result.droppedBytes += dropped;
+			result.complete = result.complete && bench.listener->bytes + dropped == total;
+		}
+
+		result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		result.cpuSeconds = CpuSeconds() - cpuStart;
+		return result;
+	}
+}
+
+RECORD_TEST(RecordersScale)
+{
+	const double seconds = Seconds();
+
+	std::printf("%9s %12s %14s %14s %12s\n", "recorders", "cpu %", "cpu %/rec", "rss KB/rec", "dropped KB");
+	for (size_t count : RecorderCounts())
+	{
+		const auto result = Run(count, seconds);
+		CHECK(result.complete);
+
+		// CPU in percent of one core.
+		const double cpu = result.cpuSeconds / result.wallSeconds * 100;
+		std::printf("%9zu %12.2f %14.3f %14.1f %12.1f\n", count, cpu, cpu / count, result.residentBytes / 1024.0 / count, result.droppedBytes / 1024.0);
+	}
+
+	rusage usage = {};
+	getrusage(RUSAGE_SELF, &usage);
+	std::printf("max rss %ld KB\n", usage.ru_maxrss);
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,142 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "check.h"
+#include "pcm_meter.h"
+
+using record_core::PcmLevels;
+
+// Compares the SIMD metering kernels with the scalar one, and with the
+// previous Windows metering of a chunk (GetAmplitude after
+// convertBytesToInt16, one vector allocated per chunk).
+namespace
+{
+	// 10ms of stereo at 48kHz.
+	constexpr size_t kChunkSamples = 960;
+	constexpr size_t kChunks = 64;
+
+	typedef void (*Kernel)(const int16_t*, size_t, PcmLevels&);
+
+	size_t ChunkCount()
+	{
+		const char* count = std::getenv("RECORD_BENCHMARK_CHUNKS");
+		return count ? std::strtoul(count, nullptr, 10) : 200000;
+	}
+
+	double Seconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Previous Windows path, as it was (the vector is twice the needed size
+	// and the first half is zeros).
+	std::vector<int16_t> ConvertBytesToInt16(const uint8_t* bytes, size_t size)
+	{
+		std::vector<int16_t> values(size / 2);
+		for (size_t i = 0; i < size; i += 2)
+		{
+			values.push_back(int16_t(bytes[i] << 0 | bytes[i + 1] << 8));
+		}
+		return values;
+	}
+
+	double PreviousAmplitude(const uint8_t* chunk, size_t size)
+	{
+		int maxSample = -160;
+		auto values = ConvertBytesToInt16(chunk, size);
+
+		for (size_t i = 0; i < size; i++)
+		{
+			const int curSample = std::abs(values[i]);
+			if (curSample > maxSample)
+			{
+				maxSample = curSample;
+			}
+		}
+
+		return 20 * std::log10(maxSample / 32767.0);
+	}
+
+	std::vector<int16_t> Samples()
+	{
+		std::vector<int16_t> samples(kChunkSamples * kChunks);
+		uint32_t noise = 1;
+		for (auto& sample : samples)
+		{
+			noise = noise * 1664525u + 1013904223u;
+			sample = static_cast<int16_t>(noise >> 16);
+		}
+		return samples;
+	}
+
+	void Report(const char* name, double seconds, size_t chunks, double scalarSeconds)
+	{
+		const double bytes = static_cast<double>(chunks) * kChunkSamples * sizeof(int16_t);
+		std::printf("%-10s %8.1f ns/chunk %8.2f GB/s %6.2fx scalar\n", name, seconds * 1e9 / chunks, bytes / seconds / 1e9, scalarSeconds / seconds);
+	}
+
+	double Run(Kernel kernel, const std::vector<int16_t>& samples, size_t chunks, PcmLevels& levels)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < chunks; i++)
+		{
+			kernel(&samples[(i % kChunks) * kChunkSamples], kChunkSamples, levels);
+		}
+		return Seconds(start);
+	}
+}
+
+RECORD_TEST(KernelsVersusScalar)
+{
+	const size_t chunks = ChunkCount();
+	const auto samples = Samples();
+
+	PcmLevels scalar;
+	const double scalarSeconds = Run(record_core::MeasurePcm16Scalar, samples, chunks, scalar);
+
+	double previousPeak = -160.0;
+	const auto* bytes = reinterpret_cast<const uint8_t*>(samples.data());
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < chunks; i++)
+	{
+		previousPeak = std::fmax(previousPeak, PreviousAmplitude(bytes + (i % kChunks) * kChunkSamples * sizeof(int16_t), kChunkSamples * sizeof(int16_t)));
+	}
+	const double previousSeconds = Seconds(start);
+
+	std::printf("%zu chunks of %zu samples\n", chunks, kChunkSamples);
+	Report("previous", previousSeconds, chunks, scalarSeconds);
+	Report("scalar", scalarSeconds, chunks, scalarSeconds);
+
+	struct NamedKernel
+	{
+		const char* name;
+		Kernel measure;
+	};
+	std::vector<NamedKernel> kernels;
+#if defined(RECORD_CORE_X86)
+	if (__builtin_cpu_supports("sse2")) kernels.push_back({ "sse2", record_core::MeasurePcm16Sse2 });
+	if (__builtin_cpu_supports("avx2")) kernels.push_back({ "avx2", record_core::MeasurePcm16Avx2 });
+#endif
+	kernels.push_back({ "dispatched", record_core::MeasurePcm16 });
+
+	for (const auto& kernel : kernels)
+	{
+		PcmLevels levels;
+		const double seconds = Run(kernel.measure, samples, chunks, levels);
+
+		CHECK(levels.peak == scalar.peak);
+		CHECK(levels.sumSquares == scalar.sumSquares);
+		CHECK(levels.clipCount == scalar.clipCount);
+		CHECK(levels.sampleCount == scalar.sampleCount);
+		Report(kernel.name, seconds, chunks, scalarSeconds);
+	}
+
+	std::printf("dispatched kernel: %s\n", record_core::MeasurePcm16KernelName());
+	CHECK(previousPeak <= scalar.PeakDbfs() + 0.01);
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,148 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "pcm_meter.h"
+
+using record_core::MeasurePcm16Scalar;
+using record_core::PcmLevels;
+
+namespace
+{
+	typedef void (*Kernel)(const int16_t*, size_t, PcmLevels&);
+
+	struct NamedKernel
+	{
+		const char* name;
+		Kernel measure;
+	};
+
+	// Kernels supported by the running CPU, the scalar one excluded.
+	std::vector<NamedKernel> VectorKernels()
+	{
+		std::vector<NamedKernel> kernels;
+#if defined(RECORD_CORE_X86)
+		if (__builtin_cpu_supports("sse2")) kernels.push_back({ "sse2", record_core::MeasurePcm16Sse2 });
+		if (__builtin_cpu_supports("avx2")) kernels.push_back({ "avx2", record_core::MeasurePcm16Avx2 });
+#endif
+		kernels.push_back({ "dispatched", record_core::MeasurePcm16 });
+		return kernels;
+	}
+
+	// Deterministic samples, full scale values included.
+	std::vector<int16_t> RandomSamples(size_t count, uint32_t seed)
+	{
+		std::vector<int16_t> samples(count);
+		for (auto& sample : samples)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			sample = static_cast<int16_t>(seed >> 16);
+			if ((seed & 0xff) == 0) sample = INT16_MIN;
+			if ((seed & 0xff) == 1) sample = INT16_MAX;
+		}
+		return samples;
+	}
+
+	bool SameLevels(const PcmLevels& a, const PcmLevels& b)
+	{
+		return a.peak == b.peak && a.sumSquares == b.sumSquares && a.clipCount == b.clipCount && a.sampleCount == b.sampleCount;
+	}
+
+	void CheckAgainstScalar(const int16_t* samples, size_t count)
+	{
+		PcmLevels expected;
+		MeasurePcm16Scalar(samples, count, expected);
+
+		for (const auto& kernel : VectorKernels())
+		{
+			PcmLevels levels;
+			kernel.measure(samples, count, levels);
+			if (!SameLevels(levels, expected))
+			{
+				std::printf("%s differs from scalar, %zu samples\n", kernel.name, count);
+			}
+			CHECK(SameLevels(levels, expected));
+		}
+	}
+}
+
+RECORD_TEST(KernelsMatchScalarForAllTails)
+{
+	// Every length up to a few vectors, from unaligned addresses.
+	const auto samples = RandomSamples(300, 1);
+	for (size_t offset = 0; offset < 4; offset++)
+	{
+		for (size_t count = 0; count + offset <= samples.size(); count++)
+		{
+			CheckAgainstScalar(samples.data() + offset, count);
+		}
+	}
+}
+
+RECORD_TEST(KernelsMatchScalarOnLongBuffers)
+{
+	// Lanes are flushed before their counters overflow.
+	const auto samples = RandomSamples(3 * 1000 * 1000 + 7, 2);
+	CheckAgainstScalar(samples.data(), samples.size());
+
+	const std::vector<int16_t> fullScale(2 * 1000 * 1000 + 3, INT16_MIN);
+	CheckAgainstScalar(fullScale.data(), fullScale.size());
+}
+
+RECORD_TEST(KernelsAccumulateAcrossCalls)
+{
+	const auto samples = RandomSamples(1000, 3);
+
+	PcmLevels expected;
+	MeasurePcm16Scalar(samples.data(), samples.size(), expected);
+
+	for (const auto& kernel : VectorKernels())
+	{
+		PcmLevels levels;
+		kernel.measure(samples.data(), 333, levels);
+		kernel.measure(samples.data() + 333, samples.size() - 333, levels);
+		CHECK(SameLevels(levels, expected));
+	}
+}
+
+RECORD_TEST(ScalarReferenceValues)
+{
+	const std::vector<int16_t> samples = { 0, 100, -200, INT16_MAX, INT16_MIN, -1 };
+
+	PcmLevels levels;
+	MeasurePcm16Scalar(samples.data(), samples.size(), levels);
+	CHECK(levels.peak == 32768);
+	CHECK(levels.clipCount == 2);
+	CHECK(levels.sampleCount == samples.size());
+	CHECK(levels.sumSquares == 10000ull + 40000ull + 32767ull * 32767ull + 32768ull * 32768ull + 1ull);
+}
+
+RECORD_TEST(LevelsInDbfs)
+{
+	PcmLevels levels;
+	CHECK_NEAR(levels.PeakDbfs(), record_core::kMinDbfs, 0.0);
+	CHECK_NEAR(levels.RmsDbfs(), record_core::kMinDbfs, 0.0);
+
+	// Half scale square wave: peak and RMS at -6.02 dBFS.
+	std::vector<int16_t> square(1000);
+	for (size_t i = 0; i < square.size(); i++)
+	{
+		square[i] = i % 2 == 0 ? 16384 : -16384;
+	}
+	record_core::MeasurePcm16(square.data(), square.size(), levels);
+	CHECK_NEAR(levels.PeakDbfs(), -6.02, 0.01);
+	CHECK_NEAR(levels.RmsDbfs(), -6.02, 0.01);
+
+	levels.Reset();
+	CHECK(SameLevels(levels, PcmLevels()));
+}
+
+RECORD_TEST(DispatchedKernelIsNamed)
+{
+	const std::string name = record_core::MeasurePcm16KernelName();
+	CHECK(name == "avx2" || name == "sse2" || name == "scalar");
+	std::printf("kernel: %s\n", name.c_str());
+}
+
+RECORD_TEST_MAIN()
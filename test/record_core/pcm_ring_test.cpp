@@ -0,0 +1,182 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "pcm_ring.h"
+#include "spsc_ring.h"
+
+using record_core::PcmRing;
+using record_core::PcmRingChunk;
+using record_core::SpscRing;
+
+namespace
+{
+	std::vector<uint8_t> Bytes(size_t size, uint8_t value)
+	{
+		return std::vector<uint8_t>(size, value);
+	}
+
+	bool Write(PcmRing* ring, size_t size, uint8_t value, PcmRingChunk& chunk)
+	{
+		const auto bytes = Bytes(size, value);
+		return ring->Write(bytes.data(), bytes.size(), chunk);
+	}
+
+	// Chunk bytes, read in place.
+	std::vector<uint8_t> Read(const PcmRing* ring, const PcmRingChunk& chunk)
+	{
+		const uint8_t* data = ring->Data() + chunk.position % ring->Capacity();
+		return std::vector<uint8_t>(data, data + chunk.length);
+	}
+}
+
+RECORD_TEST(EmptyCapacityIsRejected)
+{
+	CHECK(PcmRing::Create(0) == nullptr);
+}
+
+RECORD_TEST(ChunksAreWrittenInPlace)
+{
+	PcmRing* ring = PcmRing::Create(100);
+	CHECK(ring != nullptr);
+	if (!ring) return;
+
+	PcmRingChunk first, second;
+	CHECK(Write(ring, 30, 1, first));
+	CHECK(Write(ring, 20, 2, second));
+
+	CHECK(first.position == 0 && first.length == 30 && first.sequence == 0);
+	CHECK(second.position == 30 && second.length == 20 && second.sequence == 1);
+	CHECK(Read(ring, first) == Bytes(30, 1));
+	CHECK(Read(ring, second) == Bytes(20, 2));
+	CHECK(ring->ReservedCursor()->load() == 50);
+
+	ring->Release();
+}
+
+RECORD_TEST(EmptyOrOversizedChunksAreRejected)
+{
+	PcmRing* ring = PcmRing::Create(100);
+	if (!ring) return;
+
+	PcmRingChunk chunk;
+	CHECK(!Write(ring, 0, 1, chunk));
+	CHECK(!Write(ring, 101, 1, chunk));
+	CHECK(Write(ring, 100, 1, chunk));
+	CHECK(chunk.sequence == 0);
+
+	ring->Release();
+}
+
+RECORD_TEST(RingEndIsSkippedForContiguousChunks)
+{
+	PcmRing* ring = PcmRing::Create(100);
+	if (!ring) return;
+
+	PcmRingChunk chunk;
+	CHECK(Write(ring, 70, 1, chunk));
+	CHECK(Write(ring, 40, 2, chunk));
+
+	// Starts at the ring start, the 30 end bytes are skipped.
+	CHECK(chunk.position == 100);
+	CHECK(chunk.position % ring->Capacity() == 0);
+	CHECK(Read(ring, chunk) == Bytes(40, 2));
+
+	ring->Release();
+}
+
+RECORD_TEST(ChunkIsValidUntilOverwritten)
+{
+	PcmRing* ring = PcmRing::Create(100);
+	if (!ring) return;
+
+	PcmRingChunk first, chunk;
+	CHECK(Write(ring, 40, 1, first));
+	CHECK(Write(ring, 40, 2, chunk));
+	CHECK(ring->IsValid(first));
+
+	// Fits at the ring end, first is intact.
+	CHECK(Write(ring, 20, 3, chunk));
+	CHECK(ring->IsValid(first));
+	CHECK(Read(ring, first) == Bytes(40, 1));
+
+	// Reserved before being written, first is reported as overwritten.
+	CHECK(Write(ring, 1, 4, chunk));
+	CHECK(!ring->IsValid(first));
+
+	ring->Release();
+}
+
+RECORD_TEST(RingLivesUntilLastReference)
+{
+	PcmRing* ring = PcmRing::Create(16);
+	if (!ring) return;
+
+	ring->Retain();
+	PcmRing::ReleaseCallback(ring);
+
+	// Still usable by the remaining reference.
+	PcmRingChunk chunk;
+	CHECK(Write(ring, 16, 5, chunk));
+	CHECK(Read(ring, chunk) == Bytes(16, 5));
+
+	ring->Release();
+}
+
+RECORD_TEST(ConsumerReadsChunksOfProducer)
+{
+	// Locations in flight never cover the ring, so no chunk is overwritten
+	// while read and each one is intact.
+	constexpr size_t kMaxChunk = 256;
+	constexpr uint64_t kChunks = 100000;
+
+	PcmRing* ring = PcmRing::Create(4096);
+	if (!ring) return;
+	SpscRing<PcmRingChunk> locations(8);
+
+	std::thread producer([&]()
+		{
+			std::vector<uint8_t> bytes(kMaxChunk);
+			for (uint64_t i = 0; i < kChunks; i++)
+			{
+				const size_t size = 1 + (i * 37) % kMaxChunk;
+				std::fill(bytes.begin(), bytes.begin() + size, static_cast<uint8_t>(i));
+
+				PcmRingChunk chunk;
+				ring->Write(bytes.data(), size, chunk);
+				while (!locations.TryPush([&chunk](PcmRingChunk& slot) { slot = chunk; }))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+
+	uint64_t read = 0;
+	bool intact = true;
+	bool ordered = true;
+
+	while (read < kChunks)
+	{
+		const size_t count = locations.Drain([&](PcmRingChunk& chunk)
+			{
+				ordered = ordered && chunk.sequence == read && chunk.length == 1 + (read * 37) % kMaxChunk;
+				intact = intact && Read(ring, chunk) == Bytes(chunk.length, static_cast<uint8_t>(read)) && ring->IsValid(chunk);
+				read++;
+			});
+		if (count == 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	producer.join();
+
+	CHECK(ordered);
+	CHECK(intact);
+
+	ring->Release();
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,231 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "check.h"
+#include "sample_format.h"
+
+using record_core::SampleConverter;
+using record_core::SampleFormat;
+
+namespace
+{
+	typedef void (*Kernel)(const uint8_t*, SampleFormat, size_t, int16_t*);
+
+	// Reference conversion of one sample, from the format definitions.
+	int16_t Reference(int32_t value, SampleFormat format)
+	{
+		switch (format)
+		{
+		case SampleFormat::s24:
+			return static_cast<int16_t>(value >> 8);
+		case SampleFormat::s32:
+			return static_cast<int16_t>(value >> 16);
+		default:
+			return static_cast<int16_t>(value);
+		}
+	}
+
+	int16_t Reference(float value)
+	{
+		if (std::isnan(value) || value >= 1.0f) return INT16_MAX;
+		if (value <= -1.0f) return INT16_MIN;
+
+		// Just below 1.0 rounds to 32768, saturated.
+		const double rounded = std::nearbyint(static_cast<double>(value) * 32768.0);
+		return static_cast<int16_t>(rounded > INT16_MAX ? INT16_MAX : rounded);
+	}
+
+	// Little endian bytes of integer samples.
+	std::vector<uint8_t> Bytes(const std::vector<int32_t>& values, SampleFormat format)
+	{
+		const size_t size = record_core::BytesPerSample(format);
+		std::vector<uint8_t> bytes;
+		for (int32_t value : values)
+		{
+			for (size_t i = 0; i < size; i++)
+			{
+				bytes.push_back(static_cast<uint8_t>(static_cast<uint32_t>(value) >> (8 * i)));
+			}
+		}
+		return bytes;
+	}
+
+	std::vector<uint8_t> Bytes(const std::vector<float>& values)
+	{
+		std::vector<uint8_t> bytes(values.size() * sizeof(float));
+		if (!values.empty()) std::memcpy(bytes.data(), values.data(), bytes.size());
+		return bytes;
+	}
+
+	std::vector<int16_t> References(const std::vector<int32_t>& values, SampleFormat format)
+	{
+		std::vector<int16_t> expected;
+		for (int32_t value : values) expected.push_back(Reference(value, format));
+		return expected;
+	}
+
+	std::vector<int16_t> References(const std::vector<float>& values)
+	{
+		std::vector<int16_t> expected;
+		for (float value : values) expected.push_back(Reference(value));
+		return expected;
+	}
+
+	// Kernels of the running CPU, dispatched one included.
+	std::vector<Kernel> Kernels()
+	{
+		std::vector<Kernel> kernels = { record_core::ConvertToS16Scalar, record_core::ConvertToS16 };
+#if defined(RECORD_CORE_X86)
+		if (__builtin_cpu_supports("sse2")) kernels.push_back(record_core::ConvertToS16Sse2);
+#endif
+		return kernels;
+	}
+
+	// Converts bytes with each kernel, from an unaligned copy of them.
+	bool AllKernelsGive(const std::vector<uint8_t>& bytes, SampleFormat format, const std::vector<int16_t>& expected)
+	{
+		std::vector<uint8_t> unaligned(bytes.size() + 1);
+		if (!bytes.empty()) std::memcpy(unaligned.data() + 1, bytes.data(), bytes.size());
+
+		bool same = true;
+		for (Kernel kernel : Kernels())
+		{
+			std::vector<int16_t> converted(expected.size() + 1, 0x5a5a);
+			kernel(unaligned.data() + 1, format, expected.size(), converted.data());
+
+			// Nothing written past count.
+			same = same && converted.back() == 0x5a5a;
+			converted.pop_back();
+			same = same && converted == expected;
+		}
+		return same;
+	}
+
+	// Integer edge values of format, repeated to count samples.
+	std::vector<int32_t> IntegerValues(SampleFormat format, size_t count)
+	{
+		std::vector<int32_t> edges;
+		switch (format)
+		{
+		case SampleFormat::s24:
+			edges = { -8388608, 8388607, -1, 0, 1, 255, 256, -256, -257, 0x7fff00, -0x7fff01 };
+			break;
+		case SampleFormat::s32:
+			edges = { INT32_MIN, INT32_MAX, -1, 0, 1, 65535, 65536, -65536, -65537, 0x7fff0000, -0x7fff0001 };
+			break;
+		default:
+			edges = { INT16_MIN, INT16_MAX, -1, 0, 1, 255, 256, -256, -257 };
+			break;
+		}
+
+		std::vector<int32_t> values;
+		for (size_t i = 0; i < count; i++) values.push_back(edges[i % edges.size()]);
+		return values;
+	}
+
+	std::vector<float> FloatValues(size_t count)
+	{
+		const float edges[] = {
+			-1.0f, 1.0f, 0.0f, -0.0f, 0.5f, -0.5f,
+			// Clipped.
+			1.5f, -1.5f, 1e9f, -1e9f,
+			std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::quiet_NaN(),
+			// Just inside full scale.
+			32767.0f / 32768.0f, std::nextafter(1.0f, 0.0f), std::nextafter(-1.0f, 0.0f),
+			// Halfway between two steps, rounded to even.
+			0.5f / 32768.0f, 1.5f / 32768.0f, -0.5f / 32768.0f, -1.5f / 32768.0f,
+			// Smaller than a step.
+			1e-7f, -1e-7f, std::numeric_limits<float>::denorm_min(),
+		};
+		const size_t edgeCount = sizeof(edges) / sizeof(edges[0]);
+
+		std::vector<float> values;
+		for (size_t i = 0; i < count; i++) values.push_back(edges[i % edgeCount]);
+		return values;
+	}
+}
+
+RECORD_TEST(BytesPerSampleMatchFormats)
+{
+	CHECK(record_core::BytesPerSample(SampleFormat::s16) == 2);
+	CHECK(record_core::BytesPerSample(SampleFormat::s24) == 3);
+	CHECK(record_core::BytesPerSample(SampleFormat::s32) == 4);
+	CHECK(record_core::BytesPerSample(SampleFormat::f32) == 4);
+}
+
+RECORD_TEST(FullScaleFloatsAreSaturated)
+{
+	const std::vector<float> values = { -1.0f, 1.0f, 2.0f, -2.0f, 0.5f };
+	const std::vector<int16_t> expected = { INT16_MIN, INT16_MAX, INT16_MAX, INT16_MIN, 16384 };
+	CHECK(References(values) == expected);
+	CHECK(AllKernelsGive(Bytes(values), SampleFormat::f32, expected));
+}
+
+RECORD_TEST(IntegersAreTruncated)
+{
+	// Most significant 16 bits, rounded toward negative infinity.
+	CHECK(AllKernelsGive(Bytes({ -8388608, 8388607, -1, 255, 256 }, SampleFormat::s24), SampleFormat::s24,
+		{ INT16_MIN, INT16_MAX, -1, 0, 1 }));
+	CHECK(AllKernelsGive(Bytes({ INT32_MIN, INT32_MAX, -1, 65535, 65536 }, SampleFormat::s32), SampleFormat::s32,
+		{ INT16_MIN, INT16_MAX, -1, 0, 1 }));
+}
+
+RECORD_TEST(KernelsMatchReferenceForEachLength)
+{
+	// Lengths around the 8 samples of a SIMD block, tails included.
+	for (size_t count = 0; count <= 35; count++)
+	{
+		for (SampleFormat format : { SampleFormat::s16, SampleFormat::s24, SampleFormat::s32 })
+		{
+			const auto values = IntegerValues(format, count);
+			CHECK(AllKernelsGive(Bytes(values, format), format, References(values, format)));
+		}
+
+		const auto floats = FloatValues(count);
+		CHECK(AllKernelsGive(Bytes(floats), SampleFormat::f32, References(floats)));
+	}
+}
+
+RECORD_TEST(ConverterGivesS16AsIs)
+{
+	const auto bytes = Bytes(IntegerValues(SampleFormat::s16, 9), SampleFormat::s16);
+
+	SampleConverter converter;
+	CHECK(converter.Format() == SampleFormat::s16);
+	CHECK(converter.ToS16(bytes.data(), 9) == reinterpret_cast<const int16_t*>(bytes.data()));
+}
+
+RECORD_TEST(ConverterConvertsOtherFormats)
+{
+	SampleConverter converter;
+
+	for (SampleFormat format : { SampleFormat::s24, SampleFormat::s32 })
+	{
+		converter.Configure(format);
+		CHECK(converter.Format() == format);
+
+		// Growing then shrinking counts, the buffer is reused.
+		for (size_t count : { 3, 17, 5 })
+		{
+			const auto values = IntegerValues(format, count);
+			const auto bytes = Bytes(values, format);
+			const int16_t* samples = converter.ToS16(bytes.data(), count);
+			CHECK(std::vector<int16_t>(samples, samples + count) == References(values, format));
+		}
+	}
+
+	converter.Configure(SampleFormat::f32);
+	for (size_t count : { 1, 23, 7 })
+	{
+		const auto values = FloatValues(count);
+		const auto bytes = Bytes(values);
+		const int16_t* samples = converter.ToS16(bytes.data(), count);
+		CHECK(std::vector<int16_t>(samples, samples + count) == References(values));
+	}
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,118 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "meter_snapshot.h"
+#include "seqlock.h"
+
+using record_core::MeterSnapshot;
+using record_core::SeqLock;
+
+namespace
+{
+	constexpr int kWrites = 100000;
+	constexpr int kReaders = 3;
+
+	// Every field holds the same value, a torn copy mixes two of them.
+	MeterSnapshot MakeSnapshot(int value)
+	{
+		MeterSnapshot snapshot;
+		snapshot.current = value;
+		snapshot.max = value;
+		snapshot.rms = value;
+		snapshot.clipCount = static_cast<uint64_t>(value);
+		snapshot.numChannels = value;
+		for (auto& channel : snapshot.channels)
+		{
+			channel.peak = value;
+			channel.rms = value;
+			channel.truePeak = value;
+			channel.peakHold = value;
+		}
+		snapshot.loudness.momentary = value;
+		snapshot.loudness.integrated = value;
+		return snapshot;
+	}
+
+	bool IsConsistent(const MeterSnapshot& snapshot)
+	{
+		const double value = snapshot.current;
+		bool consistent = snapshot.max == value && snapshot.rms == value && snapshot.clipCount == static_cast<uint64_t>(value) && snapshot.numChannels == static_cast<int>(value) && snapshot.loudness.momentary == value && snapshot.loudness.integrated == value;
+		for (const auto& channel : snapshot.channels)
+		{
+			consistent = consistent && channel.peak == value && channel.rms == value && channel.truePeak == value && channel.peakHold == value;
+		}
+		return consistent;
+	}
+
+	// Size not multiple of the word size.
+	struct Odd
+	{
+		uint8_t bytes[13];
+	};
+}
+
+RECORD_TEST(LoadReturnsStoredValue)
+{
+	SeqLock<MeterSnapshot> lock;
+	CHECK(lock.Load().current == record_core::kMinDbfs);
+
+	lock.Store(MakeSnapshot(42));
+	CHECK(IsConsistent(lock.Load()));
+	CHECK(lock.Load().current == 42);
+
+	Odd odd;
+	for (uint8_t i = 0; i < sizeof(odd.bytes); i++)
+	{
+		odd.bytes[i] = static_cast<uint8_t>(i + 1);
+	}
+	SeqLock<Odd> oddLock(odd);
+	CHECK(oddLock.Load().bytes[12] == 13);
+}
+
+RECORD_TEST(ReadersNeverSeeTornValues)
+{
+	SeqLock<MeterSnapshot> lock(MakeSnapshot(0));
+	std::atomic<bool> done{ false };
+	std::atomic<int> torn{ 0 };
+	std::atomic<int> backwards{ 0 };
+	std::atomic<uint64_t> loads{ 0 };
+
+	std::vector<std::thread> readers;
+	for (int r = 0; r < kReaders; r++)
+	{
+		readers.emplace_back([&]() {
+			double last = 0;
+			uint64_t count = 0;
+			while (!done.load(std::memory_order_acquire))
+			{
+				const auto snapshot = lock.Load();
+				if (!IsConsistent(snapshot)) torn++;
+				if (snapshot.current < last) backwards++;
+				last = snapshot.current;
+				count++;
+			}
+			loads += count;
+		});
+	}
+
+	for (int i = 1; i <= kWrites; i++)
+	{
+		lock.Store(MakeSnapshot(i));
+	}
+	done.store(true, std::memory_order_release);
+
+	for (auto& reader : readers)
+	{
+		reader.join();
+	}
+
+	CHECK(torn == 0);
+	CHECK(backwards == 0);
+	CHECK(loads > 0);
+	CHECK(lock.Load().current == kWrites);
+}
+
+RECORD_TEST_MAIN()
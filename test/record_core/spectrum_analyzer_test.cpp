@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "check.h"
+#include "pcm_meter.h"
+#include "spectrum_analyzer.h"
+
+using record_core::SpectrumAnalyzer;
+using record_core::SpectrumConfig;
+
+namespace
+{
+	constexpr double kPi = 3.14159265358979323846;
+	constexpr int kSampleRate = 48000;
+	constexpr int kFftSize = 1024;
+
+	// Mono sine, amplitude in [0, 1].
+	std::vector<int16_t> Sine(double frequency, double amplitude, size_t frameCount)
+	{
+		std::vector<int16_t> samples(frameCount);
+		for (size_t i = 0; i < frameCount; i++)
+		{
+			samples[i] = static_cast<int16_t>(std::lround(32767.0 * amplitude * std::sin(2.0 * kPi * frequency * i / kSampleRate)));
+		}
+		return samples;
+	}
+
+	SpectrumConfig MakeConfig(double maxFrameRate)
+	{
+		SpectrumConfig config;
+		config.fftSize = kFftSize;
+		config.numBands = 16;
+		config.maxFrameRate = maxFrameRate;
+		return config;
+	}
+
+	// Last analyzed frame and the number of frames.
+	struct Frames
+	{
+		std::vector<float> last;
+		int count = 0;
+	};
+
+	Frames Process(SpectrumAnalyzer& analyzer, const std::vector<int16_t>& samples, size_t frameCount)
+	{
+		Frames frames;
+		analyzer.Process(samples.data(), frameCount, [&frames](const float* bands, int numBands) {
+			frames.last.assign(bands, bands + numBands);
+			frames.count++;
+		});
+		return frames;
+	}
+}
+
+RECORD_TEST(DisabledWithoutFftSize)
+{
+	SpectrumAnalyzer analyzer;
+	analyzer.Configure(kSampleRate, 1, SpectrumConfig());
+	CHECK(!analyzer.IsEnabled());
+
+	const auto samples = Sine(1000.0, 0.5, 4096);
+	CHECK(Process(analyzer, samples, samples.size()).count == 0);
+}
+
+RECORD_TEST(FullScaleSineIsZeroDbfs)
+{
+	SpectrumAnalyzer analyzer;
+	analyzer.Configure(kSampleRate, 1, MakeConfig(0.0));
+	CHECK(analyzer.NumBands() == 16);
+
+	// Centered on bin 16, no scalloping loss.
+	const double frequency = 16.0 * kSampleRate / kFftSize;
+	const auto samples = Sine(frequency, 1.0, 4096);
+	const auto frames = Process(analyzer, samples, samples.size());
+	CHECK(frames.count > 0);
+
+	const auto peak = std::max_element(frames.last.begin(), frames.last.end());
+	CHECK_NEAR(*peak, 0.0, 0.1);
+	// Highest band is far from the tone.
+	CHECK(frames.last.back() < -60.0f);
+}
+
+RECORD_TEST(HalfScaleSineIsMinusSixDbfs)
+{
+	SpectrumAnalyzer analyzer;
+	analyzer.Configure(kSampleRate, 1, MakeConfig(0.0));
+
+	const auto samples = Sine(16.0 * kSampleRate / kFftSize, 0.5, 4096);
+	const auto frames = Process(analyzer, samples, samples.size());
+
+	CHECK_NEAR(*std::max_element(frames.last.begin(), frames.last.end()), -6.02, 0.1);
+}
+
+RECORD_TEST(SilenceIsFloor)
+{
+	SpectrumAnalyzer analyzer;
+	analyzer.Configure(kSampleRate, 1, MakeConfig(0.0));
+
+	const std::vector<int16_t> samples(4096, 0);
+	const auto frames = Process(analyzer, samples, samples.size());
+	CHECK(frames.count > 0);
+	for (float band : frames.last)
+	{
+		CHECK_NEAR(band, record_core::kMinDbfs, 1e-6);
+	}
+}
+
+RECORD_TEST(FramesFollowHopSize)
+{
+	SpectrumAnalyzer analyzer;
+	analyzer.Configure(kSampleRate, 1, MakeConfig(0.0));
+
+	// First frame once fftSize frames are in, then one per hop of fftSize / 2.
+	const std::vector<int16_t> samples(4096, 0);
+	CHECK(Process(analyzer, samples, samples.size()).count == 7);
+}
+
+RECORD_TEST(FrameRateIsCapped)
+{
+	SpectrumAnalyzer analyzer;
+	analyzer.Configure(kSampleRate, 1, MakeConfig(30.0));
+
+	const std::vector<int16_t> samples(kSampleRate, 0);
+	const int count = Process(analyzer, samples, samples.size()).count;
+	CHECK(count > 0);
+	CHECK(count <= 30);
+}
+
+RECORD_TEST(ChannelsAreMixed)
+{
+	SpectrumAnalyzer analyzer;
+	analyzer.Configure(kSampleRate, 2, MakeConfig(0.0));
+
+	// Opposite phases cancel out.
+	const auto mono = Sine(1000.0, 0.5, 4096);
+	std::vector<int16_t> samples;
+	for (int16_t sample : mono)
+	{
+		samples.push_back(sample);
+		samples.push_back(static_cast<int16_t>(-sample));
+	}
+
+	const auto frames = Process(analyzer, samples, mono.size());
+	CHECK(frames.count > 0);
+	CHECK(*std::max_element(frames.last.begin(), frames.last.end()) < -100.0f);
+}
+
+RECORD_TEST_MAIN()
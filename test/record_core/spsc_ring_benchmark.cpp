@@ -0,0 +1,164 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "spsc_ring.h"
+
+// Compares the ring handing stream chunks to the main thread with the
+// mutex guarded queue of tasks it replaced (one std::function and one
+// chunk copy per chunk).
+namespace
+{
+	constexpr size_t kChunkBytes = 4096;
+
+	size_t ChunkCount()
+	{
+		const char* count = std::getenv("RECORD_BENCHMARK_CHUNKS");
+		return count ? std::strtoul(count, nullptr, 10) : 100000;
+	}
+
+	double Seconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Previous path: each chunk is copied in a task posted to a locked queue.
+	class TaskQueue
+	{
+	public:
+		void Post(std::function<void()> task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_tasks.push_back(std::move(task));
+			}
+			m_condition.notify_one();
+		}
+
+		// Runs tasks until count of them ran.
+		void Run(size_t count)
+		{
+			size_t done = 0;
+			std::deque<std::function<void()>> tasks;
+			while (done < count)
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_condition.wait(lock, [this]() { return !m_tasks.empty(); });
+					tasks.swap(m_tasks);
+				}
+				for (auto& task : tasks)
+				{
+					task();
+					done++;
+				}
+				tasks.clear();
+			}
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::deque<std::function<void()>> m_tasks;
+	};
+
+	struct Result
+	{
+		double seconds = 0;
+		uint64_t bytes = 0;
+	};
+
+	Result RunTaskQueue(size_t chunks)
+	{
+		TaskQueue queue;
+		Result result;
+		const std::vector<uint8_t> captured(kChunkBytes, 1);
+		const auto start = std::chrono::steady_clock::now();
+
+		std::thread producer([&]() {
+			for (size_t i = 0; i < chunks; i++)
+			{
+				std::vector<uint8_t> chunk(captured);
+				queue.Post([&result, chunk]() { result.bytes += chunk.size(); });
+			}
+		});
+		queue.Run(chunks);
+		producer.join();
+
+		result.seconds = Seconds(start);
+		return result;
+	}
+
+	Result RunRing(size_t chunks)
+	{
+		record_core::SpscRing<std::vector<uint8_t>> ring(256);
+		Result result;
+		const std::vector<uint8_t> captured(kChunkBytes, 1);
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool wakeup = false;
+		const auto start = std::chrono::steady_clock::now();
+
+		std::thread producer([&]() {
+			for (size_t i = 0; i < chunks; i++)
+			{
+				while (!ring.TryPush([&captured](std::vector<uint8_t>& slot) { slot.assign(captured.begin(), captured.end()); }))
+				{
+					std::this_thread::yield();
+				}
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					wakeup = true;
+				}
+				condition.notify_one();
+			}
+		});
+
+		size_t done = 0;
+		while (done < chunks)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [&wakeup]() { return wakeup; });
+				wakeup = false;
+			}
+			done += ring.Drain([&result](std::vector<uint8_t>& slot) {
+				result.bytes += slot.size();
+				slot.clear();
+			});
+		}
+		producer.join();
+
+		result.seconds = Seconds(start);
+		return result;
+	}
+
+	void Report(const char* name, const Result& result, size_t chunks)
+	{
+		std::printf("%-10s %8.1f ns/chunk %8.1f MB/s\n", name, result.seconds * 1e9 / chunks, result.bytes / result.seconds / 1e6);
+	}
+}
+
+RECORD_TEST(TaskQueueVersusRing)
+{
+	const size_t chunks = ChunkCount();
+
+	const auto queue = RunTaskQueue(chunks);
+	const auto ring = RunRing(chunks);
+
+	CHECK(queue.bytes == chunks * kChunkBytes);
+	CHECK(ring.bytes == chunks * kChunkBytes);
+
+	std::printf("%zu chunks of %zu bytes\n", chunks, kChunkBytes);
+	Report("task queue", queue, chunks);
+	Report("spsc ring", ring, chunks);
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,127 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "spsc_ring.h"
+
+using record_core::SpscRing;
+
+namespace
+{
+	constexpr uint32_t kItems = 200000;
+
+	// Chunk filled in place, as captured buffers are.
+	struct Chunk
+	{
+		std::vector<uint32_t> values;
+	};
+}
+
+RECORD_TEST(CapacityIsRoundedUpToPowerOfTwo)
+{
+	CHECK(SpscRing<int>(0).Capacity() == 2);
+	CHECK(SpscRing<int>(5).Capacity() == 8);
+	CHECK(SpscRing<int>(64).Capacity() == 64);
+}
+
+RECORD_TEST(PushFailsWhenFull)
+{
+	SpscRing<int> ring(4);
+	int value = 0;
+	while (ring.TryPush([&value](int& slot) { slot = value++; }))
+	{
+	}
+	CHECK(value == 4);
+	CHECK(ring.Size() == 4);
+
+	bool filled = false;
+	CHECK(!ring.TryPush([&filled](int&) { filled = true; }));
+	CHECK(!filled);
+
+	// Drained slots are free again.
+	std::vector<int> values;
+	CHECK(ring.Drain([&values](int& slot) { values.push_back(slot); }) == 4);
+	CHECK((values == std::vector<int>{ 0, 1, 2, 3 }));
+	CHECK(ring.TryPush([](int& slot) { slot = 4; }));
+}
+
+RECORD_TEST(DrainStopsAtMaxCount)
+{
+	SpscRing<int> ring(8);
+	for (int i = 0; i < 6; i++)
+	{
+		ring.TryPush([i](int& slot) { slot = i; });
+	}
+
+	std::vector<int> values;
+	CHECK(ring.Drain([&values](int& slot) { values.push_back(slot); }, 4) == 4);
+	CHECK(ring.Size() == 2);
+	CHECK(ring.Drain([&values](int& slot) { values.push_back(slot); }, 0) == 0);
+	CHECK(ring.Drain([&values](int& slot) { values.push_back(slot); }) == 2);
+	CHECK((values == std::vector<int>{ 0, 1, 2, 3, 4, 5 }));
+}
+
+RECORD_TEST(SlotsAreReused)
+{
+	SpscRing<Chunk> ring(2);
+	for (int i = 0; i < 10; i++)
+	{
+		ring.TryPush([](Chunk& chunk) { chunk.values.assign(100, 1); });
+		ring.Drain([](Chunk& chunk) { chunk.values.clear(); });
+	}
+
+	// Cleared vectors keep their capacity.
+	ring.Drain([](Chunk&) {});
+	size_t capacity = 0;
+	ring.TryPush([&capacity](Chunk& chunk) { capacity = chunk.values.capacity(); });
+	CHECK(capacity >= 100);
+}
+
+RECORD_TEST(ConcurrentProducerAndConsumerKeepOrder)
+{
+	SpscRing<Chunk> ring(16);
+	std::atomic<bool> produced{ false };
+	uint32_t fullCount = 0;
+
+	std::thread producer([&]() {
+		for (uint32_t i = 0; i < kItems; i++)
+		{
+			// Retries when full, as the capture thread never does, so every
+			// item goes through.
+			while (!ring.TryPush([i](Chunk& chunk) { chunk.values.assign(4, i); }))
+			{
+				fullCount++;
+				std::this_thread::yield();
+			}
+		}
+		produced.store(true, std::memory_order_release);
+	});
+
+	uint32_t expected = 0;
+	int errors = 0;
+	auto consume = [&](Chunk& chunk) {
+		for (uint32_t value : chunk.values)
+		{
+			if (value != expected) errors++;
+		}
+		expected++;
+		chunk.values.clear();
+	};
+
+	while (!produced.load(std::memory_order_acquire))
+	{
+		ring.Drain(consume, 5);
+		std::this_thread::yield();
+	}
+	producer.join();
+	ring.Drain(consume);
+
+	CHECK(errors == 0);
+	CHECK(expected == kItems);
+	CHECK(ring.Size() == 0);
+	std::printf("producer found the ring full %u times\n", fullCount);
+}
+
+RECORD_TEST_MAIN()
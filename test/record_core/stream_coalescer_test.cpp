@@ -0,0 +1,228 @@
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "check.h"
+#include "stream_coalescer.h"
+
+using record_core::StreamCoalescer;
+
+namespace
+{
+	constexpr size_t kFrameBytes = 4;
+
+	// Chunks given by the coalescer, their bytes count up from 0.
+	struct Chunks
+	{
+		std::vector<size_t> sizes;
+		std::vector<uint8_t> bytes;
+
+		void operator()(const uint8_t* data, size_t size)
+		{
+			sizes.push_back(size);
+			bytes.insert(bytes.end(), data, data + size);
+		}
+
+		bool InOrder() const
+		{
+			for (size_t i = 0; i < bytes.size(); i++)
+			{
+				if (bytes[i] != static_cast<uint8_t>(i)) return false;
+			}
+			return true;
+		}
+	};
+
+	// Appends size bytes following the ones appended so far.
+	class Source
+	{
+	public:
+		void Append(StreamCoalescer& coalescer, size_t size, Chunks& chunks)
+		{
+			coalescer.Append(Next(size).data(), size, std::ref(chunks));
+		}
+
+		void Append(StreamCoalescer& coalescer, size_t size, StreamCoalescer::Clock::time_point now, Chunks& chunks)
+		{
+			coalescer.Append(Next(size).data(), size, now, std::ref(chunks));
+		}
+
+	private:
+		std::vector<uint8_t> Next(size_t size)
+		{
+			std::vector<uint8_t> data(size);
+			for (auto& value : data) value = static_cast<uint8_t>(m_position++);
+			return data;
+		}
+
+		size_t m_position = 0;
+	};
+}
+
+RECORD_TEST(ChunkIsSentAtThreshold)
+{
+	StreamCoalescer coalescer;
+	coalescer.Configure(100, kFrameBytes);
+	Source source;
+	Chunks chunks;
+
+	for (int i = 0; i < 3; i++) source.Append(coalescer, 32, chunks);
+	CHECK(chunks.sizes.empty());
+
+	// 128 bytes, one chunk and 28 pending.
+	source.Append(coalescer, 32, chunks);
+	CHECK((chunks.sizes == std::vector<size_t>{ 100 }));
+
+	source.Append(coalescer, 72, chunks);
+	CHECK((chunks.sizes == std::vector<size_t>{ 100, 100 }));
+	CHECK(chunks.InOrder());
+}
+
+RECORD_TEST(LargeBufferIsSplitInChunks)
+{
+	StreamCoalescer coalescer;
+	coalescer.Configure(100, kFrameBytes);
+	Source source;
+	Chunks chunks;
+
+	source.Append(coalescer, 1040, chunks);
+	CHECK(chunks.sizes.size() == 10);
+	CHECK(chunks.InOrder());
+
+	coalescer.Flush(std::ref(chunks));
+	CHECK(chunks.sizes.size() == 11 && chunks.sizes.back() == 40);
+}
+
+RECORD_TEST(ChunkSizeIsRoundedToFrames)
+{
+	StreamCoalescer coalescer;
+	Source source;
+	Chunks chunks;
+
+	coalescer.Configure(10, kFrameBytes);
+	source.Append(coalescer, 16, chunks);
+	CHECK((chunks.sizes == std::vector<size_t>{ 8, 8 }));
+
+	// Smaller than a frame, each frame is a chunk.
+	coalescer.Configure(3, kFrameBytes);
+	source.Append(coalescer, 8, chunks);
+	CHECK((chunks.sizes == std::vector<size_t>{ 8, 8, 4, 4 }));
+	CHECK(chunks.InOrder());
+}
+
+RECORD_TEST(DisabledPassesBuffersAsIs)
+{
+	StreamCoalescer coalescer;
+	coalescer.Configure(0, kFrameBytes);
+	Source source;
+	Chunks chunks;
+
+	CHECK(!coalescer.IsEnabled());
+	source.Append(coalescer, 12, chunks);
+	source.Append(coalescer, 0, chunks);
+	source.Append(coalescer, 1000, chunks);
+	CHECK((chunks.sizes == std::vector<size_t>{ 12, 1000 }));
+
+	coalescer.Flush(std::ref(chunks));
+	CHECK(chunks.sizes.size() == 2);
+}
+
+RECORD_TEST(FlushSendsPendingDataOnStop)
+{
+	StreamCoalescer coalescer;
+	coalescer.Configure(100, kFrameBytes);
+	Source source;
+	Chunks chunks;
+
+	source.Append(coalescer, 60, chunks);
+	coalescer.Flush(std::ref(chunks));
+	CHECK((chunks.sizes == std::vector<size_t>{ 60 }));
+
+	// Nothing left.
+	coalescer.Flush(std::ref(chunks));
+	CHECK(chunks.sizes.size() == 1);
+
+	// Next chunk starts after the flushed data.
+	source.Append(coalescer, 100, chunks);
+	CHECK((chunks.sizes == std::vector<size_t>{ 60, 100 }));
+	CHECK(chunks.InOrder());
+}
+
+RECORD_TEST(ResetDropsPendingData)
+{
+	StreamCoalescer coalescer;
+	coalescer.Configure(100, kFrameBytes);
+	Source source;
+	Chunks chunks;
+
+	source.Append(coalescer, 60, chunks);
+	coalescer.Reset();
+	coalescer.Flush(std::ref(chunks));
+	CHECK(chunks.sizes.empty());
+}
+
+RECORD_TEST(MaxDelaySendsIncompleteChunk)
+{
+	using std::chrono::milliseconds;
+
+	StreamCoalescer coalescer;
+	coalescer.Configure(1000, kFrameBytes, milliseconds(100));
+	Source source;
+	Chunks chunks;
+
+	const auto start = StreamCoalescer::Clock::now();
+	source.Append(coalescer, 40, start, chunks);
+	source.Append(coalescer, 40, start + milliseconds(99), chunks);
+	CHECK(chunks.sizes.empty());
+
+	// Oldest data waited long enough, sent with the appended data.
+	source.Append(coalescer, 40, start + milliseconds(100), chunks);
+	CHECK((chunks.sizes == std::vector<size_t>{ 120 }));
+
+	// Delay counts from the next pending data.
+	source.Append(coalescer, 40, start + milliseconds(150), chunks);
+	source.Append(coalescer, 40, start + milliseconds(200), chunks);
+	CHECK(chunks.sizes.size() == 1);
+	source.Append(coalescer, 40, start + milliseconds(250), chunks);
+	CHECK((chunks.sizes == std::vector<size_t>{ 120, 120 }));
+	CHECK(chunks.InOrder());
+}
+
+RECORD_TEST(MaxDelayKeepsFullChunks)
+{
+	using std::chrono::milliseconds;
+
+	StreamCoalescer coalescer;
+	coalescer.Configure(100, kFrameBytes, milliseconds(10));
+	Source source;
+	Chunks chunks;
+
+	// Late data completing a chunk is not sent twice, the rest starts a new
+	// delay.
+	const auto start = StreamCoalescer::Clock::now();
+	source.Append(coalescer, 60, start, chunks);
+	source.Append(coalescer, 60, start + milliseconds(5), chunks);
+	CHECK((chunks.sizes == std::vector<size_t>{ 100 }));
+
+	source.Append(coalescer, 20, start + milliseconds(14), chunks);
+	CHECK(chunks.sizes.size() == 1);
+	source.Append(coalescer, 20, start + milliseconds(15), chunks);
+	CHECK((chunks.sizes == std::vector<size_t>{ 100, 60 }));
+	CHECK(chunks.InOrder());
+}
+
+RECORD_TEST(MaxDelayIsDisabledByDefault)
+{
+	StreamCoalescer coalescer;
+	coalescer.Configure(1000, kFrameBytes);
+	Source source;
+	Chunks chunks;
+
+	const auto start = StreamCoalescer::Clock::now();
+	source.Append(coalescer, 40, start, chunks);
+	source.Append(coalescer, 40, start + std::chrono::hours(1), chunks);
+	CHECK(chunks.sizes.empty());
+}
+
+RECORD_TEST_MAIN()
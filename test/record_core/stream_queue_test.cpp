@@ -0,0 +1,236 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "check.h"
+#include "stream_queue.h"
+
+using record_core::StreamOverflowPolicy;
+using record_core::StreamQueue;
+using record_core::StreamQueueItem;
+
+namespace
+{
+	constexpr size_t kFrameBytes = 4;
+
+	void PushValue(StreamQueue& queue, uint32_t value)
+	{
+		uint8_t data[kFrameBytes];
+		std::memcpy(data, &value, sizeof(value));
+		queue.Push(data, sizeof(data));
+	}
+
+	// Values of the drained chunks, in order.
+	std::vector<uint32_t> DrainValues(StreamQueue& queue)
+	{
+		std::vector<uint32_t> values;
+		queue.Drain([&values](StreamQueueItem& item) {
+			for (size_t i = 0; i + kFrameBytes <= item.bytes.size(); i += kFrameBytes)
+			{
+				uint32_t value;
+				std::memcpy(&value, item.bytes.data() + i, sizeof(value));
+				values.push_back(value);
+			}
+		});
+		return values;
+	}
+}
+
+RECORD_TEST(DrainIsUnlimitedWithoutCredit)
+{
+	StreamQueue queue(8);
+	queue.Configure(StreamOverflowPolicy::dropNewest, 0, kFrameBytes);
+
+	for (uint32_t i = 0; i < 8; i++) PushValue(queue, i);
+
+	CHECK(DrainValues(queue).size() == 8);
+	CHECK(queue.HasCredit());
+}
+
+RECORD_TEST(DrainStopsAtCredit)
+{
+	StreamQueue queue(16);
+	queue.Configure(StreamOverflowPolicy::dropNewest, 0, kFrameBytes);
+	queue.SetCredit(4);
+
+	for (uint32_t i = 0; i < 10; i++) PushValue(queue, i);
+
+	auto values = DrainValues(queue);
+	CHECK(values.size() == 4);
+	CHECK(values.back() == 3);
+	CHECK(!queue.HasCredit());
+	CHECK(DrainValues(queue).empty());
+
+	queue.Acknowledge(3);
+	values = DrainValues(queue);
+	CHECK(values.size() == 3);
+	CHECK(values.front() == 4);
+	CHECK(queue.Stats().queuedChunks == 3);
+}
+
+RECORD_TEST(StalledConsumerKeepsQueueBounded)
+{
+	// Consumer took its credit and never acknowledges.
+	StreamQueue queue(8);
+	queue.Configure(StreamOverflowPolicy::dropNewest, 0, kFrameBytes);
+	queue.SetCredit(4);
+
+	size_t delivered = 0;
+	for (uint32_t i = 0; i < 1000; i++)
+	{
+		PushValue(queue, i);
+		delivered += DrainValues(queue).size();
+	}
+
+	const auto stats = queue.Stats();
+	CHECK(delivered == 4);
+	CHECK(stats.queuedChunks == 8);
+	CHECK(stats.droppedChunks == 1000 - 4 - 8);
+	CHECK(stats.droppedBytes == stats.droppedChunks * kFrameBytes);
+}
+
+RECORD_TEST(StalledConsumerSpillIsBounded)
+{
+	const size_t maxSpill = 16 * kFrameBytes;
+
+	for (auto policy : { StreamOverflowPolicy::dropOldest, StreamOverflowPolicy::coalesce, StreamOverflowPolicy::block })
+	{
+		StreamQueue queue(4);
+		queue.Configure(policy, maxSpill, kFrameBytes);
+		queue.SetCredit(0);
+
+		for (uint32_t i = 0; i < 1000; i++) PushValue(queue, i);
+
+		const auto stats = queue.Stats();
+		CHECK(stats.queuedChunks == 4);
+		// Everything is either queued, spilled or counted as dropped.
+		CHECK(stats.droppedBytes == (1000 - 4) * kFrameBytes - maxSpill);
+
+		// End of the stream, the spill follows queued chunks.
+		queue.Abort();
+		CHECK(DrainValues(queue).size() == 4);
+		CHECK(queue.FlushSpill());
+		auto spilled = DrainValues(queue);
+		CHECK(spilled.size() == 16);
+		if (spilled.size() == 16)
+		{
+			// Oldest bytes are dropped, or new ones.
+			CHECK(spilled.front() == (policy == StreamOverflowPolicy::dropOldest ? 984u : 4u));
+		}
+	}
+}
+
+RECORD_TEST(PacketsAreDroppedInsteadOfWaiting)
+{
+	StreamQueue queue(2);
+	queue.Configure(StreamOverflowPolicy::block, 1024, 1);
+	queue.SetCredit(0);
+
+	const uint8_t packet[3] = { 1, 2, 3 };
+	record_core::StreamPacketInfo info;
+	CHECK(queue.PushPacket(packet, sizeof(packet), info));
+	CHECK(queue.PushPacket(packet, sizeof(packet), info));
+	// Would wait forever before, the consumer has no credit.
+	CHECK(!queue.PushPacket(packet, sizeof(packet), info));
+	CHECK(queue.Stats().droppedBytes == sizeof(packet));
+}
+
+RECORD_TEST(BlockWaitsOutsideOfProducerLocks)
+{
+	StreamQueue queue(8);
+	queue.Configure(StreamOverflowPolicy::block, 1024 * kFrameBytes, kFrameBytes);
+	queue.SetCredit(0);
+
+	std::atomic<bool> waiting{ false };
+	std::atomic<bool> done{ false };
+
+	std::thread producer([&]() {
+		for (uint32_t i = 0; i < 8; i++) PushValue(queue, i);
+
+		waiting = true;
+		queue.WaitForSpace();
+		done = true;
+	});
+
+	while (!waiting) std::this_thread::yield();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	// Producer waits for the stalled consumer, stats are still available.
+	CHECK(!done);
+	CHECK(queue.Stats().queuedChunks == 8);
+
+	// Consumer acknowledges, half of the slots are released.
+	queue.Acknowledge(4);
+	CHECK(DrainValues(queue).size() == 4);
+
+	producer.join();
+	CHECK(done);
+}
+
+RECORD_TEST(AbortReleasesWaitingProducer)
+{
+	StreamQueue queue(8);
+	queue.Configure(StreamOverflowPolicy::block, 0, kFrameBytes);
+	queue.SetCredit(0);
+
+	for (uint32_t i = 0; i < 8; i++) PushValue(queue, i);
+
+	std::thread producer([&queue]() { queue.WaitForSpace(); });
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	queue.Abort();
+	producer.join();
+
+	// Stream ends, the credit is lifted.
+	CHECK(queue.HasCredit());
+	CHECK(DrainValues(queue).size() == 8);
+
+	queue.Configure(StreamOverflowPolicy::block, 0, kFrameBytes);
+	PushValue(queue, 8);
+	CHECK(!queue.HasCredit());
+	CHECK(DrainValues(queue).empty());
+}
+
+RECORD_TEST(ConcurrentDrainKeepsOrder)
+{
+	StreamQueue queue(64);
+	queue.Configure(StreamOverflowPolicy::dropNewest, 0, kFrameBytes);
+	queue.SetCredit(record_core::kStreamCredit);
+
+	constexpr uint32_t kCount = 200000;
+	std::atomic<bool> finished{ false };
+
+	std::thread producer([&]() {
+		for (uint32_t i = 0; i < kCount; i++) PushValue(queue, i);
+		finished = true;
+	});
+
+	std::vector<uint32_t> received;
+	bool ordered = true;
+	for (;;)
+	{
+		const bool last = finished;
+		auto values = DrainValues(queue);
+
+		for (auto value : values)
+		{
+			ordered = ordered && (received.empty() || value > received.back());
+			received.push_back(value);
+		}
+		// Acknowledged once handled, like the Dart side.
+		queue.Acknowledge(values.size());
+
+		if (last && queue.Stats().queuedChunks == 0)
+		{
+			break;
+		}
+	}
+	producer.join();
+
+	const auto stats = queue.Stats();
+	CHECK(ordered);
+	CHECK(received.size() + stats.droppedChunks == kCount);
+}
+
+RECORD_TEST_MAIN()
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "check.h"
+#include "voice_activity_detector.h"
+
+using record_core::VadConfig;
+using record_core::VadMode;
+using record_core::VoiceActivityDetector;
+
+namespace
+{
+	constexpr double kPi = 3.14159265358979323846;
+	constexpr int kSampleRate = 16000;
+	// Processed blocks, as delivered by a 10ms capture period.
+	constexpr size_t kBlockFrames = kSampleRate / 100;
+
+	enum class Label
+	{
+		silence,
+		voice,
+	};
+
+	struct Segment
+	{
+		Label label;
+		int durationMs;
+		// Level of the segment in dBFS.
+		double levelDb;
+	};
+
+	// Labelled fixture: background noise with voiced segments, and a noise
+	// burst a few dB above the background that must not be taken for voice.
+	const std::vector<Segment> kFixture = {
+		{ Label::silence, 1000, -60.0 },
+		{ Label::voice, 800, -20.0 },
+		{ Label::silence, 1200, -60.0 },
+		{ Label::silence, 500, -52.0 },
+		{ Label::silence, 500, -60.0 },
+		{ Label::voice, 500, -30.0 },
+		{ Label::silence, 1000, -60.0 },
+	};
+
+	struct Fixture
+	{
+		std::vector<int16_t> samples;
+		// Label of each block.
+		std::vector<Label> labels;
+	};
+
+	// Deterministic white noise, RMS at levelDb.
+	class Noise
+	{
+	public:
+		double Next(double levelDb)
+		{
+			m_state = m_state * 1664525u + 1013904223u;
+			// Uniform in [-1, 1), RMS of 1/sqrt(3).
+			const double uniform = static_cast<int32_t>(m_state) / 2147483648.0;
+			return uniform * std::sqrt(3.0) * std::pow(10.0, levelDb / 20.0);
+		}
+
+	private:
+		uint32_t m_state = 12345;
+	};
+
+	int16_t ToS16(double value)
+	{
+		return static_cast<int16_t>(std::lround(std::max(-1.0, std::min(value, 32767.0 / 32768.0)) * 32768.0));
+	}
+
+	Fixture MakeFixture(int numChannels)
+	{
+		Fixture fixture;
+		Noise noise;
+		size_t frame = 0;
+
+		for (const auto& segment : kFixture)
+		{
+			const size_t frameCount = static_cast<size_t>(kSampleRate) * segment.durationMs / 1000;
+
+			for (size_t i = 0; i < frameCount; i++, frame++)
+			{
+				double value = noise.Next(segment.label == Label::voice ? -60.0 : segment.levelDb);
+
+				if (segment.label == Label::voice)
+				{
+					// Vowel like: harmonics of a 150Hz pitch with a 4Hz syllable rate.
+					const double t = static_cast<double>(frame) / kSampleRate;
+					double voice = 0.0;
+					for (int harmonic = 1; harmonic <= 8; harmonic++)
+					{
+						voice += std::sin(2.0 * kPi * 150.0 * harmonic * t) / harmonic;
+					}
+					const double syllable = 0.6 + 0.4 * std::sin(2.0 * kPi * 4.0 * t);
+					// Harmonic sum RMS is about 0.9.
+					value += voice * syllable * std::pow(10.0, segment.levelDb / 20.0);
+				}
+
+				for (int ch = 0; ch < numChannels; ch++)
+				{
+					fixture.samples.push_back(ToS16(value));
+				}
+			}
+
+			for (size_t i = 0; i < frameCount / kBlockFrames; i++)
+			{
+				fixture.labels.push_back(segment.label);
+			}
+		}
+
+		return fixture;
+	}
+
+	VadConfig MakeConfig(VadMode mode)
+	{
+		VadConfig config;
+		config.mode = mode;
+		config.hangoverMs = 200;
+		return config;
+	}
+
+	// Activity of each block.
+	std::vector<bool> Detect(VoiceActivityDetector& vad, const Fixture& fixture, int numChannels)
+	{
+		std::vector<bool> activity;
+		for (size_t block = 0; block < fixture.labels.size(); block++)
+		{
+			vad.Process(fixture.samples.data() + block * kBlockFrames * numChannels, kBlockFrames);
+			activity.push_back(vad.IsActive());
+		}
+		return activity;
+	}
+
+	struct Score
+	{
+		// Voice blocks detected out of voice blocks, onsets excluded.
+		int voiceDetected = 0;
+		int voiceBlocks = 0;
+		// Silence blocks taken for voice out of silence blocks, hangovers excluded.
+		int falseAlarms = 0;
+		int silenceBlocks = 0;
+	};
+
+	Score Evaluate(const std::vector<Label>& labels, const std::vector<bool>& activity)
+	{
+		// Blocks after a transition where either result is accepted.
+		constexpr size_t kOnsetBlocks = 3;
+		constexpr size_t kHangoverBlocks = 20 + 3;
+
+		Score score;
+		size_t sinceVoice = kHangoverBlocks;
+		size_t sinceSilence = 0;
+
+		for (size_t i = 0; i < labels.size(); i++)
+		{
+			if (labels[i] == Label::voice)
+			{
+				sinceVoice = 0;
+				if (++sinceSilence > kOnsetBlocks)
+				{
+					score.voiceBlocks++;
+					score.voiceDetected += activity[i] ? 1 : 0;
+				}
+			}
+			else
+			{
+				sinceSilence = 0;
+				if (++sinceVoice > kHangoverBlocks)
+				{
+					score.silenceBlocks++;
+					score.falseAlarms += activity[i] ? 1 : 0;
+				}
+			}
+		}
+
+		return score;
+	}
+}
+
+RECORD_TEST(DisabledKeepsEverything)
+{
+	VoiceActivityDetector vad;
+	vad.Configure(kSampleRate, 1, VadConfig());
+	CHECK(!vad.IsEnabled());
+
+	const std::vector<int16_t> silence(kBlockFrames, 0);
+	CHECK(vad.Process(silence.data(), silence.size()));
+	CHECK(!vad.IsActive());
+}
+
+RECORD_TEST(LabelledFixtureIsDetected)
+{
+	const auto fixture = MakeFixture(1);
+
+	VoiceActivityDetector vad;
+	vad.Configure(kSampleRate, 1, MakeConfig(VadMode::flag));
+
+	const auto score = Evaluate(fixture.labels, Detect(vad, fixture, 1));
+	CHECK(score.voiceBlocks > 0);
+	CHECK(score.silenceBlocks > 0);
+	// Voice is held for its whole duration, noise is never voiced.
+	CHECK(score.voiceDetected == score.voiceBlocks);
+	CHECK(score.falseAlarms == 0);
+}
+
+RECORD_TEST(StereoFixtureIsDetected)
+{
+	const auto fixture = MakeFixture(2);
+
+	VoiceActivityDetector vad;
+	vad.Configure(kSampleRate, 2, MakeConfig(VadMode::flag));
+
+	const auto score = Evaluate(fixture.labels, Detect(vad, fixture, 2));
+	CHECK(score.voiceDetected == score.voiceBlocks);
+	CHECK(score.falseAlarms == 0);
+}
+
+RECORD_TEST(ActivityChangesOncePerVoiceSegment)
+{
+	const auto fixture = MakeFixture(1);
+
+	VoiceActivityDetector vad;
+	vad.Configure(kSampleRate, 1, MakeConfig(VadMode::flag));
+
+	const auto activity = Detect(vad, fixture, 1);
+	int starts = 0;
+	for (size_t i = 1; i < activity.size(); i++)
+	{
+		starts += activity[i] && !activity[i - 1] ? 1 : 0;
+	}
+	CHECK(starts == 2);
+}
+
+RECORD_TEST(SkipKeepsVoiceAndHangover)
+{
+	const auto fixture = MakeFixture(1);
+
+	VoiceActivityDetector vad;
+	vad.Configure(kSampleRate, 1, MakeConfig(VadMode::skip));
+
+	// Recorders keep blocks Process reports active in skip mode.
+	size_t kept = 0;
+	size_t keptVoice = 0;
+	size_t voice = 0;
+	for (size_t block = 0; block < fixture.labels.size(); block++)
+	{
+		const bool keep = vad.Process(fixture.samples.data() + block * kBlockFrames, kBlockFrames);
+		kept += keep ? 1 : 0;
+
+		if (fixture.labels[block] == Label::voice)
+		{
+			voice++;
+			keptVoice += keep ? 1 : 0;
+		}
+	}
+
+	// Each segment may lose its onset block, gains at most its hangover.
+	CHECK(keptVoice + 2 >= voice);
+	CHECK(kept <= voice + 2 * (20 + 1));
+	CHECK(kept < fixture.labels.size() / 2);
+}
+
+RECORD_TEST(QuietVoiceUnderMinEnergyIsIgnored)
+{
+	const auto fixture = MakeFixture(1);
+
+	VadConfig config = MakeConfig(VadMode::flag);
+	// Voice segments are at -20 and -30 dBFS, above -25 dBFS only the first.
+	config.minEnergyDb = -25.0;
+
+	VoiceActivityDetector vad;
+	vad.Configure(kSampleRate, 1, config);
+
+	const auto activity = Detect(vad, fixture, 1);
+	int starts = 0;
+	for (size_t i = 1; i < activity.size(); i++)
+	{
+		starts += activity[i] && !activity[i - 1] ? 1 : 0;
+	}
+	CHECK(starts == 1);
+}
+
+RECORD_TEST(ResetClearsActivity)
+{
+	const auto fixture = MakeFixture(1);
+
+	VoiceActivityDetector vad;
+	vad.Configure(kSampleRate, 1, MakeConfig(VadMode::flag));
+
+	// Ends within the first voice segment.
+	const size_t voiceEnd = static_cast<size_t>(kSampleRate) * 1500 / 1000;
+	vad.Process(fixture.samples.data(), voiceEnd);
+	CHECK(vad.IsActive());
+
+	vad.Reset();
+	CHECK(!vad.IsActive());
+}
+
+RECORD_TEST_MAIN()